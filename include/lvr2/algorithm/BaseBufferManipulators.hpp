@@ -31,6 +31,7 @@
 #include <chrono>
 #include <algorithm>
 #include <unordered_set>
+#include <vector>
 #include <memory>
 #include <boost/core/typeinfo.hpp>
 
@@ -120,6 +121,40 @@ private:
     const size_t m_right;
 };
 
+class Select : public boost::static_visitor< MultiChannelMap::val_type > 
+{
+public:
+    /**
+     * @param indices   Indices of the elements to keep, in output order
+     */
+    Select(const std::vector<size_t>& indices)
+    :m_indices(indices)
+    {}
+
+    template<typename T>
+    MultiChannelMap::val_type operator()(Channel<T>& channel) const
+    {
+        MultiChannelMap::val_type vres;
+
+        const size_t width = channel.width();
+        Channel<T> ret(m_indices.size(), width);
+
+        const T* in = channel.dataPtr().get();
+        T* out = ret.dataPtr().get();
+
+        #pragma omp parallel for schedule(static)
+        for(size_t i = 0; i < m_indices.size(); i++)
+        {
+            std::copy_n(in + m_indices[i] * width, width, out + i * width);
+        }
+
+        vres = ret;
+        return vres;
+    }
+private:
+    const std::vector<size_t>& m_indices;
+};
+
 class RandomSample : public boost::static_visitor< MultiChannelMap::val_type > 
 {
 public:
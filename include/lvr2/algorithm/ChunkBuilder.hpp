@@ -61,6 +61,21 @@ class ChunkBuilder : public std::enable_shared_from_this<ChunkBuilder>
         std::shared_ptr<std::unordered_map<unsigned int, std::vector<std::weak_ptr<ChunkBuilder>>>>
             vertexUse);
 
+    /**
+     * @brief ChunkBuilder constructs a chunk builder for an already known set of faces
+     *
+     * The duplicate detection of \ref addFace is skipped, no further faces may be added.
+     *
+     * @param originalMesh mesh that is being chunked
+     * @param faces faces of the chunk in the original mesh
+     * @param duplicateVertices vertices of the chunk that are also used by other chunks
+     * @param numVertices number of distinct vertices of the given faces
+     */
+    ChunkBuilder(std::shared_ptr<HalfEdgeMesh<BaseVector<float>>> originalMesh,
+                 std::vector<FaceHandle> faces,
+                 std::vector<VertexHandle> duplicateVertices,
+                 unsigned int numVertices);
+
     ~ChunkBuilder();
 
     /**
@@ -106,14 +106,28 @@ class ChunkManager : public ChunkHashGrid
     /**
      * @brief buildChunks builds chunks from an original mesh
      *
-     * Creates chunks from an original mesh and initializes the initial chunk structure
+     * Creates chunks from an original mesh and initializes the initial chunk structure.
+     * Only chunks that contain faces are created. The chunks are built in parallel.
+     *
+     * If a valid changed area is given, only the chunks intersecting it and the ring of
+     * chunks around it are rewritten, e.g. after the mesh of a layer was regenerated for
+     * a new scan. Duplicate vertices
+     * on the borders to the unchanged chunks are still detected using the whole mesh.
+     * Chunks inside the changed area that no longer contain any faces are not removed.
      *
      * @param mesh mesh which is being chunked
      * @param maxChunkOverlap maximum allowed overlap between chunks relative to the chunk size.
      * Larger triangles will be cut
      * @param savePath UST FOR TESTING - REMOVE LATER ON
+     * @param layer layer of the chunks
+     * @param changedArea area whose chunks (expanded by one chunk) are rewritten, all chunks if invalid
      */
-    void buildChunks(MeshBufferPtr mesh, float maxChunkOverlap, std::string savePath, std::string layer = std::string("mesh"));
+    void buildChunks(MeshBufferPtr mesh,
+                     float maxChunkOverlap,
+                     std::string savePath,
+                     std::string layer = std::string("mesh"),
+                     const BoundingBox<BaseVector<float>>& changedArea
+                     = BoundingBox<BaseVector<float>>());
 
     /**
      * @brief extractArea creates and returns MeshBufferPtr of merged chunks for given area.
@@ -124,10 +124,23 @@ void ChunkingPipeline<BaseVecT>::practicabilityAnalysis(HalfEdgeMesh<BaseVecT>&
     DenseVertexMap <Normal<float>> vertexNormals = calcVertexNormals(hem, faceNormals);
     // Calc average vertex angles
     DenseVertexMap<float> averageAngles = calcAverageVertexAngles(hem, vertexNormals);
-    // Calc roughness
-    DenseVertexMap<float> roughness = calcVertexRoughness(hem, m_roughnessRadius, vertexNormals);
-    // Calc vertex height differences
-    DenseVertexMap<float> heightDifferences = calcVertexHeightDifferences(hem, m_heightDifferencesRadius);
+    // Calc roughness and vertex height differences, in one traversal if the radii are equal
+    DenseVertexMap<float> roughness;
+    DenseVertexMap<float> heightDifferences;
+    LocalNeighborhoodFeatures roughnessFeatures;
+    roughnessFeatures.averageAngles = &averageAngles;
+    roughnessFeatures.roughness = &roughness;
+    if (m_roughnessRadius == m_heightDifferencesRadius)
+    {
+        roughnessFeatures.heightDifferences = &heightDifferences;
+    }
+    else
+    {
+        LocalNeighborhoodFeatures heightFeatures;
+        heightFeatures.heightDifferences = &heightDifferences;
+        LocalNeighborhoodEngine<BaseVecT>(hem, m_heightDifferencesRadius).compute(heightFeatures);
+    }
+    LocalNeighborhoodEngine<BaseVecT>(hem, m_roughnessRadius).compute(roughnessFeatures);
 
     // create and fill channels
     FloatChannel faceNormalChannel(faceNormals.numValues(), channel_type < Normal < float >> ::w);
@@ -292,7 +305,16 @@ bool ChunkingPipeline<BaseVecT>::start(const boost::filesystem::path& scanDir)
         std::cout << timestamp << voxelSizeStr  << "Starting chunking and saving of mesh buffer..." << std::endl;
         // TODO: get maxChunkOverlap size
         // TODO: savePath is not used in buildChunks (remove it?)
-        m_chunkManager->buildChunks(meshBuffer, 0.1f, "", "mesh_" + std::to_string(layer));
+        // only the chunks of the new region have changed, buildChunks also rewrites the
+        // ring of chunks around it whose border faces were regenerated
+        BoundingBox<BaseVector<float>> changedArea;
+        if (newChunksBB.isValid())
+        {
+            changedArea = BoundingBox<BaseVector<float>>(
+                BaseVector<float>(newChunksBB.getMin().x, newChunksBB.getMin().y, newChunksBB.getMin().z),
+                BaseVector<float>(newChunksBB.getMax().x, newChunksBB.getMax().y, newChunksBB.getMax().z));
+        }
+        m_chunkManager->buildChunks(meshBuffer, 0.1f, "", "mesh_" + std::to_string(layer), changedArea);
         std::cout << timestamp << voxelSizeStr  << "Finished chunking and saving of mesh buffer!" << std::endl;
     }
 
@@ -34,6 +34,8 @@
 
 #include "lvr2/geometry/BaseMesh.hpp"
 
+#include <vector>
+
 namespace lvr2
 {
 
@@ -43,20 +45,39 @@ namespace lvr2
  * Faces which have 2 or 3 adjacent boundary edges, are removed. If the face
  * is adjacent to only one boundary edge, it is deleted if the face's area is
  * smaller than `areaThreshold`.
+ *
+ * In each iteration, all faces are classified in parallel on the mesh as it
+ * was at the beginning of the iteration. Faces which become boundary faces by
+ * removing their neighbours are removed in the next iteration. The loop stops
+ * early if an iteration doesn't remove any face.
  */
 template<typename BaseVecT>
 void cleanContours(BaseMesh<BaseVecT>& mesh, int iterations, float areaThreshold);
 
+/**
+ * @brief Finds all holes consisting of less than or equal to `maxSize` edges.
+ *
+ * For each connected part of the mesh, each boundary-contour except the one
+ * with most edges is assumed to be a hole. The contours are extracted in
+ * parallel: contours touching each other in a vertex are traced by the same
+ * thread. The holes are sorted by their smallest edge handle, so the result
+ * doesn't depend on the number of threads.
+ *
+ * @return The edges of each hole in the order of the contour.
+ */
+template<typename BaseVecT>
+std::vector<std::vector<EdgeHandle>> findHoles(const BaseMesh<BaseVecT>& mesh, size_t maxSize);
 
 /**
  * @brief Fills holes consisting of less than or equal to `maxSize` edges.
  *
  * It is a rather simple algorithm, really. For each connected part of the mesh
  * it assumes that each boundary-contour except the one with most edges is a
- * hole. These holes are then filled by collapsing all of their boundary edges
- * until no collapsable edge is left (which happens in any case when the hole
- * has only three edges left). If the remaining hole has only three edges after
- * the previous step, it is filled by simply inserting a triangle.
+ * hole (see `findHoles()`). These holes are then filled by collapsing all of
+ * their boundary edges until no collapsable edge is left (which happens in any
+ * case when the hole has only three edges left). If the remaining hole has
+ * only three edges after the previous step, it is filled by simply inserting
+ * a triangle.
  *
  * Important: this algorithm assumes that the mesh doesn't contain any lonely
  * edges.
@@ -66,6 +87,23 @@ void cleanContours(BaseMesh<BaseVecT>& mesh, int iterations, float areaThreshold
 template<typename BaseVecT>
 size_t naiveFillSmallHoles(BaseMesh<BaseVecT>& mesh, size_t maxSize, bool collapseOnly);
 
+/**
+ * @brief Fills holes consisting of less than or equal to `maxSize` edges with
+ *        a minimal triangulation.
+ *
+ * In contrast to `naiveFillSmallHoles()` no vertices are moved. The holes
+ * found by `findHoles()` are triangulated like in `pmp::SurfaceHoleFilling`:
+ * the triangulation minimizes the maximum dihedral angle between neighbouring
+ * faces first and the area second. The triangulations are computed in
+ * parallel and inserted in the order of the holes afterwards. Holes touching
+ * themselves, or a hole filled before in a way that makes their
+ * triangulation invalid, are left open.
+ *
+ * @return The number of holes that this algorithm wasn't able to fill.
+ */
+template<typename BaseVecT>
+size_t triangulateSmallHoles(BaseMesh<BaseVecT>& mesh, size_t maxSize);
+
 } // namespace lvr2
 
 #include "lvr2/algorithm/CleanupAlgorithms.tcc"
@@ -30,9 +30,17 @@
  */
 
 #include "lvr2/util/Progress.hpp"
+#include "lvr2/util/Timestamp.hpp"
+#include "lvr2/util/Logging.hpp"
+#include "lvr2/util/UnionFind.hpp"
 #include "lvr2/algorithm/ContourAlgorithms.hpp"
 #include "lvr2/attrmaps/AttrMaps.hpp"
-#include "lvr2/util/Timestamp.hpp"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <limits>
+#include <utility>
 
 namespace lvr2
 {
@@ -40,10 +48,25 @@ namespace lvr2
 template<typename BaseVecT>
 void cleanContours(BaseMesh<BaseVecT>& mesh, int iterations, float areaThreshold)
 {
+    vector<FaceHandle> facesToRemove;
     for (int i = 0; i < iterations; i++)
     {
-        for (const auto fH: mesh.faces())
+        // Faces are classified in parallel on the mesh as it was at the
+        // beginning of the iteration and removed afterwards. Faces which
+        // only become boundary faces by these removals are handled in the
+        // next iteration.
+        const size_t numIndices = mesh.nextFaceIndex();
+        vector<char> remove(numIndices, false);
+
+        #pragma omp parallel for schedule(dynamic, 4096)
+        for (size_t idx = 0; idx < numIndices; idx++)
         {
+            const FaceHandle fH(idx);
+            if (!mesh.containsFace(fH))
+            {
+                continue;
+            }
+
             // For each face, we want to count the number of boundary edges
             // adjacent to that face. This can be a number between 0 and 3.
             int boundaryEdgeCount = 0;
@@ -65,216 +88,537 @@ void cleanContours(BaseMesh<BaseVecT>& mesh, int iterations, float areaThreshold
             // with the face.
             if (boundaryEdgeCount >= 2)
             {
-                mesh.removeFace(fH);
+                remove[idx] = true;
             }
             else if (boundaryEdgeCount == 1 && mesh.calcFaceArea(fH) < areaThreshold)
             {
-                mesh.removeFace(fH);
+                remove[idx] = true;
             }
         }
+
+        facesToRemove.clear();
+        for (size_t idx = 0; idx < numIndices; idx++)
+        {
+            if (remove[idx])
+            {
+                facesToRemove.push_back(FaceHandle(idx));
+            }
+        }
+
+        if (facesToRemove.empty())
+        {
+            break;
+        }
+
+        for (auto fH: facesToRemove)
+        {
+            mesh.removeFace(fH);
+        }
     }
 }
 
-
 template<typename BaseVecT>
-size_t naiveFillSmallHoles(BaseMesh<BaseVecT>& mesh, size_t maxSize, bool collapseOnly)
+vector<vector<EdgeHandle>> findHoles(const BaseMesh<BaseVecT>& mesh, size_t maxSize)
 {
+    vector<vector<EdgeHandle>> holes;
+
     // There are no holes with less than three edges.
     if (maxSize < 3)
     {
-        return 0;
+        return holes;
     }
 
-    std::cout << timestamp << "Trying to remove all holes with size ≤ " << maxSize << std::endl;
+    // The indices of edge handles are not necessarily contiguous, so we
+    // collect the handles first and refer to edges by their position.
+    vector<EdgeHandle> edges;
+    edges.reserve(mesh.numEdges());
+    vector<size_t> positionOf(mesh.nextEdgeIndex());
+    for (auto eH: mesh.edges())
+    {
+        positionOf[eH.idx()] = edges.size();
+        edges.push_back(eH);
+    }
+
+    vector<char> isBoundary(edges.size(), false);
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        isBoundary[i] = mesh.numAdjacentFaces(edges[i]) == 1;
+    }
+
+    // Group all boundary edges which share a vertex. Each group consists of
+    // one or more contours which touch each other and is traced by a single
+    // thread, since `walkContour()` may continue with any of the edges.
+    ConcurrentUnionFind groups(edges.size());
+    #pragma omp parallel
+    {
+        vector<EdgeHandle> edgesOfVertex;
+
+        #pragma omp for schedule(dynamic, 4096)
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            if (!isBoundary[i])
+            {
+                continue;
+            }
+
+            for (auto vH: mesh.getVerticesOfEdge(edges[i]))
+            {
+                edgesOfVertex.clear();
+                mesh.getEdgesOfVertex(vH, edgesOfVertex);
+                for (auto otherH: edgesOfVertex)
+                {
+                    const size_t other = positionOf[otherH.idx()];
+                    if (other > i && isBoundary[other])
+                    {
+                        groups.unite(i, other);
+                    }
+                }
+            }
+        }
+    }
+
+    // Collect the edges of each group in ascending order
+    vector<size_t> groupOfEdge(edges.size(), 0);
+    vector<vector<size_t>> groupEdges;
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        if (!isBoundary[i])
+        {
+            continue;
+        }
+        const size_t root = groups.find(i);
+        if (root == i)
+        {
+            groupOfEdge[i] = groupEdges.size();
+            groupEdges.emplace_back();
+        }
+        groupEdges[groupOfEdge[root]].push_back(i);
+    }
 
+    // Trace all contours. Each contour starts at its smallest edge.
+    vector<vector<vector<EdgeHandle>>> groupContours(groupEdges.size());
+    vector<char> visited(edges.size(), false);
+    std::exception_ptr error;
 
-    // First, we need to have a ClusterBiMap where each cluster describes one
-    // connected part of the mesh.
-    auto subMeshes = clusterGrowing(mesh, [](FaceHandle referenceFaceH, FaceHandle currentFaceH)
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t group = 0; group < groupEdges.size(); group++)
+    {
+        try
+        {
+            for (auto i: groupEdges[group])
+            {
+                if (visited[i])
+                {
+                    continue;
+                }
+
+                groupContours[group].emplace_back();
+                calcContourEdges(mesh, edges[i], groupContours[group].back());
+                for (auto edgeH: groupContours[group].back())
+                {
+                    visited[positionOf[edgeH.idx()]] = true;
+                }
+            }
+        }
+        catch (...)
+        {
+            #pragma omp critical
+            {
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    vector<vector<EdgeHandle>> contours;
+    for (auto& contoursOfGroup: groupContours)
+    {
+        for (auto& contour: contoursOfGroup)
+        {
+            contours.push_back(std::move(contour));
+        }
+    }
+    std::sort(contours.begin(), contours.end(), [](const auto& a, const auto& b)
+    {
+        return a[0] < b[0];
+    });
+
+    // Now we have a list of all contours of the mesh. Next, we need to find
+    // the contour with most edges of each connected part of the mesh. This is
+    // a very naive assumption: we say that the contour containing most edges
+    // is the "outer" contour which we don't treat as a hole. This is far from
+    // being universally correct, but works OK for small holes.
+    auto subMeshes = connectedClusterGrowing(mesh, [](FaceHandle faceH, FaceHandle neighbourH)
     {
         return true;
     });
 
-    DenseEdgeMap<bool> visitedEdges(mesh.numEdges(), false);
+    DenseClusterMap<size_t> outerContour;
+    vector<ClusterHandle> clusterOfContour(contours.size());
+    for (size_t i = 0; i < contours.size(); i++)
+    {
+        const auto faces = mesh.getFacesOfEdge(contours[i][0]);
+        const auto faceH = faces[0] ? faces[0].unwrap() : faces[1].unwrap();
+        const auto clusterH = subMeshes.getClusterH(faceH);
+        clusterOfContour[i] = clusterH;
+
+        auto outer = outerContour.get(clusterH);
+        if (!outer || contours[i].size() > contours[*outer].size())
+        {
+            outerContour.insert(clusterH, i);
+        }
+    }
+
+    // We assume that all remaining contours are holes we could fill.
+    for (size_t i = 0; i < contours.size(); i++)
+    {
+        if (outerContour[clusterOfContour[i]] != i && contours[i].size() <= maxSize)
+        {
+            holes.push_back(std::move(contours[i]));
+        }
+    }
+
+    return holes;
+}
+
+template<typename BaseVecT>
+size_t naiveFillSmallHoles(BaseMesh<BaseVecT>& mesh, size_t maxSize, bool collapseOnly)
+{
+    // There are no holes with less than three edges.
+    if (maxSize < 3)
+    {
+        return 0;
+    }
+
+    std::cout << timestamp << "Trying to remove all holes with size ≤ " << maxSize << std::endl;
+
+    auto contours = findHoles(mesh, maxSize);
 
     // We count how many holes we were unable to fill. This happens when a hole
     // has many non-collapsable edges.
     size_t failedToFillCount = 0;
 
-    // This is only used later but created here to avoid useless heap
-    // allocations.
-    vector<vector<EdgeHandle>> contours;
+    // The contour each boundary edge belongs to. This lets us fix edges
+    // invalidated by a collapse without searching all contours.
+    SparseEdgeMap<size_t> contourOfEdge;
+    for (size_t i = 0; i < contours.size(); i++)
+    {
+        for (auto edgeH: contours[i])
+        {
+            contourOfEdge.insert(edgeH, i);
+        }
+    }
 
-    // We execute the algorithm for each connected part of the mesh
     string comment = timestamp.getElapsedTime() + "Trying to remove all holes ";
+    ProgressBar progress(contours.size(), comment);
 
-    ProgressBar progress(subMeshes.numCluster(), comment);
-    for (auto clusterH: subMeshes)
+    // We need the index later and can't use a range based for loop.
+    for (size_t contourIdx = 0; contourIdx < contours.size(); contourIdx++)
     {
         if(!timestamp.isQuiet())
             ++progress;
-        contours.clear();
 
-        // We only use this within the loop, but create it here to avoid
-        // useless heap allocations.
-        vector<EdgeHandle> contourEdges;
+        auto& contour = contours[contourIdx];
 
-        for (auto faceH: subMeshes[clusterH])
+        // Collapse as many edges as possible, but already stop when we
+        // have less than 4 edges left.
+        while (contour.size() > 3)
         {
-            for (auto eH: mesh.getEdgesOfFace(faceH))
+            auto collapsableEdge = std::find_if(contour.begin(), contour.end(), [&](auto edgeH)
             {
-                // Skip already visited edges and mark edge as visited
-                if (visitedEdges[eH])
-                {
-                    continue;
-                }
-                visitedEdges[eH] = true;
-
-                // We are only interested in boundary edges
-                if (mesh.numAdjacentFaces(eH) != 1)
-                {
-                    continue;
-                }
+                return mesh.isCollapsable(edgeH);
+            });
 
-                // Get full contour and store it in our list
-                contourEdges.clear();
-                calcContourEdges(mesh, eH, contourEdges);
-                contours.emplace_back(contourEdges);
+            // In case there is no collapsable edge anymore
+            if (collapsableEdge == contour.end())
+            {
+                break;
+            }
 
-                // Mark all edges in the contour we just added as visited
-                for (auto edgeH: contours.back())
+            // Collapse edge and remove it from the list of contours
+            auto collapseResult = mesh.collapseEdge(*collapsableEdge);
+            contourOfEdge.erase(*collapsableEdge);
+            contour.erase(collapsableEdge);
+
+            // It may happen that the edge collapse invalidated an edge
+            // from our list. We need to fix that.
+            //
+            // First, we know that only one face will be collapsed, so we
+            // can just deal with that one.
+            auto removedNeighbor = collapseResult.neighbors[0]
+                ? *(collapseResult.neighbors[0])
+                : *(collapseResult.neighbors[1]);
+
+            // We have to check if the removed edges are referenced
+            // anywhere. If yes, we have to fix those occurrences to avoid
+            // referencing invalid edges later. But we only store boundary
+            // edges, so we only need to fix anything if the new edge is
+            // still a boundary edge. That means that it is referred to
+            // somewhere.
+            if (mesh.numAdjacentFaces(removedNeighbor.newEdge) < 2)
+            {
+                for (auto removedEdgeH: removedNeighbor.removedEdges)
                 {
-                    visitedEdges[edgeH] = true;
+                    // Each edge is only part of one contour
+                    auto i = contourOfEdge.erase(removedEdgeH);
+                    if (!i || *i < contourIdx)
+                    {
+                        continue;
+                    }
+
+                    // We replace the handle with the new one
+                    auto& contourToFix = contours[*i];
+                    auto it = std::find(contourToFix.begin(), contourToFix.end(), removedEdgeH);
+                    if (it != contourToFix.end())
+                    {
+                        *it = removedNeighbor.newEdge;
+                        contourOfEdge.insert(removedNeighbor.newEdge, *i);
+                    }
                 }
             }
         }
 
-        // It can actually happen that a cluster doesn't contain any contour
-        // edges that we haven't visited before. In that case, just ignore it.
-        if (contours.size() == 0)
+        if (collapseOnly)
         {
             continue;
         }
 
-        // Now we have a list of all contours of the current part of the mesh.
-        // Next, we need to find the contour with most vertices and delete it
-        // from the list. This is a very naive assumption: we say that the
-        // contour containing most edges is the "outer" contour which we don't
-        // treat as a hole. This is far from being universally correct, but
-        // works OK for small holes.
-        size_t maxIdx = 0;
-        for (size_t i = 1; i < contours.size(); i++)
+        // We collapsed as many edges as we could. In most cases, there is
+        // only one or two triangles left which we can close right ahead.
+        // Otherwise, we just leave the hole.
+        if (contour.size() == 3)
         {
-            if (contours[i].size() > contours[maxIdx].size())
-            {
-                maxIdx = i;
-            }
+            // The edges in `contour` are already in the correct order.
+            auto v0 = mesh.getVertexBetween(contour[0], contour[1]).unwrap();
+            auto v1 = mesh.getVertexBetween(contour[1], contour[2]).unwrap();
+            auto v2 = mesh.getVertexBetween(contour[2], contour[0]).unwrap();
+            mesh.addFace(v0, v1, v2);
+        }
+        else
+        {
+            failedToFillCount += 1;
         }
-        contours.erase(contours.begin() + maxIdx);
+    }
+
+    if(!timestamp.isQuiet())
+    {
+        std::cout << std::endl;
+    }
+
+    return failedToFillCount;
+}
+
+template<typename BaseVecT>
+size_t triangulateSmallHoles(BaseMesh<BaseVecT>& mesh, size_t maxSize)
+{
+    auto holes = findHoles(mesh, maxSize);
+    if (holes.empty())
+    {
+        return 0;
+    }
+
+    lvr2::logout::get() << lvr2::info << "[CleanupAlgorithms] Triangulating " << holes.size()
+                        << " holes with size ≤ " << maxSize << lvr2::endl;
+
+    using CoordT = typename BaseVecT::CoordType;
 
-        // We assume that all remaining contours are holes we could fill. (And
-        // yes, we need the index later and can't use a range based for loop).
-        for (size_t contourIdx = 0; contourIdx < contours.size(); contourIdx++)
+    // Weight of a triangulation: the maximum dihedral angle (measured as
+    // 1 - cos) and the sum of the (squared) triangle areas. Triangulations
+    // are compared lexicographically.
+    using Weight = std::pair<CoordT, CoordT>;
+    const Weight infinite(std::numeric_limits<CoordT>::max(), std::numeric_limits<CoordT>::max());
+
+    // The triangles of each hole as indices into its vertex list
+    vector<vector<std::array<size_t, 3>>> triangles(holes.size());
+    vector<vector<VertexHandle>> holeVertices(holes.size());
+
+    #pragma omp parallel
+    {
+        vector<VertexHandle> vertices;
+        vector<VertexHandle> opposite;
+        vector<Weight> weight;
+        vector<size_t> split;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t h = 0; h < holes.size(); h++)
         {
-            auto& contour = contours[contourIdx];
+            const auto& hole = holes[h];
+            const size_t n = hole.size();
+
+            // Vertex i is the start of edge i in walking direction, which is
+            // the orientation of the faces filling the hole
+            vertices.clear();
+            opposite.clear();
+            for (size_t i = 0; i < n; i++)
+            {
+                vertices.push_back(mesh.getVertexBetween(hole[(i + n - 1) % n], hole[i]).unwrap());
+                const auto faces = mesh.getFacesOfEdge(hole[i]);
+                const auto faceH = faces[0] ? faces[0].unwrap() : faces[1].unwrap();
+                opposite.push_back(mesh.getOppositeVertex(faceH, hole[i]).unwrap());
+            }
 
-            // We only try to fill the hole if it is smaller than the threshold
-            if (contour.size() > maxSize)
+            // Contours touching themselves can't be filled by a triangulation
+            auto sorted = vertices;
+            std::sort(sorted.begin(), sorted.end());
+            if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
             {
                 continue;
             }
 
-            // Collapse as many edges as possible, but already stop when we
-            // have less than 4 edges left.
-            while (contour.size() > 3)
+            auto normal = [&](VertexHandle a, VertexHandle b, VertexHandle c)
+            {
+                const BaseVecT& pa = mesh.getVertexPosition(a);
+                auto cross = (mesh.getVertexPosition(b) - pa).cross(mesh.getVertexPosition(c) - pa);
+                return cross.length2() == 0 ? cross : cross.normalized();
+            };
+
+            auto isInteriorEdge = [&](VertexHandle a, VertexHandle b)
+            {
+                auto edgeH = mesh.getEdgeBetween(a, b);
+                return edgeH && mesh.numAdjacentFaces(edgeH.unwrap()) == 2;
+            };
+
+            // Minimal triangulation of the polygon [i, k] by dynamic
+            // programming, see Liepa: "Filling Holes in Meshes"
+            weight.assign(n * n, infinite);
+            split.assign(n * n, 0);
+            for (size_t i = 0; i + 1 < n; i++)
+            {
+                weight[i * n + i + 1] = Weight(0, 0);
+            }
+
+            auto triangleWeight = [&](size_t i, size_t m, size_t k)
             {
-                auto collapsableEdge = std::find_if(contour.begin(), contour.end(), [&](auto edgeH)
+                const auto a = vertices[i];
+                const auto b = vertices[m];
+                const auto c = vertices[k];
+
+                // If one of the edges already exists inside the mesh, this
+                // would result in an invalid triangulation
+                if (isInteriorEdge(a, b) || isInteriorEdge(b, c) || isInteriorEdge(c, a))
                 {
-                    return mesh.isCollapsable(edgeH);
-                });
+                    return infinite;
+                }
+
+                const BaseVecT& pa = mesh.getVertexPosition(a);
+                const CoordT area = (mesh.getVertexPosition(b) - pa).cross(mesh.getVertexPosition(c) - pa).length2();
+                const auto n0 = normal(a, b, c);
 
-                // In case there is no collapsable edge anymore
-                if (collapsableEdge == contour.end())
+                // Dihedral angles with the neighbours of (i, m), (m, k) and
+                // (k, i), which are either existing faces or triangles of
+                // the sub polygons
+                auto d = (i + 1 == m) ? opposite[i] : vertices[split[i * n + m]];
+                CoordT angle = 1 - n0.dot(normal(a, d, b));
+
+                d = (m + 1 == k) ? opposite[m] : vertices[split[m * n + k]];
+                angle = std::max(angle, 1 - n0.dot(normal(b, d, c)));
+
+                if (i == 0 && k + 1 == n)
                 {
-                    break;
+                    angle = std::max(angle, 1 - n0.dot(normal(c, opposite[k], a)));
                 }
 
-                // Collapse edge and remove it from the list of contours
-                auto collapseResult = mesh.collapseEdge(*collapsableEdge);
-                contour.erase(collapsableEdge);
-
-                // It may happen that the edge collapse invalidated an edge
-                // from our list. We need to fix that.
-                //
-                // First, we know that only one face will be collapsed, so we
-                // can just deal with that one.
-                auto removedNeighbor = collapseResult.neighbors[0]
-                    ? *(collapseResult.neighbors[0])
-                    : *(collapseResult.neighbors[1]);
-
-                // We have to check if the removed edges are referenced
-                // anywhere. If yes, we have to fix those occurrences to avoid
-                // referencing invalid edges later. But we only store boundary
-                // edges, so we only need to fix anything if the new edge is
-                // still a boundary edge. That means that it is referred to
-                // somewhere.
-                if (mesh.numAdjacentFaces(removedNeighbor.newEdge) < 2)
+                return Weight(angle, area);
+            };
+
+            for (size_t j = 2; j < n; j++)
+            {
+                for (size_t i = 0; i + j < n; i++)
                 {
-                    for (auto removedEdgeH: removedNeighbor.removedEdges)
+                    const size_t k = i + j;
+                    Weight best = infinite;
+                    for (size_t m = i + 1; m < k; m++)
                     {
-                        for (size_t i = contourIdx; i < contours.size(); i++)
+                        const Weight& left = weight[i * n + m];
+                        const Weight& right = weight[m * n + k];
+                        if (left == infinite || right == infinite)
+                        {
+                            continue;
+                        }
+                        const Weight w = triangleWeight(i, m, k);
+                        if (w == infinite)
                         {
-                            auto& contourToFix = contours[i];
-                            auto it = std::find(contourToFix.begin(), contourToFix.end(), removedEdgeH);
-                            if (it != contourToFix.end())
-                            {
-                                // We replace the handle with the new one
-                                *it = removedNeighbor.newEdge;
-
-                                // We can stop here, because each edge is only
-                                // part of one contour.
-                                break;
-                            }
+                            continue;
+                        }
+                        const Weight sum(std::max({left.first, w.first, right.first}), left.second + w.second + right.second);
+                        if (sum < best)
+                        {
+                            best = sum;
+                            split[i * n + k] = m;
                         }
                     }
-                }
-
-                // If the removed face belongs to a cluster different from the
-                // current one, we also have to remove the face there.
-                auto clusterH = subMeshes.getClusterOf(removedNeighbor.removedFace);
-                if (clusterH)
-                {
-                    subMeshes.removeFromCluster(clusterH.unwrap(), removedNeighbor.removedFace);
+                    weight[i * n + k] = best;
                 }
             }
 
-            if (collapseOnly)
+            if (weight[n - 1] == infinite)
             {
                 continue;
             }
 
-            // We collapsed as many edges as we could. In most cases, there is
-            // only one or two triangles left which we can close right ahead.
-            // Otherwise, we just leave the hole.
-            if (contour.size() == 3)
-            {
-                // The edges in `contour` are already in the correct order.
-                auto v0 = mesh.getVertexBetween(contour[0], contour[1]).unwrap();
-                auto v1 = mesh.getVertexBetween(contour[1], contour[2]).unwrap();
-                auto v2 = mesh.getVertexBetween(contour[2], contour[0]).unwrap();
-                mesh.addFace(v0, v1, v2);
-            }
-            else
+            // Extract the triangles of the optimal triangulation
+            vector<std::pair<size_t, size_t>> todo = {{0, n - 1}};
+            while (!todo.empty())
             {
-                failedToFillCount += 1;
+                auto range = todo.back();
+                todo.pop_back();
+                if (range.second - range.first < 2)
+                {
+                    continue;
+                }
+                const size_t m = split[range.first * n + range.second];
+                triangles[h].push_back({range.first, m, range.second});
+                todo.push_back({range.first, m});
+                todo.push_back({m, range.second});
             }
+            holeVertices[h] = vertices;
         }
     }
 
-    if(!timestamp.isQuiet())
+    // Adding faces is not thread safe, so the triangulations are inserted
+    // one after another. A hole sharing vertices with a hole filled before
+    // is skipped if its triangulation is no longer valid.
+    size_t failedToFillCount = 0;
+    lvr2::Monitor monitor(lvr2::LogLevel::info, "[CleanupAlgorithms] Filling holes", holes.size());
+    for (size_t h = 0; h < holes.size(); h++)
     {
-        std::cout << std::endl;
+        ++monitor;
+        const auto& vertices = holeVertices[h];
+
+        bool valid = !triangles[h].empty();
+        for (size_t i = 0; valid && i < holes[h].size(); i++)
+        {
+            valid = mesh.containsEdge(holes[h][i]) && mesh.numAdjacentFaces(holes[h][i]) == 1;
+        }
+        for (size_t t = 0; valid && t < triangles[h].size(); t++)
+        {
+            for (size_t j = 0; valid && j < 3; j++)
+            {
+                auto edgeH = mesh.getEdgeBetween(vertices[triangles[h][t][j]], vertices[triangles[h][t][(j + 1) % 3]]);
+                valid = !edgeH || mesh.numAdjacentFaces(edgeH.unwrap()) < 2;
+            }
+        }
+
+        if (!valid)
+        {
+            failedToFillCount += 1;
+            continue;
+        }
+
+        for (const auto& triangle: triangles[h])
+        {
+            mesh.addFace(vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]]);
+        }
     }
+    monitor.terminate();
 
     return failedToFillCount;
 }
@@ -148,15 +148,35 @@ BoundingRectangle<typename BaseVecT::CoordType> calculateBoundingRectangle(
 /**
  * @brief Algorithm which generates clusters from the given mesh. The given predicate decides which faces will be in
  *        the same clusters.
+ *
+ * Several clusters are grown speculatively in parallel. The result is the same as growing the clusters one after
+ * another from the unvisited face with the smallest index, independent of the number of threads.
+ *
  * @tparam Pred a predicate which decides, which faces will be in the same cluster. It gets the following parameters:
  *         (FaceHandle referenceFaceH, FaceHandle currentFaceH) and returs a bool. The referenceFaceH is the first
  *         FaceHandle, which was added to the current cluster. currentFaceH is the current FaceHandle for which the
  *         predicate has to decide, whether it should be added to the current cluster or not. The decision is done
- *         by returing true = add currentFaceH to cluster or false = don't add currentFaceH to cluster.
+ *         by returing true = add currentFaceH to cluster or false = don't add currentFaceH to cluster. The
+ *         predicate is called concurrently from several threads.
  */
 template<typename BaseVecT, typename Pred>
 ClusterBiMap<FaceHandle> clusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pred);
 
+/**
+ * @brief Algorithm which generates clusters of connected faces from the given mesh in parallel. Two neighbouring
+ *        faces are in the same cluster if the given predicate holds for them.
+ *
+ * In contrast to `clusterGrowing()` the predicate decides about pairs of faces sharing an edge, so the clusters are
+ * the connected components of the mesh after removing all edges the predicate rejects. The components are labeled
+ * with a concurrent union-find. Clusters are created in the order of their smallest face index and contain their
+ * faces in ascending index order, so the result does not depend on the number of threads.
+ *
+ * @tparam Pred a symmetric predicate with the parameters (FaceHandle faceH, FaceHandle neighbourH) which returns true
+ *         if the two neighbouring faces belong to the same cluster. It is called concurrently from several threads.
+ */
+template<typename BaseVecT, typename Pred>
+ClusterBiMap<FaceHandle> connectedClusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pred);
+
 /**
  * @brief Algorithm which generates plane clusters from the given mesh.
  * @param minSinAngle `1 - minSinAngle` is the allowed difference between the sin of the angle of the starting
@@ -195,6 +215,7 @@ ClusterBiMap<FaceHandle> iterativePlanarClusterGrowing(
  *                    face and all other faces in one cluster.
  * @param numIterations for cluster improvement
  * @param minClusterSize minimum size for clusters (number of faces) for which a regression plane should be generated
+ * @param seed seed for the RANSAC plane fitting, see `calcRegressionPlanesRANSAC()`
  */
 template<typename BaseVecT>
 ClusterBiMap<FaceHandle> iterativePlanarClusterGrowingRANSAC(
@@ -204,7 +225,8 @@ ClusterBiMap<FaceHandle> iterativePlanarClusterGrowingRANSAC(
     int numIterations,
     int minClusterSize,
     int ransacIterations = 100,
-    int ransacSamples = 10
+    int ransacSamples = 10,
+    unsigned int seed = 0
 );
 
 /// Calcs a regression plane for the given cluster
@@ -215,14 +237,15 @@ Plane<BaseVecT> calcRegressionPlane(
     const FaceMap<Normal<typename BaseVecT::CoordType>>& normals
 );
 
-/// Calcs a regression plane for the given cluster
+/// Calcs a regression plane for the given cluster. The samples are drawn from a generator initialized with seed.
 template<typename BaseVecT>
 Plane<BaseVecT> calcRegressionPlaneRANSAC(
     const BaseMesh<BaseVecT>& mesh,
     const Cluster<FaceHandle>& cluster,
     const FaceMap<Normal<typename BaseVecT::CoordType>>& normals,
     const int num_iterations = 100,
-    const int num_samples = 10
+    const int num_samples = 10,
+    unsigned int seed = 0
 );
 
 /// Calcs a regression plane for the given cluster
@@ -236,7 +259,7 @@ Plane<BaseVecT> calcRegressionPlanePCA(
 );
 
 /**
- * @brief Calcs regression planes for all cluster in clusters
+ * @brief Calcs regression planes for all cluster in clusters. The planes are fitted concurrently.
  * @param minClusterSize minimum size for clusters (number of faces) for which a regression plane should be generated
  * @return map from cluster handle to its regression plane (clusterH -> Plane)
  */
@@ -249,8 +272,10 @@ DenseClusterMap<Plane<BaseVecT>> calcRegressionPlanes(
 );
 
 /**
- * @brief Calcs regression planes for all cluster in clusters
+ * @brief Calcs regression planes for all cluster in clusters. The planes are fitted concurrently.
  * @param minClusterSize minimum size for clusters (number of faces) for which a regression plane should be generated
+ * @param seed each cluster draws its samples from its own generator, which is seeded with this seed and the cluster
+ *             handle. The result only depends on the seed and not on the number of threads.
  * @return map from cluster handle to its regression plane (clusterH -> Plane)
  */
 template<typename BaseVecT>
@@ -260,7 +285,8 @@ DenseClusterMap<Plane<BaseVecT>> calcRegressionPlanesRANSAC(
     const FaceMap<Normal<typename BaseVecT::CoordType>>& normals,
     int minClusterSize,
     int iterations = 100,
-    int samples = 10
+    int samples = 10,
+    unsigned int seed = 0
 );
 
 /// Drags all points from the given cluster into the given plane
@@ -48,14 +48,19 @@
 #include "lvr2/util/Debug.hpp"
 #include "lvr2/util/Progress.hpp"
 #include "lvr2/util/Timestamp.hpp"
+#include "lvr2/util/UnionFind.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <complex>
 #include <sstream>
 #include <cmath>
 #include <limits>
+#include <random>
 #include <unordered_set>
 
+#include <omp.h>
+
 using std::unordered_set;
 using std::max;
 
@@ -66,7 +71,7 @@ template<typename BaseVecT>
 void removeDanglingCluster(BaseMesh<BaseVecT>& mesh, size_t sizeThreshold)
 {
     // Do cluster growing without a predicate, so cluster will consist of connected faces
-    auto clusterSet = clusterGrowing(mesh, [](auto referenceFaceH, auto currentFaceH)
+    auto clusterSet = connectedClusterGrowing(mesh, [](auto faceH, auto neighbourH)
     {
         return true;
     });
@@ -398,42 +403,162 @@ template<typename BaseVecT, typename Pred>
 ClusterBiMap<FaceHandle> clusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pred)
 {
     ClusterBiMap<FaceHandle> clusters;
-    DenseFaceMap<bool> visited(mesh.numFaces(), false);
+    const size_t numIndices = mesh.nextFaceIndex();
+    DenseFaceMap<bool> visited(numIndices, false);
 
     // This vector is only used later, but in order to avoid heap allocations
     // we will create this list here to retain the buffer.
     vector<FaceHandle> faceNeighbours;
 
-    // Iterate over all faces
-    for (auto faceH: mesh.faces())
+    // Serial growing of the cluster starting at faceH. This is the reference
+    // algorithm, the speculative rounds below produce exactly its result.
+    auto growCluster = [&](FaceHandle faceH)
     {
-        // Check if face is in a cluster (i.e. we have not visited it)
-        if (!visited[faceH])
+        // We found a face yet to be visited. Prepare things for growing.
+        vector<FaceHandle> stack;
+        stack.push_back(faceH);
+        auto cluster = clusters.createCluster();
+
+        // Grow my cluster, groOW!
+        while (!stack.empty())
+        {
+            auto currentFace = stack.back();
+            stack.pop_back();
+
+            // Check if the last faces from stack and starting face match the criteria to join the same cluster
+            if (!visited[currentFace] && pred(faceH, currentFace))
+            {
+                // The face matched the criteria => add it to cluster and mark as visited.
+                clusters.addToCluster(cluster, currentFace);
+                visited[currentFace] = true;
+
+                // Find all unvisited neighbours of the current face and them to the stack
+                faceNeighbours.clear();
+                mesh.getNeighboursOfFace(currentFace, faceNeighbours);
+                for (auto neighbour: faceNeighbours)
+                {
+                    if (!visited[neighbour])
+                    {
+                        stack.push_back(neighbour);
+                    }
+                }
+            }
+        }
+    };
+
+    const size_t numThreads = omp_get_max_threads();
+    if (numThreads == 1)
+    {
+        // Iterate over all faces
+        for (auto faceH: mesh.faces())
+        {
+            // Check if face is in a cluster (i.e. we have not visited it)
+            if (!visited[faceH])
+            {
+                growCluster(faceH);
+            }
+        }
+        return clusters;
+    }
+
+    // The clusters are grown in rounds. Each round takes the next unvisited
+    // faces as candidate seeds and grows all of them concurrently. A face
+    // belongs to the candidate which claimed it last, where candidates with
+    // a lower rank may take faces from higher ranks, and a candidate gives up
+    // as soon as it reaches a face of a lower rank. Afterwards the candidates
+    // are committed in rank order, i.e. in the order the serial algorithm
+    // would use them as seeds. A speculative cluster is only taken over if it
+    // is complete and disjoint from all clusters committed before, otherwise
+    // it is grown again serially.
+    const size_t numCandidates = 4 * numThreads;
+    vector<std::atomic<uint64_t>> claims(numIndices);
+    for (auto& claim: claims)
+    {
+        claim.store(0, std::memory_order_relaxed);
+    }
+
+    vector<FaceHandle> seeds;
+    vector<vector<FaceHandle>> regions(numCandidates);
+    vector<char> aborted(numCandidates);
+
+    size_t nextSeed = 0;
+    uint64_t round = 0;
+    while (true)
+    {
+        seeds.clear();
+        for (; nextSeed < numIndices && seeds.size() < numCandidates; nextSeed++)
+        {
+            FaceHandle faceH(nextSeed);
+            if (mesh.containsFace(faceH) && !visited[faceH])
+            {
+                seeds.push_back(faceH);
+            }
+        }
+        if (seeds.empty())
+        {
+            break;
+        }
+        round++;
+
+        #pragma omp parallel
         {
-            // We found a face yet to be visited. Prepare things for growing.
             vector<FaceHandle> stack;
-            stack.push_back(faceH);
-            auto cluster = clusters.createCluster();
+            vector<FaceHandle> neighbours;
 
-            // Grow my cluster, groOW!
-            while (!stack.empty())
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t rank = 0; rank < seeds.size(); rank++)
             {
-                auto currentFace = stack.back();
-                stack.pop_back();
+                const FaceHandle seedH = seeds[rank];
+                const uint64_t tag = (round << 32) | (rank + 1);
+                vector<FaceHandle>& region = regions[rank];
+                region.clear();
+                aborted[rank] = false;
+
+                // Faces of the current round are still unvisited from the
+                // point of view of this candidate unless it owns them
+                auto isVisited = [&](FaceHandle faceH)
+                {
+                    return visited[faceH] || claims[faceH.idx()].load(std::memory_order_relaxed) == tag;
+                };
 
-                // Check if the last faces from stack and starting face match the criteria to join the same cluster
-                if (!visited[currentFace] && pred(faceH, currentFace))
+                stack.clear();
+                stack.push_back(seedH);
+                while (!stack.empty() && !aborted[rank])
                 {
-                    // The face matched the criteria => add it to cluster and mark as visited.
-                    clusters.addToCluster(cluster, currentFace);
-                    visited[currentFace] = true;
-
-                    // Find all unvisited neighbours of the current face and them to the stack
-                    faceNeighbours.clear();
-                    mesh.getNeighboursOfFace(currentFace, faceNeighbours);
-                    for (auto neighbour: faceNeighbours)
+                    auto currentFace = stack.back();
+                    stack.pop_back();
+
+                    if (isVisited(currentFace) || !pred(seedH, currentFace))
+                    {
+                        continue;
+                    }
+
+                    uint64_t owner = claims[currentFace.idx()].load(std::memory_order_relaxed);
+                    while (true)
                     {
-                        if (!visited[neighbour])
+                        if (owner >> 32 == round && (owner & 0xffffffff) < rank + 1)
+                        {
+                            // Most likely this face belongs to a cluster
+                            // which is committed before this one
+                            aborted[rank] = true;
+                            break;
+                        }
+                        if (claims[currentFace.idx()].compare_exchange_weak(owner, tag, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    if (aborted[rank])
+                    {
+                        break;
+                    }
+
+                    region.push_back(currentFace);
+                    neighbours.clear();
+                    mesh.getNeighboursOfFace(currentFace, neighbours);
+                    for (auto neighbour: neighbours)
+                    {
+                        if (!isVisited(neighbour))
                         {
                             stack.push_back(neighbour);
                         }
@@ -441,6 +566,96 @@ ClusterBiMap<FaceHandle> clusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pre
                 }
             }
         }
+
+        for (size_t rank = 0; rank < seeds.size(); rank++)
+        {
+            if (visited[seeds[rank]])
+            {
+                continue;
+            }
+
+            const uint64_t tag = (round << 32) | (rank + 1);
+            bool valid = !aborted[rank];
+            for (size_t i = 0; valid && i < regions[rank].size(); i++)
+            {
+                const FaceHandle faceH = regions[rank][i];
+                valid = !visited[faceH] && claims[faceH.idx()].load(std::memory_order_relaxed) == tag;
+            }
+
+            if (!valid)
+            {
+                growCluster(seeds[rank]);
+                continue;
+            }
+
+            auto cluster = clusters.createCluster();
+            for (auto faceH: regions[rank])
+            {
+                clusters.addToCluster(cluster, faceH);
+                visited[faceH] = true;
+            }
+        }
+    }
+
+    return clusters;
+}
+
+template<typename BaseVecT, typename Pred>
+ClusterBiMap<FaceHandle> connectedClusterGrowing(const BaseMesh<BaseVecT>& mesh, Pred pred)
+{
+    const size_t numIndices = mesh.nextFaceIndex();
+    ConcurrentUnionFind components(numIndices);
+
+    // Unite neighbouring faces. Each pair is checked once, by the face with
+    // the smaller index.
+    #pragma omp parallel
+    {
+        vector<FaceHandle> faceNeighbours;
+
+        #pragma omp for schedule(dynamic, 4096)
+        for (size_t i = 0; i < numIndices; i++)
+        {
+            FaceHandle faceH(i);
+            if (!mesh.containsFace(faceH))
+            {
+                continue;
+            }
+
+            faceNeighbours.clear();
+            mesh.getNeighboursOfFace(faceH, faceNeighbours);
+            for (auto neighbour: faceNeighbours)
+            {
+                if (neighbour.idx() > i && pred(faceH, neighbour))
+                {
+                    components.unite(i, neighbour.idx());
+                }
+            }
+        }
+    }
+
+    vector<size_t> roots(numIndices);
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numIndices; i++)
+    {
+        roots[i] = components.find(i);
+    }
+
+    // The root of each component is its smallest face, so it is visited
+    // before all other faces of its component
+    ClusterBiMap<FaceHandle> clusters;
+    vector<ClusterHandle> clusterOfRoot(numIndices, ClusterHandle(0));
+    for (size_t i = 0; i < numIndices; i++)
+    {
+        FaceHandle faceH(i);
+        if (!mesh.containsFace(faceH))
+        {
+            continue;
+        }
+        if (roots[i] == i)
+        {
+            clusterOfRoot[i] = clusters.createCluster();
+        }
+        clusters.addToCluster(clusterOfRoot[roots[i]], faceH);
     }
 
     return clusters;
@@ -500,7 +715,8 @@ ClusterBiMap<FaceHandle> iterativePlanarClusterGrowingRANSAC(
     int numIterations,
     int minClusterSize,
     int ransacIterations,
-    int ransacSamples
+    int ransacSamples,
+    unsigned int seed
 )
 {
     ClusterBiMap<FaceHandle> clusters;
@@ -520,7 +736,8 @@ ClusterBiMap<FaceHandle> iterativePlanarClusterGrowingRANSAC(
                     normals,
                     minClusterSize,
                     ransacIterations,
-                    ransacSamples);
+                    ransacSamples,
+                    seed);
 
         // Drag vertices into planes
         dragToRegressionPlanes(mesh, clusters, planes, normals);
@@ -531,6 +748,15 @@ ClusterBiMap<FaceHandle> iterativePlanarClusterGrowingRANSAC(
     return clusters;
 }
 
+/// Derives the RANSAC seed of a single cluster from the seed of the whole run
+inline unsigned int clusterSeed(unsigned int seed, ClusterHandle clusterH)
+{
+    std::seed_seq sequence{seed, static_cast<unsigned int>(clusterH.idx())};
+    unsigned int clusterSeed;
+    sequence.generate(&clusterSeed, &clusterSeed + 1);
+    return clusterSeed;
+}
+
 template<typename BaseVecT>
 DenseClusterMap<Plane<BaseVecT>> calcRegressionPlanes(
     const BaseMesh<BaseVecT>& mesh,
@@ -543,18 +769,30 @@ DenseClusterMap<Plane<BaseVecT>> calcRegressionPlanes(
     size_t defaultClusterThreshold = 10 * std::log(mesh.numFaces());
     size_t minClusterThresholdSize = max(static_cast<size_t>(minClusterSize), defaultClusterThreshold);
 
-    // For all clusters in cluster map
+    // Collect all clusters which are large enough for a regression plane
+    vector<ClusterHandle> planarClusters;
     for (auto clusterH: clusters)
     {
-        // Get current cluster
-        auto cluster = clusters[clusterH];
-        if (cluster.handles.size() > minClusterThresholdSize)
+        if (clusters[clusterH].handles.size() > minClusterThresholdSize)
         {
-            // Calc regression plane for current cluster and add to cluster map: cluster -> plane
-            planes.insert(clusterH, calcRegressionPlanePCA(mesh, cluster, normals));
+            planarClusters.push_back(clusterH);
         }
     }
 
+    // The planes are independent of each other, so they are fitted concurrently
+    vector<Plane<BaseVecT>> fittedPlanes(planarClusters.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < planarClusters.size(); i++)
+    {
+        fittedPlanes[i] = calcRegressionPlanePCA(mesh, clusters[planarClusters[i]], normals);
+    }
+
+    // Add planes to cluster map: cluster -> plane
+    for (size_t i = 0; i < planarClusters.size(); i++)
+    {
+        planes.insert(planarClusters[i], fittedPlanes[i]);
+    }
+
     return planes;
 }
 
@@ -565,25 +803,45 @@ DenseClusterMap<Plane<BaseVecT>> calcRegressionPlanesRANSAC(
     const FaceMap<Normal<typename BaseVecT::CoordType>>& normals,
     int minClusterSize,
     int iterations,
-    int samples
+    int samples,
+    unsigned int seed
 )
 {
     DenseClusterMap<Plane<BaseVecT>> planes;
     size_t defaultClusterThreshold = 10 * std::log(mesh.numFaces());
     size_t minClusterThresholdSize = max(static_cast<size_t>(minClusterSize), defaultClusterThreshold);
 
-    // For all clusters in cluster map
+    // Collect all clusters which are large enough for a regression plane
+    vector<ClusterHandle> planarClusters;
     for (auto clusterH: clusters)
     {
-        // Get current cluster
-        auto cluster = clusters[clusterH];
-        if (cluster.handles.size() > minClusterThresholdSize)
+        if (clusters[clusterH].handles.size() > minClusterThresholdSize)
         {
-            // Calc regression plane for current cluster and add to cluster map: cluster -> plane
-            planes.insert(clusterH, calcRegressionPlaneRANSAC(mesh, cluster, normals, iterations, samples));
+            planarClusters.push_back(clusterH);
         }
     }
 
+    // The planes are independent of each other, so they are fitted concurrently
+    vector<Plane<BaseVecT>> fittedPlanes(planarClusters.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < planarClusters.size(); i++)
+    {
+        fittedPlanes[i] = calcRegressionPlaneRANSAC(
+            mesh,
+            clusters[planarClusters[i]],
+            normals,
+            iterations,
+            samples,
+            clusterSeed(seed, planarClusters[i])
+        );
+    }
+
+    // Add planes to cluster map: cluster -> plane
+    for (size_t i = 0; i < planarClusters.size(); i++)
+    {
+        planes.insert(planarClusters[i], fittedPlanes[i]);
+    }
+
     return planes;
 }
 
@@ -679,9 +937,11 @@ Plane<BaseVecT> calcRegressionPlaneRANSAC(
     const Cluster<FaceHandle>& cluster,
     const FaceMap<Normal<typename BaseVecT::CoordType>>& normals,
     const int num_iterations,
-    const int num_samples
+    const int num_samples,
+    unsigned int seed
 )
 {
+    std::mt19937 generator(seed);
     float error_limit = 0.01; // dynamically voxelsize / 100
     Plane<BaseVecT> best_plane;
     int best_inlier = 0;
@@ -737,8 +997,8 @@ Plane<BaseVecT> calcRegressionPlaneRANSAC(
         // build avg plane of RANSAC samples
         for(int j=0; j<num_samples; j++)
         {
-            const FaceHandle& faceHandle = cluster.handles[rand() % num_cluster_faces];
-            plane.pos += mesh.getVertexPositionsOfFace(faceHandle)[rand() % 3];
+            const FaceHandle& faceHandle = cluster.handles[generator() % num_cluster_faces];
+            plane.pos += mesh.getVertexPositionsOfFace(faceHandle)[generator() % 3];
             plane.normal += normals[faceHandle];
         }
 
@@ -52,40 +52,66 @@ boost::optional<DenseVertexMap<RGB8Color>> calcColorFromPointCloud(
         return boost::none;
     }
 
-    DenseVertexMap<RGB8Color> vertexMap;
-    vertexMap.reserve(mesh.numVertices());
+    vector<VertexHandle> handles;
+    handles.reserve(mesh.numVertices());
+    for (auto vertexH: mesh.vertices())
+    {
+        handles.push_back(vertexH);
+    }
 
     // k-nearest-neighbors
     const int k = 1;
 
     UCharChannel colors = *(surface->pointBuffer()->getUCharChannel("colors"));
 
-    vector<size_t> cv;
-    for (auto vertexH: mesh.vertices())
-    {
-        cv.clear();
-        auto p = mesh.getVertexPosition(vertexH);
-        surface->searchTree()->kSearch(p, k, cv);
+    // The vertices are split into blocks of consecutive handles. Each thread
+    // answers the queries of a whole block with its own result buffer.
+    const size_t blockSize = 4096;
+    const size_t numBlocks = (handles.size() + blockSize - 1) / blockSize;
 
-        float r = 0.0f, g = 0.0f, b = 0.0f;
+    vector<RGB8Color> vertexColors(handles.size());
+    #pragma omp parallel
+    {
+        vector<size_t> cv;
 
-        for (size_t pointIdx : cv)
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t block = 0; block < numBlocks; block++)
         {
-            auto color = colors[pointIdx];
-            r += color[0];
-            g += color[1];
-            b += color[2];
+            const size_t end = std::min(handles.size(), (block + 1) * blockSize);
+            for (size_t i = block * blockSize; i < end; i++)
+            {
+                cv.clear();
+                auto p = mesh.getVertexPosition(handles[i]);
+                surface->searchTree()->kSearch(p, k, cv);
+
+                float r = 0.0f, g = 0.0f, b = 0.0f;
+
+                for (size_t pointIdx : cv)
+                {
+                    auto color = colors[pointIdx];
+                    r += color[0];
+                    g += color[1];
+                    b += color[2];
+                }
+
+                r /= k;
+                g /= k;
+                b /= k;
+
+                vertexColors[i] = {
+                    static_cast<uint8_t>(r),
+                    static_cast<uint8_t>(g),
+                    static_cast<uint8_t>(b)
+                };
+            }
         }
+    }
 
-        r /= k;
-        g /= k;
-        b /= k;
-
-        vertexMap.insert(vertexH, {
-            static_cast<uint8_t>(r),
-            static_cast<uint8_t>(g),
-            static_cast<uint8_t>(b)
-        });
+    DenseVertexMap<RGB8Color> vertexMap;
+    vertexMap.reserve(mesh.nextVertexIndex());
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        vertexMap.insert(handles[i], vertexColors[i]);
     }
 
     return vertexMap;
@@ -36,6 +36,7 @@
 #include <utility>
 #include <cmath>
 
+#include "lvr2/algorithm/HandleCompaction.hpp"
 #include "lvr2/algorithm/Materializer.hpp"
 #include "lvr2/types/MeshBuffer.hpp"
 #include "lvr2/util/Progress.hpp"
@@ -48,85 +49,89 @@ namespace lvr2
 template<typename BaseVecT>
 MeshBufferPtr SimpleFinalizer<BaseVecT>::apply(const BaseMesh <BaseVecT>& mesh)
 {
-    // Create vertex and normal buffer
-    DenseVertexMap<size_t> idxMap;
-    idxMap.reserve(mesh.numVertices());
+    // Compact the live handles. The compact index of a vertex is its 
+    // position in the output buffers, the same as in a serial iteration.
+    const std::vector<VertexHandle> vertexHandles = collectVertexHandles(mesh);
+    const std::vector<FaceHandle> faceHandles = collectFaceHandles(mesh);
+    const std::vector<Index> idxMap = compactIndices(vertexHandles, mesh.nextVertexIndex());
 
-    vector<float> vertices;
-    vertices.reserve(mesh.numVertices() * 3);
+    const size_t numVertices = vertexHandles.size();
+    const size_t numFaces = faceHandles.size();
 
-    vector<float> normals;
+    // Create vertex, normal, color and face buffers
+    floatArr vertices(new float[numVertices * 3]);
+
+    floatArr normals;
     if (m_normalData)
     {
-        normals.reserve(mesh.numVertices() * 3);
+        normals = floatArr(new float[numVertices * 3]);
     }
 
-    vector<unsigned char> colors;
+    ucharArr colors;
     if (m_colorData)
     {
-        colors.reserve(mesh.numVertices() * 3);
+        colors = ucharArr(new unsigned char[numVertices * 3]);
     }
 
+    indexArray faces(new unsigned int[numFaces * 3]);
+
     // for all vertices
-    size_t vertexCount = 0;
-    for (auto vH : mesh.vertices())
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numVertices; i++)
     {
+        const VertexHandle vH = vertexHandles[i];
         auto point = mesh.getVertexPosition(vH);
 
         // add vertex positions to buffer
-        vertices.push_back(point.x);
-        vertices.push_back(point.y);
-        vertices.push_back(point.z);
+        vertices[3 * i]     = point.x;
+        vertices[3 * i + 1] = point.y;
+        vertices[3 * i + 2] = point.z;
 
         if (m_normalData)
         {
             // add normal data to buffer if given
             auto normal = (*m_normalData)[vH];
-            normals.push_back(normal.getX());
-            normals.push_back(normal.getY());
-            normals.push_back(normal.getZ());
+            normals[3 * i]     = normal.getX();
+            normals[3 * i + 1] = normal.getY();
+            normals[3 * i + 2] = normal.getZ();
         }
 
         if (m_colorData)
         {
             // add color data to buffer if given
-            colors.push_back(static_cast<unsigned char>((*m_colorData)[vH][0]));
-            colors.push_back(static_cast<unsigned char>((*m_colorData)[vH][1]));
-            colors.push_back(static_cast<unsigned char>((*m_colorData)[vH][2]));
+            const RGB8Color& color = (*m_colorData)[vH];
+            colors[3 * i]     = static_cast<unsigned char>(color[0]);
+            colors[3 * i + 1] = static_cast<unsigned char>(color[1]);
+            colors[3 * i + 2] = static_cast<unsigned char>(color[2]);
         }
-
-        // Save index of vertex for face mapping
-        idxMap.insert(vH, vertexCount);
-        vertexCount++;
     }
 
-    // Create face buffer
-    vector<unsigned int> faces;
-    faces.reserve(mesh.numFaces() * 3);
-    for (auto fH : mesh.faces())
+    // for all faces
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numFaces; i++)
     {
-        auto handles = mesh.getVerticesOfFace(fH);
-        for (auto handle : handles)
+        auto handles = mesh.getVerticesOfFace(faceHandles[i]);
+        for (size_t j = 0; j < 3; j++)
         {
             // add faces to buffer
-            faces.push_back(idxMap[handle]);
+            faces[3 * i + j] = idxMap[handles[j].idx()];
         }
     }
 
     // create buffer object and pass values
     MeshBufferPtr buffer( new MeshBuffer );
 
-    buffer->setVertices(Util::convert_vector_to_shared_array(vertices), vertices.size() / 3);
-    buffer->setFaceIndices(Util::convert_vector_to_shared_array(faces), faces.size() / 3);
+    buffer->setVertices(vertices, numVertices);
+    buffer->setFaceIndices(faces, numFaces);
 
     if (m_normalData)
     {
-        buffer->setVertexNormals(Util::convert_vector_to_shared_array(normals));
+        buffer->setVertexNormals(normals);
     }
 
     if (m_colorData)
     {
-        buffer->setVertexColors(Util::convert_vector_to_shared_array(colors));
+        buffer->setVertexColors(colors);
     }
 
     return buffer;
@@ -179,136 +184,118 @@ void TextureFinalizer<BaseVecT>::setMaterializerResult(const MaterializerResult<
 template<typename BaseVecT>
 MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
 {
-    // Create vertex buffer and all buffers holding vertex attributes
-    vector<float> vertices;
-    vertices.reserve(mesh.numVertices() * 3 * 2);
-
-    vector<float> normals;
-    if (m_vertexNormals)
+    // Clusters in iteration order
+    vector<ClusterHandle> clusterHandles;
+    clusterHandles.reserve(m_cluster.numCluster());
+    for (auto clusterH: m_cluster)
     {
-        normals.reserve(mesh.numVertices() * 3 * 2);
+        clusterHandles.push_back(clusterH);
     }
+    const size_t numClusters = clusterHandles.size();
 
-    vector<unsigned char> colors;
-    if (m_clusterColors)
-    {
-        colors.reserve(mesh.numVertices() * 3 * 2);
-    }
+    // For each cluster: its vertices in order of first appearance and the
+    // cluster local vertex index of each face corner. Vertices shared by
+    // several clusters are duplicated, so clusters are independent of
+    // each other.
+    vector<vector<VertexHandle>> clusterVertices(numClusters);
+    vector<vector<unsigned int>> clusterCorners(numClusters);
 
-    // Create buffer and variables for texturizing
-    bool useTextures = false;
-    if (m_materializerResult && m_materializerResult.get().m_textures)
-    {
-        useTextures = true;
-    }
-    vector<float> texCoords;
-    vector<Material> materials;
-    vector<unsigned int> faceMaterials;
-    vector<unsigned int> clusterMaterials;
-    vector<Texture> textures;
-    vector<vector<unsigned int>> clusterFaceIndices;
-    size_t clusterCount = 0;
-    size_t faceCount = 0;
-
-    // Global material index will be used for indexing materials in the faceMaterialIndexBuffer
-    // The basic material will have the index 0
-    unsigned int globalMaterialIndex = 1;
-    // Create default material
-    unsigned char defaultR = 0, defaultG = 0, defaultB = 0;
-    Material m;
-    std::array<unsigned char, 3> arr = {defaultR, defaultG, defaultB};
-    m.m_color = std::move(arr);
-    materials.push_back(m);
-    // This map remembers which texture and material are associated with each other
-    std::map<int, unsigned int> textureMaterialMap; // Stores the ID of the material for each textureIndex
-    textureMaterialMap[-1] = 0; // texIndex -1 => no texture => default material with index 0
-
-    std::map<RGB8Color, int> colorMaterialMap;
-
-    // Create face buffer
-    vector<unsigned int> faces;
-    faces.reserve(mesh.numFaces() * 3);
-
-    // This counter is used to determine the index of a newly inserted vertex
-    size_t vertexCount = 0;
-
-    lvr2::Monitor monitor(lvr2::LogLevel::info, "Finalizing mesh", m_cluster.numCluster());
-
-    // Loop over all clusters
-    for (auto clusterH: m_cluster)
+    lvr2::Monitor monitor(lvr2::LogLevel::info, "Finalizing mesh", numClusters);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < numClusters; c++)
     {
+        auto& cluster = m_cluster.getCluster(clusterHandles[c]);
+        auto& clusterVertexHandles = clusterVertices[c];
+        auto& corners = clusterCorners[c];
+        corners.reserve(cluster.handles.size() * 3);
+
         // This map remembers which vertex we already inserted and at what
         // position. This is important to create the face map.
-        SparseVertexMap<size_t> idxMap;
+        SparseVertexMap<unsigned int> idxMap;
 
-        // Vector for storing indices of created faces
-        vector<unsigned int> faceIndices;
-
-        ++monitor;
-
-        auto& cluster = m_cluster.getCluster(clusterH);
-
-        // Loop over all faces of the cluster
         for (auto faceH: cluster.handles)
         {
             for (auto vertexH: mesh.getVerticesOfFace(faceH))
             {
-                // Check if we already inserted this vertex. If not...
                 if (!idxMap.containsKey(vertexH))
                 {
-                    // ... insert it into the buffers (with all its attributes)
-                    auto point = mesh.getVertexPosition(vertexH);
-
-                    vertices.push_back(point.x);
-                    vertices.push_back(point.y);
-                    vertices.push_back(point.z);
-
-                    if (m_vertexNormals)
-                    {
-                        auto normal = (*m_vertexNormals)[vertexH];
-                        normals.push_back(normal.getX());
-                        normals.push_back(normal.getY());
-                        normals.push_back(normal.getZ());
-                    }
-
-                    // If individual vertex colors are present: use these
-                    if (m_vertexColors)
-                    {
-                        colors.push_back(static_cast<unsigned char>((*m_vertexColors)[vertexH][0]));
-                        colors.push_back(static_cast<unsigned char>((*m_vertexColors)[vertexH][1]));
-                        colors.push_back(static_cast<unsigned char>((*m_vertexColors)[vertexH][2]));
-                    }
-                    else if (m_clusterColors)
-                    {
-                        // else: use cluster colors if present
-                        colors.push_back(static_cast<unsigned char>((*m_clusterColors)[clusterH][0]));
-                        colors.push_back(static_cast<unsigned char>((*m_clusterColors)[clusterH][1]));
-                        colors.push_back(static_cast<unsigned char>((*m_clusterColors)[clusterH][2]));
-                    } // else: no colors
-
-                    // Save index of vertex for face mapping
-                    idxMap.insert(vertexH, vertexCount);
-                    vertexCount++;
+                    idxMap.insert(vertexH, clusterVertexHandles.size());
+                    clusterVertexHandles.push_back(vertexH);
                 }
-
-                // At this point we know that the vertex is certainly in the
-                // map (and the buffers).
-                faces.push_back(idxMap[vertexH]);
+                corners.push_back(idxMap[vertexH]);
             }
-            faceIndices.push_back(faceCount++);
         }
 
-        clusterFaceIndices.push_back(faceIndices);
+        ++monitor;
+    }
+    monitor.terminate();
 
-        // When using textures,
-        // For each cluster:
-        if (m_materializerResult)
-        {
-            // This map remembers which vertices were already visited for materials and textures
-            // Each vertex must be visited exactly once
-            SparseVertexMap<size_t> vertexVisitedMap;
-            size_t vertexVisitCount = 0;
+    // Prefix sums give the first vertex and face of each cluster in the buffers
+    vector<size_t> vertexOffsets(numClusters + 1, 0);
+    vector<size_t> faceOffsets(numClusters + 1, 0);
+    for (size_t c = 0; c < numClusters; c++)
+    {
+        vertexOffsets[c + 1] = vertexOffsets[c] + clusterVertices[c].size();
+        faceOffsets[c + 1] = faceOffsets[c] + clusterCorners[c].size() / 3;
+    }
+    const size_t numVertices = vertexOffsets.back();
+    const size_t numFaces = faceOffsets.back();
+
+    // Create vertex buffer and all buffers holding vertex attributes
+    floatArr vertices(new float[numVertices * 3]);
+    indexArray faces(new unsigned int[numFaces * 3]);
+
+    floatArr normals;
+    if (m_vertexNormals)
+    {
+        normals = floatArr(new float[numVertices * 3]);
+    }
+
+    ucharArr colors;
+    if (m_clusterColors || m_vertexColors)
+    {
+        colors = ucharArr(new unsigned char[numVertices * 3]);
+    }
+
+    // Create buffer and variables for texturizing
+    bool useTextures = false;
+    if (m_materializerResult && m_materializerResult.get().m_textures)
+    {
+        useTextures = true;
+    }
+    floatArr texCoords;
+    indexArray faceMaterials;
+    vector<Material> materials;
+    vector<unsigned int> clusterMaterials;
+    vector<Texture> textures;
+    vector<indexArray> clusterFaceIndices(numClusters);
 
+    // Materials are numbered in order of first use, so they are assigned 
+    // in a serial pass over the clusters
+    if (m_materializerResult)
+    {
+        texCoords = floatArr(new float[numVertices * 2]);
+        faceMaterials = indexArray(new unsigned int[numFaces]);
+        clusterMaterials.reserve(numClusters);
+
+        // Global material index will be used for indexing materials in the faceMaterialIndexBuffer
+        // The basic material will have the index 0
+        unsigned int globalMaterialIndex = 1;
+        // Create default material
+        unsigned char defaultR = 0, defaultG = 0, defaultB = 0;
+        Material m;
+        std::array<unsigned char, 3> arr = {defaultR, defaultG, defaultB};
+        m.m_color = std::move(arr);
+        materials.push_back(m);
+        // This map remembers which texture and material are associated with each other
+        std::map<int, unsigned int> textureMaterialMap; // Stores the ID of the material for each textureIndex
+        textureMaterialMap[-1] = 0; // texIndex -1 => no texture => default material with index 0
+
+        std::map<RGB8Color, int> colorMaterialMap;
+
+        for (auto clusterH: clusterHandles)
+        {
             Material m = m_materializerResult.get().m_clusterMaterials.get(clusterH).get();
             bool clusterHasTextures = static_cast<bool>(m.m_texture); // optional
             bool clusterHasColor = static_cast<bool>(m.m_color); // optional
@@ -336,7 +323,6 @@ MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
                 {
                     // No: create material with texture
                     materials.push_back(m);
-                    //textures.push_back(std::move(texture));
                     textureMaterialMap[textureIndex] = globalMaterialIndex;
                     materialIndex = globalMaterialIndex;
                     globalMaterialIndex++;
@@ -364,65 +350,116 @@ MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
             }
 
             clusterMaterials.push_back(materialIndex);
+        }
+    }
 
+    // Write all clusters directly into their part of the buffers
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t c = 0; c < numClusters; c++)
+    {
+        const ClusterHandle clusterH = clusterHandles[c];
+        const vector<VertexHandle>& clusterVertexHandles = clusterVertices[c];
+        const vector<unsigned int>& corners = clusterCorners[c];
+        const size_t vertexOffset = vertexOffsets[c];
+        const size_t faceOffset = faceOffsets[c];
+        const size_t clusterFaces = faceOffsets[c + 1] - faceOffset;
+
+        for (size_t j = 0; j < clusterVertexHandles.size(); j++)
+        {
+            const VertexHandle vertexH = clusterVertexHandles[j];
+            const size_t i = vertexOffset + j;
 
+            auto point = mesh.getVertexPosition(vertexH);
+            vertices[3 * i]     = point.x;
+            vertices[3 * i + 1] = point.y;
+            vertices[3 * i + 2] = point.z;
 
-            // For each face in cluster:
-            // Materials
-            for (auto faceH : cluster.handles)
+            if (m_vertexNormals)
             {
+                auto normal = (*m_vertexNormals)[vertexH];
+                normals[3 * i]     = normal.getX();
+                normals[3 * i + 1] = normal.getY();
+                normals[3 * i + 2] = normal.getZ();
+            }
 
-                faceMaterials.push_back(materialIndex);
+            // If individual vertex colors are present: use these
+            if (m_vertexColors)
+            {
+                const RGB8Color& color = (*m_vertexColors)[vertexH];
+                colors[3 * i]     = static_cast<unsigned char>(color[0]);
+                colors[3 * i + 1] = static_cast<unsigned char>(color[1]);
+                colors[3 * i + 2] = static_cast<unsigned char>(color[2]);
+            }
+            else if (m_clusterColors)
+            {
+                // else: use cluster colors if present
+                const RGB8Color& color = (*m_clusterColors)[clusterH];
+                colors[3 * i]     = static_cast<unsigned char>(color[0]);
+                colors[3 * i + 1] = static_cast<unsigned char>(color[1]);
+                colors[3 * i + 2] = static_cast<unsigned char>(color[2]);
+            } // else: no colors
+
+            if (m_materializerResult)
+            {
+                auto& vertexTexCoords = m_materializerResult.get().m_vertexTexCoords;
+                bool vertexHasTexCoords = vertexTexCoords.is_initialized()
+                                          ? static_cast<bool>(vertexTexCoords.get().get(vertexH))
+                                          : false;
 
-                // For each vertex in face:
-                for (auto vertexH : mesh.getVerticesOfFace(faceH))
+                if (useTextures && vertexHasTexCoords)
+                {
+                    // Use tex coord vertex map to find texture coords
+                    const TexCoords coords = vertexTexCoords.get()
+                        .get(vertexH).get()
+                        .getTexCoords(clusterH);
+
+                    texCoords[2 * i]     = coords.u;
+                    texCoords[2 * i + 1] = coords.v;
+                }
+                else
                 {
-                    if (!vertexVisitedMap.containsKey(vertexH))
-                    {
-                        auto& vertexTexCoords = m_materializerResult.get().m_vertexTexCoords;
-                        bool vertexHasTexCoords = vertexTexCoords.is_initialized()
-                                                  ? static_cast<bool>(vertexTexCoords.get().get(vertexH))
-                                                  : false;
-
-                        if (useTextures && vertexHasTexCoords)
-                        {
-                            // Use tex coord vertex map to find texture coords
-                            const TexCoords coords = m_materializerResult.get()
-                                .m_vertexTexCoords.get()
-                                .get(vertexH).get()
-                                .getTexCoords(clusterH);
-
-                            texCoords.push_back(coords.u);
-                            texCoords.push_back(coords.v);
-                            texCoords.push_back(0.0);
-                        } else {
-                            // Cluster does not have a texture, use default coords
-                            // Every vertex needs an entry in this buffer,
-                            // This is why 0's are inserted
-                            texCoords.push_back(0.0);
-                            texCoords.push_back(0.0);
-                            texCoords.push_back(0.0);
-                        }
-                        vertexVisitedMap.insert(vertexH, vertexVisitCount);
-                        vertexVisitCount++;
-                    }
+                    // Cluster does not have a texture, use default coords.
+                    // Every vertex needs an entry in this buffer
+                    texCoords[2 * i]     = 0.0;
+                    texCoords[2 * i + 1] = 0.0;
                 }
             }
         }
+
+        for (size_t k = 0; k < corners.size(); k++)
+        {
+            faces[3 * faceOffset + k] = vertexOffset + corners[k];
+        }
+
+        indexArray faceIndices(new unsigned int[clusterFaces]);
+        for (size_t f = 0; f < clusterFaces; f++)
+        {
+            faceIndices[f] = faceOffset + f;
+        }
+        clusterFaceIndices[c] = faceIndices;
+
+        if (m_materializerResult)
+        {
+            std::fill(faceMaterials.get() + faceOffset, faceMaterials.get() + faceOffset + clusterFaces, clusterMaterials[c]);
+        }
+
+        // Free the intermediate cluster data as early as possible
+        vector<VertexHandle>().swap(clusterVertices[c]);
+        vector<unsigned int>().swap(clusterCorners[c]);
     }
 
     MeshBufferPtr buffer = MeshBufferPtr( new MeshBuffer );
-    buffer->setVertices(Util::convert_vector_to_shared_array(vertices), vertices.size() / 3);
-    buffer->setFaceIndices(Util::convert_vector_to_shared_array(faces), faces.size() / 3);
+    buffer->setVertices(vertices, numVertices);
+    buffer->setFaceIndices(faces, numFaces);
 
     if (m_vertexNormals)
     {
-        buffer->setVertexNormals(Util::convert_vector_to_shared_array(normals));
+        buffer->setVertexNormals(normals);
     }
 
     if (m_clusterColors || m_vertexColors)
     {
-        buffer->setVertexColors(Util::convert_vector_to_shared_array(colors));
+        buffer->setVertexColors(colors);
     }
 
     if (m_materializerResult)
@@ -441,24 +478,16 @@ MeshBufferPtr TextureFinalizer<BaseVecT>::apply(const BaseMesh<BaseVecT>& mesh)
         mats.insert(mats.end(), materials.begin(), materials.end());
         texts.insert(texts.end(), textures.begin(), textures.end());
 
-        buffer->setFaceMaterialIndices(Util::convert_vector_to_shared_array(faceMaterials));
+        buffer->setFaceMaterialIndices(faceMaterials);
         buffer->addIndexChannel(Util::convert_vector_to_shared_array(clusterMaterials), "cluster_material_indices", clusterMaterials.size(), 1);
 
-        // convert from 3 floats per vertex to 2...
-        floatArr texCoordsArr = floatArr( new float[(texCoords.size() / 3) * 2] );
-
-        for (size_t i = 0; i < texCoords.size() / 3; i++)
-        {
-            texCoordsArr[i*2 + 0] = texCoords[i*3 + 0];
-            texCoordsArr[i*2 + 1] = texCoords[i*3 + 1];
-        }
-        buffer->setTextureCoordinates(texCoordsArr);
+        buffer->setTextureCoordinates(texCoords);
 
         // TODO TALK TO THOMAS
-        for (size_t i = 0; i < clusterFaceIndices.size(); i++)
+        for (size_t i = 0; i < numClusters; i++)
         {
             std::string cluster_name = "cluster" + std::to_string(i) + "_face_indices";
-            buffer->addIndexChannel(Util::convert_vector_to_shared_array(clusterFaceIndices[i]), cluster_name, clusterFaceIndices[i].size(), 1);
+            buffer->addIndexChannel(clusterFaceIndices[i], cluster_name, faceOffsets[i + 1] - faceOffsets[i], 1);
         }
     }
 
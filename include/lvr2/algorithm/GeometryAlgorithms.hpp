@@ -171,7 +171,8 @@ DenseEdgeMap<float> calcVertexAngleEdges(
  * This function combines the logic of the calcVertexRoughness- and calcVertexHeightDiff-functions,
  * allowing us to calculate the local neighborhood for each single vertex just once.
  * By that, this function should always be used when the roughness and height difference values are
- * both needed.
+ * both needed. The results are the same as those of the single functions. See LocalNeighborhoodEngine
+ * for other combinations of features.
  *
  * @param mesh        The given mesh for the calculation.
  * @param radius      The radius which defines the local neighborhood.
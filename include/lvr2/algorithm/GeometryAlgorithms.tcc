@@ -40,6 +40,7 @@
 #include "lvr2/algorithm/FinalizeAlgorithms.hpp"
 #include "lvr2/util/Util.hpp"
 #include "lvr2/geometry/BaseMesh.hpp"
+#include "lvr2/algorithm/LocalNeighborhoodEngine.hpp"
 #include <iostream>
 
 #ifdef LVR2_USE_EMBREE
@@ -208,94 +209,16 @@ template <typename BaseVecT>
 DenseVertexMap<float> calcVertexHeightDifferences(
   const BaseMesh<BaseVecT> &mesh, double radius)
 {
-    // We create a map to store a height-diff for each vertex. We preallocate
-    // memory for all vertices. This is not only an optimization, but more
-    // importantly to avoid multithreading crashes. The parallelized loop
-    // further down inserts into this data structure; if there is no free
-    // memory left, it will reallocate which will crash horribly when multiple
-    // threads are involved.
+    // The neighborhood is limited on the xy plane: a neighborhood limited by
+    // a sphere would reject connections that leave the radius, which gives
+    // wrong results e.g. for a flat wall.
     DenseVertexMap<float> heightDiff;
-    heightDiff.reserve(mesh.nextVertexIndex());
 
-    // Output
-    string msg = timestamp.getElapsedTime() + "Computing height differences...";
-    ProgressBar progress(mesh.numVertices(), msg);
-    ++progress;
-
-    std::set<VertexHandle> invalid;
-
-    // Calculate height difference for each vertex
-    // for(auto vH : mesh.vertices())
-    #pragma omp parallel for
-    for (size_t i = 0; i < mesh.nextVertexIndex(); i++)
-    {
-        auto vH = VertexHandle(i);
-        if (!mesh.containsVertex(vH))
-        {
-          continue;
-        }
-
-        // this was wrong:
-        // this neighborhood rejects connections outside a maximum radius
-        // however, for a flat wall this would give wrong results
-        // -> solution: finish at last neighbor outside the radius 
-        //  but still consider it for height diff computation
-        // other solution: limit the search only along the xy plane
-        // - could be the best solution though
-        // Alex: Second thought
-        // even after these fixes it would be wrong for some cases
-        // e.g. if the vertex lies outside of the cylinder, and the only connection 
-        // to it has a steep edge. Then it is discared from height diff computation
-        // however, the correct solution would be to find the intersection of the edge
-        // with the limiting geometry (sphere/cylinder)
-        
-        BaseVecT normal;
-        normal.x = 0.0;
-        normal.y = 0.0;
-        normal.z = 1.0;
-        // this would also work for rotated meshes, if you define an up vector
-
-        // forgot own position!
-        const BaseVecT& vPos = mesh.getVertexPosition(vH);
-        float height = normal.dot(vPos);
-        float minHeight = height;
-        float maxHeight = height;
-
-        visitLocalVertexNeighborhoodPlane(mesh, invalid, vH, normal, radius, [&](auto neighbor) 
-        {
-            auto curPos = mesh.getVertexPosition(neighbor);
-
-            // height w.r.t. plane
-            float height = normal.dot(curPos);
-
-            if (height < minHeight)
-            {
-                minHeight = height;
-            }
-            if (height > maxHeight)
-            {
-                maxHeight = height;
-            }
-        });
-
-        // Calculate the final height difference
-        #pragma omp critical
-        {
-            heightDiff.insert(vH, maxHeight - minHeight);
-            ++progress;
-        }
-    }
-
-    if(!timestamp.isQuiet())
-    {
-      std::cout << std::endl;
-    }
+    LocalNeighborhoodFeatures features;
+    features.heightDifferences = &heightDiff;
 
-    if(!invalid.empty())
-    {
-        std::cerr << "Found " << invalid.size() << " invalid, non manifold "
-            << "vertices." << std::endl;
-    }
+    LocalNeighborhoodEngine<BaseVecT> engine(mesh, radius);
+    engine.compute(features);
 
     return heightDiff;
 }
@@ -365,62 +288,16 @@ DenseVertexMap<float> calcVertexRoughness(
     double radius,
     const VertexMap<Normal<typename BaseVecT::CoordType>> &normals)
 {
-    // We create a map to store the roughness for each vertex. We preallocate
-    // memory for all vertices. This is not only an optimization, but more
-    // importantly to avoid multithreading crashes. The parallelized loop
-    // further down inserts into this data structure; if there is no free
-    // memory left, it will reallocate which will crash horribly when multiple
-    // threads are involved.
     DenseVertexMap<float> roughness;
-    roughness.reserve(mesh.nextVertexIndex());
-
     auto averageAngles = calcAverageVertexAngles(mesh, normals);
 
-    // Output
-    string msg = timestamp.getElapsedTime() + "Computing roughness";
-    ProgressBar progress(mesh.numVertices(), msg);
-    ++progress;
+    LocalNeighborhoodFeatures features;
+    features.averageAngles = &averageAngles;
+    features.roughness = &roughness;
 
-    std::set<VertexHandle> invalid;
+    LocalNeighborhoodEngine<BaseVecT> engine(mesh, radius);
+    engine.compute(features);
 
-    // Calculate roughness for each vertex
-    #pragma omp parallel for
-    for (size_t i = 0; i < mesh.nextVertexIndex(); i++)
-    {
-        auto vH = VertexHandle(i);
-        if (!mesh.containsVertex(vH))
-        {
-            continue;
-        }
-
-        // forgot to add self
-        float sum = averageAngles[vH];
-        size_t count = 1;
-
-        visitLocalVertexNeighborhood(mesh, invalid, vH, radius, [&](auto neighbor) 
-        {
-            sum += averageAngles[neighbor];
-            count += 1;
-        });
-
-        #pragma omp critical
-        {
-            // Calculate the final roughness
-            roughness.insert(vH, count ? sum / count : 0);
-            ++progress;
-        }
-    }
-    if(!timestamp.isQuiet())
-    {
-        std::cout << std::endl;
-    }
-
-    if (!invalid.empty())
-    {
-        std::cerr << "Found " << invalid.size() << " invalid, non manifold "
-            << "vertices." << std::endl;
-    }
-    
     return roughness;
 }
 
@@ -432,61 +309,15 @@ void calcVertexRoughnessAndHeightDifferences(
     DenseVertexMap<float> &roughness,
     DenseVertexMap<float> &heightDiff)
 {
-    // Reserving memory in those maps is important to avoid multi threading
-    // related crashes.
-    roughness.clear();
-    roughness.reserve(mesh.nextVertexIndex());
-    heightDiff.clear();
-    heightDiff.reserve(mesh.nextVertexIndex());
-
-    std::set<VertexHandle> invalid;
     auto averageAngles = calcAverageVertexAngles(mesh, normals);
 
-    // Calculate roughness and height difference for each vertex
-    #pragma omp parallel for
-    for (size_t i = 0; i < mesh.nextVertexIndex(); i++)
-    {
-        auto vH = VertexHandle(i);
-        if (!mesh.containsVertex(vH))
-        {
-            continue;
-        }
-
-        double sum = 0.0;
-        uint32_t count = 0;
-        float minHeight = std::numeric_limits<float>::max();
-        float maxHeight = std::numeric_limits<float>::lowest();
+    LocalNeighborhoodFeatures features;
+    features.averageAngles = &averageAngles;
+    features.roughness = &roughness;
+    features.heightDifferences = &heightDiff;
 
-        visitLocalVertexNeighborhood(mesh, invalid, vH, radius, [&](auto neighbor) 
-        {
-            sum += averageAngles[neighbor];
-            count += 1;
-
-            auto curPos = mesh.getVertexPosition(neighbor);
-            if (curPos.z < minHeight)
-            {
-                minHeight = curPos.z;
-            }
-            if (curPos.z > maxHeight)
-            {
-                maxHeight = curPos.z;
-            }
-        });
-
-        #pragma omp critical
-        {
-            // Calculate the final roughness
-            roughness.insert(vH, count ? sum / count : 0);
-
-            // Calculate the final height difference
-            heightDiff.insert(vH, maxHeight - minHeight);
-        }
-    }
-    if (!invalid.empty())
-    {
-        std::cerr << "Found " << invalid.size() << " invalid, non manifold "
-            << "vertices." << std::endl;
-    }
+    LocalNeighborhoodEngine<BaseVecT> engine(mesh, radius);
+    engine.compute(features);
 }
 
 template <typename BaseVecT>
@@ -580,9 +411,8 @@ DenseVertexMap<float> calcNormalClearance(
     auto raycaster = BVHRaycaster<DistInt>(buffer);
 #endif
 
-    // Reserve enough memory for all vertices to prevent unnecessary reallocations
-    DenseVertexMap<float> freespace;
-    freespace.reserve(mesh.nextVertexIndex());
+    // Create a slot for every vertex, so the threads can write without locking
+    DenseVertexMap<float> freespace(mesh.nextVertexIndex(), std::numeric_limits<float>::infinity());
     
     std::stringstream msg;
     msg << timestamp << "[calcNormalClearance] Calculating free space along vertex normals";
@@ -613,19 +443,25 @@ DenseVertexMap<float> calcNormalClearance(
             // Add the same offset to the distance result
             distance = result.dist + 0.001;
         }
-        
-        #pragma omp critical
-        {
-            freespace.insert(vertexH, distance);
-            ++progress;
-        }
+
+        freespace[vertexH] = distance;
+        ++progress;
     }
 
     if (!timestamp.isQuiet())
     {
         std::cout << std::endl;
     }
-    
+
+    // Deleted vertices have no value
+    for (size_t i = 0; i < mesh.nextVertexIndex(); i++)
+    {
+        if (!mesh.containsVertex(VertexHandle(i)))
+        {
+            freespace.erase(VertexHandle(i));
+        }
+    }
+
     return freespace;
 }
 
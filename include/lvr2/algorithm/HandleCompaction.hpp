@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * HandleCompaction.hpp
+ *
+ * Order preserving compaction of mesh handles for parallel loops.
+ *
+ * @date 18.10.2026
+ */
+
+#ifndef LVR2_ALGORITHM_HANDLECOMPACTION_H_
+#define LVR2_ALGORITHM_HANDLECOMPACTION_H_
+
+#include <vector>
+
+#include "lvr2/geometry/BaseMesh.hpp"
+#include "lvr2/geometry/Handles.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Collects the handles of all vertices of the mesh in ascending order.
+ *
+ * The result has the same order as iterating over `mesh.vertices()`, but is
+ * computed in parallel with a prefix sum over the handle index space. The
+ * position of a handle in the returned vector is its compact index.
+ */
+template<typename BaseVecT>
+std::vector<VertexHandle> collectVertexHandles(const BaseMesh<BaseVecT>& mesh);
+
+/**
+ * @brief Collects the handles of all faces of the mesh in ascending order.
+ *
+ * The result has the same order as iterating over `mesh.faces()`.
+ */
+template<typename BaseVecT>
+std::vector<FaceHandle> collectFaceHandles(const BaseMesh<BaseVecT>& mesh);
+
+/**
+ * @brief Collects the handles of all edges of the mesh in ascending order.
+ *
+ * Every edge is reported once, even if the mesh uses several indices for
+ * it (like the two half edges of a `HalfEdgeMesh`). The result has the
+ * same handles and order as iterating over `mesh.edges()`.
+ */
+template<typename BaseVecT>
+std::vector<EdgeHandle> collectEdgeHandles(const BaseMesh<BaseVecT>& mesh);
+
+/**
+ * @brief Inverts a list of compacted handles.
+ *
+ * @param handles   Handles as returned by one of the collect functions
+ * @param end       The next free handle index of the mesh, e.g.
+ *                  `mesh.nextVertexIndex()`
+ * @return A vector indexed by handle index that holds the compact index of
+ *         each handle or the maximum `Index` value for deleted handles.
+ */
+template<typename HandleT>
+std::vector<Index> compactIndices(const std::vector<HandleT>& handles, Index end);
+
+} // namespace lvr2
+
+#include "lvr2/algorithm/HandleCompaction.tcc"
+
+#endif /* LVR2_ALGORITHM_HANDLECOMPACTION_H_ */
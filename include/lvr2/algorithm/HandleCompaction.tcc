@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * HandleCompaction.tcc
+ *
+ * @date 18.10.2026
+ */
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "lvr2/config/lvropenmp.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Collects all indices in [0, end) for which `contains` holds, in
+ *        ascending order. Each thread counts and then fills a contiguous
+ *        block of the index space; the block offsets are a prefix sum over
+ *        the counts.
+ */
+template<typename HandleT, typename ContainsF>
+std::vector<HandleT> collectHandles(Index end, ContainsF contains)
+{
+    const size_t numBlocks = std::max<size_t>(1, 4 * OpenMPConfig::getNumThreads());
+    const size_t blockSize = (end + numBlocks - 1) / numBlocks;
+
+    std::vector<size_t> offsets(numBlocks + 1, 0);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < numBlocks; b++)
+    {
+        const size_t first = std::min<size_t>(end, b * blockSize);
+        const size_t last = std::min<size_t>(end, first + blockSize);
+        size_t count = 0;
+        for (size_t i = first; i < last; i++)
+        {
+            count += contains(HandleT(i)) ? 1 : 0;
+        }
+        offsets[b + 1] = count;
+    }
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<HandleT> handles(offsets.back());
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < numBlocks; b++)
+    {
+        const size_t first = std::min<size_t>(end, b * blockSize);
+        const size_t last = std::min<size_t>(end, first + blockSize);
+        size_t out = offsets[b];
+        for (size_t i = first; i < last; i++)
+        {
+            if (contains(HandleT(i)))
+            {
+                handles[out++] = HandleT(i);
+            }
+        }
+    }
+
+    return handles;
+}
+
+template<typename BaseVecT>
+std::vector<VertexHandle> collectVertexHandles(const BaseMesh<BaseVecT>& mesh)
+{
+    return collectHandles<VertexHandle>(mesh.nextVertexIndex(), [&](VertexHandle h)
+    {
+        return mesh.containsVertex(h);
+    });
+}
+
+template<typename BaseVecT>
+std::vector<FaceHandle> collectFaceHandles(const BaseMesh<BaseVecT>& mesh)
+{
+    return collectHandles<FaceHandle>(mesh.nextFaceIndex(), [&](FaceHandle h)
+    {
+        return mesh.containsFace(h);
+    });
+}
+
+/**
+ * @brief Checks whether h is the handle the mesh reports for its edge.
+ *
+ * Meshes may use several indices for one edge (e.g. the two half edges of a
+ * HalfEdgeMesh). Only the one returned by `getEdgeBetween()` for the
+ * endpoints of the edge is canonical, which is also the one `mesh.edges()`
+ * visits.
+ */
+template<typename BaseVecT>
+bool isCanonicalEdge(const BaseMesh<BaseVecT>& mesh, EdgeHandle h)
+{
+    if (!mesh.containsEdge(h))
+    {
+        return false;
+    }
+    auto endpoints = mesh.getVerticesOfEdge(h);
+    auto canonical = mesh.getEdgeBetween(endpoints[0], endpoints[1]);
+    return canonical && canonical.unwrap() == h;
+}
+
+template<typename BaseVecT>
+std::vector<EdgeHandle> collectEdgeHandles(const BaseMesh<BaseVecT>& mesh)
+{
+    return collectHandles<EdgeHandle>(mesh.nextEdgeIndex(), [&](EdgeHandle h)
+    {
+        return isCanonicalEdge(mesh, h);
+    });
+}
+
+template<typename HandleT>
+std::vector<Index> compactIndices(const std::vector<HandleT>& handles, Index end)
+{
+    std::vector<Index> indices(end, std::numeric_limits<Index>::max());
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        indices[handles[i].idx()] = i;
+    }
+
+    return indices;
+}
+
+} // namespace lvr2
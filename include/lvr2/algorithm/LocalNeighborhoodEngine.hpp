@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * LocalNeighborhoodEngine.hpp
+ *
+ * @date 18.10.2026
+ */
+
+#ifndef LVR2_ALGORITHM_LOCALNEIGHBORHOODENGINE_H_
+#define LVR2_ALGORITHM_LOCALNEIGHBORHOODENGINE_H_
+
+#include <vector>
+
+#include "lvr2/geometry/BaseMesh.hpp"
+#include "lvr2/geometry/Handles.hpp"
+#include "lvr2/attrmaps/AttrMaps.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Inputs and outputs of LocalNeighborhoodEngine::compute().
+ *
+ * Only the features with an output map are computed. The output maps are
+ * overwritten and contain one value per vertex of the mesh.
+ */
+struct LocalNeighborhoodFeatures
+{
+    /// Average vertex angles, see calcAverageVertexAngles(). Needed for the roughness.
+    const VertexMap<float>* averageAngles = nullptr;
+
+    /// Difference between the highest and the lowest vertex along the up
+    /// vector within the cylindrical neighborhood, see calcVertexHeightDifferences()
+    DenseVertexMap<float>* heightDifferences = nullptr;
+
+    /// Mean average angle within the spherical neighborhood, see calcVertexRoughness()
+    DenseVertexMap<float>* roughness = nullptr;
+};
+
+/**
+ * @brief Computes several local neighborhood features of all vertices in a
+ *        single traversal of the mesh.
+ *
+ * Two neighborhoods are determined for each vertex: the spherical one
+ * contains all vertices that are connected to the vertex by a path within
+ * the sphere of the given radius, the cylindrical one uses the distance
+ * orthogonal to the up vector instead. Since every spherical neighbor is also
+ * a cylindrical neighbor, both are found in the same traversal: the spherical
+ * neighborhood is expanded first, its border then continues the cylindrical
+ * one.
+ *
+ * The vertices are processed in parallel. Each thread marks visited vertices
+ * in its own array with a stamp that changes for every vertex, so the
+ * array never has to be cleared. The results are written directly into
+ * preallocated dense maps.
+ *
+ * If caching is enabled, the neighborhoods found by the first call of
+ * compute() are stored in compressed sparse rows and reused by further
+ * calls, e.g. for other features with the same radius.
+ */
+template<typename BaseVecT>
+class LocalNeighborhoodEngine
+{
+public:
+    /**
+     * @brief Creates an engine for the given mesh. The mesh must not be
+     *        changed while the engine is in use.
+     *
+     * @param mesh                  The mesh
+     * @param radius                The radius of the local neighborhoods
+     * @param cacheNeighborhoods    Store the neighborhoods for later calls of compute()
+     * @param up                    The up vector, defining the cylindrical neighborhoods
+     *                              and the height of the vertices
+     */
+    LocalNeighborhoodEngine(
+        const BaseMesh<BaseVecT>& mesh,
+        double radius,
+        bool cacheNeighborhoods = false,
+        const BaseVecT& up = BaseVecT(0, 0, 1)
+    );
+
+    /**
+     * @brief Computes all requested features with one traversal, or without
+     *        any traversal if the neighborhoods are cached.
+     */
+    void compute(LocalNeighborhoodFeatures& features);
+
+    /// True if the neighborhoods are cached
+    bool isCached() const { return !m_offsets.empty(); }
+
+    /// Drops the cached neighborhoods
+    void clearCache();
+
+private:
+
+    /// Per thread state of the traversal
+    struct TraversalState
+    {
+        /// Visit stamp of each vertex
+        std::vector<uint32_t> stamps;
+        /// Stamp of the current traversal. Vertices with this stamp are
+        /// cylindrical neighbors, those with stamp + 1 spherical ones.
+        uint32_t stamp = 0;
+
+        std::vector<VertexHandle> sphereStack;
+        std::vector<VertexHandle> cylinderStack;
+        std::vector<VertexHandle> directNeighbors;
+
+        /// Non manifold vertices found by this thread
+        std::vector<VertexHandle> invalid;
+    };
+
+    /**
+     * @brief Visits the local neighborhood of `vH` (not `vH` itself). The
+     *        spherical neighbors are visited first.
+     *
+     * @param visitor   Called with each neighbor and whether it is a spherical neighbor
+     */
+    template<typename VisitorF>
+    void traverse(VertexHandle vH, TraversalState& state, VisitorF&& visitor) const;
+
+    const BaseMesh<BaseVecT>& m_mesh;
+    double m_radius;
+    BaseVecT m_up;
+    bool m_cacheNeighborhoods;
+
+    // Cached neighborhoods: the neighbors of vertex i are
+    // m_neighbors[m_offsets[i], m_offsets[i + 1]), the first m_numSphere[i]
+    // of them are spherical neighbors.
+    std::vector<size_t> m_offsets;
+    std::vector<uint32_t> m_numSphere;
+    std::vector<Index> m_neighbors;
+};
+
+} // namespace lvr2
+
+#include "lvr2/algorithm/LocalNeighborhoodEngine.tcc"
+
+#endif /* LVR2_ALGORITHM_LOCALNEIGHBORHOODENGINE_H_ */
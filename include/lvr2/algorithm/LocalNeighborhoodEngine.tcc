@@ -0,0 +1,348 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * LocalNeighborhoodEngine.tcc
+ *
+ * @date 18.10.2026
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "lvr2/util/Logging.hpp"
+#include "lvr2/util/Panic.hpp"
+
+namespace lvr2
+{
+
+template<typename BaseVecT>
+LocalNeighborhoodEngine<BaseVecT>::LocalNeighborhoodEngine(
+    const BaseMesh<BaseVecT>& mesh,
+    double radius,
+    bool cacheNeighborhoods,
+    const BaseVecT& up)
+    : m_mesh(mesh),
+      m_radius(radius),
+      m_up(up.normalized()),
+      m_cacheNeighborhoods(cacheNeighborhoods)
+{
+}
+
+template<typename BaseVecT>
+void LocalNeighborhoodEngine<BaseVecT>::clearCache()
+{
+    std::vector<size_t>().swap(m_offsets);
+    std::vector<uint32_t>().swap(m_numSphere);
+    std::vector<Index>().swap(m_neighbors);
+}
+
+template<typename BaseVecT>
+template<typename VisitorF>
+void LocalNeighborhoodEngine<BaseVecT>::traverse(
+    VertexHandle vH,
+    TraversalState& state,
+    VisitorF&& visitor) const
+{
+    // Start a new traversal. Only when the stamps run out, the array has
+    // to be reset.
+    if (state.stamp >= std::numeric_limits<uint32_t>::max() - 2)
+    {
+        std::fill(state.stamps.begin(), state.stamps.end(), 0);
+        state.stamp = 0;
+    }
+    state.stamp += 2;
+    const uint32_t cylinderStamp = state.stamp;
+    const uint32_t sphereStamp = state.stamp + 1;
+
+    // Prepare values for the radius tests
+    const BaseVecT vPos = m_mesh.getVertexPosition(vH);
+    const BaseVecT vPosProj = vPos - m_up * vPos.dot(m_up);
+    const double radiusSquared = m_radius * m_radius;
+
+    auto expand = [&](VertexHandle curVH)
+    {
+        state.directNeighbors.clear();
+        try
+        {
+            m_mesh.getNeighboursOfVertex(curVH, state.directNeighbors);
+        }
+        catch (lvr2::PanicException& exception)
+        {
+            state.invalid.push_back(curVH);
+        }
+    };
+
+    auto inCylinder = [&](const BaseVecT& pos)
+    {
+        const BaseVecT posProj = pos - m_up * pos.dot(m_up);
+        return posProj.squaredDistanceFrom(vPosProj) < radiusSquared;
+    };
+
+    state.stamps[vH.idx()] = sphereStamp;
+    state.sphereStack.clear();
+    state.cylinderStack.clear();
+    state.sphereStack.push_back(vH);
+
+    // Expand the spherical neighborhood. Neighbors outside of the sphere but
+    // inside of the cylinder start the remaining cylindrical neighborhood.
+    while (!state.sphereStack.empty())
+    {
+        VertexHandle curVH = state.sphereStack.back();
+        state.sphereStack.pop_back();
+
+        expand(curVH);
+        for (auto newVH : state.directNeighbors)
+        {
+            if (state.stamps[newVH.idx()] >= cylinderStamp)
+            {
+                continue;
+            }
+
+            const BaseVecT& pos = m_mesh.getVertexPosition(newVH);
+            if (pos.squaredDistanceFrom(vPos) < radiusSquared)
+            {
+                state.stamps[newVH.idx()] = sphereStamp;
+                visitor(newVH, true);
+                state.sphereStack.push_back(newVH);
+            }
+            else if (inCylinder(pos))
+            {
+                state.stamps[newVH.idx()] = cylinderStamp;
+                state.cylinderStack.push_back(newVH);
+            }
+        }
+    }
+
+    // All spherical neighbors are known now, everything else is only
+    // reachable within the cylinder.
+    while (!state.cylinderStack.empty())
+    {
+        VertexHandle curVH = state.cylinderStack.back();
+        state.cylinderStack.pop_back();
+        visitor(curVH, false);
+
+        expand(curVH);
+        for (auto newVH : state.directNeighbors)
+        {
+            if (state.stamps[newVH.idx()] >= cylinderStamp)
+            {
+                continue;
+            }
+
+            if (inCylinder(m_mesh.getVertexPosition(newVH)))
+            {
+                state.stamps[newVH.idx()] = cylinderStamp;
+                state.cylinderStack.push_back(newVH);
+            }
+        }
+    }
+}
+
+template<typename BaseVecT>
+void LocalNeighborhoodEngine<BaseVecT>::compute(LocalNeighborhoodFeatures& features)
+{
+    if (features.roughness && !features.averageAngles)
+    {
+        panic("LocalNeighborhoodEngine: The roughness needs the average vertex angles");
+    }
+
+    const size_t numIndices = m_mesh.nextVertexIndex();
+    const bool useCache = isCached();
+    const bool buildCache = m_cacheNeighborhoods && !useCache;
+
+    // Every vertex gets a slot, so the threads can write without locking
+    if (features.heightDifferences)
+    {
+        *features.heightDifferences = DenseVertexMap<float>(numIndices, 0.0f);
+    }
+    if (features.roughness)
+    {
+        *features.roughness = DenseVertexMap<float>(numIndices, 0.0f);
+    }
+
+    // Neighborhoods found by one thread, later merged into the cache
+    struct CacheBuffer
+    {
+        std::vector<Index> vertices;
+        std::vector<size_t> begins;
+        std::vector<uint32_t> numSphere;
+        std::vector<Index> neighbors;
+    };
+    std::vector<CacheBuffer> buffers;
+    std::vector<VertexHandle> invalid;
+
+    lvr2::Monitor monitor(lvr2::LogLevel::info, "[LocalNeighborhoodEngine] Computing local neighborhood features", m_mesh.numVertices());
+
+    #pragma omp parallel
+    {
+        TraversalState state;
+        if (!useCache)
+        {
+            state.stamps.assign(numIndices, 0);
+        }
+        CacheBuffer buffer;
+
+        #pragma omp for schedule(dynamic, 64)
+        for (size_t i = 0; i < numIndices; i++)
+        {
+            const VertexHandle vH(i);
+            if (!m_mesh.containsVertex(vH))
+            {
+                continue;
+            }
+
+            // The vertex itself is part of both neighborhoods
+            const float height = m_up.dot(m_mesh.getVertexPosition(vH));
+            float minHeight = height;
+            float maxHeight = height;
+            double angleSum = features.averageAngles ? (*features.averageAngles)[vH] : 0.0;
+            size_t sphereCount = 1;
+
+            auto accumulate = [&](VertexHandle neighbor, bool inSphere)
+            {
+                const float height = m_up.dot(m_mesh.getVertexPosition(neighbor));
+                minHeight = std::min(minHeight, height);
+                maxHeight = std::max(maxHeight, height);
+
+                if (inSphere && features.averageAngles)
+                {
+                    angleSum += (*features.averageAngles)[neighbor];
+                    sphereCount++;
+                }
+            };
+
+            if (useCache)
+            {
+                const size_t begin = m_offsets[i];
+                const size_t end = m_offsets[i + 1];
+                for (size_t j = begin; j < end; j++)
+                {
+                    accumulate(VertexHandle(m_neighbors[j]), j - begin < m_numSphere[i]);
+                }
+            }
+            else if (buildCache)
+            {
+                buffer.vertices.push_back(i);
+                buffer.begins.push_back(buffer.neighbors.size());
+                uint32_t numSphere = 0;
+                traverse(vH, state, [&](VertexHandle neighbor, bool inSphere)
+                {
+                    accumulate(neighbor, inSphere);
+                    buffer.neighbors.push_back(neighbor.idx());
+                    numSphere += inSphere;
+                });
+                buffer.numSphere.push_back(numSphere);
+            }
+            else
+            {
+                traverse(vH, state, accumulate);
+            }
+
+            if (features.heightDifferences)
+            {
+                (*features.heightDifferences)[vH] = maxHeight - minHeight;
+            }
+            if (features.roughness)
+            {
+                (*features.roughness)[vH] = angleSum / sphereCount;
+            }
+            ++monitor;
+        }
+
+        // Once per thread
+        #pragma omp critical
+        {
+            invalid.insert(invalid.end(), state.invalid.begin(), state.invalid.end());
+            if (buildCache)
+            {
+                buffers.push_back(std::move(buffer));
+            }
+        }
+    }
+    monitor.terminate();
+
+    // Deleted vertices have no value
+    for (size_t i = 0; i < numIndices; i++)
+    {
+        const VertexHandle vH(i);
+        if (!m_mesh.containsVertex(vH))
+        {
+            if (features.heightDifferences)
+            {
+                features.heightDifferences->erase(vH);
+            }
+            if (features.roughness)
+            {
+                features.roughness->erase(vH);
+            }
+        }
+    }
+
+    if (buildCache)
+    {
+        m_offsets.assign(numIndices + 1, 0);
+        m_numSphere.assign(numIndices, 0);
+        for (const CacheBuffer& buffer : buffers)
+        {
+            for (size_t k = 0; k < buffer.vertices.size(); k++)
+            {
+                const size_t end = k + 1 < buffer.vertices.size() ? buffer.begins[k + 1] : buffer.neighbors.size();
+                m_offsets[buffer.vertices[k] + 1] = end - buffer.begins[k];
+                m_numSphere[buffer.vertices[k]] = buffer.numSphere[k];
+            }
+        }
+        for (size_t i = 0; i < numIndices; i++)
+        {
+            m_offsets[i + 1] += m_offsets[i];
+        }
+        m_neighbors.resize(m_offsets[numIndices]);
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t b = 0; b < buffers.size(); b++)
+        {
+            const CacheBuffer& buffer = buffers[b];
+            for (size_t k = 0; k < buffer.vertices.size(); k++)
+            {
+                const size_t end = k + 1 < buffer.vertices.size() ? buffer.begins[k + 1] : buffer.neighbors.size();
+                std::copy(buffer.neighbors.begin() + buffer.begins[k],
+                          buffer.neighbors.begin() + end,
+                          m_neighbors.begin() + m_offsets[buffer.vertices[k]]);
+            }
+        }
+    }
+
+    if (!invalid.empty())
+    {
+        std::sort(invalid.begin(), invalid.end());
+        invalid.erase(std::unique(invalid.begin(), invalid.end()), invalid.end());
+        lvr2::logout::get() << lvr2::warning << "[LocalNeighborhoodEngine] Found " << invalid.size()
+            << " invalid, non manifold vertices." << lvr2::endl;
+    }
+}
+
+} // namespace lvr2
@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * MeshPathPlanner.hpp
+ *
+ * @date 18.10.2026
+ */
+
+#ifndef LVR2_ALGORITHM_MESHPATHPLANNER_H_
+#define LVR2_ALGORITHM_MESHPATHPLANNER_H_
+
+#include <limits>
+#include <list>
+#include <vector>
+
+#include "lvr2/geometry/BaseMesh.hpp"
+#include "lvr2/geometry/Handles.hpp"
+#include "lvr2/attrmaps/AttrMaps.hpp"
+
+namespace lvr2
+{
+
+/**
+ * @brief Shortest path queries on the vertex graph of a mesh.
+ *
+ * The adjacency of the mesh and the edge costs are copied once into
+ * compressed sparse rows, so queries neither allocate nor access the half
+ * edge structure. Vertices whose cost reaches the lethal cost cannot be
+ * entered, like in Dijkstra().
+ *
+ * Queries stop as soon as the goal is reached. A* uses the Euclidean
+ * distance to the goal, scaled with the smallest ratio of edge cost to
+ * edge length in the mesh, so the heuristic never overestimates and the
+ * paths are optimal for any non-negative edge costs. The bidirectional
+ * search runs A* from both ends with averaged heuristics.
+ *
+ * All per-vertex search state lives in a Workspace. A workspace is reset by
+ * incrementing a generation counter instead of clearing its arrays, so it
+ * can be reused for any number of queries. One workspace must not be used
+ * by several threads at the same time. planBatch() runs many queries in
+ * parallel with one workspace per thread.
+ */
+template<typename BaseVecT>
+class MeshPathPlanner
+{
+public:
+
+    /// The search algorithm
+    enum class Method
+    {
+        /// Dijkstra's algorithm, stopping at the goal
+        Dijkstra,
+        /// A* with the Euclidean distance to the goal as heuristic
+        AStar,
+        /// A* from start and goal simultaneously
+        Bidirectional
+    };
+
+    /// A start and goal vertex for planBatch()
+    struct Query
+    {
+        VertexHandle start;
+        VertexHandle goal;
+    };
+
+    /// The result of a query
+    struct Result
+    {
+        /// True if a path was found
+        bool found = false;
+
+        /// The cost of the path
+        float cost = std::numeric_limits<float>::infinity();
+
+        /// The vertices of the path from start to goal
+        std::vector<VertexHandle> path;
+
+        /// The number of vertices expanded by the search
+        size_t numExpanded = 0;
+    };
+
+    /// Reusable search state, see class description
+    class Workspace
+    {
+    public:
+        Workspace() = default;
+
+    private:
+        friend class MeshPathPlanner<BaseVecT>;
+
+        struct HeapEntry
+        {
+            float key;
+            Index vertex;
+        };
+
+        /// State of one search direction
+        struct Direction
+        {
+            std::vector<uint32_t> generation;
+            std::vector<float> distance;
+            std::vector<Index> predecessor;
+            /// Position in the heap, or one of the constants below
+            std::vector<uint32_t> heapPos;
+            std::vector<HeapEntry> heap;
+        };
+
+        static constexpr uint32_t Closed = std::numeric_limits<uint32_t>::max();
+
+        /// Prepares the workspace for a new query on a graph with `size` vertices
+        void begin(size_t size);
+
+        /// Indexed binary heap operations on the queue of one direction
+        void push(Direction& dir, Index vertex, float key);
+        Index pop(Direction& dir);
+        void decreaseKey(Direction& dir, Index vertex, float key);
+        void siftUp(Direction& dir, uint32_t pos);
+        void siftDown(Direction& dir, uint32_t pos);
+
+        Direction m_directions[2];
+        uint32_t m_generation = 0;
+    };
+
+    /**
+     * @brief Creates the search graph.
+     *
+     * @param mesh          The mesh
+     * @param edgeCosts     Non-negative cost of each edge
+     */
+    MeshPathPlanner(const BaseMesh<BaseVecT>& mesh, const DenseEdgeMap<float>& edgeCosts);
+
+    /**
+     * @brief Creates the search graph without the lethal vertices.
+     *
+     * @param mesh          The mesh
+     * @param edgeCosts     Non-negative cost of each edge
+     * @param vertexCosts   Cost of each vertex
+     * @param lethalCost    Vertices with at least this cost cannot be entered
+     */
+    MeshPathPlanner(
+        const BaseMesh<BaseVecT>& mesh,
+        const DenseEdgeMap<float>& edgeCosts,
+        const DenseVertexMap<float>& vertexCosts,
+        float lethalCost = 1.0f
+    );
+
+    /**
+     * @brief Searches a path from `start` to `goal` with a thread local workspace.
+     */
+    Result plan(VertexHandle start, VertexHandle goal, Method method = Method::AStar) const;
+
+    /**
+     * @brief Searches a path from `start` to `goal` with the given workspace.
+     */
+    Result plan(VertexHandle start, VertexHandle goal, Workspace& workspace, Method method = Method::AStar) const;
+
+    /**
+     * @brief Searches a path from `start` to `goal` and stores it in `path`,
+     *        like Dijkstra().
+     *
+     * @return true if a path between start and goal exists
+     */
+    bool plan(VertexHandle start, VertexHandle goal, std::list<VertexHandle>& path, Method method = Method::AStar) const;
+
+    /**
+     * @brief Answers all queries in parallel.
+     *
+     * @return The results in the order of the queries
+     */
+    std::vector<Result> planBatch(const std::vector<Query>& queries, Method method = Method::AStar) const;
+
+    /// The factor of the Euclidean distance used as heuristic
+    float heuristicScale() const { return m_heuristicScale; }
+
+private:
+
+    /// Copies the adjacency of the mesh into the CSR arrays
+    void buildGraph(
+        const BaseMesh<BaseVecT>& mesh,
+        const DenseEdgeMap<float>& edgeCosts,
+        const DenseVertexMap<float>* vertexCosts,
+        float lethalCost
+    );
+
+    /// Euclidean distance between two vertices
+    float distance(Index a, Index b) const;
+
+    /// Scaled Euclidean distance between two vertices
+    float heuristic(Index a, Index b) const;
+
+    Result searchUnidirectional(Index start, Index goal, Workspace& workspace, bool useHeuristic) const;
+
+    Result searchBidirectional(Index start, Index goal, Workspace& workspace) const;
+
+    /// The neighbors of vertex i are m_targets[m_offsets[i], m_offsets[i + 1])
+    std::vector<size_t> m_offsets;
+    std::vector<Index> m_targets;
+    std::vector<float> m_costs;
+
+    /// Vertex positions, three coordinates per vertex index
+    std::vector<float> m_positions;
+
+    /// Vertices that exist in the mesh
+    std::vector<bool> m_valid;
+
+    /// Vertices below the lethal cost
+    std::vector<bool> m_enterable;
+
+    float m_heuristicScale;
+};
+
+} // namespace lvr2
+
+#include "lvr2/algorithm/MeshPathPlanner.tcc"
+
+#endif /* LVR2_ALGORITHM_MESHPATHPLANNER_H_ */
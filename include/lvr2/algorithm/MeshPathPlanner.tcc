@@ -0,0 +1,567 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * MeshPathPlanner.tcc
+ *
+ * @date 18.10.2026
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+#include "lvr2/algorithm/HandleCompaction.hpp"
+#include "lvr2/util/Panic.hpp"
+
+namespace lvr2
+{
+
+template<typename BaseVecT>
+void MeshPathPlanner<BaseVecT>::Workspace::begin(size_t size)
+{
+    m_generation++;
+    for (auto& dir : m_directions)
+    {
+        // The arrays are only cleared when the graph changes or the
+        // generation counter wraps around
+        if (dir.generation.size() != size || m_generation == 0)
+        {
+            dir.generation.assign(size, 0);
+            dir.distance.resize(size);
+            dir.predecessor.resize(size);
+            dir.heapPos.resize(size);
+        }
+        dir.heap.clear();
+    }
+    if (m_generation == 0)
+    {
+        m_generation = 1;
+    }
+}
+
+template<typename BaseVecT>
+void MeshPathPlanner<BaseVecT>::Workspace::push(Direction& dir, Index vertex, float key)
+{
+    dir.heap.push_back({ key, vertex });
+    siftUp(dir, dir.heap.size() - 1);
+}
+
+template<typename BaseVecT>
+Index MeshPathPlanner<BaseVecT>::Workspace::pop(Direction& dir)
+{
+    Index top = dir.heap.front().vertex;
+    dir.heapPos[top] = Closed;
+    dir.heap.front() = dir.heap.back();
+    dir.heap.pop_back();
+    if (!dir.heap.empty())
+    {
+        siftDown(dir, 0);
+    }
+    return top;
+}
+
+template<typename BaseVecT>
+void MeshPathPlanner<BaseVecT>::Workspace::decreaseKey(Direction& dir, Index vertex, float key)
+{
+    uint32_t pos = dir.heapPos[vertex];
+    dir.heap[pos].key = key;
+    siftUp(dir, pos);
+}
+
+template<typename BaseVecT>
+void MeshPathPlanner<BaseVecT>::Workspace::siftUp(Direction& dir, uint32_t pos)
+{
+    HeapEntry entry = dir.heap[pos];
+    while (pos > 0)
+    {
+        uint32_t parent = (pos - 1) / 2;
+        if (dir.heap[parent].key <= entry.key)
+        {
+            break;
+        }
+        dir.heap[pos] = dir.heap[parent];
+        dir.heapPos[dir.heap[pos].vertex] = pos;
+        pos = parent;
+    }
+    dir.heap[pos] = entry;
+    dir.heapPos[entry.vertex] = pos;
+}
+
+template<typename BaseVecT>
+void MeshPathPlanner<BaseVecT>::Workspace::siftDown(Direction& dir, uint32_t pos)
+{
+    HeapEntry entry = dir.heap[pos];
+    uint32_t size = dir.heap.size();
+    while (true)
+    {
+        uint32_t child = 2 * pos + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && dir.heap[child + 1].key < dir.heap[child].key)
+        {
+            child++;
+        }
+        if (entry.key <= dir.heap[child].key)
+        {
+            break;
+        }
+        dir.heap[pos] = dir.heap[child];
+        dir.heapPos[dir.heap[pos].vertex] = pos;
+        pos = child;
+    }
+    dir.heap[pos] = entry;
+    dir.heapPos[entry.vertex] = pos;
+}
+
+template<typename BaseVecT>
+MeshPathPlanner<BaseVecT>::MeshPathPlanner(
+    const BaseMesh<BaseVecT>& mesh,
+    const DenseEdgeMap<float>& edgeCosts
+)
+{
+    buildGraph(mesh, edgeCosts, nullptr, 0.0f);
+}
+
+template<typename BaseVecT>
+MeshPathPlanner<BaseVecT>::MeshPathPlanner(
+    const BaseMesh<BaseVecT>& mesh,
+    const DenseEdgeMap<float>& edgeCosts,
+    const DenseVertexMap<float>& vertexCosts,
+    float lethalCost
+)
+{
+    buildGraph(mesh, edgeCosts, &vertexCosts, lethalCost);
+}
+
+template<typename BaseVecT>
+void MeshPathPlanner<BaseVecT>::buildGraph(
+    const BaseMesh<BaseVecT>& mesh,
+    const DenseEdgeMap<float>& edgeCosts,
+    const DenseVertexMap<float>* vertexCosts,
+    float lethalCost
+)
+{
+    const size_t numVertices = mesh.nextVertexIndex();
+    const std::vector<EdgeHandle> edges = collectEdgeHandles(mesh);
+
+    m_valid.assign(numVertices, false);
+    m_enterable.assign(numVertices, false);
+    m_positions.assign(3 * numVertices, 0.0f);
+    for (auto vH : mesh.vertices())
+    {
+        m_valid[vH.idx()] = true;
+        m_enterable[vH.idx()] = vertexCosts == nullptr || (*vertexCosts)[vH] < lethalCost;
+        auto p = mesh.getVertexPosition(vH);
+        m_positions[3 * vH.idx()] = p.x;
+        m_positions[3 * vH.idx() + 1] = p.y;
+        m_positions[3 * vH.idx() + 2] = p.z;
+    }
+
+    auto enterable = [&](VertexHandle vH)
+    {
+        return m_enterable[vH.idx()];
+    };
+
+    // Count the degree of each vertex
+    std::vector<std::array<VertexHandle, 2>> endpoints(edges.size());
+    m_offsets.assign(numVertices + 1, 0);
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        float cost = edgeCosts[edges[i]];
+        if (!(cost >= 0.0f))
+        {
+            panic("MeshPathPlanner: edge costs must not be negative or NaN");
+        }
+
+        endpoints[i] = mesh.getVerticesOfEdge(edges[i]);
+        if (enterable(endpoints[i][1]))
+        {
+            m_offsets[endpoints[i][0].idx() + 1]++;
+        }
+        if (enterable(endpoints[i][0]))
+        {
+            m_offsets[endpoints[i][1].idx() + 1]++;
+        }
+    }
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        m_offsets[i + 1] += m_offsets[i];
+    }
+
+    // Fill the rows
+    m_targets.resize(m_offsets[numVertices]);
+    m_costs.resize(m_offsets[numVertices]);
+    std::vector<size_t> fill(m_offsets.begin(), m_offsets.end() - 1);
+    float minRatio = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        Index a = endpoints[i][0].idx();
+        Index b = endpoints[i][1].idx();
+        float cost = edgeCosts[edges[i]];
+
+        if (enterable(endpoints[i][1]))
+        {
+            m_targets[fill[a]] = b;
+            m_costs[fill[a]++] = cost;
+        }
+        if (enterable(endpoints[i][0]))
+        {
+            m_targets[fill[b]] = a;
+            m_costs[fill[b]++] = cost;
+        }
+
+        float length = distance(a, b);
+        if (length > 0.0f)
+        {
+            minRatio = std::min(minRatio, cost / length);
+        }
+    }
+
+    // Sort each row by target, so the search order does not depend on the
+    // order of the edges in the mesh
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        size_t begin = m_offsets[i];
+        size_t end = m_offsets[i + 1];
+        if (end - begin < 2)
+        {
+            continue;
+        }
+        std::vector<std::pair<Index, float>> row(end - begin);
+        for (size_t j = begin; j < end; j++)
+        {
+            row[j - begin] = { m_targets[j], m_costs[j] };
+        }
+        std::sort(row.begin(), row.end());
+        for (size_t j = begin; j < end; j++)
+        {
+            m_targets[j] = row[j - begin].first;
+            m_costs[j] = row[j - begin].second;
+        }
+    }
+
+    // The heuristic is only admissible if no edge is cheaper than its length
+    // times the scale. The margin covers rounding in the distances.
+    m_heuristicScale = std::isfinite(minRatio) ? minRatio * (1.0f - 1e-5f) : 0.0f;
+}
+
+template<typename BaseVecT>
+float MeshPathPlanner<BaseVecT>::distance(Index a, Index b) const
+{
+    float dx = m_positions[3 * a] - m_positions[3 * b];
+    float dy = m_positions[3 * a + 1] - m_positions[3 * b + 1];
+    float dz = m_positions[3 * a + 2] - m_positions[3 * b + 2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+template<typename BaseVecT>
+float MeshPathPlanner<BaseVecT>::heuristic(Index a, Index b) const
+{
+    return m_heuristicScale * distance(a, b);
+}
+
+template<typename BaseVecT>
+typename MeshPathPlanner<BaseVecT>::Result MeshPathPlanner<BaseVecT>::plan(
+    VertexHandle start,
+    VertexHandle goal,
+    Method method
+) const
+{
+    thread_local Workspace workspace;
+    return plan(start, goal, workspace, method);
+}
+
+template<typename BaseVecT>
+typename MeshPathPlanner<BaseVecT>::Result MeshPathPlanner<BaseVecT>::plan(
+    VertexHandle start,
+    VertexHandle goal,
+    Workspace& workspace,
+    Method method
+) const
+{
+    Result result;
+
+    const Index s = start.idx();
+    const Index g = goal.idx();
+    if (s >= m_valid.size() || g >= m_valid.size() || !m_valid[s] || !m_valid[g])
+    {
+        return result;
+    }
+
+    if (s == g)
+    {
+        result.found = true;
+        result.cost = 0.0f;
+        result.path.push_back(start);
+        return result;
+    }
+
+    // The goal can never be entered
+    if (!m_enterable[g])
+    {
+        return result;
+    }
+
+    switch (method)
+    {
+        case Method::Dijkstra:
+            return searchUnidirectional(s, g, workspace, false);
+        case Method::AStar:
+            return searchUnidirectional(s, g, workspace, true);
+        case Method::Bidirectional:
+            // The backward search only knows the edges into enterable
+            // vertices, so it can not reach a lethal start
+            if (!m_enterable[s])
+            {
+                return searchUnidirectional(s, g, workspace, true);
+            }
+            return searchBidirectional(s, g, workspace);
+    }
+    return result;
+}
+
+template<typename BaseVecT>
+bool MeshPathPlanner<BaseVecT>::plan(
+    VertexHandle start,
+    VertexHandle goal,
+    std::list<VertexHandle>& path,
+    Method method
+) const
+{
+    Result result = plan(start, goal, method);
+    path.assign(result.path.begin(), result.path.end());
+    return result.found;
+}
+
+template<typename BaseVecT>
+std::vector<typename MeshPathPlanner<BaseVecT>::Result> MeshPathPlanner<BaseVecT>::planBatch(
+    const std::vector<Query>& queries,
+    Method method
+) const
+{
+    std::vector<Result> results(queries.size());
+
+    #pragma omp parallel
+    {
+        Workspace workspace;
+
+        // Queries differ a lot in their length, so hand them out one by one
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t i = 0; i < queries.size(); i++)
+        {
+            results[i] = plan(queries[i].start, queries[i].goal, workspace, method);
+        }
+    }
+
+    return results;
+}
+
+template<typename BaseVecT>
+typename MeshPathPlanner<BaseVecT>::Result MeshPathPlanner<BaseVecT>::searchUnidirectional(
+    Index start,
+    Index goal,
+    Workspace& workspace,
+    bool useHeuristic
+) const
+{
+    Result result;
+
+    workspace.begin(m_valid.size());
+    const uint32_t generation = workspace.m_generation;
+    auto& dir = workspace.m_directions[0];
+
+    dir.generation[start] = generation;
+    dir.distance[start] = 0.0f;
+    dir.predecessor[start] = start;
+    workspace.push(dir, start, useHeuristic ? heuristic(start, goal) : 0.0f);
+
+    while (!dir.heap.empty())
+    {
+        Index current = workspace.pop(dir);
+        result.numExpanded++;
+
+        // With a consistent heuristic the goal has its final distance
+        // as soon as it leaves the queue
+        if (current == goal)
+        {
+            result.found = true;
+            break;
+        }
+
+        const float currentDistance = dir.distance[current];
+        for (size_t j = m_offsets[current]; j < m_offsets[current + 1]; j++)
+        {
+            Index next = m_targets[j];
+            float nextDistance = currentDistance + m_costs[j];
+
+            if (dir.generation[next] != generation)
+            {
+                dir.generation[next] = generation;
+                dir.distance[next] = nextDistance;
+                dir.predecessor[next] = current;
+                workspace.push(dir, next, nextDistance + (useHeuristic ? heuristic(next, goal) : 0.0f));
+            }
+            else if (dir.heapPos[next] != Workspace::Closed && nextDistance < dir.distance[next])
+            {
+                dir.distance[next] = nextDistance;
+                dir.predecessor[next] = current;
+                workspace.decreaseKey(dir, next, nextDistance + (useHeuristic ? heuristic(next, goal) : 0.0f));
+            }
+        }
+    }
+
+    if (!result.found)
+    {
+        return result;
+    }
+
+    result.cost = dir.distance[goal];
+    for (Index v = goal; v != start; v = dir.predecessor[v])
+    {
+        result.path.push_back(VertexHandle(v));
+    }
+    result.path.push_back(VertexHandle(start));
+    std::reverse(result.path.begin(), result.path.end());
+
+    return result;
+}
+
+template<typename BaseVecT>
+typename MeshPathPlanner<BaseVecT>::Result MeshPathPlanner<BaseVecT>::searchBidirectional(
+    Index start,
+    Index goal,
+    Workspace& workspace
+) const
+{
+    Result result;
+
+    workspace.begin(m_valid.size());
+    const uint32_t generation = workspace.m_generation;
+
+    // Average of the forward and backward heuristic. The backward search
+    // uses the negated potential, so both searches see consistent reduced
+    // costs and may stop once the sum of their smallest keys reaches the
+    // best connection found so far.
+    auto potential = [&](int side, Index v)
+    {
+        float p = 0.5f * (heuristic(v, goal) - heuristic(v, start));
+        return side == 0 ? p : -p;
+    };
+
+    const Index roots[2] = { start, goal };
+    for (int side = 0; side < 2; side++)
+    {
+        auto& dir = workspace.m_directions[side];
+        dir.generation[roots[side]] = generation;
+        dir.distance[roots[side]] = 0.0f;
+        dir.predecessor[roots[side]] = roots[side];
+        workspace.push(dir, roots[side], potential(side, roots[side]));
+    }
+
+    float best = std::numeric_limits<float>::infinity();
+    Index meet = start;
+
+    auto& forward = workspace.m_directions[0];
+    auto& backward = workspace.m_directions[1];
+    while (!forward.heap.empty() && !backward.heap.empty())
+    {
+        if (forward.heap.front().key + backward.heap.front().key >= best)
+        {
+            break;
+        }
+
+        // Expand the side with the smaller key
+        int side = forward.heap.front().key <= backward.heap.front().key ? 0 : 1;
+        auto& dir = workspace.m_directions[side];
+        auto& other = workspace.m_directions[1 - side];
+
+        Index current = workspace.pop(dir);
+        result.numExpanded++;
+
+        // The graph only contains edges into enterable vertices. All
+        // vertices labeled by the backward search are enterable, so its
+        // edges are the reverse of the forward edges with the same cost.
+        const float currentDistance = dir.distance[current];
+        for (size_t j = m_offsets[current]; j < m_offsets[current + 1]; j++)
+        {
+            Index next = m_targets[j];
+            float nextDistance = currentDistance + m_costs[j];
+
+            if (dir.generation[next] != generation)
+            {
+                dir.generation[next] = generation;
+                dir.distance[next] = nextDistance;
+                dir.predecessor[next] = current;
+                workspace.push(dir, next, nextDistance + potential(side, next));
+            }
+            else if (dir.heapPos[next] != Workspace::Closed && nextDistance < dir.distance[next])
+            {
+                dir.distance[next] = nextDistance;
+                dir.predecessor[next] = current;
+                workspace.decreaseKey(dir, next, nextDistance + potential(side, next));
+            }
+            else
+            {
+                continue;
+            }
+
+            if (other.generation[next] == generation && nextDistance + other.distance[next] < best)
+            {
+                best = nextDistance + other.distance[next];
+                meet = next;
+            }
+        }
+    }
+
+    if (best == std::numeric_limits<float>::infinity())
+    {
+        return result;
+    }
+
+    result.found = true;
+    result.cost = best;
+    for (Index v = meet; v != start; v = forward.predecessor[v])
+    {
+        result.path.push_back(VertexHandle(v));
+    }
+    result.path.push_back(VertexHandle(start));
+    std::reverse(result.path.begin(), result.path.end());
+    for (Index v = meet; v != goal;)
+    {
+        v = backward.predecessor[v];
+        result.path.push_back(VertexHandle(v));
+    }
+
+    return result;
+}
+
+} // namespace lvr2
@@ -33,6 +33,7 @@
  * @author Johan M. von Behren <johan@vonbehren.eu>
  */
 
+#include <exception>
 #include <vector>
 
 using std::vector;
@@ -57,16 +58,29 @@ boost::optional<Normal<typename BaseVecT::CoordType>> getFaceNormal(std::array<B
 template <typename BaseVecT>
 DenseFaceMap<Normal<typename BaseVecT::CoordType>> calcFaceNormals(const BaseMesh<BaseVecT>& mesh)
 {
-    DenseFaceMap<Normal<typename BaseVecT::CoordType>> out;
-    out.reserve(mesh.numFaces());
-
+    vector<FaceHandle> handles;
+    handles.reserve(mesh.numFaces());
     for (auto faceH: mesh.faces())
     {
-        auto maybeNormal = getFaceNormal(mesh.getVertexPositionsOfFace(faceH));
-        auto normal = maybeNormal
+        handles.push_back(faceH);
+    }
+
+    // Compute all normals in parallel and insert them in handle order afterwards
+    vector<Normal<typename BaseVecT::CoordType>> faceNormals(handles.size());
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        auto maybeNormal = getFaceNormal(mesh.getVertexPositionsOfFace(handles[i]));
+        faceNormals[i] = maybeNormal
             ? *maybeNormal
             : Normal<typename BaseVecT::CoordType>(0, 0, 1);
-        out.insert(faceH, normal);
+    }
+
+    DenseFaceMap<Normal<typename BaseVecT::CoordType>> out;
+    out.reserve(mesh.nextFaceIndex());
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        out.insert(handles[i], faceNormals[i]);
     }
     return out;
 }
@@ -105,51 +119,89 @@ DenseVertexMap<Normal<typename BaseVecT::CoordType>> calcVertexNormals(
     const PointsetSurface<BaseVecT>& surface
 )
 {
+    vector<VertexHandle> handles;
+    handles.reserve(mesh.numVertices());
+    for (auto vH: mesh.vertices())
+    {
+        handles.push_back(vH);
+    }
 
-    DenseVertexMap<Normal<typename BaseVecT::CoordType>> normalMap;
-    normalMap.reserve(mesh.numVertices());
+    FloatChannelOptional pointNormals = surface.pointBuffer()->getFloatChannel("normals");
 
-    for (auto vH: mesh.vertices())
+    // The first error is rethrown after the parallel loop
+    std::exception_ptr error;
+
+    vector<Normal<typename BaseVecT::CoordType>> vertexNormals(handles.size());
+    #pragma omp parallel
     {
-        // Use averaged normals from adjacent faces
-        if (auto normal = interpolatedVertexNormal(mesh, normals, vH))
-        {
-            normalMap.insert(vH, *normal);
-        }
-        else
+        vector<size_t> pointIdx;
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (size_t i = 0; i < handles.size(); i++)
         {
-            // Fall back to normals from point cloud
-            if (!surface.pointBuffer()->hasNormals())
+            try
             {
-                // The panic is justified here: in the process of creating the
-                // mesh, normals have to be estimated. These normals are
-                // written to the point buffer.
-                panic("the point buffer needs normals!");
-            }
+                // Use averaged normals from adjacent faces
+                if (auto normal = interpolatedVertexNormal(mesh, normals, handles[i]))
+                {
+                    vertexNormals[i] = *normal;
+                    continue;
+                }
 
-            // Get idx for nearest point to vertex from point cloud
-            auto vertex = mesh.getVertexPosition(vH);
-            vector<size_t> pointIdx;
-            surface.searchTree()->kSearch(vertex, 1, pointIdx);
-            if (pointIdx.empty())
-            {
-                panic("no near point found!");
-            }
+                // Fall back to normals from point cloud
+                if (!surface.pointBuffer()->hasNormals())
+                {
+                    // The panic is justified here: in the process of creating the
+                    // mesh, normals have to be estimated. These normals are
+                    // written to the point buffer.
+                    panic("the point buffer needs normals!");
+                }
 
-            // Get normal for nearest vertex neighbour from point cloud
-            FloatChannelOptional normals = surface.pointBuffer()->getFloatChannel("normals");
-            if(normals)
-            {
-                Normal<typename BaseVecT::CoordType> normal = (*normals)[pointIdx[0]];
-                normalMap.insert(vH, normal);
+                // Get idx for nearest point to vertex from point cloud
+                auto vertex = mesh.getVertexPosition(handles[i]);
+                pointIdx.clear();
+                surface.searchTree()->kSearch(vertex, 1, pointIdx);
+                if (pointIdx.empty())
+                {
+                    panic("no near point found!");
+                }
+
+                // Get normal for nearest vertex neighbour from point cloud
+                if(pointNormals)
+                {
+                    Normal<typename BaseVecT::CoordType> normal = (*pointNormals)[pointIdx[0]];
+                    vertexNormals[i] = normal;
+                }
+                else
+                {
+                    panic("no normal for point found!");
+                }
             }
-            else
+            catch (...)
             {
-                panic("no normal for point found!");
+                #pragma omp critical
+                {
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
             }
         }
     }
 
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    DenseVertexMap<Normal<typename BaseVecT::CoordType>> normalMap;
+    normalMap.reserve(mesh.nextVertexIndex());
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        normalMap.insert(handles[i], vertexNormals[i]);
+    }
+
     return normalMap;
 }
 
@@ -159,31 +211,45 @@ DenseVertexMap<Normal<typename BaseVecT::CoordType>> calcVertexNormals(
     const FaceMap<Normal<typename BaseVecT::CoordType>>& normals
 )
 {
-    DenseVertexMap<Normal<typename BaseVecT::CoordType>> normalMap;
-    normalMap.reserve(mesh.numVertices());
-
+    vector<VertexHandle> handles;
+    handles.reserve(mesh.numVertices());
     for (auto vH: mesh.vertices())
+    {
+        handles.push_back(vH);
+    }
+
+    vector<Normal<typename BaseVecT::CoordType>> vertexNormals(handles.size());
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (size_t i = 0; i < handles.size(); i++)
     {
         try
         {
 
             // Use averaged normals from adjacent faces
-            if (auto normal = interpolatedVertexNormal(mesh, normals, vH))
+            if (auto normal = interpolatedVertexNormal(mesh, normals, handles[i]))
             {
-                normalMap.insert(vH, *normal);
+                vertexNormals[i] = *normal;
             }
             else
             {
-                normalMap.insert(vH, Normal<typename BaseVecT::CoordType>(0, 0, 1));
+                vertexNormals[i] = Normal<typename BaseVecT::CoordType>(0, 0, 1);
             }
         }
         catch (...)
         {
+            #pragma omp critical
             std::cout << timestamp << "Warning: Loop detected. Using default normal" << std::endl;
-            normalMap.insert(vH, Normal<typename BaseVecT::CoordType>(0, 0, 1));
+            vertexNormals[i] = Normal<typename BaseVecT::CoordType>(0, 0, 1);
         }
     }
 
+    DenseVertexMap<Normal<typename BaseVecT::CoordType>> normalMap;
+    normalMap.reserve(mesh.nextVertexIndex());
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        normalMap.insert(handles[i], vertexNormals[i]);
+    }
+
     return normalMap;
 }
 
@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * StatisticalOutlierFilter.hpp
+ *
+ * @date 18.10.2026
+ */
+
+#ifndef LVR2_ALGORITHM_STATISTICALOUTLIERFILTER_HPP_
+#define LVR2_ALGORITHM_STATISTICALOUTLIERFILTER_HPP_
+
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/reconstruction/BigGrid.hpp"
+#include "lvr2/registration/ReductionAlgorithm.hpp"
+#include "lvr2/types/PointBuffer.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lvr2
+{
+
+/**
+ * @brief Removes outliers from point clouds on the CPU.
+ *
+ * In statistical mode, the score of a point is the mean distance to its k
+ * nearest neighbors. Points whose score exceeds the mean score of the cloud
+ * by more than stdDevMult standard deviations are removed. In radius mode,
+ * the score is the distance to the minNeighbors-th nearest neighbor and
+ * points with a score larger than radius are removed, i.e. points with fewer
+ * than minNeighbors neighbors within the radius.
+ *
+ * The neighbors are searched with the SearchTree returned by getSearchTree()
+ * from all OpenMP threads in parallel.
+ *
+ * Large projects can be filtered in streaming mode on the cells of a
+ * BigGrid. Each cell is searched together with the cells in a ring of
+ * haloCells around it, so only the points of a few cells are in memory
+ * per thread. The scores are kept in a memory mapped file between the
+ * pass that computes the statistics and the pass that emits the inliers.
+ * Neighbors further away than the halo are not found, which can only make
+ * scores of sparse regions larger than in the in-memory mode.
+ */
+template<typename BaseVecT>
+class StatisticalOutlierFilter
+{
+public:
+
+    enum class Mode
+    {
+        /// Mean distance to the k nearest neighbors
+        Statistical,
+        /// Number of neighbors within a radius
+        Radius
+    };
+
+    struct Options
+    {
+        Mode mode = Mode::Statistical;
+
+        /// Number of neighbors of the statistical mode
+        int k = 50;
+
+        /// Allowed deviation from the mean score in standard deviations
+        float stdDevMult = 1.0f;
+
+        /// Radius of the radius mode
+        float radius = 0.1f;
+
+        /// Minimum number of neighbors within the radius
+        int minNeighbors = 2;
+
+        /// Search tree implementation, see getSearchTree()
+        std::string searchTree = "flann";
+
+        /// Streaming mode: width of the ring of neighbor cells
+        int haloCells = 1;
+    };
+
+    /// Receives the inliers of one cell in streaming mode
+    using CellSink = std::function<void(const Vector3i& cell, PointBufferPtr inliers)>;
+
+    StatisticalOutlierFilter(const Options& options);
+
+    /**
+     * @brief Computes the indices of the inliers of a point cloud.
+     *
+     * @return The indices in ascending order
+     */
+    std::vector<size_t> inliers(PointBufferPtr points) const;
+
+    /**
+     * @brief Returns a new point buffer with all channels of the inliers.
+     */
+    PointBufferPtr filter(PointBufferPtr points) const;
+
+    /**
+     * @brief Filters the points of a BigGrid in streaming mode.
+     *
+     * @param grid      The grid
+     * @param sink      Called once for every cell with remaining points. The
+     *                  calls are serialized, but the cells arrive in no
+     *                  particular order.
+     * @param tempDir   Directory for the memory mapped scores
+     * @return The number of inliers
+     */
+    size_t filter(const BigGrid<BaseVecT>& grid, const CellSink& sink, const std::string& tempDir = "./") const;
+
+private:
+
+    /**
+     * @brief Computes the scores of the first `numScored` points of `points`.
+     *        All points are used as neighbors.
+     */
+    void computeScores(PointBufferPtr points, size_t numScored, float* scores) const;
+
+    /// Number of neighbors to search, including the point itself
+    int numNeighbors() const;
+
+    /// Returns the largest score of an inlier
+    float threshold(double sum, double sumSquares, size_t n) const;
+
+    Options m_options;
+};
+
+/**
+ * @brief ReductionAlgorithm implementation that removes outliers with a
+ *        StatisticalOutlierFilter
+ */
+class OutlierReductionAlgorithm : public ReductionAlgorithm
+{
+public:
+    using Filter = StatisticalOutlierFilter<BaseVector<float>>;
+
+    OutlierReductionAlgorithm(const Filter::Options& options) : m_filter(options) {};
+
+    PointBufferPtr getReducedPoints() override
+    {
+        if (!m_pointBuffer)
+        {
+            return PointBufferPtr(new PointBuffer());
+        }
+        return m_filter.filter(m_pointBuffer);
+    }
+
+private:
+    Filter m_filter;
+};
+
+using OutlierReductionAlgorithmPtr = std::shared_ptr<OutlierReductionAlgorithm>;
+
+} // namespace lvr2
+
+#include "lvr2/algorithm/StatisticalOutlierFilter.tcc"
+
+#endif /* LVR2_ALGORITHM_STATISTICALOUTLIERFILTER_HPP_ */
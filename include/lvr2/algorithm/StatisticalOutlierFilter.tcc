@@ -0,0 +1,343 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * StatisticalOutlierFilter.tcc
+ *
+ * @date 18.10.2026
+ */
+
+#include "lvr2/algorithm/BaseBufferManipulators.hpp"
+#include "lvr2/util/Factories.hpp"
+#include "lvr2/util/Logging.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace lvr2
+{
+
+template<typename BaseVecT>
+StatisticalOutlierFilter<BaseVecT>::StatisticalOutlierFilter(const Options& options)
+    : m_options(options)
+{
+    if (m_options.mode == Mode::Statistical && m_options.k < 1)
+    {
+        throw std::invalid_argument("StatisticalOutlierFilter: k must be positive");
+    }
+    if (m_options.mode == Mode::Radius && m_options.minNeighbors < 1)
+    {
+        throw std::invalid_argument("StatisticalOutlierFilter: minNeighbors must be positive");
+    }
+    if (m_options.haloCells < 0)
+    {
+        throw std::invalid_argument("StatisticalOutlierFilter: haloCells must not be negative");
+    }
+}
+
+template<typename BaseVecT>
+int StatisticalOutlierFilter<BaseVecT>::numNeighbors() const
+{
+    // The point itself is one of its neighbors
+    return (m_options.mode == Mode::Statistical ? m_options.k : m_options.minNeighbors) + 1;
+}
+
+template<typename BaseVecT>
+void StatisticalOutlierFilter<BaseVecT>::computeScores(PointBufferPtr points, size_t numScored, float* scores) const
+{
+    using CoordT = typename BaseVecT::CoordType;
+
+    SearchTreePtr<BaseVecT> tree = getSearchTree<BaseVecT>(m_options.searchTree, points);
+    const floatArr pts = points->getPointArray();
+    const int k = numNeighbors();
+
+    // One query per point. The CPU search trees have no batched search, and
+    // the default kSearchParallel() only loops over kSearch() serially.
+    #pragma omp parallel
+    {
+        std::vector<size_t> indices;
+        std::vector<CoordT> distances;
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (size_t i = 0; i < numScored; i++)
+        {
+            const BaseVecT p(pts[3 * i], pts[3 * i + 1], pts[3 * i + 2]);
+            int found = tree->kSearch(p, k, indices, distances);
+
+            // Distances are computed here, since the search trees do not
+            // agree on whether they return squared distances
+            float sum = 0.0f;
+            float last = 0.0f;
+            int used = 0;
+            for (int j = 0; j < found && used < k - 1; j++)
+            {
+                if (indices[j] == i)
+                {
+                    continue;
+                }
+                const float* q = &pts[3 * indices[j]];
+                last = (p - BaseVecT(q[0], q[1], q[2])).length();
+                sum += last;
+                used++;
+            }
+
+            if (m_options.mode == Mode::Statistical)
+            {
+                scores[i] = used > 0 ? sum / used : std::numeric_limits<float>::infinity();
+            }
+            else
+            {
+                scores[i] = used == k - 1 ? last : std::numeric_limits<float>::infinity();
+            }
+        }
+    }
+}
+
+template<typename BaseVecT>
+float StatisticalOutlierFilter<BaseVecT>::threshold(double sum, double sumSquares, size_t n) const
+{
+    if (m_options.mode == Mode::Radius)
+    {
+        return m_options.radius;
+    }
+    if (n == 0)
+    {
+        return -std::numeric_limits<float>::infinity();
+    }
+    double mean = sum / n;
+    double variance = n > 1 ? std::max(0.0, (sumSquares - sum * mean) / (n - 1)) : 0.0;
+    return mean + m_options.stdDevMult * std::sqrt(variance);
+}
+
+template<typename BaseVecT>
+std::vector<size_t> StatisticalOutlierFilter<BaseVecT>::inliers(PointBufferPtr points) const
+{
+    const size_t n = points->numPoints();
+    std::vector<float> scores(n);
+    computeScores(points, n, scores.data());
+
+    double sum = 0.0, sumSquares = 0.0;
+    size_t count = 0;
+    #pragma omp parallel for schedule(static) reduction(+:sum, sumSquares, count)
+    for (size_t i = 0; i < n; i++)
+    {
+        if (std::isfinite(scores[i]))
+        {
+            sum += scores[i];
+            sumSquares += static_cast<double>(scores[i]) * scores[i];
+            count++;
+        }
+    }
+    const float maxScore = threshold(sum, sumSquares, count);
+
+    std::vector<size_t> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (scores[i] <= maxScore)
+        {
+            result.push_back(i);
+        }
+    }
+
+    lvr2::logout::get() << lvr2::info << "[StatisticalOutlierFilter] Removed " << n - result.size()
+                        << " of " << n << " points" << lvr2::endl;
+    return result;
+}
+
+template<typename BaseVecT>
+PointBufferPtr StatisticalOutlierFilter<BaseVecT>::filter(PointBufferPtr points) const
+{
+    std::vector<size_t> indices = inliers(points);
+    if (indices.size() == points->numPoints())
+    {
+        return points;
+    }
+    return std::make_shared<PointBuffer>(points->manipulate(manipulators::Select(indices)));
+}
+
+template<typename BaseVecT>
+size_t StatisticalOutlierFilter<BaseVecT>::filter(const BigGrid<BaseVecT>& grid, const CellSink& sink, const std::string& tempDir) const
+{
+    const auto& cells = grid.getCells();
+
+    std::vector<Vector3i> cellIndices;
+    size_t numPoints = 0;
+    size_t numScores = 0;
+    for (const auto& [index, cell] : cells)
+    {
+        if (cell.size > 0)
+        {
+            cellIndices.push_back(index);
+            numPoints += cell.size;
+            numScores = std::max(numScores, cell.offset + cell.size);
+        }
+    }
+    std::sort(cellIndices.begin(), cellIndices.end(), [](const Vector3i& a, const Vector3i& b)
+    {
+        return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+    });
+
+    // Scores in the order of the points in the grid files
+    boost::iostreams::mapped_file scoreFile;
+    boost::iostreams::mapped_file_params params;
+    params.path = (boost::filesystem::path(tempDir) / "outlier_scores.mmf").string();
+    params.mode = std::ios_base::in | std::ios_base::out | std::ios_base::trunc;
+    params.new_file_size = sizeof(float) * std::max<size_t>(1, numScores);
+    scoreFile.open(params);
+    float* scores = reinterpret_cast<float*>(scoreFile.data());
+
+    const int halo = m_options.haloCells;
+    double sum = 0.0, sumSquares = 0.0;
+    size_t count = 0;
+
+    lvr2::Monitor scoreProgress(lvr2::LogLevel::info, "[StatisticalOutlierFilter] Computing scores", cellIndices.size());
+
+    #pragma omp parallel for schedule(dynamic, 1) reduction(+:sum, sumSquares, count)
+    for (size_t c = 0; c < cellIndices.size(); c++)
+    {
+        const Vector3i& index = cellIndices[c];
+        const CellInfo& cell = cells.at(index);
+
+        // The points of the cell come first, followed by the halo
+        std::vector<float> local;
+        auto append = [&](const Vector3i& i)
+        {
+            size_t n = 0;
+            floatArr points = grid.points(i, n);
+            if (n > 0)
+            {
+                local.insert(local.end(), points.get(), points.get() + 3 * n);
+            }
+        };
+        append(index);
+        for (int dx = -halo; dx <= halo; dx++)
+        {
+            for (int dy = -halo; dy <= halo; dy++)
+            {
+                for (int dz = -halo; dz <= halo; dz++)
+                {
+                    if (dx != 0 || dy != 0 || dz != 0)
+                    {
+                        append(index + Vector3i(dx, dy, dz));
+                    }
+                }
+            }
+        }
+
+        const size_t n = local.size() / 3;
+        floatArr localPoints(new float[local.size()]);
+        std::copy(local.begin(), local.end(), localPoints.get());
+        PointBufferPtr buffer(new PointBuffer(localPoints, n));
+
+        float* cellScores = scores + cell.offset;
+        computeScores(buffer, cell.size, cellScores);
+
+        for (size_t i = 0; i < cell.size; i++)
+        {
+            if (std::isfinite(cellScores[i]))
+            {
+                sum += cellScores[i];
+                sumSquares += static_cast<double>(cellScores[i]) * cellScores[i];
+                count++;
+            }
+        }
+
+        ++scoreProgress;
+    }
+    scoreProgress.terminate();
+
+    const float maxScore = threshold(sum, sumSquares, count);
+    size_t numInliers = 0;
+
+    lvr2::Monitor filterProgress(lvr2::LogLevel::info, "[StatisticalOutlierFilter] Filtering cells", cellIndices.size());
+
+    #pragma omp parallel for schedule(dynamic, 1) reduction(+:numInliers)
+    for (size_t c = 0; c < cellIndices.size(); c++)
+    {
+        const Vector3i& index = cellIndices[c];
+        const CellInfo& cell = cells.at(index);
+        const float* cellScores = scores + cell.offset;
+
+        std::vector<size_t> keep;
+        for (size_t i = 0; i < cell.size; i++)
+        {
+            if (cellScores[i] <= maxScore)
+            {
+                keep.push_back(i);
+            }
+        }
+
+        if (!keep.empty())
+        {
+            size_t n = 0;
+            floatArr points = grid.points(index, n);
+            PointBufferPtr buffer(new PointBuffer(points, n));
+
+            size_t numNormals = 0;
+            floatArr normals = grid.normals(index, numNormals);
+            if (normals)
+            {
+                buffer->setNormalArray(normals, numNormals);
+            }
+            size_t numColors = 0;
+            ucharArr colors = grid.colors(index, numColors);
+            if (colors)
+            {
+                buffer->setColorArray(colors, numColors);
+            }
+            if (keep.size() < cell.size)
+            {
+                buffer = std::make_shared<PointBuffer>(buffer->manipulate(manipulators::Select(keep)));
+            }
+
+            #pragma omp critical
+            {
+                sink(index, buffer);
+            }
+            numInliers += keep.size();
+        }
+
+        ++filterProgress;
+    }
+    filterProgress.terminate();
+
+    scoreFile.close();
+    boost::filesystem::remove(params.path);
+
+    lvr2::logout::get() << lvr2::info << "[StatisticalOutlierFilter] Removed " << numPoints - numInliers
+                        << " of " << numPoints << " points" << lvr2::endl;
+
+    return numInliers;
+}
+
+} // namespace lvr2
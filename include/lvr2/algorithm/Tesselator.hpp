@@ -36,24 +36,19 @@
 #include "lvr2/util/ClusterBiMap.hpp"
 #include "lvr2/algorithm/NormalAlgorithms.hpp"
 
-#if _MSC_VER
-#include <Windows.h>
-#endif
-
-#ifndef __APPLE__
-#include <GL/glu.h>
-#include <GL/glut.h>
-#define CALLBACK
-#else
-#include <OpenGL/glu.h>
-#include <GLUT/glut.h>
-#endif
+#include <vector>
 
 namespace lvr2
 {
 
 /**
-* Tesslation algorithm, utilizing the OpenGL tesselator to ease the reconstructed mesh.
+* Tesslation algorithm, retriangulating each planar cluster to ease the reconstructed mesh.
+* The contours of a cluster are projected onto its plane and triangulated as a polygon with
+* holes by ear clipping. The triangulation only depends on the cluster, so clusters are
+* tesselated in parallel, and apply() may be called from several threads for different meshes.
+* Unlike the former GLU tesselator, no vertices are inserted at contour intersections. Only
+* local self intersections are cut off, so clusters with self intersecting contours may be
+* covered differently than before.
 * This algorithm is destryoing the mesh correlation between clusters, faces and vertices thus
 * it is currently not suitable to run any algorithms requiring an coherent mesh.
 */
@@ -72,62 +67,37 @@ public:
         float lineFusionThreshold
     );
 
-private:
-
-    /**
-    * The OpenGL tesselation object
-    */
-    static GLUtesselator* m_tesselator;
-
-    /**
-    * The OpenGL type. This defines how the vertices are tesselated.
-    */
-    static GLenum m_type;
-
-    /**
-    * List of vertices to keep track of until the end of the tesselation.
-    */
-    static std::vector<BaseVecT> m_vertices;
-
-    /**
-    * List of faces to keep track of until the end of the tesselation.
-    */
-    static std::vector<BaseVecT> m_faces;
-
     /**
-    * OpenGL callback, which is invoked by glBegin() to indicate the start of an primitiv.
-    */
-    static void CALLBACK beginCallback(GLenum type);
-
-    /**
-    * OpenGL callback, which is called for every vertex, adding it to our internal list.
-    */
-    static void CALLBACK vertexCallback(void* data);
+     * Triangulates a planar polygon with holes. Contours with the orientation of the largest
+     * contour are outer boundaries, all others are holes of the smallest outer boundary that
+     * contains them.
+     *
+     * @param contours  The closed contours of the polygon
+     * @param normal    The normal of the polygon's plane
+     * @return The corners of the triangles, three per triangle, counter-clockwise around normal
+     */
+    static std::vector<BaseVecT> tesselate(
+        const std::vector<std::vector<BaseVecT>>& contours,
+        const Normal<typename BaseVecT::CoordType>& normal
+    );
 
-    /**
-    * OpenGL callback, which is called when the tesselator wants to create an new vertex on an intersection.
-    * This simply takes the coords and adds it as an new vertex to our interal list.
-    */
-    static void CALLBACK combineDataCallback(GLdouble coords[3],
-                                             void *vertex_data[4],
-                                             GLfloat weight[4],
-                                             void **outData,
-                                             void *userData);
+private:
 
     /**
-    * OpenGL callback, which is invoked by glEnd() to indicate the end of an primitiv.
-    */
-    static void CALLBACK endCallback(void);
-    /**
-    * OpenGL callback, which is called on any error occurring while running the tesslation.
+    * Ear clipping triangulation of a polygon with holes in the plane, see Tesselator.tcc
     */
-    static void CALLBACK errorCallback(GLenum errno);
+    class Triangulator;
 
     /**
-    * Initalizes the tesselator object, deleting the old one if one is found and registering all
-    * necessary callbacks.
+    * Computes the triangles of a single cluster. Only reads the mesh.
     */
-    static void init();
+    static std::vector<BaseVecT> tesselateCluster(
+        BaseMesh<BaseVecT>& mesh,
+        const ClusterBiMap<FaceHandle>& clusters,
+        const DenseFaceMap<Normal<typename BaseVecT::CoordType>>& faceNormals,
+        ClusterHandle clusterH,
+        float lineFusionThreshold
+    );
 
     /**
     * Adds the tesslated faces to the current cluster. Avoid any errors while adding
@@ -138,7 +108,8 @@ private:
         BaseMesh<BaseVecT>& mesh,
         ClusterBiMap<FaceHandle>& clusters,
         DenseFaceMap<Normal<typename BaseVecT::CoordType>>& faceNormal,
-        ClusterHandle clusterH
+        ClusterHandle clusterH,
+        const std::vector<BaseVecT>& faces
     );
 };
 
@@ -33,203 +33,824 @@
 #include "lvr2/util/ClusterBiMap.hpp"
 #include "lvr2/algorithm/ClusterAlgorithms.hpp"
 
-// disable deprecation warnings for the Tesselator since GLUT is horrifying outdated.
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <utility>
 
 namespace lvr2
 {
 
-template<typename BaseVecT>
-GLUtesselator* Tesselator<BaseVecT>::m_tesselator;
+// The Triangulator is a port of earcut.hpp (https://github.com/mapbox/earcut.hpp).
+// Copyright (c) 2016, Mapbox
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose
+// with or without fee is hereby granted, provided that the above copyright notice
+// and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD TO
+// THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+// CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA
+// OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+// ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// See EARCUT_LICENSE.txt for details.
 
+/**
+ * Ear clipping of a polygon with holes given by 2D points. The holes are merged into the outer
+ * boundary by bridges to its leftmost point, the resulting ring is stored as a doubly linked
+ * list of nodes. If no ear can be found, duplicate and collinear points are removed, local self
+ * intersections are cut off, and finally the polygon is split along a valid diagonal.
+ * Each instance only works on its own data, so any number of them may run concurrently.
+ */
 template<typename BaseVecT>
-std::vector<BaseVecT> Tesselator<BaseVecT>::m_vertices;
+class Tesselator<BaseVecT>::Triangulator
+{
+public:
+    /// Point range [first, last) of a contour
+    using Range = std::pair<size_t, size_t>;
 
-template<typename BaseVecT>
-std::vector<BaseVecT> Tesselator<BaseVecT>::m_faces;
+    Triangulator(const std::vector<double>& x, const std::vector<double>& y, std::vector<size_t>& triangles)
+        : m_x(x), m_y(y), m_triangles(triangles)
+    {
+    }
 
-template<typename BaseVecT>
-GLenum Tesselator<BaseVecT>::m_type;
+    /**
+     * Appends the triangles of the polygon as point indices to the output. The outer boundary
+     * is made counter-clockwise and the holes clockwise, so all triangles are counter-clockwise.
+     */
+    void run(Range outer, const std::vector<Range>& holes)
+    {
+        m_nodes.clear();
+        m_nodes.reserve(outer.second - outer.first + 3 * holes.size() + 8);
 
-template<typename BaseVecT>
-void Tesselator<BaseVecT>::beginCallback(GLenum type)
-{
-    m_type = type;
-    m_vertices.clear();
-}
+        size_t outerNode = linkedList(outer, true);
+        if (outerNode == NONE || next(outerNode) == prev(outerNode))
+        {
+            return;
+        }
 
-template<typename BaseVecT>
-void Tesselator<BaseVecT>::combineDataCallback(GLdouble coords[3],
-                                               void *vertex_data[4],
-                                               GLfloat weight[4],
-                                               void **outData,
-                                               void *userData)
-{
-    GLdouble* vertex = new GLdouble[3];
+        if (!holes.empty())
+        {
+            outerNode = eliminateHoles(holes, outerNode);
+        }
 
-    vertex[0] = coords[0];
-    vertex[1] = coords[1];
-    vertex[2] = coords[2];
+        earcutLinked(outerNode, 0);
+    }
 
-    BaseVecT v(vertex[0], vertex[1], vertex[2]);
-    m_vertices.push_back(v);
+private:
+    static constexpr size_t NONE = std::numeric_limits<size_t>::max();
 
-    *outData = vertex;
-}
+    struct Node
+    {
+        size_t  i;
+        double  x;
+        double  y;
+        size_t  prev;
+        size_t  next;
+        bool    steiner;
+    };
+
+    size_t& next(size_t n) { return m_nodes[n].next; }
+    size_t& prev(size_t n) { return m_nodes[n].prev; }
+
+    /// Twice the signed area of the triangle, negative if (p, q, r) is counter-clockwise
+    double area(size_t p, size_t q, size_t r) const
+    {
+        const Node& a = m_nodes[p];
+        const Node& b = m_nodes[q];
+        const Node& c = m_nodes[r];
+        return (b.y - a.y) * (c.x - b.x) - (b.x - a.x) * (c.y - b.y);
+    }
 
-template<typename BaseVecT>
-void Tesselator<BaseVecT>::endCallback(void)
-{
+    bool equals(size_t p, size_t q) const
+    {
+        return m_nodes[p].x == m_nodes[q].x && m_nodes[p].y == m_nodes[q].y;
+    }
 
-    if (m_vertices.size() < 3)
+    static bool pointInTriangle(double ax, double ay, double bx, double by,
+                                double cx, double cy, double px, double py)
     {
-        m_vertices.clear();
-        return;
+        return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+               (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+               (bx - px) * (cy - py) >= (cx - px) * (by - py);
     }
 
-    if (m_type == GL_TRIANGLES)
+    size_t insertNode(size_t i, size_t last)
     {
-        for (size_t i = 0; i < m_vertices.size() / 3; ++i)
+        size_t p = m_nodes.size();
+        m_nodes.push_back(Node{i, m_x[i], m_y[i], p, p, false});
+        if (last != NONE)
         {
-            m_faces.push_back(m_vertices[i * 3 + 2]);
-            m_faces.push_back(m_vertices[i * 3 + 1]);
-            m_faces.push_back(m_vertices[i * 3 + 0]);
+            next(p) = next(last);
+            prev(p) = last;
+            prev(next(last)) = p;
+            next(last) = p;
         }
+        return p;
     }
-    else if (m_type == GL_TRIANGLE_FAN)
+
+    void removeNode(size_t p)
+    {
+        prev(next(p)) = prev(p);
+        next(prev(p)) = next(p);
+    }
+
+    /// Creates a circular list of the range in the given orientation
+    size_t linkedList(Range range, bool counterClockwise)
     {
-        for(size_t i = 0; i < m_vertices.size() - 2; ++i)
+        double sum = 0;
+        for (size_t i = range.first, j = range.second - 1; i < range.second; j = i++)
         {
-            m_faces.push_back(m_vertices[i + 2]);
-            m_faces.push_back(m_vertices[i + 1]);
-            m_faces.push_back(m_vertices[0]);
+            sum += (m_x[j] - m_x[i]) * (m_y[i] + m_y[j]);
         }
+
+        size_t last = NONE;
+        if (counterClockwise == (sum > 0))
+        {
+            for (size_t i = range.first; i < range.second; i++)
+            {
+                last = insertNode(i, last);
+            }
+        }
+        else
+        {
+            for (size_t i = range.second; i-- > range.first; )
+            {
+                last = insertNode(i, last);
+            }
+        }
+
+        if (last != NONE && equals(last, next(last)))
+        {
+            size_t n = next(last);
+            removeNode(last);
+            last = n;
+        }
+        return last;
     }
-    else if (m_type == GL_TRIANGLE_STRIP)
+
+    /// Removes duplicate and collinear points
+    size_t filterPoints(size_t start, size_t end = NONE)
     {
-        for(size_t i = 0; i < m_vertices.size() - 2; ++i)
+        if (start == NONE)
+        {
+            return start;
+        }
+        if (end == NONE)
+        {
+            end = start;
+        }
+
+        size_t p = start;
+        bool again;
+        do
         {
-            if (i % 2 == 0)
+            again = false;
+            if (!m_nodes[p].steiner && (equals(p, next(p)) || area(prev(p), p, next(p)) == 0))
             {
-                m_faces.push_back(m_vertices[i + 2]);
-                m_faces.push_back(m_vertices[i + 1]);
-                m_faces.push_back(m_vertices[i]);
-            } else
+                removeNode(p);
+                p = end = prev(p);
+                if (p == next(p))
+                {
+                    break;
+                }
+                again = true;
+            }
+            else
             {
-                m_faces.push_back(m_vertices[i]);
-                m_faces.push_back(m_vertices[i + 1]);
-                m_faces.push_back(m_vertices[i + 2]);
+                p = next(p);
+            }
+        } while (again || p != end);
+
+        return end;
+    }
+
+    void addTriangle(size_t a, size_t b, size_t c)
+    {
+        m_triangles.push_back(m_nodes[a].i);
+        m_triangles.push_back(m_nodes[b].i);
+        m_triangles.push_back(m_nodes[c].i);
+    }
+
+    void earcutLinked(size_t ear, int pass)
+    {
+        if (ear == NONE)
+        {
+            return;
+        }
+
+        size_t stop = ear;
+        while (prev(ear) != next(ear))
+        {
+            size_t p = prev(ear);
+            size_t n = next(ear);
+
+            if (isEar(ear))
+            {
+                addTriangle(p, ear, n);
+                removeNode(ear);
+
+                // skipping the next vertex leads to less sliver triangles
+                ear = next(n);
+                stop = next(n);
+                continue;
+            }
+
+            ear = n;
+
+            if (ear == stop)
+            {
+                if (pass == 0)
+                {
+                    earcutLinked(filterPoints(ear), 1);
+                }
+                else if (pass == 1)
+                {
+                    ear = cureLocalIntersections(filterPoints(ear));
+                    earcutLinked(ear, 2);
+                }
+                else
+                {
+                    splitEarcut(ear);
+                }
+                break;
             }
         }
     }
-}
 
-template<typename BaseVecT>
-void Tesselator<BaseVecT>::errorCallback(GLenum errno)
-{
-    std::cerr << "[Tesselator-Error:] "
-              << __FILE__ << " (" << __LINE__ << "): "
-              << gluErrorString(errno) << std::endl;
-}
+    bool isEar(size_t ear)
+    {
+        size_t a = prev(ear);
+        size_t b = ear;
+        size_t c = next(ear);
 
-template<typename BaseVecT>
-void Tesselator<BaseVecT>::vertexCallback(void* data)
-{
-    const GLdouble *ptr = (const GLdouble*)data;
+        // reflex, can't be an ear
+        if (area(a, b, c) >= 0)
+        {
+            return false;
+        }
 
-    BaseVecT vertex(*ptr, *(ptr+1), *(ptr+2));
-    m_vertices.push_back(vertex);
-}
+        const Node& na = m_nodes[a];
+        const Node& nb = m_nodes[b];
+        const Node& nc = m_nodes[c];
+        double minX = std::min({na.x, nb.x, nc.x});
+        double minY = std::min({na.y, nb.y, nc.y});
+        double maxX = std::max({na.x, nb.x, nc.x});
+        double maxY = std::max({na.y, nb.y, nc.y});
 
-template<typename BaseVecT>
-void Tesselator<BaseVecT>::init() {
-    // init tesselator
-    if (m_tesselator)
+        // make sure there are no other points inside the potential ear
+        for (size_t p = next(c); p != a; p = next(p))
+        {
+            const Node& np = m_nodes[p];
+            if (np.x >= minX && np.x <= maxX && np.y >= minY && np.y <= maxY &&
+                pointInTriangle(na.x, na.y, nb.x, nb.y, nc.x, nc.y, np.x, np.y) &&
+                area(prev(p), p, next(p)) >= 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Cuts off triangles of two crossing edges a-p and p.next-b
+    size_t cureLocalIntersections(size_t start)
     {
-        gluDeleteTess(m_tesselator);
+        size_t p = start;
+        do
+        {
+            size_t a = prev(p);
+            size_t b = next(next(p));
+
+            if (!equals(a, b) && intersects(a, p, next(p), b) && locallyInside(a, b) && locallyInside(b, a))
+            {
+                addTriangle(a, p, b);
+
+                removeNode(next(p));
+                removeNode(p);
+
+                p = start = b;
+            }
+            p = next(p);
+        } while (p != start);
+
+        return filterPoints(p);
     }
 
-    m_tesselator = gluNewTess();
+    /// Splits the polygon along a valid diagonal and triangulates both parts
+    void splitEarcut(size_t start)
+    {
+        size_t a = start;
+        do
+        {
+            size_t b = next(next(a));
+            while (b != prev(a))
+            {
+                if (m_nodes[a].i != m_nodes[b].i && isValidDiagonal(a, b))
+                {
+                    size_t c = splitPolygon(a, b);
+
+                    a = filterPoints(a, next(a));
+                    c = filterPoints(c, next(c));
+
+                    earcutLinked(a, 0);
+                    earcutLinked(c, 0);
+                    return;
+                }
+                b = next(b);
+            }
+            a = next(a);
+        } while (a != start);
+    }
 
-    gluTessCallback(m_tesselator, GLU_TESS_BEGIN, (GLvoid (CALLBACK*) ()) &beginCallback);
-    gluTessCallback(m_tesselator, GLU_TESS_VERTEX, (GLvoid (CALLBACK*) ()) &vertexCallback);
-    gluTessCallback(m_tesselator, GLU_TESS_COMBINE_DATA, (GLvoid (CALLBACK*) ()) &combineDataCallback);
-    gluTessCallback(m_tesselator, GLU_TESS_END, (GLvoid (CALLBACK*) ()) &endCallback);
-    gluTessCallback(m_tesselator, GLU_TESS_ERROR, (GLvoid (CALLBACK*) ()) &errorCallback);
+    size_t eliminateHoles(const std::vector<Range>& holes, size_t outerNode)
+    {
+        std::vector<size_t> queue;
+        for (const Range& hole : holes)
+        {
+            size_t list = linkedList(hole, false);
+            if (list == NONE)
+            {
+                continue;
+            }
+            if (list == next(list))
+            {
+                m_nodes[list].steiner = true;
+            }
+            queue.push_back(getLeftmost(list));
+        }
 
-    gluTessProperty(m_tesselator, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_NONZERO);
-}
+        std::sort(queue.begin(), queue.end(), [this](size_t a, size_t b)
+        {
+            return m_nodes[a].x < m_nodes[b].x;
+        });
+
+        // process holes from left to right
+        for (size_t hole : queue)
+        {
+            outerNode = eliminateHole(hole, outerNode);
+        }
+        return outerNode;
+    }
+
+    size_t eliminateHole(size_t hole, size_t outerNode)
+    {
+        size_t bridge = findHoleBridge(hole, outerNode);
+        if (bridge == NONE)
+        {
+            return outerNode;
+        }
+
+        size_t bridgeReverse = splitPolygon(bridge, hole);
+
+        // filter collinear points around the cuts
+        filterPoints(bridgeReverse, next(bridgeReverse));
+        return filterPoints(bridge, next(bridge));
+    }
+
+    /// Finds a point of the outer boundary that is visible from the leftmost point of the hole
+    size_t findHoleBridge(size_t hole, size_t outerNode)
+    {
+        size_t p = outerNode;
+        double hx = m_nodes[hole].x;
+        double hy = m_nodes[hole].y;
+        double qx = -std::numeric_limits<double>::infinity();
+        size_t m = NONE;
+
+        // find a segment intersected by a ray from the hole's leftmost point to the left;
+        // the segment's endpoint with lesser x will be the potential connection point
+        do
+        {
+            const Node& np = m_nodes[p];
+            const Node& nn = m_nodes[next(p)];
+            if (hy <= np.y && hy >= nn.y && nn.y != np.y)
+            {
+                double x = np.x + (hy - np.y) * (nn.x - np.x) / (nn.y - np.y);
+                if (x <= hx && x > qx)
+                {
+                    qx = x;
+                    m = np.x < nn.x ? p : next(p);
+                    if (x == hx)
+                    {
+                        // hole touches outer segment, pick its leftmost endpoint
+                        return m;
+                    }
+                }
+            }
+            p = next(p);
+        } while (p != outerNode);
+
+        if (m == NONE)
+        {
+            return NONE;
+        }
+
+        // look for points inside the triangle of hole point, segment intersection and endpoint.
+        // If there are none, m is a valid connection. Otherwise choose the point with the
+        // minimum angle to the ray as connection point
+        size_t stop = m;
+        double mx = m_nodes[m].x;
+        double my = m_nodes[m].y;
+        double tanMin = std::numeric_limits<double>::infinity();
+
+        p = m;
+        do
+        {
+            const Node& np = m_nodes[p];
+            if (hx >= np.x && np.x >= mx && hx != np.x &&
+                pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, np.x, np.y))
+            {
+                double tan = std::abs(hy - np.y) / (hx - np.x);
+
+                if (locallyInside(p, hole) &&
+                    (tan < tanMin || (tan == tanMin && (np.x > m_nodes[m].x ||
+                        (np.x == m_nodes[m].x && sectorContainsSector(m, p))))))
+                {
+                    m = p;
+                    tanMin = tan;
+                }
+            }
+            p = next(p);
+        } while (p != stop);
+
+        return m;
+    }
+
+    /// Whether the sector in vertex m contains the sector in vertex p in the same coordinates
+    bool sectorContainsSector(size_t m, size_t p)
+    {
+        return area(prev(m), m, prev(p)) < 0 && area(next(p), m, next(m)) < 0;
+    }
+
+    size_t getLeftmost(size_t start)
+    {
+        size_t p = start;
+        size_t leftmost = start;
+        do
+        {
+            const Node& np = m_nodes[p];
+            const Node& nl = m_nodes[leftmost];
+            if (np.x < nl.x || (np.x == nl.x && np.y < nl.y))
+            {
+                leftmost = p;
+            }
+            p = next(p);
+        } while (p != start);
+        return leftmost;
+    }
+
+    /// Checks if a diagonal between two polygon nodes is valid (lies in polygon interior)
+    bool isValidDiagonal(size_t a, size_t b)
+    {
+        return m_nodes[next(a)].i != m_nodes[b].i && m_nodes[prev(a)].i != m_nodes[b].i &&
+               !intersectsPolygon(a, b) &&
+               // locally visible and does not create opposite-facing sectors
+               ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+                 (area(prev(a), a, prev(b)) != 0 || area(a, prev(b), b) != 0)) ||
+                // special zero-length case
+                (equals(a, b) && area(prev(a), a, next(a)) > 0 && area(prev(b), b, next(b)) > 0));
+    }
+
+    static int sign(double value)
+    {
+        return value > 0 ? 1 : value < 0 ? -1 : 0;
+    }
+
+    /// For collinear points p, q, r, checks if q lies on segment pr
+    bool onSegment(size_t p, size_t q, size_t r) const
+    {
+        const Node& np = m_nodes[p];
+        const Node& nq = m_nodes[q];
+        const Node& nr = m_nodes[r];
+        return nq.x <= std::max(np.x, nr.x) && nq.x >= std::min(np.x, nr.x) &&
+               nq.y <= std::max(np.y, nr.y) && nq.y >= std::min(np.y, nr.y);
+    }
+
+    /// Checks if the segments p1-q1 and p2-q2 intersect
+    bool intersects(size_t p1, size_t q1, size_t p2, size_t q2) const
+    {
+        int o1 = sign(area(p1, q1, p2));
+        int o2 = sign(area(p1, q1, q2));
+        int o3 = sign(area(p2, q2, p1));
+        int o4 = sign(area(p2, q2, q1));
+
+        return (o1 != o2 && o3 != o4) ||
+               (o1 == 0 && onSegment(p1, p2, q1)) ||
+               (o2 == 0 && onSegment(p1, q2, q1)) ||
+               (o3 == 0 && onSegment(p2, p1, q2)) ||
+               (o4 == 0 && onSegment(p2, q1, q2));
+    }
+
+    /// Checks if the diagonal a-b intersects any edge of the polygon
+    bool intersectsPolygon(size_t a, size_t b)
+    {
+        size_t p = a;
+        do
+        {
+            size_t n = next(p);
+            if (m_nodes[p].i != m_nodes[a].i && m_nodes[n].i != m_nodes[a].i &&
+                m_nodes[p].i != m_nodes[b].i && m_nodes[n].i != m_nodes[b].i &&
+                intersects(p, n, a, b))
+            {
+                return true;
+            }
+            p = n;
+        } while (p != a);
+        return false;
+    }
+
+    /// Checks if the diagonal a-b is locally inside the polygon
+    bool locallyInside(size_t a, size_t b)
+    {
+        return area(prev(a), a, next(a)) < 0 ?
+            area(a, b, next(a)) >= 0 && area(a, prev(a), b) >= 0 :
+            area(a, b, prev(a)) < 0 || area(a, next(a), b) < 0;
+    }
+
+    /// Checks if the middle point of the diagonal a-b is inside the polygon
+    bool middleInside(size_t a, size_t b)
+    {
+        size_t p = a;
+        bool inside = false;
+        double px = (m_nodes[a].x + m_nodes[b].x) / 2;
+        double py = (m_nodes[a].y + m_nodes[b].y) / 2;
+        do
+        {
+            const Node& np = m_nodes[p];
+            const Node& nn = m_nodes[next(p)];
+            if (((np.y > py) != (nn.y > py)) && nn.y != np.y &&
+                (px < (nn.x - np.x) * (py - np.y) / (nn.y - np.y) + np.x))
+            {
+                inside = !inside;
+            }
+            p = next(p);
+        } while (p != a);
+        return inside;
+    }
+
+    /// Links a and b with a bridge. Returns the copy of b in the second polygon
+    size_t splitPolygon(size_t a, size_t b)
+    {
+        size_t a2 = m_nodes.size();
+        m_nodes.push_back(Node{m_nodes[a].i, m_nodes[a].x, m_nodes[a].y, NONE, NONE, false});
+        size_t b2 = m_nodes.size();
+        m_nodes.push_back(Node{m_nodes[b].i, m_nodes[b].x, m_nodes[b].y, NONE, NONE, false});
+
+        size_t an = next(a);
+        size_t bp = prev(b);
+
+        next(a) = b;
+        prev(b) = a;
+
+        next(a2) = an;
+        prev(an) = a2;
+
+        next(b2) = a2;
+        prev(a2) = b2;
+
+        next(bp) = b2;
+        prev(b2) = bp;
+
+        return b2;
+    }
+
+    const std::vector<double>&  m_x;
+    const std::vector<double>&  m_y;
+    std::vector<size_t>&        m_triangles;
+    std::vector<Node>           m_nodes;
+};
 
 template<typename BaseVecT>
-void Tesselator<BaseVecT>::apply(
-    BaseMesh<BaseVecT>& mesh,
-    ClusterBiMap<FaceHandle>& clusters,
-    DenseFaceMap<Normal<typename BaseVecT::CoordType>>& faceNormals,
-    float lineFusionThreshold
+std::vector<BaseVecT> Tesselator<BaseVecT>::tesselate(
+    const std::vector<std::vector<BaseVecT>>& contours,
+    const Normal<typename BaseVecT::CoordType>& normal
 )
 {
-    // Status message for mesh generation
-    string comment = timestamp.getElapsedTime() + "Tesselating clusters ";
-    ProgressBar progress(clusters.numCluster(), comment);
+    using Range = typename Triangulator::Range;
 
-    init();
+    // orthonormal basis of the plane with u x v = normal, so counter-clockwise
+    // in (u, v) is counter-clockwise around the normal
+    BaseVecT n(normal.x, normal.y, normal.z);
+    BaseVecT axis(0, 0, 1);
+    if (std::abs(n.x) <= std::abs(n.y) && std::abs(n.x) <= std::abs(n.z))
+    {
+        axis = BaseVecT(1, 0, 0);
+    }
+    else if (std::abs(n.y) <= std::abs(n.z))
+    {
+        axis = BaseVecT(0, 1, 0);
+    }
+    BaseVecT u = n.cross(axis);
+    u.normalize();
+    BaseVecT v = n.cross(u);
+
+    // project all contours into the plane
+    std::vector<BaseVecT> points;
+    std::vector<double> x, y;
+    std::vector<Range> ranges;
+    std::vector<double> areas;
+    for (const auto& contour : contours)
+    {
+        if (contour.size() < 3)
+        {
+            continue;
+        }
 
-    for (auto clusterH: clusters)
+        size_t first = points.size();
+        for (const auto& p : contour)
+        {
+            points.push_back(p);
+            x.push_back(p.dot(u));
+            y.push_back(p.dot(v));
+        }
+        ranges.push_back(Range(first, points.size()));
+
+        double area = 0;
+        for (size_t i = first, j = points.size() - 1; i < points.size(); j = i++)
+        {
+            area += x[j] * y[i] - x[i] * y[j];
+        }
+        areas.push_back(area / 2);
+    }
+
+    std::vector<BaseVecT> faces;
+    if (ranges.empty())
     {
-        m_vertices.clear();
-        m_faces.clear();
+        return faces;
+    }
 
-        auto contours = findContours(mesh, clusters, clusterH);
-        // collect garbage GL vertices manually
-        vector<GLdouble*> garbage;
+    // The orientation of the largest contour is the one of outer boundaries. With
+    // the non-zero winding rule, contours of opposite orientation are holes
+    size_t largest = 0;
+    for (size_t i = 1; i < areas.size(); i++)
+    {
+        if (std::abs(areas[i]) > std::abs(areas[largest]))
+        {
+            largest = i;
+        }
+    }
+    bool outerPositive = areas[largest] > 0;
+
+    std::vector<size_t> outers;
+    std::vector<size_t> holes;
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        if (areas[i] == 0)
+        {
+            continue;
+        }
+        ((areas[i] > 0) == outerPositive ? outers : holes).push_back(i);
+    }
 
-        gluTessBeginPolygon(m_tesselator, 0);
+    // assign each hole to the smallest outer boundary containing it
+    std::vector<std::vector<Range>> holesOf(outers.size());
+    for (size_t hole : holes)
+    {
+        double hx = x[ranges[hole].first];
+        double hy = y[ranges[hole].first];
 
-        for (auto contour: contours)
+        size_t best = outers.size();
+        for (size_t k = 0; k < outers.size(); k++)
         {
-            if (contour.size() < 3)
+            const Range& r = ranges[outers[k]];
+
+            bool inside = false;
+            for (size_t i = r.first, j = r.second - 1; i < r.second; j = i++)
             {
-                continue;
+                if ((y[i] > hy) != (y[j] > hy) &&
+                    hx < (x[j] - x[i]) * (hy - y[i]) / (y[j] - y[i]) + x[i])
+                {
+                    inside = !inside;
+                }
             }
 
-            // subtract lineFusionThreshold of lvr1 by one to avoid conflicts with new implementation
-            auto simpleContour = simplifyContour(mesh, contour, 1 - lineFusionThreshold);
+            if (inside && (best == outers.size() || std::abs(areas[outers[k]]) < std::abs(areas[outers[best]])))
+            {
+                best = k;
+            }
+        }
 
-            gluTessBeginContour(m_tesselator);
+        if (best < outers.size())
+        {
+            holesOf[best].push_back(ranges[hole]);
+        }
+    }
 
-            for(auto vH: simpleContour)
-            {
-                auto& v = mesh.getVertexPosition(vH);
+    std::vector<size_t> triangles;
+    Triangulator triangulator(x, y, triangles);
+    for (size_t k = 0; k < outers.size(); k++)
+    {
+        triangulator.run(ranges[outers[k]], holesOf[k]);
+    }
 
-                GLdouble* tVertex = new GLdouble[3];
-                tVertex[0] = v.x;
-                tVertex[1] = v.y;
-                tVertex[2] = v.z;
+    // points that are collinear in the mesh are not exactly collinear after the projection,
+    // skip the resulting slivers as they have no area and no meaningful normal
+    double minX = *std::min_element(x.begin(), x.end());
+    double maxX = *std::max_element(x.begin(), x.end());
+    double minY = *std::min_element(y.begin(), y.end());
+    double maxY = *std::max_element(y.begin(), y.end());
+    double minArea = 1e-8 * ((maxX - minX) * (maxX - minX) + (maxY - minY) * (maxY - minY));
 
-                gluTessVertex(m_tesselator, tVertex, tVertex);
-                garbage.push_back(tVertex);
-            }
+    faces.reserve(triangles.size());
+    for (size_t t = 0; t + 2 < triangles.size(); t += 3)
+    {
+        size_t a = triangles[t];
+        size_t b = triangles[t + 1];
+        size_t c = triangles[t + 2];
+        double area = (x[b] - x[a]) * (y[c] - y[a]) - (x[c] - x[a]) * (y[b] - y[a]);
+        if (std::abs(area) <= minArea)
+        {
+            continue;
+        }
+        faces.push_back(points[a]);
+        faces.push_back(points[b]);
+        faces.push_back(points[c]);
+    }
+    return faces;
+}
 
-            gluTessEndContour(m_tesselator);
+template<typename BaseVecT>
+std::vector<BaseVecT> Tesselator<BaseVecT>::tesselateCluster(
+    BaseMesh<BaseVecT>& mesh,
+    const ClusterBiMap<FaceHandle>& clusters,
+    const DenseFaceMap<Normal<typename BaseVecT::CoordType>>& faceNormals,
+    ClusterHandle clusterH,
+    float lineFusionThreshold
+)
+{
+    std::vector<std::vector<BaseVecT>> polygon;
+    for (auto contour: findContours(mesh, clusters, clusterH))
+    {
+        if (contour.size() < 3)
+        {
+            continue;
         }
 
-        gluTessEndPolygon(m_tesselator);
+        // subtract lineFusionThreshold of lvr1 by one to avoid conflicts with new implementation
+        auto simpleContour = simplifyContour(mesh, contour, 1 - lineFusionThreshold);
 
-        for (size_t i = 0; i < garbage.size(); i++)
+        std::vector<BaseVecT> points;
+        points.reserve(simpleContour.size());
+        for (auto vH: simpleContour)
         {
-            delete[] garbage[i];
+            points.push_back(mesh.getVertexPosition(vH));
         }
+        polygon.push_back(std::move(points));
+    }
+
+    // the plane of the cluster is given by the average normal of its faces
+    BaseVecT normalSum;
+    for (auto fH: clusters[clusterH].handles)
+    {
+        normalSum += faceNormals[fH];
+    }
+
+    auto normal = Normal<typename BaseVecT::CoordType>(0, 0, 1);
+    if (normalSum.length() > 0)
+    {
+        normal = Normal<typename BaseVecT::CoordType>(normalSum);
+    }
+
+    return tesselate(polygon, normal);
+}
+
+template<typename BaseVecT>
+void Tesselator<BaseVecT>::apply(
+    BaseMesh<BaseVecT>& mesh,
+    ClusterBiMap<FaceHandle>& clusters,
+    DenseFaceMap<Normal<typename BaseVecT::CoordType>>& faceNormals,
+    float lineFusionThreshold
+)
+{
+    // Status message for mesh generation
+    string comment = timestamp.getElapsedTime() + "Tesselating clusters ";
+    ProgressBar progress(clusters.numCluster(), comment);
 
-        addTesselatedFaces(mesh, clusters, faceNormals, clusterH);
+    std::vector<ClusterHandle> clusterHandles;
+    clusterHandles.reserve(clusters.numCluster());
+    for (auto clusterH: clusters)
+    {
+        clusterHandles.push_back(clusterH);
+    }
 
+    // The triangulation of a cluster only reads the mesh, so all clusters are
+    // tesselated in parallel before any of them is replaced
+    std::vector<std::vector<BaseVecT>> faces(clusterHandles.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < clusterHandles.size(); i++)
+    {
+        faces[i] = tesselateCluster(mesh, clusters, faceNormals, clusterHandles[i], lineFusionThreshold);
         ++progress;
     }
 
-    gluDeleteTess(m_tesselator);
-    m_tesselator = 0;
+    for (size_t i = 0; i < clusterHandles.size(); i++)
+    {
+        addTesselatedFaces(mesh, clusters, faceNormals, clusterHandles[i], faces[i]);
+        std::vector<BaseVecT>().swap(faces[i]);
+    }
 
     if(!timestamp.isQuiet())
     {
@@ -242,7 +863,8 @@ void Tesselator<BaseVecT>::addTesselatedFaces(
     BaseMesh<BaseVecT>& mesh,
     ClusterBiMap<FaceHandle>& clusters,
     DenseFaceMap<Normal<typename BaseVecT::CoordType>>& faceNormals,
-    ClusterHandle clusterH
+    ClusterHandle clusterH,
+    const std::vector<BaseVecT>& faces
 )
 {
     // delete all faces of cluster in mesh
@@ -261,16 +883,12 @@ void Tesselator<BaseVecT>::addTesselatedFaces(
     auto oldNormal = Normal<typename BaseVecT::CoordType>(0, 0, 1);
 
     // then re-add all faces and vertices generated by the tesselator
-    for (size_t i = 0; i < m_faces.size() / 3; ++i)
+    for (size_t i = 0; i < faces.size() / 3; ++i)
     {
-        auto v1 = m_faces[i * 3 + 2];
-        auto v2 = m_faces[i * 3 + 1];
-        auto v3 = m_faces[i * 3 + 0];
-
         // TODO make sure we reuse the added vertices here instead of duplicating everything
-        auto v1H = mesh.addVertex(v1);
-        auto v2H = mesh.addVertex(v2);
-        auto v3H = mesh.addVertex(v3);
+        auto v1H = mesh.addVertex(faces[i * 3 + 0]);
+        auto v2H = mesh.addVertex(faces[i * 3 + 1]);
+        auto v3H = mesh.addVertex(faces[i * 3 + 2]);
 
         if (!mesh.isFaceInsertionValid(v1H, v2H, v3H))
         {
@@ -291,5 +909,3 @@ void Tesselator<BaseVecT>::addTesselatedFaces(
 }
 
 } // namespace lvr2
-
-#pragma GCC diagnostic pop
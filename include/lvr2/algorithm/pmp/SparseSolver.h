@@ -0,0 +1,104 @@
+// Copyright 2011-2020 the Polygon Mesh Processing Library developers.
+// Distributed under a MIT-style license, see PMP_LICENSE.txt for details.
+
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+namespace pmp {
+
+//! \brief Reusable solver for the sparse symmetric systems of the PMP algorithms.
+//! \details The symbolic analysis of the system matrix is cached and only
+//! recomputed when the sparsity pattern changes, i.e. when the connectivity of
+//! the mesh changes between calls. All columns of the right hand side are
+//! solved with the same factorization. The iterative methods use a row-major
+//! copy of the matrix so that Eigen can evaluate the matrix-vector products of
+//! the conjugate gradient iterations in parallel with OpenMP. They require a
+//! symmetric definite system matrix.
+//! \ingroup algorithms
+class SparseSolver
+{
+public:
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+
+    //! The available solution methods
+    enum class Method
+    {
+        //! Sparse Cholesky (LDL^T) factorization, exact but single-threaded
+        LDLT,
+        //! Conjugate gradients with a Jacobi (diagonal) preconditioner
+        CG_Jacobi,
+        //! Conjugate gradients with an incomplete Cholesky preconditioner
+        CG_IncompleteCholesky
+    };
+
+    //! Construct a solver using \p method.
+    SparseSolver(Method method = Method::LDLT);
+
+    //! Select the solution method. Drops all cached factorizations.
+    void set_method(Method method);
+
+    //! The currently selected solution method
+    Method method() const { return method_; }
+
+    //! Relative residual tolerance of the iterative methods (default: 1e-10)
+    void set_tolerance(double tolerance) { tolerance_ = tolerance; }
+
+    //! Maximum number of iterations of the iterative methods (default: 2 * n)
+    void set_max_iterations(int iterations) { max_iterations_ = iterations; }
+
+    //! \brief Solve A * X = B for all columns of \p B.
+    //! \details If \p A has the same sparsity pattern as the matrix of the
+    //! previous call, only the numerical factorization is recomputed. The
+    //! iterative methods start from the previous solution in this case.
+    //! \return true on success, false if factorization or solve failed.
+    bool solve(const SparseMatrix& A, const Eigen::MatrixXd& B,
+               Eigen::MatrixXd& X);
+
+    //! Drop all cached factorizations and solutions.
+    void reset();
+
+private:
+    using RowMajorMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+    //! Check whether \p A has the same pattern as the cached one.
+    bool same_pattern(const SparseMatrix& A) const;
+
+    //! Remember the sparsity pattern of \p A.
+    void store_pattern(const SparseMatrix& A);
+
+    bool solve_ldlt(const SparseMatrix& A, bool reuse,
+                    const Eigen::MatrixXd& B, Eigen::MatrixXd& X);
+
+    template <typename CG>
+    bool solve_cg(CG& cg, const SparseMatrix& A, bool reuse,
+                  const Eigen::MatrixXd& B, Eigen::MatrixXd& X);
+
+private:
+    Method method_;
+    double tolerance_;
+    int max_iterations_;
+
+    // cached sparsity pattern
+    bool analyzed_;
+    Eigen::Index rows_;
+    Eigen::Index cols_;
+    std::vector<SparseMatrix::StorageIndex> outer_;
+    std::vector<SparseMatrix::StorageIndex> inner_;
+
+    // previous solution, used as initial guess by the iterative methods
+    Eigen::MatrixXd x_prev_;
+
+    Eigen::SimplicialLDLT<SparseMatrix> ldlt_;
+    Eigen::ConjugateGradient<RowMajorMatrix, Eigen::Lower | Eigen::Upper,
+                             Eigen::DiagonalPreconditioner<double>>
+        cg_jacobi_;
+    Eigen::ConjugateGradient<RowMajorMatrix, Eigen::Lower | Eigen::Upper,
+                             Eigen::IncompleteCholesky<double>>
+        cg_ichol_;
+};
+
+} // namespace pmp
@@ -6,6 +6,7 @@
 #include <map>
 
 #include "lvr2/geometry/pmp/SurfaceMesh.h"
+#include "lvr2/algorithm/pmp/SparseSolver.h"
 
 namespace pmp {
 
@@ -32,6 +33,11 @@ public:
     //! \throw InvalidInputException in case of missing boundary constraints
     void fair(unsigned int k = 2);
 
+    //! \brief Access the linear solver used by fair().
+    //! \details The symbolic factorization is kept between calls as long as
+    //! the connectivity, the selection and \p k do not change.
+    SparseSolver& solver() { return solver_; }
+
 private:
     void setup_matrix_row(const Vertex v, VertexProperty<double> vweight,
                           EdgeProperty<double> eweight,
@@ -48,6 +54,8 @@ private:
     VertexProperty<double> vweight_;
     EdgeProperty<double> eweight_;
     VertexProperty<int> idx_;
+
+    SparseSolver solver_; //!< solver reused between calls to fair()
 };
 
 } // namespace pmp
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "lvr2/geometry/pmp/SurfaceMesh.h"
+#include "lvr2/algorithm/pmp/SparseSolver.h"
 
 namespace pmp {
 
@@ -27,6 +28,11 @@ public:
     //! \throw SolverException in case of failure to solve the linear system.
     void lscm();
 
+    //! \brief Access the linear solver used by harmonic() and lscm().
+    //! \details The symbolic factorization is kept between calls of the same
+    //! method as long as the connectivity does not change.
+    SparseSolver& solver() { return solver_; }
+
 private:
     //! setup boundary constraints: map surface boundary to unit circle
     void setup_boundary_constraints();
@@ -37,6 +43,9 @@ private:
 private:
     //! the mesh
     SurfaceMesh& mesh_;
+
+    //! the linear solver
+    SparseSolver solver_;
 };
 
 } // namespace pmp
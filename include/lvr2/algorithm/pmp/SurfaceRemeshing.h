@@ -14,6 +14,9 @@ class TriangleKdTree;
 //! on edge collapse, split, flip, and tangential relaxation.
 //! See \cite botsch_2004_remeshing and \cite dunyach_2013_adaptive for a more
 //! detailed description.
+//! Tangential smoothing and back-projection run in parallel. The split,
+//! collapse and flip passes find their candidate edges in parallel and apply
+//! them serially in edge order, so the result equals the serial algorithm.
 //! \ingroup algorithms
 class SurfaceRemeshing
 {
@@ -57,6 +60,7 @@ private:
     Point weighted_centroid(Vertex v);
 
     void project_to_reference(Vertex v);
+    void project_point(const Point& q, Point& p, Point& n, Scalar& s) const;
 
     bool is_too_long(Vertex v0, Vertex v1) const
     {
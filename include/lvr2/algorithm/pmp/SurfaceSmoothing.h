@@ -4,6 +4,7 @@
 #pragma once
 
 #include "lvr2/geometry/pmp/SurfaceMesh.h"
+#include "lvr2/algorithm/pmp/SparseSolver.h"
 
 namespace pmp {
 
@@ -41,6 +42,12 @@ public:
         compute_vertex_weights(use_uniform_laplace);
     }
 
+    //! \brief Access the linear solver used by implicit_smoothing().
+    //! \details The symbolic factorization is kept between calls as long as
+    //! the connectivity does not change. Select an iterative method to solve
+    //! in parallel on large meshes.
+    SparseSolver& solver() { return solver_; }
+
 private:
     //! Initialize cotan/uniform Laplace weights.
     void compute_edge_weights(bool use_uniform_laplace);
@@ -56,6 +63,9 @@ private:
     // recompute if numbers change (i.e. mesh has changed)
     unsigned int how_many_edge_weights_;
     unsigned int how_many_vertex_weights_;
+
+    //! solver for the implicit smoothing system, reused between iterations
+    SparseSolver solver_;
 };
 
 } // namespace pmp
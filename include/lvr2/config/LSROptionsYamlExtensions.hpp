@@ -65,6 +65,7 @@ struct convert<lvr2::LSROptions>
         node["removeDanglingArtifacts"] = options.removeDanglingArtifacts;
         node["cleanContours"] = options.cleanContours;
         node["fillHoles"] = options.fillHoles;
+        node["triangulateHoles"] = options.triangulateHoles;
         node["optimizePlanes"] = options.optimizePlanes;
         node["planeNormalThreshold"] = options.planeNormalThreshold;
         node["planeIterations"] = options.planeIterations;
@@ -168,6 +169,11 @@ struct convert<lvr2::LSROptions>
             options.fillHoles = node["fillHoles"].as<int>();
         }
 
+        if (node["triangulateHoles"])
+        {
+            options.triangulateHoles = node["triangulateHoles"].as<bool>();
+        }
+
         if (node["optimizePlanes"])
         {
             options.optimizePlanes = node["optimizePlanes"].as<bool>();
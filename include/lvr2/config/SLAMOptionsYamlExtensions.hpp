@@ -76,6 +76,7 @@ struct convert<lvr2::SLAMOptions>
         node["closeLoopDistance"] = options.closeLoopDistance;
         node["closeLoopPairs"] = options.closeLoopPairs;
         node["loopSize"] = options.loopSize;
+        node["verifyCloseScans"] = options.verifyCloseScans;
         node["slamIterations"] = options.slamIterations;
         node["slamMaxDistance"] = options.slamMaxDistance;
         node["slamEpsilon"] = options.slamEpsilon;
@@ -187,6 +188,11 @@ struct convert<lvr2::SLAMOptions>
             options.loopSize = node["loopSize"].as<int>();
         }
 
+        if (node["verifyCloseScans"])
+        {
+            options.verifyCloseScans = node["verifyCloseScans"].as<bool>();
+        }
+
         if (node["slamIterations"])
         {
             options.slamIterations = node["slamIterations"].as<int>();
@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * PointLODIO.hpp
+ *
+ * @date 18.10.2026
+ */
+
+#ifndef LVR2_IO_POINTLODIO_HPP_
+#define LVR2_IO_POINTLODIO_HPP_
+
+#include "lvr2/types/PointBuffer.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lvr2
+{
+
+/**
+ * @brief One node of a point cloud level of detail hierarchy.
+ *
+ * The nodes are stored in breadth first order with the root at index 0. The
+ * children of a node are stored next to each other starting at firstChild.
+ * The layout of this struct is the on-disk layout of the hierarchy file.
+ */
+struct PointLODNode
+{
+    /// Bounding box of the points of the node and all of its descendants
+    float min[3];
+    float max[3];
+
+    /// Position of the node data in the data file
+    uint64_t byteOffset;
+
+    /// Number of points stored in the node
+    uint64_t numPoints;
+
+    /// Index of the first child, 0 for leaves
+    uint32_t firstChild;
+
+    /// Number of children
+    uint8_t numChildren;
+
+    /// Depth of the node, 0 for the root
+    uint8_t depth;
+
+    uint16_t reserved;
+};
+
+static_assert(sizeof(PointLODNode) == 48, "PointLODNode must match the on-disk layout");
+
+/**
+ * @brief Global information about a point cloud level of detail hierarchy.
+ */
+struct PointLODMetadata
+{
+    /// Number of points of the input point cloud
+    uint64_t numPoints = 0;
+
+    /// Number of points in all nodes
+    uint64_t numStoredPoints = 0;
+
+    /// Number of nodes in the hierarchy
+    uint64_t numNodes = 0;
+
+    /// Depth of the deepest node
+    uint32_t maxDepth = 0;
+
+    /// Resolution of the sampling grid of inner nodes
+    uint32_t samplingResolution = 0;
+
+    /// Bounding box of all points
+    float min[3] = {0, 0, 0};
+    float max[3] = {0, 0, 0};
+
+    bool hasNormals = false;
+    bool hasColors = false;
+};
+
+/**
+ * @brief Reads and writes point cloud level of detail hierarchies.
+ *
+ * A hierarchy is stored in a directory with three files:
+ *
+ *  - metadata.yaml:  The PointLODMetadata
+ *  - hierarchy.bin:  All PointLODNode structs in breadth first order
+ *  - octree.bin:     The point data of the nodes. The data of a node starts
+ *                    at its byteOffset and contains numPoints float xyz
+ *                    positions, followed by float xyz normals and uchar rgb
+ *                    colors if the hierarchy has them.
+ *
+ * Leaves contain all points of their region. Inner nodes contain a
+ * subsample of the points of their children that replaces the children
+ * when the region is viewed from a distance. A viewer only has to read the
+ * hierarchy and can then load the data of the nodes it needs with a single
+ * read each, e.g. through HTTP range requests.
+ */
+class PointLODIO
+{
+public:
+    /**
+     * @brief Opens the hierarchy in the given directory.
+     */
+    PointLODIO(const std::string& directory);
+
+    /**
+     * @brief Creates the directory and starts writing a new hierarchy.
+     */
+    void beginWrite(const PointLODMetadata& metadata);
+
+    /**
+     * @brief Appends the data of one node to the data file. May be called
+     *        from several threads at the same time.
+     *
+     * @param points    numPoints xyz positions
+     * @param normals   numPoints xyz normals if the hierarchy has normals
+     * @param colors    numPoints rgb colors if the hierarchy has colors
+     * @return The byteOffset of the node
+     */
+    uint64_t writeNodeData(const float* points, const float* normals, const unsigned char* colors, size_t numPoints);
+
+    /**
+     * @brief Writes the hierarchy and the metadata and closes the data file.
+     */
+    void finishWrite(const std::vector<PointLODNode>& nodes, const PointLODMetadata& metadata);
+
+    /**
+     * @brief Reads the metadata and the hierarchy.
+     */
+    void readIndex();
+
+    const PointLODMetadata& metadata() const { return m_metadata; }
+
+    const std::vector<PointLODNode>& nodes() const { return m_nodes; }
+
+    /**
+     * @brief Selects the nodes that have to be loaded to display the cloud.
+     *
+     * Starts at the root and descends into the children of every node for
+     * which `refine` returns true. `visible` can be used to skip whole
+     * subtrees, e.g. outside of the view frustum.
+     *
+     * @return Indices of the selected nodes
+     */
+    std::vector<size_t> selectNodes(
+        const std::function<bool(const PointLODNode&)>& visible,
+        const std::function<bool(const PointLODNode&)>& refine
+    ) const;
+
+    /**
+     * @brief Reads the points of one node. May be called from several
+     *        threads at the same time.
+     */
+    PointBufferPtr readNode(size_t index) const;
+
+    /// Size of the data of a node with `numPoints` points in bytes
+    size_t nodeDataSize(size_t numPoints) const;
+
+private:
+    std::string m_directory;
+
+    PointLODMetadata m_metadata;
+    std::vector<PointLODNode> m_nodes;
+
+    std::ofstream m_dataOut;
+    uint64_t m_dataSize = 0;
+    std::mutex m_mutex;
+};
+
+} // namespace lvr2
+
+#endif /* LVR2_IO_POINTLODIO_HPP_ */
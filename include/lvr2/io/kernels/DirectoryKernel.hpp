@@ -211,6 +211,8 @@ public:
 
     virtual bool isMeta(const std::string& path) const;
 
+    virtual bool concurrentReads() const;
+
 protected:
     template <typename T>
     boost::shared_array<T> loadArray(
@@ -257,6 +257,16 @@ public:
     {
         return false;
     }
+
+    /**
+     * @brief   Returns true if the kernel can be read from several
+     *          threads concurrently
+     */
+    virtual bool concurrentReads() const
+    {
+        return false;
+    }
+
     /**
      * @brief   Returns the path to the file resource of the 
      *          kernel
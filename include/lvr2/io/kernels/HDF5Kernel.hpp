@@ -18,8 +18,19 @@ namespace lvr2
  * 
  */
 struct HDF5KernelConfig {
-    /// The higher the compressionLevel the lower the memory consumption but higher runtime
-    unsigned int compressionLevel = 9;
+    /// Deflate level of the datasets, 0 disables compression. The higher the
+    /// compressionLevel the lower the memory consumption but higher runtime
+    unsigned int compressionLevel = 1;
+
+    /// Shuffle the bytes of the elements before deflating them. Improves the
+    /// compression of float and integer channels, especially at low levels.
+    bool shuffle = true;
+
+    /// Target size of the chunks of compressed datasets in bytes
+    size_t chunkBytes = 4 * 1024 * 1024;
+
+    /// Number of threads that (de)compress chunks, all OpenMP threads if <= 0
+    int numThreads = 0;
 };
 
 class HDF5Kernel : public FileKernel
@@ -359,9 +370,15 @@ public:
         const std::string& group, const std::string& sensor_type
     ) const;
 
+    virtual bool concurrentReads() const;
+
     template<typename T>
     cv::Mat createMat(const std::vector<size_t>& dims) const;
 
+    /// Chunking and filters of a new dataset with the given dimensions
+    template<typename T>
+    HighFive::DataSetCreateProps createProperties(const std::vector<size_t>& dims) const;
+
     std::shared_ptr<HighFive::File>  m_hdf5File;
 
     HDF5KernelConfig m_config;
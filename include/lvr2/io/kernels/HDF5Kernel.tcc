@@ -38,7 +38,7 @@ ChannelOptional<T> HDF5Kernel::loadChannelOptional(
             if (elementCount)
             {
                 ret = Channel<T>(dim[0], dim[1]);
-                dataset.read(ret->dataPtr().get());
+                hdf5util::readParallel(dataset, ret->dataPtr().get(), m_config.numThreads);
             }
         }
     }
@@ -100,7 +100,7 @@ boost::shared_array<T> HDF5Kernel::loadArray(
             {
                 ret = boost::shared_array<T>(new T[elementCount]);
 
-                dataset.read(ret.get());
+                hdf5util::readParallel(dataset, ret.get(), m_config.numThreads);
             }
         }
     } 
@@ -125,33 +125,24 @@ void HDF5Kernel::saveArray(
 
 
 template<typename T>
-static std::vector<hsize_t> autoComputeChunkSize(
-    const std::vector<size_t> dims,
-    size_t chunkBytes)
-{    
-    std::vector<hsize_t> chunk_sizes(dims.size(), 1);
-
-    size_t elems_per_chunk = chunkBytes / sizeof(T);
-    size_t current_elems_per_chunk = 1;
-    
-    size_t dim_id = dims.size() - 1;
+HighFive::DataSetCreateProps HDF5Kernel::createProperties(const std::vector<size_t>& dims) const
+{
+    HighFive::DataSetCreateProps properties;
 
-    while(dim_id >= 0 && dims[dim_id] * current_elems_per_chunk <= elems_per_chunk) 
+    if(m_config.compressionLevel > 0)
     {
-        current_elems_per_chunk *= dims[dim_id];
-        chunk_sizes[dim_id] = dims[dim_id];
-        // If all dimensions were processed return early, otherwise dim_id will wrap because its unsigned
-        // this can lead to invalid memory access
-        if (dim_id == 0)
+        std::vector<hsize_t> chunkSizes = hdf5util::computeChunkSize(dims, sizeof(T), m_config.chunkBytes);
+        if(!chunkSizes.empty())
         {
-            return chunk_sizes;
+            properties.add(HighFive::Chunking(chunkSizes));
+            if(m_config.shuffle)
+            {
+                properties.add(HighFive::Shuffle());
+            }
+            properties.add(HighFive::Deflate(m_config.compressionLevel));
         }
-
-        dim_id -= 1;
     }
-
-    chunk_sizes[dim_id] = elems_per_chunk / current_elems_per_chunk;
-    return chunk_sizes;
+    return properties;
 }
 
 template<typename T> 
@@ -167,21 +158,14 @@ void HDF5Kernel::saveArray(
     if(m_hdf5File && m_hdf5File->isValid())
     {
         HighFive::DataSpace dataSpace(dim);
-        HighFive::DataSetCreateProps properties;
-
-        if(m_config.compressionLevel > 0)
-        {
-            std::vector<hsize_t> chunkSizes = autoComputeChunkSize<T>(dim, 10 * 1024);
-            properties.add(HighFive::Chunking(chunkSizes));
-            properties.add(HighFive::Deflate(m_config.compressionLevel));
-        }
+        HighFive::DataSetCreateProps properties = createProperties<T>(dim);
         
         std::unique_ptr<HighFive::DataSet> dataset = hdf5util::createDataset<T>(
             g, datasetName, dataSpace, properties
         );
 
         const T* ptr = data.get();
-        dataset->write_raw(ptr);
+        hdf5util::writeParallel(*dataset, ptr, m_config.numThreads);
         m_hdf5File->flush();
     } 
     else 
@@ -212,7 +196,7 @@ bool HDF5Kernel::getChannel(const std::string group, const std::string name, boo
             if(elementCount)
             {
                 channel = Channel<T>(dim[0], dim[1]);
-                dataset.read(channel->dataPtr().get());
+                hdf5util::readParallel(dataset, channel->dataPtr().get(), m_config.numThreads);
             }
         }
     }
@@ -311,22 +295,14 @@ void HDF5Kernel::save(HighFive::Group &g,
             std::vector<size_t > dims = {channel.numElements(), channel.width()};
 
             HighFive::DataSpace dataSpace(dims);
-            HighFive::DataSetCreateProps properties;
-
-            if(m_config.compressionLevel > 0)
-            {
-                std::vector<hsize_t> chunkSizes;
-                chunkSizes.assign(dims.begin(), dims.end()); 
-                properties.add(HighFive::Chunking(chunkSizes));
-                properties.add(HighFive::Deflate(m_config.compressionLevel));
-            }
+            HighFive::DataSetCreateProps properties = createProperties<T>(dims);
     
             std::unique_ptr<HighFive::DataSet> dataset = hdf5util::createDataset<T>(
                 g, datasetName, dataSpace, properties
             );
 
             const T* ptr = channel.dataPtr().get();
-            dataset->write_raw(ptr);
+            hdf5util::writeParallel(*dataset, ptr, m_config.numThreads);
             m_hdf5File->flush();
 
             std::string sensor_type = "Channel";
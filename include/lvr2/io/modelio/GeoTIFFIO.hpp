@@ -29,7 +29,9 @@
 
 #include <gdal_priv.h>
 #include <opencv2/opencv.hpp>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace lvr2
 {
@@ -48,6 +50,20 @@ public:
      */
     GeoTIFFIO(std::string filename, int cols, int rows, int bands);
 
+    /**
+     * @brief Creates a tiled and internally compressed GeoTIFF. Blocks that are
+     *        never written are left sparse and read back as no data.
+     * @param filename filename of output GeoTIFF file
+     * @param cols number of columns / width of the image
+     * @param rows number of rows / length of the image
+     * @param bands number of bands
+     * @param type data type of the bands
+     * @param blockSize width and height of the internal tiles, a multiple of 16
+     * @param compression GDAL compression method, e.g. DEFLATE, LZW, ZSTD or NONE
+     */
+    GeoTIFFIO(std::string filename, int cols, int rows, int bands,
+              GDALDataType type, int blockSize, std::string compression = "DEFLATE");
+
     /**
      * @param filename
      */
@@ -66,6 +82,45 @@ public:
      */
     int writeBand(cv::Mat *mat, int band);
 
+    /**
+     * @brief Writes a window of float values into the given band. The window
+     *        should be aligned to the internal tiles. Safe to call from several
+     *        threads, the writes are serialized.
+     * @param data width * height values in row major order
+     * @param band number of band to be written
+     * @param xOff column of the upper left pixel of the window
+     * @param yOff row of the upper left pixel of the window
+     * @param width width of the window
+     * @param height height of the window
+     * @return standard C++ return value
+     */
+    int writeBlock(const float *data, int band, int xOff, int yOff, int width, int height);
+
+    /**
+     * @param geoTransform six affine coefficients mapping pixels to georeferenced coordinates
+     */
+    void setGeoTransform(double *geoTransform);
+
+    /**
+     * @param srs coordinate system in any format understood by GDAL, e.g. EPSG:25832 or WKT
+     * @return standard C++ return value
+     */
+    int setSpatialReference(const std::string& srs);
+
+    /**
+     * @param band_index index of the band of interest
+     * @param value value that marks pixels without data
+     */
+    void setNoDataValue(int band_index, double value);
+
+    /**
+     * @brief Builds internal overviews for all bands
+     * @param factors decimation factors of the overview levels, e.g. 2, 4, 8
+     * @param resampling GDAL resampling method used to compute the levels
+     * @return standard C++ return value
+     */
+    int buildOverviews(std::vector<int> factors, const std::string& resampling = "AVERAGE");
+
     /**
      * @return width of dataset in number of pixels
      */
@@ -110,6 +165,8 @@ private:
     GDALDataset *m_gtif_dataset;
     GDALDriver *m_gtif_driver;
     int m_cols, m_rows, m_bands;
+    std::string m_compression;
+    std::mutex m_mutex;
 };
 }
 
@@ -36,12 +36,22 @@
 #define LASIO_H_
 
 #include "lvr2/io/modelio/ModelIOBase.hpp"
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/geometry/BoundingBox.hpp"
+
+#include <functional>
 
 namespace lvr2
 {
 
 /**
- * @brief   Interface class to read laser scan data in .las-Format
+ * @brief   Interface class to read and write laser scan data in .las and
+ *          .laz format.
+ *
+ *          The point records are split into contiguous ranges that are decoded
+ *          in parallel, each by its own reader, directly into the channels of
+ *          the resulting PointBuffer. When writing, the records are encoded in
+ *          parallel batches and passed to the (compressing) writer afterwards.
  */
 class LasIO : public ModelIOBase
 {
@@ -50,19 +60,78 @@ public:
     virtual ~LasIO() {};
 
     /**
-     * @brief Parse the given file and load supported elements.
+     * @brief Parse the given file and load supported elements, i.e. points,
+     *        intensities and colors.
      *
      * @param filename  The file to read.
      */
     virtual ModelPtr read(string filename );
 
     /**
-     * @brief Save the loaded elements to the given file.
+     * @brief Parse the given file and load the selected attributes.
+     *
+     * @param filename              The file to read.
+     * @param readColors            Load RGB colors into the "colors" channel.
+     *                              Files without colors get gray values from the
+     *                              intensities.
+     * @param readIntensities       Load intensities into the "intensities" channel.
+     * @param readClassifications   Load classifications into the "classifications" channel.
+     */
+    ModelPtr read(string filename, bool readColors, bool readIntensities,
+                  bool readClassifications = false);
+
+    /**
+     * @brief Parse the given file and load the selected attributes of all points
+     *        inside the given bounding box. Files that do not intersect the box
+     *        are not decoded at all.
+     *
+     * @param filename              The file to read.
+     * @param bb                    Only points inside this box are loaded.
+     * @param readColors            Load RGB colors into the "colors" channel.
+     * @param readIntensities       Load intensities into the "intensities" channel.
+     * @param readClassifications   Load classifications into the "classifications" channel.
+     */
+    ModelPtr read(string filename, const BoundingBox<BaseVector<float>>& bb,
+                  bool readColors = true, bool readIntensities = true,
+                  bool readClassifications = false);
+
+    /**
+     * @brief Reads the bounding box and the number of point records from the
+     *        header of the given file without decoding any points.
+     *
+     * @param filename  The file to read.
+     * @param bb        The bounding box of the points according to the header.
+     * @param numPoints The number of point records.
+     * @return false if the file could not be opened.
+     */
+    bool readHeader(string filename, BoundingBox<BaseVector<float>>& bb, size_t& numPoints);
+
+    /**
+     * @brief Reads the coordinates of all points of the given file in a
+     *        single pass, in chunks of consecutive point records. Each chunk
+     *        is decoded in parallel and passed to @p process in file order,
+     *        so memory is bounded by the chunk size.
+     *
+     * @param filename  The file to read.
+     * @param chunkSize Maximum number of points per chunk.
+     * @param process   Called with a buffer holding the "points" of each chunk.
+     * @return false if the file could not be opened or ended unexpectedly.
+     */
+    bool readChunks(string filename, size_t chunkSize, const std::function<void(PointBufferPtr)>& process);
+
+    /**
+     * @brief Save the loaded elements to the given file. Files ending with
+     *        .laz are compressed.
      *
      * @param filename Filename of the file to write.
      */
     virtual void save( string filename );
 
+private:
+
+    /// Reads the file, optionally restricted to the points inside bb
+    ModelPtr readPoints(const string& filename, const BoundingBox<BaseVector<float>>* bb,
+                        bool readColors, bool readIntensities, bool readClassifications);
 };
 
 } /* namespace lvr2 */
@@ -65,12 +65,17 @@ public:
     /**
      * \brief   Parse the given file and load supported elements.
      *
+     * The file is memory mapped and split into line aligned blocks that
+     * are parsed in parallel directly into the channels of the mesh.
+     * Vertex attributes are only added if there is one per vertex.
+     *
      * @param filename  The file to read.
      */
     ModelPtr read( std::string filename );
 
     /**
-     * @brief     Writes the mesh to an obj file.
+     * @brief     Writes the mesh to an obj file. The lines are formatted
+     *            in parallel blocks.
      *
      * @param  model     The model containing all mesh data
      * @param  filename  The file name to use
@@ -60,6 +60,30 @@ namespace lvr2
 
 using Vec = BaseVector<float>;
 
+/**
+ * @brief Pose and meta information of a scan read by \ref UosIO
+ */
+struct UosScanInfo
+{
+    /// Number of the scan, i.e., xxx in scanxxx.3d
+    int             number;
+
+    /// Path of the scan file
+    string          filename;
+
+    /// Transformation from .frames or .pose file
+    Matrix4<Vec>    pose;
+
+    /// Number of loaded points (after reduction, 0 in poses only mode)
+    size_t          numPoints;
+
+    /// True if the scan file contains color information
+    bool            hasColor;
+
+    /// True if the scan file contains intensity information
+    bool            hasIntensity;
+};
+
 /**
  * @brief An input class for laser scans in UOS 3d format.
  *
@@ -70,6 +94,12 @@ using Vec = BaseVector<float>;
  * single scans will be transformed according to the last
  * transformation in the file. If no .frame file are present, the
  * .pose files will be sued to transform the scans.
+ *
+ * Scans in new format are loaded concurrently. Points can be reduced
+ * while reading, either by keeping only every n-th point of each scan
+ * (\ref setReduction) or by an octree based reduction of each scan
+ * (\ref setOctreeReduction). If only the poses are needed, the points
+ * can be skipped completely (\ref setPosesOnly).
  */
 class UosIO : public ModelIOBase
 {
@@ -86,7 +116,11 @@ public:
         m_reductionTarget(0),
         m_numScans(0),
         m_saveRemission(false),
-        m_saveRemissionColor(false){}
+        m_saveRemissionColor(false),
+        m_modulo(1),
+        m_voxelSize(0.0f),
+        m_minPointsPerVoxel(1),
+        m_posesOnly(false){}
 
     /**
      * @brief Reads all scans or an specified range of scans
@@ -112,6 +146,53 @@ public:
     void setLastScan(int n) {m_lastScan = n;}
 
 
+    /**
+     * @brief Keep only every n-th point of each scan. The skipped
+     *        lines are not parsed.
+     */
+    void setReduction(size_t n) { m_modulo = n > 0 ? n : 1; }
+
+
+    /**
+     * @brief Reduce each scan with a random sample octree after
+     *        reading. A voxel size <= 0 disables the reduction.
+     *
+     * @param voxelSize         Voxel size of the octree
+     * @param minPointsPerVoxel Minimum number of points per voxel
+     */
+    void setOctreeReduction(float voxelSize, size_t minPointsPerVoxel = 1)
+    {
+        m_voxelSize = voxelSize;
+        m_minPointsPerVoxel = minPointsPerVoxel;
+    }
+
+
+    /**
+     * @brief If true, only poses and meta information are read.
+     *        The returned model contains no point cloud in this case.
+     */
+    void setPosesOnly(bool posesOnly) { m_posesOnly = posesOnly; }
+
+
+    /**
+     * @brief Returns pose and meta information of the scans in new
+     *        format that were loaded by the last call to \ref read
+     */
+    const std::vector<UosScanInfo>& getScanInfos() const { return m_scanInfos; }
+
+
+    /**
+     * @brief Reads a single scan file in UOS format without transforming
+     *        it. The configured reductions are applied. Points, colors and
+     *        intensities are stored in the returned buffer.
+     *
+     * @param filename  A .3d file
+     * @return          The points of the scan or an empty pointer if the
+     *                  file could not be read
+     */
+    PointBufferPtr readScan(const string& filename);
+
+
     /**
      * Reduces the given point cloud and exports all points
      * into on single file.
@@ -174,6 +255,33 @@ private:
     void readOldFormat(ModelPtr &m, string dir, int first, int last, size_t &n);
 
 
+    /**
+     * @brief Reads the transformation of a scan. The last transformation
+     *        of the .frames file is used if present, otherwise the .pose file.
+     * @param base      Path of the scan without extension
+     */
+    Matrix4<Vec> readScanPose(const string& base);
+
+
+    /**
+     * @brief Determines the attributes of a scan from its first data line
+     */
+    void readScanAttributes(const string& filename, bool& hasColor, bool& hasIntensity);
+
+
+    /**
+     * @brief Transforms all points of the given scan
+     */
+    void transformScan(PointBufferPtr scan, const Matrix4<Vec>& tf);
+
+
+    /**
+     * @brief Appends every skipPoints-th point of the scan to out, counting
+     *        from the global index firstCounter of its first point
+     */
+    void formatReducedPoints(PointBufferPtr scan, size_t firstCounter, size_t skipPoints, string& out);
+
+
     inline std::string to_string(const int& t, int width)
     {
       stringstream ss;
@@ -241,6 +349,21 @@ private:
     /// If true, the original remission information will be saved
     bool    m_saveRemission;
 
+    /// Only every m_modulo-th point of a scan is read
+    size_t  m_modulo;
+
+    /// Voxel size of the octree reduction (disabled if <= 0)
+    float   m_voxelSize;
+
+    /// Minimum number of points per voxel in octree reduction
+    size_t  m_minPointsPerVoxel;
+
+    /// If true, points are not read
+    bool    m_posesOnly;
+
+    /// Poses and meta information of the loaded scans
+    std::vector<UosScanInfo> m_scanInfos;
+
 };
 
 } // namespace lvr2
@@ -8,6 +8,7 @@
 #include "lvr2/io/baseio/BaseIO.hpp"
 #include "lvr2/io/scanio/yaml/CameraImage.hpp"
 #include "lvr2/io/scanio/CameraImageIO.hpp"
+#include "lvr2/io/scanio/ConcurrentLoad.hpp"
 
 using lvr2::baseio::FeatureConstruct;
 
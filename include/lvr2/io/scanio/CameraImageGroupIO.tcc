@@ -103,17 +103,35 @@ CameraImageGroupPtr CameraImageGroupIO<BaseIO>::load(
     if (ret)
     {
         // it is a group!
-        // load data
+        // Find all images first. Always test image 0 and 1.
+        // If numbering starts with i >= 2, data will not be found
+        size_t numImages = 0;
         for (size_t i = 0;; i++)
         {
-            CameraImagePtr img = m_cameraImageIO->load(scanPosNo, camNo, groupNo, i);
-            
-            if (img)
+            Description di = Dgen->cameraImage(scanPosNo, camNo, groupNo, i);
+            if (di.dataRoot && di.data && m_baseIO->m_kernel->exists(*di.dataRoot, *di.data))
+            {
+                numImages = i + 1;
+            }
+            else if(i > 1)
+            {
+                break;
+            }
+        }
+
+        // load data
+        std::vector<CameraImagePtr> images(numImages);
+        loadConcurrently(m_baseIO->m_kernel, numImages, [&](size_t i)
+        {
+            images[i] = m_cameraImageIO->load(scanPosNo, camNo, groupNo, i);
+        });
+
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            if (images[i])
             {
-                ret->images.push_back(img);
+                ret->images.push_back(images[i]);
             }
-            // Always test image 0 and 1. If numbering
-            // starts with i >= 2, data will not be found
             else if(i > 1)
             {
                 break;
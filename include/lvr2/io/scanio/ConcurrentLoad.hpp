@@ -0,0 +1,131 @@
+#pragma once
+
+#ifndef CONCURRENTLOAD
+#define CONCURRENTLOAD
+
+#include "lvr2/io/kernels/FileKernel.hpp"
+
+#include <exception>
+#include <vector>
+
+#ifdef LVR2_USE_OPEN_MP
+#include <omp.h>
+#endif
+
+namespace lvr2
+{
+namespace scanio
+{
+
+namespace detail
+{
+
+template<typename F>
+void loadTasks(size_t n, F* load, std::exception_ptr* error)
+{
+#ifdef LVR2_USE_OPEN_MP
+    #pragma omp taskloop grainsize(1)
+#endif
+    for(size_t i = 0; i < n; i++)
+    {
+        try
+        {
+            (*load)(i);
+        }
+        catch(...)
+        {
+#ifdef LVR2_USE_OPEN_MP
+            #pragma omp critical(lvr2_scanio_load_error)
+#endif
+            {
+                if(!*error)
+                {
+                    *error = std::current_exception();
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Calls load(i) for all i in [0, n).
+ *
+ * If the kernel supports concurrent reads, the calls are run as OpenMP
+ * tasks. A call from inside a parallel region (e.g. from the load of a
+ * scan position that is itself loaded concurrently) adds its tasks to the
+ * running team, so nested loads share one pool of threads instead of
+ * oversubscribing the cores. Otherwise, the calls are made sequentially.
+ *
+ * load(i) must only write to results owned by index i. The first
+ * exception thrown by any call is rethrown after all calls have finished.
+ */
+template<typename F>
+void loadConcurrently(const FileKernelPtr& kernel, size_t n, F load)
+{
+    if(n < 2 || !kernel || !kernel->concurrentReads())
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            load(i);
+        }
+        return;
+    }
+
+    std::exception_ptr error;
+
+#ifdef LVR2_USE_OPEN_MP
+    if(omp_in_parallel())
+    {
+        detail::loadTasks(n, &load, &error);
+    }
+    else
+    {
+        #pragma omp parallel
+        #pragma omp single
+        detail::loadTasks(n, &load, &error);
+    }
+#else
+    detail::loadTasks(n, &load, &error);
+#endif
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @brief Loads the entities with the given numbers using loadConcurrently()
+ *        and returns them in the order of the numbers. Entities which could
+ *        not be loaded (nullptr) are skipped.
+ */
+template<typename PtrT, typename F>
+std::vector<PtrT> loadAllConcurrently(
+    const FileKernelPtr& kernel,
+    const std::vector<size_t>& numbers,
+    F load)
+{
+    std::vector<PtrT> loaded(numbers.size());
+    loadConcurrently(kernel, numbers.size(), [&](size_t i)
+    {
+        loaded[i] = load(numbers[i]);
+    });
+
+    std::vector<PtrT> ret;
+    ret.reserve(loaded.size());
+    for(PtrT& p : loaded)
+    {
+        if(p)
+        {
+            ret.push_back(p);
+        }
+    }
+    return ret;
+}
+
+} // namespace scanio
+} // namespace lvr2
+
+#endif // CONCURRENTLOAD
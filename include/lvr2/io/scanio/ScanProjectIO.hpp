@@ -6,6 +6,7 @@
 #include "lvr2/types/ScanTypes.hpp"
 #include "lvr2/io/baseio/MetaIO.hpp"
 #include "lvr2/io/scanio/ScanPositionIO.hpp"
+#include "lvr2/io/scanio/ConcurrentLoad.hpp"
 #include "lvr2/io/scanio/yaml/ScanProject.hpp"
 #include "lvr2/registration/ReductionAlgorithm.hpp"
 
@@ -49,14 +50,35 @@ class ScanProjectIO
     void save(ScanProjectPtr scanProject) const;
     void saveScanProject(ScanProjectPtr scanProject) const;
    
+    /**
+     * @brief Loads the scan project. If the kernel supports concurrent reads,
+     *        the scan positions and their camera images are loaded
+     *        concurrently on the OpenMP threads. The positions are always
+     *        ordered by their numbers. Unless the IO was constructed with
+     *        load_data, only meta data is parsed and points and images are
+     *        loaded on demand.
+     */
     ScanProjectPtr load() const;
     ScanProjectPtr loadScanProject() const;
     ScanProjectPtr loadScanProject(ReductionAlgorithmPtr reduction) const;
 
     boost::optional<YAML::Node> loadMeta() const;
 
-    
+    /**
+     * @brief Loads only the meta data of all scan positions, without their
+     *        sensors and bulk data. The metas are returned in the order of
+     *        the scan position numbers.
+     */
+    std::vector<YAML::Node> loadScanPositionMetas() const;
+
   protected:
+    /**
+     * @brief Returns the numbers of all existing scan positions. Numbers
+     *        below firstRequired may be missing, the first missing number
+     *        from firstRequired on ends the project.
+     */
+    std::vector<size_t> scanPositionNumbers(const size_t& firstRequired) const;
+
     BaseIO* m_baseIO = static_cast<BaseIO*>(this);
     
     // dependencies
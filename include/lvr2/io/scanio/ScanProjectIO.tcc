@@ -102,27 +102,16 @@ ScanProjectPtr ScanProjectIO<BaseIO>::load() const
     }
 
 
-    // Get all sub scans
-    size_t scanPosNo = 0;
-    while(true)
-    {  
-         lvr2::logout::get() << "[ScanProjectIO - load] try load ScanPosition "  << scanPosNo << lvr2::endl;
-        // Get description for next scan
-
-        // Generate Directories for all Filetypes
-        ScanPositionPtr scanPos = m_scanPositionIO->loadScanPosition(scanPosNo);
-        if(scanPos)
-        {
-            ret->positions.push_back(scanPos);
-        }
-        else if(scanPosNo > 1)
-        {
-            break;
-        }
+    // Get all sub scans. Numbering may start at 0 or 1.
+    std::vector<size_t> scanPosNos = scanPositionNumbers(2);
+    lvr2::logout::get() << "[ScanProjectIO - load] Loading " << scanPosNos.size() << " scan positions" << lvr2::endl;
 
-        scanPosNo++;
-
-    }
+    std::vector<ScanPositionPtr> positions = loadAllConcurrently<ScanPositionPtr>(
+        m_baseIO->m_kernel, scanPosNos, [this](size_t scanPosNo)
+    {
+        return m_scanPositionIO->loadScanPosition(scanPosNo);
+    });
+    ret->positions.insert(ret->positions.end(), positions.begin(), positions.end());
 
     return ret;
 }
@@ -177,20 +166,57 @@ ScanProjectPtr ScanProjectIO<BaseIO>::loadScanProject(ReductionAlgorithmPtr redu
 
 
     // Get all sub scans
-    size_t scanPosNo = 0;
-    while(true)
+    std::vector<ScanPositionPtr> positions = loadAllConcurrently<ScanPositionPtr>(
+        m_baseIO->m_kernel, scanPositionNumbers(0), [this, reduction](size_t scanPosNo)
     {
-        // Get description for next scan
-        ScanPositionPtr scanPos = m_scanPositionIO->loadScanPosition(scanPosNo, reduction);
-        if(!scanPos)
+        return m_scanPositionIO->loadScanPosition(scanPosNo, reduction);
+    });
+    ret->positions.insert(ret->positions.end(), positions.begin(), positions.end());
+
+    return ret;
+}
+
+template <typename BaseIO>
+std::vector<YAML::Node> ScanProjectIO<BaseIO>::loadScanPositionMetas() const
+{
+    std::vector<size_t> scanPosNos = scanPositionNumbers(2);
+
+    std::vector<boost::optional<YAML::Node>> metas(scanPosNos.size());
+    loadConcurrently(m_baseIO->m_kernel, scanPosNos.size(), [&](size_t i)
+    {
+        metas[i] = m_scanPositionIO->loadMeta(scanPosNos[i]);
+    });
+
+    std::vector<YAML::Node> ret;
+    for(size_t i = 0; i < metas.size(); i++)
+    {
+        if(metas[i])
         {
-            //if
-            break;
+            YAML::Node meta = *metas[i];
+            meta["original_name"] = scanPosNos[i];
+            ret.push_back(meta);
         }
-        ret->positions.push_back(scanPos);
-        scanPosNo++;
     }
+    return ret;
+}
 
+template <typename BaseIO>
+std::vector<size_t> ScanProjectIO<BaseIO>::scanPositionNumbers(
+    const size_t& firstRequired) const
+{
+    std::vector<size_t> ret;
+    for(size_t scanPosNo = 0;; scanPosNo++)
+    {
+        Description d = m_baseIO->m_description->position(scanPosNo);
+        if(d.dataRoot && m_baseIO->m_kernel->exists(*d.dataRoot))
+        {
+            ret.push_back(scanPosNo);
+        }
+        else if(scanPosNo >= firstRequired)
+        {
+            break;
+        }
+    }
     return ret;
 }
 
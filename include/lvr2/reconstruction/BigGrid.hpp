@@ -38,6 +38,7 @@
 #include "lvr2/geometry/BoundingBox.hpp"
 #include "lvr2/io/DataStruct.hpp"
 #include "lvr2/types/MatrixTypes.hpp"
+#include "lvr2/types/ScanTypes.hpp"
 
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <string>
@@ -106,6 +107,22 @@ class BigGrid
      */
     lvr2::floatArr points(const Vector3i& index, size_t& numPoints) const;
 
+    /**
+     * Normals of Voxel at position i,j,k
+     * @param index
+     * @param numNormals, amount of normals in lvr2::floatArr
+     * @return lvr2::floatArr, containing normals. Empty if there are no normals
+     */
+    lvr2::floatArr normals(const Vector3i& index, size_t& numNormals) const;
+
+    /**
+     * Colors of Voxel at position i,j,k
+     * @param index
+     * @param numColors, amount of colors in lvr2::ucharArr
+     * @return lvr2::ucharArr, containing colors. Empty if there are no colors
+     */
+    lvr2::ucharArr colors(const Vector3i& index, size_t& numColors) const;
+
     /**
      * @brief Returns the points within a bounding box
      * 
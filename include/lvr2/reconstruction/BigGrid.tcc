@@ -435,26 +435,26 @@ BigGrid<BaseVecT>::BigGrid(float voxelsize, ScanProjectEditMarkPtr project, cons
         scan->release();
 
         ++progressFilling;
+    }
 
-        if (m_extrude)
+    // consistency check, only valid after all scans are inserted
+    bool failed = false;
+    for (auto &[index, cell] : m_cells)
+    {
+        if (cell.inserted != cell.size)
         {
-            calcExtrusion();
+            lvr2::logout::get() << lvr2::info << "[BigGrid] Cell " << index.transpose() << ": " << cell.inserted << "/" << cell.size << lvr2::endl;
+            failed = true;
         }
+    }
+    if (failed)
+    {
+        throw std::runtime_error("BigGrid creation failed: Inconsistent number of points in cells");
+    }
 
-        // consistency check
-        bool failed = false;
-        for (auto &[index, cell] : m_cells)
-        {
-            if (cell.inserted != cell.size)
-            {
-                lvr2::logout::get() << lvr2::info << "[BigGrid] Cell " << index.transpose() << ": " << cell.inserted << "/" << cell.size << lvr2::endl;
-                failed = true;
-            }
-        }
-        if (failed)
-        {
-            throw std::runtime_error("BigGrid creation failed: Inconsistent number of points in cells");
-        }
+    if (m_extrude)
+    {
+        calcExtrusion();
     }
 }
 
@@ -657,6 +657,48 @@ lvr2::floatArr BigGrid<BaseVecT>::points(const Vector3i &index, size_t &numPoint
     return points;
 }
 
+template <typename BaseVecT>
+lvr2::floatArr BigGrid<BaseVecT>::normals(const Vector3i &index, size_t &numNormals) const
+{
+    lvr2::floatArr normals;
+    numNormals = 0;
+    auto it = m_cells.find(index);
+    if (m_hasNormal && it != m_cells.end() && it->second.size > 0)
+    {
+        auto &cell = it->second;
+
+        normals = lvr2::floatArr(new float[3 * cell.size]);
+
+        const float *cellData = (const float *)m_NormalFile.data() + 3 * cell.offset;
+
+        std::copy_n(cellData, 3 * cell.size, normals.get());
+
+        numNormals = cell.size;
+    }
+    return normals;
+}
+
+template <typename BaseVecT>
+lvr2::ucharArr BigGrid<BaseVecT>::colors(const Vector3i &index, size_t &numColors) const
+{
+    lvr2::ucharArr colors;
+    numColors = 0;
+    auto it = m_cells.find(index);
+    if (m_hasColor && it != m_cells.end() && it->second.size > 0)
+    {
+        auto &cell = it->second;
+
+        colors = lvr2::ucharArr(new uchar[3 * cell.size]);
+
+        const uchar *cellData = (const uchar *)m_ColorFile.data() + 3 * cell.offset;
+
+        std::copy_n(cellData, 3 * cell.size, colors.get());
+
+        numColors = cell.size;
+    }
+    return colors;
+}
+
 template <typename BaseVecT>
 lvr2::floatArr BigGrid<BaseVecT>::points(const BoundingBox<BaseVecT> &bb, size_t &numPoints, size_t minNumPoints) const
 {
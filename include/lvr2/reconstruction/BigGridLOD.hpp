@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * BigGridLOD.hpp
+ *
+ * @date 18.10.2026
+ */
+
+#ifndef LVR2_RECONSTRUCTION_BIGGRIDLOD_HPP_
+#define LVR2_RECONSTRUCTION_BIGGRIDLOD_HPP_
+
+#include "lvr2/reconstruction/BigGrid.hpp"
+#include "lvr2/io/PointLODIO.hpp"
+
+#include <string>
+#include <vector>
+
+namespace lvr2
+{
+
+/**
+ * @brief Builds a level of detail octree of the points of a BigGrid and
+ *        writes it with PointLODIO.
+ *
+ * The octree is built on the cells of the grid, so the hierarchy is known
+ * before a single point is read. A node is split as long as it contains
+ * more than maxPointsPerNode points and is larger than one cell. Leaves
+ * store all of their points, inner nodes store a subsample of their
+ * children with at most one point per cell of a samplingResolution^3 grid
+ * over their bounding cube.
+ *
+ * The nodes are written bottom up, one level at a time with all nodes of a
+ * level in parallel. The points of a leaf are read from the memory mapped
+ * grid files when the leaf is written, and only the subsamples are kept
+ * until the parent is done, so the whole point cloud is never in memory.
+ */
+template<typename BaseVecT>
+class BigGridLOD
+{
+public:
+
+    struct Options
+    {
+        /// Nodes with more points are split
+        size_t maxPointsPerNode = 100000;
+
+        /// Resolution of the sampling grid of the inner nodes
+        uint32_t samplingResolution = 128;
+    };
+
+    /**
+     * @brief Builds the hierarchy of the grid cells.
+     *
+     * @param grid      The grid. Must outlive this object.
+     * @param options   See Options
+     */
+    BigGridLOD(const BigGrid<BaseVecT>& grid, const Options& options);
+
+    /// @overload with default options
+    BigGridLOD(const BigGrid<BaseVecT>& grid) : BigGridLOD(grid, Options()) {}
+
+    /**
+     * @brief Samples the points of all nodes and writes the hierarchy to
+     *        `directory`.
+     */
+    void write(const std::string& directory) const;
+
+    /// Number of nodes in the hierarchy
+    size_t numNodes() const { return m_nodes.size(); }
+
+    /// Number of levels in the hierarchy
+    size_t numLevels() const { return m_levels.size() - 1; }
+
+private:
+
+    struct Node
+    {
+        /// Smallest cell index inside the node
+        Vector3i origin;
+
+        /// Side length of the node in cells, a power of two
+        int size;
+
+        /// Cells of leaves, empty for inner nodes
+        std::vector<Vector3i> cells;
+
+        size_t numPoints = 0;
+        uint32_t firstChild = 0;
+        uint8_t numChildren = 0;
+        uint8_t depth = 0;
+    };
+
+    /// Points of a node and its attributes
+    struct Sample
+    {
+        std::vector<float> points;
+        std::vector<float> normals;
+        std::vector<unsigned char> colors;
+
+        size_t size() const { return points.size() / 3; }
+        void append(const Sample& other);
+    };
+
+    /// Splits the nodes level by level
+    void subdivide();
+
+    /// Reads all points of a leaf from the grid
+    Sample loadLeaf(const Node& node) const;
+
+    /// Keeps the point closest to the center of each cell of the sampling grid
+    Sample subsample(const Sample& in) const;
+
+    const BigGrid<BaseVecT>& m_grid;
+    Options m_options;
+
+    /// Nodes in breadth first order
+    std::vector<Node> m_nodes;
+
+    /// Nodes of level i are [m_levels[i], m_levels[i + 1])
+    std::vector<size_t> m_levels;
+};
+
+} // namespace lvr2
+
+#include "lvr2/reconstruction/BigGridLOD.tcc"
+
+#endif /* LVR2_RECONSTRUCTION_BIGGRIDLOD_HPP_ */
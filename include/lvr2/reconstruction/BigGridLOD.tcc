@@ -0,0 +1,393 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * BigGridLOD.tcc
+ *
+ * @date 18.10.2026
+ */
+
+#include "lvr2/util/Logging.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace lvr2
+{
+
+template<typename BaseVecT>
+void BigGridLOD<BaseVecT>::Sample::append(const Sample& other)
+{
+    points.insert(points.end(), other.points.begin(), other.points.end());
+    normals.insert(normals.end(), other.normals.begin(), other.normals.end());
+    colors.insert(colors.end(), other.colors.begin(), other.colors.end());
+}
+
+template<typename BaseVecT>
+BigGridLOD<BaseVecT>::BigGridLOD(const BigGrid<BaseVecT>& grid, const Options& options)
+    : m_grid(grid), m_options(options)
+{
+    if (m_options.maxPointsPerNode == 0 || m_options.samplingResolution == 0)
+    {
+        throw std::invalid_argument("BigGridLOD: maxPointsPerNode and samplingResolution must be positive");
+    }
+    subdivide();
+}
+
+template<typename BaseVecT>
+void BigGridLOD<BaseVecT>::subdivide()
+{
+    const auto& cells = m_grid.getCells();
+
+    Node root;
+    Vector3i max = Vector3i::Constant(std::numeric_limits<int>::min());
+    root.origin = Vector3i::Constant(std::numeric_limits<int>::max());
+    for (const auto& [index, cell] : cells)
+    {
+        if (cell.size == 0)
+        {
+            continue;
+        }
+        root.cells.push_back(index);
+        root.numPoints += cell.size;
+        root.origin = root.origin.cwiseMin(index);
+        max = max.cwiseMax(index);
+    }
+
+    m_nodes.clear();
+    m_levels = { 0 };
+    if (root.cells.empty())
+    {
+        return;
+    }
+
+    // Sort the cells, so the result does not depend on the hash map
+    std::sort(root.cells.begin(), root.cells.end(), [](const Vector3i& a, const Vector3i& b)
+    {
+        return std::lexicographical_compare(a.data(), a.data() + 3, b.data(), b.data() + 3);
+    });
+
+    int extent = (max - root.origin).maxCoeff() + 1;
+    root.size = 1;
+    while (root.size < extent)
+    {
+        root.size *= 2;
+    }
+
+    m_nodes.push_back(std::move(root));
+    m_levels.push_back(1);
+
+    while (true)
+    {
+        const size_t begin = m_levels[m_levels.size() - 2];
+        const size_t end = m_levels.back();
+
+        std::vector<std::vector<Node>> children(end - begin);
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = begin; i < end; i++)
+        {
+            Node& node = m_nodes[i];
+            if (node.numPoints <= m_options.maxPointsPerNode || node.size == 1)
+            {
+                continue;
+            }
+
+            const int half = node.size / 2;
+            std::array<Node, 8> octants;
+            for (int o = 0; o < 8; o++)
+            {
+                octants[o].origin = node.origin + Vector3i(o & 1, (o >> 1) & 1, (o >> 2) & 1) * half;
+                octants[o].size = half;
+                octants[o].depth = node.depth + 1;
+            }
+
+            for (const Vector3i& cell : node.cells)
+            {
+                Vector3i local = cell - node.origin;
+                int o = (local.x() >= half) | (local.y() >= half) << 1 | (local.z() >= half) << 2;
+                octants[o].cells.push_back(cell);
+                octants[o].numPoints += cells.at(cell).size;
+            }
+
+            for (auto& octant : octants)
+            {
+                if (octant.numPoints > 0)
+                {
+                    children[i - begin].push_back(std::move(octant));
+                }
+            }
+
+            // Only leaves need their cells
+            node.cells.clear();
+            node.cells.shrink_to_fit();
+        }
+
+        const size_t first = m_nodes.size();
+        for (size_t i = begin; i < end; i++)
+        {
+            m_nodes[i].firstChild = children[i - begin].empty() ? 0 : m_nodes.size();
+            m_nodes[i].numChildren = children[i - begin].size();
+            for (auto& child : children[i - begin])
+            {
+                m_nodes.push_back(std::move(child));
+            }
+        }
+
+        if (m_nodes.size() == first)
+        {
+            break;
+        }
+        m_levels.push_back(m_nodes.size());
+    }
+
+    lvr2::logout::get() << lvr2::info << "[BigGridLOD] Created " << m_nodes.size() << " nodes on "
+                        << numLevels() << " levels" << lvr2::endl;
+}
+
+template<typename BaseVecT>
+typename BigGridLOD<BaseVecT>::Sample BigGridLOD<BaseVecT>::loadLeaf(const Node& node) const
+{
+    Sample leaf;
+    leaf.points.reserve(3 * node.numPoints);
+
+    for (const Vector3i& cell : node.cells)
+    {
+        size_t n = 0;
+        floatArr points = m_grid.points(cell, n);
+        leaf.points.insert(leaf.points.end(), points.get(), points.get() + 3 * n);
+
+        if (m_grid.hasNormals())
+        {
+            floatArr normals = m_grid.normals(cell, n);
+            leaf.normals.insert(leaf.normals.end(), normals.get(), normals.get() + 3 * n);
+        }
+        if (m_grid.hasColors())
+        {
+            ucharArr colors = m_grid.colors(cell, n);
+            leaf.colors.insert(leaf.colors.end(), colors.get(), colors.get() + 3 * n);
+        }
+    }
+
+    return leaf;
+}
+
+template<typename BaseVecT>
+typename BigGridLOD<BaseVecT>::Sample BigGridLOD<BaseVecT>::subsample(const Sample& in) const
+{
+    const size_t n = in.size();
+    if (n == 0)
+    {
+        return Sample();
+    }
+
+    // The sampling grid covers the bounding cube of the points. The cell
+    // indices of the points are not used, because the grid may have been
+    // built with a scale.
+    float min[3], max[3];
+    for (int d = 0; d < 3; d++)
+    {
+        min[d] = max[d] = in.points[d];
+    }
+    for (size_t i = 1; i < n; i++)
+    {
+        for (int d = 0; d < 3; d++)
+        {
+            min[d] = std::min(min[d], in.points[3 * i + d]);
+            max[d] = std::max(max[d], in.points[3 * i + d]);
+        }
+    }
+    const float side = std::max({ max[0] - min[0], max[1] - min[1], max[2] - min[2] });
+    const uint64_t res = m_options.samplingResolution;
+    const float voxel = side / res;
+    const float scale = side > 0 ? res / side : 0.0f;
+
+    std::vector<uint64_t> keys(n);
+    std::vector<float> distances(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t key = 0;
+        float distance = 0.0f;
+        for (int d = 0; d < 3; d++)
+        {
+            float p = in.points[3 * i + d];
+            uint64_t c = std::min<uint64_t>(res - 1, static_cast<uint64_t>((p - min[d]) * scale));
+            float offset = p - (min[d] + (c + 0.5f) * voxel);
+            key = key * res + c;
+            distance += offset * offset;
+        }
+        keys[i] = key;
+        distances[i] = distance;
+    }
+
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+    {
+        if (keys[a] != keys[b])
+        {
+            return keys[a] < keys[b];
+        }
+        if (distances[a] != distances[b])
+        {
+            return distances[a] < distances[b];
+        }
+        return a < b;
+    });
+
+    Sample out;
+    for (size_t j = 0; j < n; j++)
+    {
+        if (j > 0 && keys[order[j]] == keys[order[j - 1]])
+        {
+            continue;
+        }
+        const size_t i = order[j];
+        out.points.insert(out.points.end(), &in.points[3 * i], &in.points[3 * i] + 3);
+        if (!in.normals.empty())
+        {
+            out.normals.insert(out.normals.end(), &in.normals[3 * i], &in.normals[3 * i] + 3);
+        }
+        if (!in.colors.empty())
+        {
+            out.colors.insert(out.colors.end(), &in.colors[3 * i], &in.colors[3 * i] + 3);
+        }
+    }
+
+    return out;
+}
+
+template<typename BaseVecT>
+void BigGridLOD<BaseVecT>::write(const std::string& directory) const
+{
+    PointLODIO io(directory);
+
+    PointLODMetadata metadata;
+    metadata.numPoints = m_nodes.empty() ? 0 : m_nodes[0].numPoints;
+    metadata.maxDepth = numLevels() > 0 ? numLevels() - 1 : 0;
+    metadata.samplingResolution = m_options.samplingResolution;
+    metadata.hasNormals = m_grid.hasNormals();
+    metadata.hasColors = m_grid.hasColors();
+    io.beginWrite(metadata);
+
+    std::vector<PointLODNode> records(m_nodes.size());
+
+    // Subsamples of the finished nodes, kept until their parent is written
+    std::vector<Sample> samples(m_nodes.size());
+    size_t numStoredPoints = 0;
+
+    lvr2::Monitor progress(lvr2::LogLevel::info, "[BigGridLOD] Writing nodes", m_nodes.size());
+
+    for (size_t level = numLevels(); level-- > 0;)
+    {
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:numStoredPoints)
+        for (size_t i = m_levels[level]; i < m_levels[level + 1]; i++)
+        {
+            const Node& node = m_nodes[i];
+
+            Sample data;
+            if (node.numChildren == 0)
+            {
+                data = loadLeaf(node);
+            }
+            else
+            {
+                Sample merged;
+                for (size_t c = node.firstChild; c < node.firstChild + node.numChildren; c++)
+                {
+                    merged.append(samples[c]);
+                    samples[c] = Sample();
+                }
+                data = subsample(merged);
+            }
+
+            // Leaves are bounded by all of their points. The subsample of an inner node may miss
+            // the extreme points, so its bounds are the union of its children's bounds, which
+            // were written on the level below.
+            PointLODNode& record = records[i];
+            for (int d = 0; d < 3; d++)
+            {
+                record.min[d] = std::numeric_limits<float>::max();
+                record.max[d] = std::numeric_limits<float>::lowest();
+            }
+            if (node.numChildren == 0)
+            {
+                for (size_t j = 0; j < data.size(); j++)
+                {
+                    for (int d = 0; d < 3; d++)
+                    {
+                        record.min[d] = std::min(record.min[d], data.points[3 * j + d]);
+                        record.max[d] = std::max(record.max[d], data.points[3 * j + d]);
+                    }
+                }
+            }
+            else
+            {
+                for (size_t c = node.firstChild; c < node.firstChild + node.numChildren; c++)
+                {
+                    for (int d = 0; d < 3; d++)
+                    {
+                        record.min[d] = std::min(record.min[d], records[c].min[d]);
+                        record.max[d] = std::max(record.max[d], records[c].max[d]);
+                    }
+                }
+            }
+            record.numPoints = data.size();
+            record.firstChild = node.firstChild;
+            record.numChildren = node.numChildren;
+            record.depth = node.depth;
+            record.reserved = 0;
+            record.byteOffset = io.writeNodeData(data.points.data(), data.normals.data(), data.colors.data(), data.size());
+            numStoredPoints += data.size();
+
+            if (i != 0)
+            {
+                samples[i] = node.numChildren == 0 ? subsample(data) : std::move(data);
+            }
+
+            ++progress;
+        }
+    }
+
+    progress.terminate();
+
+    metadata.numStoredPoints = numStoredPoints;
+    if (!records.empty())
+    {
+        std::copy_n(records[0].min, 3, metadata.min);
+        std::copy_n(records[0].max, 3, metadata.max);
+    }
+    io.finishWrite(records, metadata);
+
+    lvr2::logout::get() << lvr2::info << "[BigGridLOD] Wrote " << numStoredPoints << " points in "
+                        << m_nodes.size() << " nodes to " << directory << lvr2::endl;
+}
+
+} // namespace lvr2
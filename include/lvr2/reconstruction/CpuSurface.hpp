@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * CpuSurface.hpp
+ *
+ * @date 18.10.2026
+ */
+
+#pragma once
+
+#include "lvr2/reconstruction/QueryPoint.hpp"
+#include "lvr2/geometry/BaseVector.hpp"
+
+#include <boost/shared_array.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lvr2
+{
+
+/**
+ * @brief CPU implementation of the interface of CudaSurface and ClSurface.
+ *
+ * The points are sorted along a Morton curve and a linear bounding volume
+ * hierarchy is built by splitting the sorted points at the highest differing
+ * bit of their Morton codes. The hierarchy answers exact k-nearest neighbor
+ * queries. The points are stored as separate coordinate arrays, so the
+ * distances of all points in a leaf are computed with SIMD instructions. All
+ * queries run in parallel with OpenMP.
+ *
+ * Normal estimation, normal interpolation and the signed distance kernel use
+ * the same formulas as the GPU implementations, so this class can be used as
+ * a drop-in replacement on machines without CUDA or OpenCL.
+ */
+class CpuSurface
+{
+public:
+    using Vec = BaseVector<float>;
+    using floatArr = boost::shared_array<float>;
+
+    /**
+     * @brief Constructor. Builds the search index.
+     *
+     * @param points        Input point cloud. Has to be kept in memory by the caller.
+     * @param num_points    Number of points in the cloud
+     * @param numThreads    Number of threads to use. -1 for all cores.
+     */
+    CpuSurface(floatArr& points, size_t num_points, int numThreads = -1);
+
+    ~CpuSurface() = default;
+
+    /**
+     * @brief Starts the calculation of the normals. The normals are estimated
+     *        from the kn nearest neighbors, oriented towards the flip point and
+     *        smoothed over the ki nearest neighbors.
+     */
+    void calculateNormals();
+
+    /**
+     * @brief Get the resulting normals of the normal calculation. After calling "calculateNormals".
+     *
+     * @param output_normals     Array of size 3 * num_points as return value
+     */
+    void getNormals(floatArr output_normals);
+
+    /**
+     * @brief Use the given normals for the distance calculation instead of
+     *        calling calculateNormals.
+     *
+     * @param normals     Array of size 3 * num_points
+     */
+    void setNormals(floatArr normals);
+
+    /**
+     * @brief Set the number of k nearest neighbors
+     *        k-neighborhood
+     *
+     * @param k             The size of the used k-neighborhood
+     *
+     */
+    void setKn(int kn);
+
+    /**
+     * @brief Set the number of k nearest neighbors
+     *        k-neighborhood for interpolation
+     *
+     * @param k             The size of the used k-neighborhood
+     *
+     */
+    void setKi(int ki);
+
+    /**
+     * @brief Set the number of k nearest neighbors
+     *        k-neighborhood for distance. Like the GPU kernels, the distance
+     *        calculation always uses the 5 nearest neighbors.
+     *
+     * @param k             The size of the used k-neighborhood
+     *
+     */
+    void setKd(int kd);
+
+    /**
+     * @brief Set the viewpoint to orientate the normals
+     *
+     * @param v_x     Coordinate X axis
+     * @param v_y     Coordinate Y axis
+     * @param v_z     Coordinate Z axis
+     *
+     */
+    void setFlippoint(float v_x, float v_y, float v_z);
+
+    /**
+     * @brief Set Method for normal calculation. Only "PCA" is supported.
+     *
+     * @param method   "PCA"
+     *
+     */
+    void setMethod(const std::string& method);
+
+    /**
+     * @brief Only present for compatibility with the GPU implementations.
+     */
+    void setReconstructionMode(bool mode = true);
+
+    /**
+     * @brief Computes the signed distance of each query point to the surface
+     *        defined by the mean position and mean normal of its nearest points.
+     *
+     * @param query_points  The query points. Distances are written in place.
+     * @param voxel_size    Voxel size of the grid. Unused, as in the GPU kernels.
+     */
+    void distances(std::vector<QueryPoint<Vec> >& query_points, float voxel_size);
+
+    /**
+     * @brief Frees the search index and the normals. Named after the GPU
+     *        implementations for compatibility.
+     */
+    void freeGPU();
+
+private:
+
+    /// A node of the bounding volume hierarchy
+    struct Node
+    {
+        float min[3];
+        float max[3];
+        /// Leaves: first sorted point and number of points. Inner nodes: count is 0.
+        uint32_t first;
+        uint32_t count;
+        /// Children of inner nodes
+        uint32_t left;
+        uint32_t right;
+    };
+
+    /// Sorts the points along the Morton curve and builds the hierarchy
+    void buildIndex();
+
+    /**
+     * @brief Recursively creates the nodes for the sorted points [begin, end)
+     *        by splitting at the highest differing bit of their Morton codes.
+     *
+     * @return The index of the created node
+     */
+    uint32_t buildNode(const std::vector<uint64_t>& keys, size_t begin, size_t end);
+
+    /**
+     * @brief Exact k-nearest neighbor search.
+     *
+     * @param x, y, z       Query position
+     * @param k             Number of neighbors to search
+     * @param indices       Output: sorted positions (not original indices) of the neighbors
+     * @param distances     Output: squared distances of the neighbors, ascending
+     * @return              The number of neighbors found, min(k, num_points)
+     */
+    size_t kSearch(float x, float y, float z, size_t k, uint32_t* indices, float* distances) const;
+
+    /// Squared distance of a position to the bounding box of a node
+    float boxDistance(const Node& node, float x, float y, float z) const;
+
+    /// Maximum number of points per leaf
+    static constexpr size_t LeafSize = 32;
+
+    floatArr m_points;
+    size_t m_numPoints;
+    int m_numThreads;
+
+    // Points in Morton order as separate coordinate arrays, padded with
+    // LeafSize entries at infinity
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+
+    // Original index of each sorted point
+    std::vector<uint32_t> m_order;
+
+    // The hierarchy, root first. Children always have higher indices than
+    // their parent.
+    std::vector<Node> m_nodes;
+
+    // Normals in Morton order
+    std::vector<float> m_normals;
+
+    float m_vx, m_vy, m_vz;
+    int m_k, m_ki, m_kd;
+};
+
+} // namespace lvr2
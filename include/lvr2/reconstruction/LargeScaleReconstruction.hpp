@@ -34,6 +34,7 @@
 #include "lvr2/reconstruction/BigGrid.hpp"
 #include "lvr2/reconstruction/FastBox.hpp"
 #include "lvr2/reconstruction/PointsetGrid.hpp"
+#include "lvr2/reconstruction/CpuSurface.hpp"
 
 
 #if defined CUDA_FOUND
@@ -109,6 +110,10 @@ struct LSROptions
     /// Use GPU for signed distance computation.
     bool useGPUDistances = false;
 
+    /// Run the GPU normal and distance computation selected by useGPU and useGPUDistances
+    /// on the CPU with SIMD instructions. Used automatically if no GPU support is available.
+    bool useCPUSurface = false;
+
     /// voxelsizes for reconstruction. Only the first one produces most types of output.
     std::vector<float> voxelSizes{0.1};
 
@@ -152,6 +157,9 @@ struct LSROptions
     /// Maximum size for hole filling.
     uint fillHoles = 0;
 
+    /// Fill holes by a minimal weight triangulation instead of collapsing their edges.
+    bool triangulateHoles = false;
+
     /// Shift all triangle vertices of a cluster onto their shared plane.
     bool optimizePlanes = false;
 
@@ -232,10 +240,10 @@ struct LSROptions
         fs::create_directories(tempDir);
 
 #ifndef GPU_FOUND
-        if (useGPU || useGPUDistances)
+        if ((useGPU || useGPUDistances) && !useCPUSurface)
         {
-            std::cout << timestamp << "Warning: No GPU found. Falling back to CPU." << std::endl;
-            useGPU = useGPUDistances = false;
+            std::cout << timestamp << "Warning: No GPU found. Using the CPU implementation of the GPU kernels." << std::endl;
+            useCPUSurface = true;
         }
 #endif
 
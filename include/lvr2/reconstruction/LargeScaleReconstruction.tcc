@@ -607,7 +607,7 @@ namespace lvr2
             hasNormals = true;
         }
 
-        if (!hasNormals && m_options.useGPU)
+        if (!hasNormals && m_options.useGPU && !m_options.useCPUSurface)
         {
             float targetSize = voxelSize / 4;
             while (numPoints > maxPointsPerChunk)
@@ -633,61 +633,95 @@ namespace lvr2
         auto ps_grid = std::make_shared<lvr2::PointsetGrid<BaseVecT, BoxT>>(voxelSize, surface, bb, true, m_options.extrude);
 
 
-#ifdef GPU_FOUND
         if ((!hasNormals && m_options.useGPU) || (!hasDistances && m_options.useGPUDistances))
         {
             floatArr points = p_loader->getPointArray();
-            lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] Generate GPU kd-tree..." << lvr2::endl;
-
-            GpuSurface gpu_surface(points, numPoints);
-
-            gpu_surface.setKn(m_options.kn);
-            gpu_surface.setKi(m_options.ki);
-            gpu_surface.setKd(m_options.kd);
-            gpu_surface.setFlippoint(flipPoint.x, flipPoint.y, flipPoint.z);
 
-            if (!hasNormals && m_options.useGPU)
+            // Runs the selected computations on either surface implementation.
+            // Missing normals are computed on the surface if calcNormals is set.
+            // Returns false if the chunk has to be retried with fewer points.
+            auto computeOnSurface = [&](auto& gpu_surface, bool calcNormals)
             {
-                floatArr normals = floatArr(new float[numPoints * 3]);
-                try
-                {
-                    gpu_surface.calculateNormals();
-                }
-                catch(std::runtime_error& e)
+                gpu_surface.setKn(m_options.kn);
+                gpu_surface.setKi(m_options.ki);
+                gpu_surface.setKd(m_options.kd);
+                gpu_surface.setFlippoint(flipPoint.x, flipPoint.y, flipPoint.z);
+
+                if (!hasNormals && calcNormals)
                 {
-                    std::string msg = e.what();
-                    if (msg.find("out of memory") == std::string::npos)
+                    floatArr normals = floatArr(new float[numPoints * 3]);
+                    try
                     {
-                        throw; // forward any other exceptions
+                        gpu_surface.calculateNormals();
                     }
-                    lvr2::logout::get() << lvr2::error << "[LargeScaleReconstruction] Not enough GPU memory. Reducing Points further." << lvr2::endl;
-                    maxPointsPerChunk = maxPointsPerChunk * 0.8;
-                    if (maxPointsPerChunk < minPointsPerChunk)
+                    catch(std::runtime_error& e)
                     {
-                        lvr2::logout::get() << lvr2::warning << "[LargeScaleReconstruction] Your GPU is garbage. Switching back to CPU" << lvr2::endl;
-                        m_options.useGPU = false;
+                        std::string msg = e.what();
+                        if (msg.find("out of memory") == std::string::npos)
+                        {
+                            throw; // forward any other exceptions
+                        }
+                        lvr2::logout::get() << lvr2::error << "[LargeScaleReconstruction] Not enough GPU memory. Reducing Points further." << lvr2::endl;
+                        maxPointsPerChunk = maxPointsPerChunk * 0.8;
+                        if (maxPointsPerChunk < minPointsPerChunk)
+                        {
+                            lvr2::logout::get() << lvr2::warning << "[LargeScaleReconstruction] Your GPU is garbage. Switching back to CPU" << lvr2::endl;
+                            m_options.useGPU = false;
+                        }
+                        return false;
                     }
+                    gpu_surface.getNormals(normals);
+
+                    p_loader->setNormalArray(normals, numPoints);
+                    hasNormals = true;
+                }
+
+                if(!hasDistances && m_options.useGPUDistances)
+                {
+                    auto& query_points = ps_grid->getQueryPoints();
+
+                    lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] Computing signed distances with brute force kernel." << lvr2::endl;
+                    lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] This might take a while...." << lvr2::endl;
+                    gpu_surface.distances(query_points, voxelSize);
+                    hasDistances = true;
+                    lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] Done." << lvr2::endl;
+                }
+                return true;
+            };
+
+            if (m_options.useCPUSurface)
+            {
+                lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] Generate CPU search index..." << lvr2::endl;
+
+                CpuSurface cpu_surface(points, numPoints);
+                if (hasNormals)
+                {
+                    // distances only, use the existing normals
+                    cpu_surface.setNormals(p_loader->getNormalArray());
+                }
+
+                // The distance kernel needs normals on the same surface, so they are
+                // computed here even if only the distances were requested
+                if (!computeOnSurface(cpu_surface, true))
+                {
                     retry = true;
                     return nullptr;
                 }
-                gpu_surface.getNormals(normals);
-
-                p_loader->setNormalArray(normals, numPoints);
-                hasNormals = true;
             }
-
-            if(!hasDistances && m_options.useGPUDistances)
+#ifdef GPU_FOUND
+            else
             {
-                auto& query_points = ps_grid->getQueryPoints();
+                lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] Generate GPU kd-tree..." << lvr2::endl;
 
-                lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] Computing signed distances in GPU with brute force kernel." << lvr2::endl;
-                lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] This might take a while...." << lvr2::endl;
-                gpu_surface.distances(query_points, voxelSize);
-                hasDistances = true;
-                lvr2::logout::get() << lvr2::info << "[LargeScaleReconstruction] Done." << lvr2::endl;
+                GpuSurface gpu_surface(points, numPoints);
+                if (!computeOnSurface(gpu_surface, m_options.useGPU))
+                {
+                    retry = true;
+                    return nullptr;
+                }
             }
-        }
 #endif // GPU_FOUND
+        }
 
         if (!hasNormals)
         {
@@ -894,7 +928,11 @@ namespace lvr2
         }
 
         if (m_options.fillHoles) {
-            naiveFillSmallHoles(mesh, m_options.fillHoles, false);
+            if (m_options.triangulateHoles) {
+                triangulateSmallHoles(mesh, m_options.fillHoles);
+            } else {
+                naiveFillSmallHoles(mesh, m_options.fillHoles, false);
+            }
         }
 
 
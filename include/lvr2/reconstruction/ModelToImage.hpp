@@ -65,31 +65,69 @@ public:
 
     typedef struct PanoPoint
     {
+        PanoPoint() : index(0) {}
         PanoPoint(size_t index_) : index(index_) {}
         size_t index;
     } PanoramaPoint;
 
-    /// Image with single depth information
+    /// Image with single depth information, stored row by row
     typedef struct DI
     {
-        vector<vector<float> > pixels;
+        vector<float> pixels;
+        int     width;
+        int     height;
         float   maxRange;
         float   minRange;
         DI() :
+            width(0), height(0),
             maxRange(std::numeric_limits<float>::lowest()),
             minRange(std::numeric_limits<float>::max()) {}
 
+        /// Depth of the pixel in row i and column j
+        float& at(int i, int j) { return pixels[(size_t)i * width + j]; }
+        float at(int i, int j) const { return pixels[(size_t)i * width + j]; }
+
     } DepthImage;
 
-    /// Image with list of projected points at each pixel
+    ///
+    /// \brief Image with list of projected points at each pixel
+    ///
+    /// The points of all pixels are stored in one array, sorted row by row.
+    /// The points of the pixel with the row-major index p = i * width + j are
+    /// points[offsets[p]] to points[offsets[p + 1] - 1], in ascending order
+    /// of their index in the point buffer.
+    ///
     typedef struct PLI
     {
-        vector<vector<vector<PanoramaPoint> > > pixels;
+        vector<size_t>          offsets;
+        vector<PanoramaPoint>   points;
+        int     width;
+        int     height;
         float   maxRange;
         float   minRange;
         PLI() :
+            width(0), height(0),
             maxRange(std::numeric_limits<float>::lowest()),
             minRange(std::numeric_limits<float>::max()) {}
+
+        /// Number of points projected to the pixel in row i and column j
+        size_t size(int i, int j) const
+        {
+            size_t p = (size_t)i * width + j;
+            return offsets[p + 1] - offsets[p];
+        }
+
+        /// First point projected to the pixel in row i and column j
+        const PanoramaPoint* begin(int i, int j) const
+        {
+            return points.data() + offsets[(size_t)i * width + j];
+        }
+
+        /// End of the points projected to the pixel in row i and column j
+        const PanoramaPoint* end(int i, int j) const
+        {
+            return points.data() + offsets[(size_t)i * width + j + 1];
+        }
     } DepthListMatrix;
 
 
@@ -187,6 +225,25 @@ public:
 
 private:
 
+    ///
+    /// \brief Projects all points of the buffer in parallel
+    ///
+    /// \param pixels       Row-major pixel index of each point
+    /// \param ranges       Range of each point
+    /// \param minRange     Minimal range of all points
+    /// \param maxRange     Maximal range of all points
+    ///
+    void projectPoints(vector<int>& pixels, vector<float>& ranges, float& minRange, float& maxRange);
+
+    ///
+    /// \brief Sorts the point indices into per pixel buckets (counting sort).
+    ///         Points with a negative pixel index are skipped.
+    ///
+    /// \param pixels       Row-major pixel index of each point
+    /// \param offsets      Start of the bucket of each pixel, width * height + 1 entries
+    /// \param points       The sorted point indices
+    ///
+    void bucketPoints(const vector<int>& pixels, vector<size_t>& offsets, vector<PanoramaPoint>& points);
 
     /// Pointer to projection
     Projection*         m_projection;
@@ -42,6 +42,13 @@ public:
 
     virtual void project(int&i , int&j, float& r, float x, float y, float z) = 0;
 
+    ///
+    /// \brief Projects n points given as consecutive x, y, z values in parallel.
+    ///         Points that can't be projected are mapped to pixel (0, 0) with
+    ///         range 0.
+    ///
+    virtual void projectPoints(const float* points, size_t n, int* i, int* j, float* r);
+
     int w() { return m_width;}
     int h() { return m_height;}
 
@@ -78,6 +85,8 @@ public:
 
     virtual void project(int&i , int&j, float& r, float x, float y, float z) override;
 
+    virtual void projectPoints(const float* points, size_t n, int* i, int* j, float* r) override;
+
 protected:
     float       m_xFactor;
     float       m_yFactor;
@@ -39,6 +39,8 @@
 #include "lvr2/algorithm/KDTree.hpp"
 
 #include <Eigen/SparseCore>
+#include <cstdint>
+#include <unordered_map>
 
 namespace lvr2
 {
@@ -55,6 +57,95 @@ namespace lvr2
  */
 bool findCloseScans(const std::vector<SLAMScanPtr>& scans, size_t scan, const SLAMOptions& options, std::vector<size_t>& output);
 
+/**
+ * @brief Same as findCloseScans, but tests every earlier Scan exactly instead of using a CloseScanIndex
+ *
+ * This is the reference for the CloseScanIndex and is used by SLAMOptions::verifyCloseScans.
+ * It counts all pairs with closeLoopPairs, so it is only feasible for short trajectories.
+ */
+bool findCloseScansExhaustive(const std::vector<SLAMScanPtr>& scans, size_t scan, const SLAMOptions& options, std::vector<size_t>& output);
+
+/**
+ * @brief Spatial index over the Scans of a trajectory to find loop closing candidates
+ *
+ * The Scans are sorted into a uniform grid, so that a query only looks at the Scans in the
+ * neighboring cells instead of all earlier Scans. Without closeLoopPairs, the grid is built over
+ * the positions of the Scans with a cell size of closeLoopDistance. With closeLoopPairs, it is
+ * built over the centers of the bounding boxes of the Scans, and only Scans whose bounding
+ * spheres are within slamMaxDistance of each other are tested for pairs. The number of pairs
+ * is estimated from a subsample of the other Scan, using the cached localKDTree of the current
+ * Scan, and the test stops as soon as the result is certain.
+ *
+ * The index stores the poses of its Scans. update() adds new Scans and rebuilds the index if
+ * any of the stored poses changed. The Points of the indexed Scans must not change.
+ */
+class CloseScanIndex
+{
+public:
+    /**
+     * @brief Creates the index over scans[0] to scans[last]
+     *
+     * @param scans   A vector with all Scans
+     * @param last    The index of the last Scan to consider
+     * @param options The options on how to search
+     */
+    CloseScanIndex(const std::vector<SLAMScanPtr>& scans, size_t last, const SLAMOptions& options);
+
+    /**
+     * @brief Extends the index to scans[0] to scans[last]
+     *
+     * Only the new Scans are added, unless the pose of an indexed Scan or the options changed.
+     * In that case, the index is rebuilt.
+     *
+     * @param last    The index of the last Scan to consider
+     */
+    void update(size_t last);
+
+    /**
+     * @brief Same as the free function findCloseScans, using the index
+     *
+     * With SLAMOptions::verifyCloseScans, the result is compared to findCloseScansExhaustive
+     * and any difference is printed.
+     *
+     * @param scan    The index of the scan. Has to be <= last
+     * @param output  Will be filled with the indices of all close Scans in ascending order
+     *
+     * @return true if any Scans were found, false otherwise
+     */
+    bool findCloseScans(size_t scan, std::vector<size_t>& output) const;
+
+private:
+    using CellKey = uint64_t;
+
+    CellKey cellKey(const Vector3d& p) const;
+
+    /// findCloseScans without the verification
+    void searchCloseScans(size_t scan, std::vector<size_t>& output) const;
+
+    /**
+     * @brief Estimates if the Scans scan and other have at least closeLoopPairs pairs
+     */
+    bool enoughPairs(size_t scan, size_t other, const KDTreePtr<Vector3f>& tree) const;
+
+    const std::vector<SLAMScanPtr>& m_scans;
+    const SLAMOptions&              m_options;
+
+    /// true if the index is built for closeLoopPairs instead of closeLoopDistance
+    bool                            m_usePairs;
+    double                          m_cellSize;
+
+    /// The position (closeLoopDistance) or bounding box center (closeLoopPairs) of each Scan
+    std::vector<Vector3d>           m_centers;
+    /// The radius of the bounding sphere around m_centers of each Scan
+    std::vector<double>             m_radii;
+    /// The largest radius in m_radii
+    double                          m_maxRadius;
+    /// The pose of each Scan when it was added to the index
+    std::vector<Transformd>         m_poses;
+
+    std::unordered_map<CellKey, std::vector<size_t>> m_grid;
+};
+
 /**
  * @brief Wrapper class for running GraphSLAM on Scans
  */
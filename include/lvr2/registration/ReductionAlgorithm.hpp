@@ -32,6 +32,7 @@
 #include "lvr2/algorithm/BaseBufferManipulators.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace lvr2
 {
@@ -168,6 +169,37 @@ public:
      }
 };
 
+/**
+ * @brief ReductionAlgorithm implementation that applies several
+ *        reduction algorithms one after another
+ */
+class SequentialReductionAlgorithm : public ReductionAlgorithm
+{
+public:
+     /**
+      * @param reductions     The reductions in the order they are applied
+      */
+     SequentialReductionAlgorithm(std::vector<ReductionAlgorithmPtr> reductions) :
+          m_reductions(std::move(reductions)) {};
+
+     virtual PointBufferPtr getReducedPoints()
+     {
+          PointBufferPtr points = m_pointBuffer;
+          for (auto& reduction : m_reductions)
+          {
+               if (!points)
+               {
+                    break;
+               }
+               reduction->setPointBuffer(points);
+               points = reduction->getReducedPoints();
+          }
+          return points;
+     }
+private:
+     std::vector<ReductionAlgorithmPtr> m_reductions;
+};
+
 } // namespace lvr2
 
 #endif // LVR2_REDUCTION_ALGORITHM_HPP
\ No newline at end of file
@@ -39,6 +39,8 @@
 #include "SLAMOptions.hpp"
 #include "GraphSLAM.hpp"
 
+#include <memory>
+
 namespace lvr2
 {
 
@@ -66,6 +68,17 @@ public:
      */
     SLAMAlign(const SLAMOptions& options = SLAMOptions(), std::vector<bool> new_scans = std::vector<bool>());
 
+    /**
+     * @brief Copies the Options, Scans and registration state of another instance
+     *
+     * The GraphSLAM instance uses the copied Options, and the index of loop closing candidates
+     * is rebuilt on the next use.
+     */
+    SLAMAlign(const SLAMAlign& other);
+
+    /// see SLAMAlign(const SLAMAlign&)
+    SLAMAlign& operator=(const SLAMAlign& other);
+
     virtual ~SLAMAlign() = default;
 
     /**
@@ -181,6 +194,8 @@ protected:
     SLAMScanPtr              m_metascan;
 
     GraphSLAM                m_graph;
+    /// Loop closing candidates of the matched Scans, extended by checkLoopClose
+    std::unique_ptr<CloseScanIndex> m_closeScans;
     bool                     m_foundLoop;
     int                      m_loopIndexCount;
 
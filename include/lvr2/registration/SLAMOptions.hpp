@@ -108,6 +108,10 @@ struct SLAMOptions
     /// For Loopclosing, this value needs to be at least 6, for GraphSLAM at least 1
     int     loopSize = 20;
 
+    /// Compare the close Scans found with the spatial index to an exhaustive search and print any difference.
+    /// Only useful for checking the index, since the exhaustive search is quadratic in the number of Scans
+    bool    verifyCloseScans = false;
+
     /// Number of ICP iterations during Loopclosing and number of GraphSLAM iterations
     int     slamIterations = 50;
 
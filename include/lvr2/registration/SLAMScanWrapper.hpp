@@ -38,6 +38,7 @@
 #include "lvr2/algorithm/KDTree.hpp"
 
 #include <Eigen/Dense>
+#include <mutex>
 #include <vector>
 
 namespace lvr2
@@ -210,6 +211,28 @@ public:
 
     KDTreePtr<Vector3f> createKDTree(size_t maxLeafSize = 20) const;
 
+    /**
+     * @brief Returns a KDTree of the Points in local Coordinates
+     *
+     * Unlike createKDTree, the tree does not depend on the current Pose. It is created on the
+     * first call and reused until the Points of the Scan change (reduce, setMinDistance,
+     * setMaxDistance). Queries have to be transformed into the local Coordinate System first.
+     *
+     * @param maxLeafSize the maximum number of Points per leaf if the tree has to be created
+     * @return KDTreePtr<Vector3f> the cached tree
+     */
+    KDTreePtr<Vector3f> localKDTree(size_t maxLeafSize = 20) const;
+
+    /**
+     * @brief Returns the axis aligned bounding box of the Points in local Coordinates
+     *
+     * The box is cached just like localKDTree. It is empty (min > max) if the Scan has no Points.
+     *
+     * @param min Will be set to the minimum corner of the box
+     * @param max Will be set to the maximum corner of the box
+     */
+    void localBoundingBox(Vector3f& min, Vector3f& max) const;
+
     /**
      * @brief Finds the nearest neighbors of all points in a Scan using a pre-generated KDTree
      *
@@ -242,6 +265,11 @@ public:
                                    std::vector<Vector3f*>& neighbors, double maxDistance);
 
 protected:
+    /**
+     * @brief Drops the cached local KDTree and bounding box after the Points changed
+     */
+    void invalidateLocalCache();
+
     ScanPtr               m_scan;
 
     std::vector<Vector3f> m_points;
@@ -250,6 +278,13 @@ protected:
     Transformd            m_deltaPose;
 
     std::vector<std::pair<Transformd, FrameUse>> m_frames;
+
+    /// see localKDTree()
+    mutable KDTreePtr<Vector3f> m_localTree;
+    /// see localBoundingBox()
+    mutable Vector3f m_localMin, m_localMax;
+    mutable bool     m_localBoxValid = false;
+    mutable std::mutex m_localCacheMutex;
 };
 
 using SLAMScanPtr = std::shared_ptr<SLAMScanWrapper>;
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * AsciiUtil.hpp
+ *
+ *  @date 19.10.2026
+ */
+
+#ifndef LVR2_UTIL_ASCIIUTIL_H_
+#define LVR2_UTIL_ASCIIUTIL_H_
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <locale.h>
+
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+namespace lvr2
+{
+
+/**
+ * @brief Tokenizing and number conversion for ASCII formats that are read
+ *        from memory mapped files.
+ *
+ * Numbers are always read and written in the C locale, independent of the
+ * global locale of the application.
+ */
+namespace asciiutil
+{
+
+/// The C locale used for all number conversions
+inline locale_t cLocale()
+{
+    static const locale_t locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    return locale;
+}
+
+/// Blanks separate the tokens of a line. Line breaks are not blanks.
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/// Returns the first character at or behind p that is not blank
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while(p < end && isBlank(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+/// Returns the end of the token starting at p
+inline const char* tokenEnd(const char* p, const char* end)
+{
+    while(p < end && !isBlank(*p) && *p != '\n')
+    {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Parses the next token as float and moves p behind it.
+ *
+ * The token is copied, since the mapped file is not null terminated.
+ * Tokens longer than 63 characters are cut off.
+ *
+ * @return false if the token does not start with a number
+ */
+inline bool parseFloat(const char*& p, const char* end, float& value)
+{
+    p = skipBlanks(p, end);
+    const char* e = tokenEnd(p, end);
+
+    char token[64];
+    size_t length = std::min<size_t>(e - p, sizeof(token) - 1);
+    std::memcpy(token, p, length);
+    token[length] = '\0';
+    p = e;
+
+    char* parsed;
+    value = strtof_l(token, &parsed, cLocale());
+    return parsed != token;
+}
+
+/**
+ * @brief Writes the value like printf("%g") and returns the end of the
+ *        written characters. The buffer needs room for 32 characters.
+ */
+inline char* formatFloat(char* buffer, double value)
+{
+    locale_t previous = uselocale(cLocale());
+    int length = std::snprintf(buffer, 32, "%g", value);
+    uselocale(previous);
+    return buffer + std::max(0, length);
+}
+
+} // namespace asciiutil
+
+} // namespace lvr2
+
+#endif /* LVR2_UTIL_ASCIIUTIL_H_ */
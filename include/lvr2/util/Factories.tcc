@@ -31,6 +31,7 @@
 
 #include <algorithm>
 
+#include "lvr2/algorithm/KDTree.hpp"
 #include "lvr2/reconstruction/SearchTreeFlann.hpp"
 #include "lvr2/reconstruction/SearchTree.hpp"
 #include "lvr2/types/PointBuffer.hpp"
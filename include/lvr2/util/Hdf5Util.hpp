@@ -18,6 +18,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 // LVR internal includes
@@ -369,6 +370,69 @@ YAML::Node getAttributeMeta(
     const HT& g
 );
 
+/**
+ * @brief Computes chunk dimensions for a row-major dataset so that a chunk
+ *        holds about chunkBytes bytes. Chunks span the trailing dimensions
+ *        completely as long as possible.
+ * 
+ * @param dims          Dimensions of the dataset
+ * @param elementSize   Size of a single element in bytes
+ * @param chunkBytes    Desired size of a chunk in bytes
+ * @return std::vector<hsize_t> Chunk dimensions, empty if the dataset is empty
+ */
+std::vector<hsize_t> computeChunkSize(
+    const std::vector<size_t>& dims,
+    size_t elementSize,
+    size_t chunkBytes);
+
+/**
+ * @brief Writes the complete dataset by filtering its chunks in parallel and
+ *        passing them to HDF5 with direct chunk writes. Only datasets whose
+ *        filter pipeline consists of deflate, optionally preceded by shuffle,
+ *        are supported.
+ * 
+ * @param dataset       A chunked dataset of a native integer or float type
+ * @param data          Row-major data of the whole dataset
+ * @param elementSize   Size of a single element in bytes
+ * @param numThreads    Number of threads, OpenMPConfig::getNumThreads() if <= 0
+ * @return false if the dataset is not supported or consists of a single or
+ *         very large chunks, which HDF5 handles better on its own. Nothing
+ *         was written then.
+ */
+bool writeChunksParallel(
+    HighFive::DataSet& dataset,
+    const void* data,
+    size_t elementSize,
+    int numThreads = 0);
+
+/**
+ * @brief Reads the complete dataset with direct chunk reads and reverts the
+ *        filters of the chunks in parallel. Supports the same datasets
+ *        as writeChunksParallel.
+ * 
+ * @return false if the dataset is not supported or consists of a single or
+ *         very large chunks. Nothing was read then.
+ */
+bool readChunksParallel(
+    const HighFive::DataSet& dataset,
+    void* data,
+    size_t elementSize,
+    int numThreads = 0);
+
+/**
+ * @brief Writes data to the dataset, compressing the chunks in parallel
+ *        if possible
+ */
+template<typename T>
+void writeParallel(HighFive::DataSet& dataset, const T* data, int numThreads = 0);
+
+/**
+ * @brief Reads the dataset into data, decompressing the chunks in parallel
+ *        if possible
+ */
+template<typename T>
+void readParallel(const HighFive::DataSet& dataset, T* data, int numThreads = 0);
+
 
 
 } // namespace hdf5util
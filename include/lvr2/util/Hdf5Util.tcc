@@ -1086,6 +1086,32 @@ YAML::Node getAttributeMeta(
 }
 
 
+template<typename T>
+void writeParallel(HighFive::DataSet& dataset, const T* data, int numThreads)
+{
+    if constexpr(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value)
+    {
+        if(writeChunksParallel(dataset, data, sizeof(T), numThreads))
+        {
+            return;
+        }
+    }
+    dataset.write_raw(data);
+}
+
+template<typename T>
+void readParallel(const HighFive::DataSet& dataset, T* data, int numThreads)
+{
+    if constexpr(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value)
+    {
+        if(readChunksParallel(dataset, data, sizeof(T), numThreads))
+        {
+            return;
+        }
+    }
+    dataset.read(data);
+}
+
 } // namespace hdf5util
 
 } // namespace lvr2
\ No newline at end of file
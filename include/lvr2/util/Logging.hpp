@@ -76,7 +76,7 @@ public:
     template<typename T>
     void append(const T& token)
     {
-        m_buffer << token;
+        buffer() << token;
     }
 
     /**
@@ -88,18 +88,19 @@ public:
      */
     void setLogLevel(const LogLevel& level)
     {
-        m_level = level;
+        currentLevel() = level;
     }
 
 private:
-    /// spdlog logger instance
-    std::shared_ptr<spdlog::logger> m_logger;
+    /// Stringstream buffer of the calling thread. Each thread assembles
+    /// its messages separately, so concurrent log statements do not mix.
+    std::stringstream&              buffer();
 
-    /// Current log level
-    LogLevel                        m_level;
+    /// Current log level of the calling thread
+    LogLevel&                       currentLevel();
 
-    /// Stringstream buffer 
-    std::stringstream               m_buffer;
+    /// spdlog logger instance
+    std::shared_ptr<spdlog::logger> m_logger;
 };
 
 /**
@@ -159,6 +159,34 @@ void printCameraImageGroupStructure(const CameraImageGroupPtr p);
  */
 void printHyperspectralPanoramaStructure(const HyperspectralPanoramaPtr p);
 
+/**
+ * @brief Parameters of the pipelined project normal estimation
+ */
+struct ProjectNormalOptions
+{
+    /// Number of nearest neighbors for normal estimation
+    size_t kn = 10;
+
+    /// Number of nearest neighbors for normal interpolation
+    size_t ki = 10;
+
+    /// Number of scans processed concurrently. 0 uses all cores.
+    size_t numThreads = 0;
+
+    /// Maximum number of loaded scans waiting for a free worker
+    size_t prefetch = 2;
+
+    /// Upper bound for the estimated memory of all scans in flight
+    /// in bytes. A single scan is always processed, even if it
+    /// exceeds the budget. 0 disables the limit.
+    size_t memoryBudget = 0;
+
+    /// Scans with at least this many points are processed alone
+    /// using all OpenMP threads. Smaller scans are processed
+    /// concurrently with one thread each.
+    size_t largeScanPoints = 5000000;
+};
+
 /**
  * @brief Estimates normals for each scan position in the 
  *        scan project. The results are written back to the
@@ -175,6 +203,22 @@ void estimateProjectNormals(
     size_t ki
 );
 
+/**
+ * @brief Estimates normals for each scan in the scan project
+ *        with overlapping I/O and computation. Scans are 
+ *        loaded ahead in the calling thread while the normals 
+ *        of previously loaded scans are computed and written 
+ *        back on a thread pool. Loading and saving are serialized,
+ *        since the kernels are not thread safe.
+ * 
+ * @param project   The scan project
+ * @param options   Neighborhood sizes, concurrency and memory limits
+ */
+void estimateProjectNormals(
+    ScanProjectPtr project,
+    const ProjectNormalOptions& options
+);
+
 /**
  * @brief Creates a scan project consisting of only the given 
  *        scan position indices
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * UnionFind.hpp
+ *
+ *  @date 18.10.2026
+ */
+
+#ifndef LVR2_UTIL_UNIONFIND_H_
+#define LVR2_UTIL_UNIONFIND_H_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace lvr2
+{
+
+/**
+ * @brief Disjoint sets over the indices [0, size) that can be merged
+ *        concurrently from several threads without locks.
+ *
+ * Roots are always linked below the smaller root, so the representative of
+ * every set is its smallest index. The final partition and its
+ * representatives therefore do not depend on the number of threads or the
+ * order of the unite() calls.
+ */
+class ConcurrentUnionFind
+{
+public:
+    /// Creates size singleton sets
+    explicit ConcurrentUnionFind(size_t size) : m_parent(size)
+    {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < size; i++)
+        {
+            m_parent[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Returns the representative (smallest index) of the set containing x
+    size_t find(size_t x)
+    {
+        while (true)
+        {
+            size_t parent = m_parent[x].load(std::memory_order_relaxed);
+            if (parent == x)
+            {
+                return x;
+            }
+            // Path halving. Parents only ever decrease, so a failed
+            // exchange means another thread already shortened the path.
+            size_t grandParent = m_parent[parent].load(std::memory_order_relaxed);
+            if (parent != grandParent)
+            {
+                m_parent[x].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+            }
+            x = grandParent;
+        }
+    }
+
+    /**
+     * @brief Merges the sets containing a and b
+     *
+     * @return true if a and b were in different sets before
+     */
+    bool unite(size_t a, size_t b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+            {
+                return false;
+            }
+            if (a < b)
+            {
+                std::swap(a, b);
+            }
+            // Link the larger root below the smaller one. Fails if a is
+            // no longer a root, in which case we retry with the new roots.
+            size_t expected = a;
+            if (m_parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+    }
+
+    /// The number of elements
+    size_t size() const
+    {
+        return m_parent.size();
+    }
+
+private:
+    std::vector<std::atomic<size_t>> m_parent;
+};
+
+} // namespace lvr2
+
+#endif /* LVR2_UTIL_UNIONFIND_H_ */
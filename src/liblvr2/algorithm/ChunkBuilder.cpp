@@ -46,6 +46,18 @@ ChunkBuilder::ChunkBuilder(
 {
 }
 
+ChunkBuilder::ChunkBuilder(std::shared_ptr<HalfEdgeMesh<BaseVector<float>>> originalMesh,
+                           std::vector<FaceHandle> faces,
+                           std::vector<VertexHandle> duplicateVertices,
+                           unsigned int numVertices)
+    : m_originalMesh(originalMesh),
+      m_numVertices(numVertices),
+      m_duplicateVertices(std::move(duplicateVertices)),
+      m_faces(std::move(faces)),
+      m_vertexUse(nullptr)
+{
+}
+
 ChunkBuilder::~ChunkBuilder() {}
 
 void ChunkBuilder::addFace(const FaceHandle& faceHandle)
@@ -334,9 +346,9 @@ MeshBufferPtr ChunkBuilder::buildMesh(
 
         // apply face attributes
         unsigned int attributedFaceIndex = m_faces[face].idx();
-        if (splitVertices->find(attributedFaceIndex) != splitVertices->end())
+        if (splitFaces->find(attributedFaceIndex) != splitFaces->end())
         {
-            attributedFaceIndex = splitVertices->at(attributedFaceIndex);
+            attributedFaceIndex = splitFaces->at(attributedFaceIndex);
         }
 
         // face channels
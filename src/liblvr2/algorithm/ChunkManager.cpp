@@ -37,10 +37,15 @@
 #include "lvr2/algorithm/ChunkManager.hpp"
 
 #include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/config/lvropenmp.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <boost/filesystem.hpp>
 #include <cmath>
+#include <limits>
+#include <tuple>
+#include <unordered_set>
 
 namespace
 {
@@ -652,11 +657,9 @@ void ChunkManager::cutLargeFaces(
 void ChunkManager::buildChunks(MeshBufferPtr mesh,
                                float maxChunkOverlap,
                                std::string savePath,
-                               std::string layer)
+                               std::string layer,
+                               const BoundingBox<BaseVector<float>>& changedArea)
 {
-    std::vector<ChunkBuilderPtr> chunkBuilders(getChunkAmount().x * getChunkAmount().y
-                                               * getChunkAmount().z);
-
     std::shared_ptr<HalfEdgeMesh<BaseVector<float>>> halfEdgeMesh
         = std::shared_ptr<HalfEdgeMesh<BaseVector<float>>>(
             new HalfEdgeMesh<BaseVector<float>>(mesh));
@@ -670,64 +673,160 @@ void ChunkManager::buildChunks(MeshBufferPtr mesh,
     // prepare mash to prevent faces from overlapping too much on chunk borders
     cutLargeFaces(halfEdgeMesh, maxChunkOverlap, splitVertices, splitFaces);
 
-    // one vector of variable size for each vertex - this is used for duplicate detection
-    std::shared_ptr<std::unordered_map<unsigned int, std::vector<std::weak_ptr<ChunkBuilder>>>>
-        vertexUse(new std::unordered_map<unsigned int, std::vector<std::weak_ptr<ChunkBuilder>>>());
+    std::vector<FaceHandle> faces;
+    faces.reserve(halfEdgeMesh->numFaces());
+    MeshHandleIteratorPtr<FaceHandle> iterator = halfEdgeMesh->facesBegin();
+    while (iterator != halfEdgeMesh->facesEnd())
+    {
+        faces.push_back(*iterator);
+        ++iterator;
+    }
 
-    for (int i = getChunkMinChunkIndex().x; i < getChunkMaxChunkIndex().x; i++)
+    // find the chunk of each face
+    std::vector<BaseVector<int>> faceCells(faces.size());
+    #pragma omp parallel for
+    for (size_t i = 0; i < faces.size(); i++)
     {
-        for (int j = getChunkMinChunkIndex().y; j < getChunkMaxChunkIndex().y; j++)
+        faceCells[i] = getCellCoordinates(getFaceCenter(halfEdgeMesh, faces[i]));
+    }
+
+    // enumerate the occupied chunks only
+    std::unordered_map<uint64_t, size_t> chunkIds;
+    std::vector<BaseVector<int>> chunkCells;
+    std::vector<size_t> faceChunks(faces.size());
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        const BaseVector<int>& cell = faceCells[i];
+        uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(cell.x) & 0x1FFFFF) << 42)
+                       | (static_cast<uint64_t>(static_cast<uint32_t>(cell.y) & 0x1FFFFF) << 21)
+                       | static_cast<uint64_t>(static_cast<uint32_t>(cell.z) & 0x1FFFFF);
+
+        auto inserted = chunkIds.insert({key, chunkCells.size()});
+        if (inserted.second)
         {
-            for (int k = getChunkMinChunkIndex().z; k < getChunkMaxChunkIndex().z; k++)
-            {
-                chunkBuilders[hashValue(i, j, k)]
-                    = ChunkBuilderPtr(new ChunkBuilder(halfEdgeMesh, vertexUse));
-            }
+            chunkCells.push_back(cell);
         }
+        faceChunks[i] = inserted.first->second;
     }
 
-    // assign the faces to the chunks
-    BaseVector<float> currentCenterPoint;
-    MeshHandleIteratorPtr<FaceHandle> iterator = halfEdgeMesh->facesBegin();
-    for (size_t i = 0; i < halfEdgeMesh->numFaces(); i++)
+    // sort the faces by chunk, keeping their order inside of each chunk
+    std::vector<size_t> chunkFaceOffsets(chunkCells.size() + 1, 0);
+    for (size_t chunk : faceChunks)
+    {
+        chunkFaceOffsets[chunk + 1]++;
+    }
+    for (size_t i = 0; i < chunkCells.size(); i++)
+    {
+        chunkFaceOffsets[i + 1] += chunkFaceOffsets[i];
+    }
+    std::vector<FaceHandle> chunkFaces(faces.size(), FaceHandle(0));
+    std::vector<size_t> fill(chunkFaceOffsets.begin(), chunkFaceOffsets.end() - 1);
+    for (size_t i = 0; i < faces.size(); i++)
     {
-        currentCenterPoint             = getFaceCenter(halfEdgeMesh, *iterator);
-        BaseVector<int> cellCorrdinate = getCellCoordinates(currentCenterPoint);
-        size_t hash = hashValue(cellCorrdinate.x, cellCorrdinate.y, cellCorrdinate.z);
+        chunkFaces[fill[faceChunks[i]]++] = faces[i];
+    }
 
-        chunkBuilders[hash]->addFace(*iterator);
+    // a vertex is duplicated if the faces of more than one chunk use it
+    const size_t noChunk = std::numeric_limits<size_t>::max();
+    std::vector<std::atomic<size_t>> vertexChunks(halfEdgeMesh->nextVertexIndex());
+    std::vector<unsigned char> duplicateVertices(vertexChunks.size(), 0);
 
-        ++iterator;
+    #pragma omp parallel for
+    for (size_t i = 0; i < vertexChunks.size(); i++)
+    {
+        vertexChunks[i].store(noChunk, std::memory_order_relaxed);
     }
 
-    // save the chunks as .ply
-    for (int i = getChunkMinChunkIndex().x; i < getChunkMaxChunkIndex().x; i++)
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t chunk = 0; chunk < chunkCells.size(); chunk++)
     {
-        for (int j = getChunkMinChunkIndex().y; j < getChunkMaxChunkIndex().y; j++)
+        for (size_t i = chunkFaceOffsets[chunk]; i < chunkFaceOffsets[chunk + 1]; i++)
         {
-            for (int k = getChunkMinChunkIndex().z; k < getChunkMaxChunkIndex().z; k++)
+            for (VertexHandle vertex : halfEdgeMesh->getVerticesOfFace(chunkFaces[i]))
             {
-                std::size_t hash = hashValue(i, j, k);
-
-                if (chunkBuilders[hash]->numFaces() > 0)
+                size_t expected = noChunk;
+                if (!vertexChunks[vertex.idx()].compare_exchange_strong(expected, chunk)
+                    && expected != chunk)
                 {
-                    // std::cout << "writing " << i << " " << j << " " << k << std::endl;
+                    #pragma omp atomic write
+                    duplicateVertices[vertex.idx()] = 1;
+                }
+            }
+        }
+    }
 
-                    // get mesh of chunk from chunk builder
-                    MeshBufferPtr chunkMeshPtr
-                        = chunkBuilders[hash]->buildMesh(mesh, splitVertices, splitFaces);
+    // select the chunks to write in the order of their grid coordinates
+    BaseVector<int> minCell(std::numeric_limits<int>::lowest(),
+                            std::numeric_limits<int>::lowest(),
+                            std::numeric_limits<int>::lowest());
+    BaseVector<int> maxCell(std::numeric_limits<int>::max(),
+                            std::numeric_limits<int>::max(),
+                            std::numeric_limits<int>::max());
+    if (changedArea.isValid())
+    {
+        // the faces of the chunks around the changed area are regenerated as well, so these
+        // chunks are rewritten to avoid seams on the borders of the changed area
+        minCell = getCellCoordinates(changedArea.getMin()) - BaseVector<int>(1, 1, 1);
+        maxCell = getCellCoordinates(changedArea.getMax()) + BaseVector<int>(1, 1, 1);
+    }
 
-                    // export chunked meshes for debugging
-                    // ModelFactory::saveModel(ModelPtr(new Model(chunkMeshPtr)),
-                    //                        savePath + "/" + std::to_string(i) + "-"
-                    //                            + std::to_string(j) + "-" + std::to_string(k)
-                    //                            + ".ply");
-                    // write chunk in hdf5
-                    setChunk<MeshBufferPtr>(layer, i, j, k, chunkMeshPtr);
+    std::vector<size_t> selectedChunks;
+    for (size_t chunk = 0; chunk < chunkCells.size(); chunk++)
+    {
+        const BaseVector<int>& cell = chunkCells[chunk];
+        if (cell.x >= minCell.x && cell.y >= minCell.y && cell.z >= minCell.z
+            && cell.x <= maxCell.x && cell.y <= maxCell.y && cell.z <= maxCell.z)
+        {
+            selectedChunks.push_back(chunk);
+        }
+    }
+    std::sort(selectedChunks.begin(), selectedChunks.end(), [&chunkCells](size_t a, size_t b) {
+        return std::make_tuple(chunkCells[a].x, chunkCells[a].y, chunkCells[a].z)
+               < std::make_tuple(chunkCells[b].x, chunkCells[b].y, chunkCells[b].z);
+    });
+
+    // build the chunk meshes in parallel rounds, then write them in order
+    const size_t roundSize = 4 * OpenMPConfig::getNumThreads();
+    for (size_t roundStart = 0; roundStart < selectedChunks.size(); roundStart += roundSize)
+    {
+        size_t roundEnd = std::min(selectedChunks.size(), roundStart + roundSize);
+        std::vector<MeshBufferPtr> chunkMeshes(roundEnd - roundStart);
 
-                    chunkBuilders[hash] = nullptr; // deallocate
+        #pragma omp parallel for schedule(dynamic)
+        for (size_t r = roundStart; r < roundEnd; r++)
+        {
+            size_t chunk = selectedChunks[r];
+            std::vector<FaceHandle> builderFaces(chunkFaces.begin() + chunkFaceOffsets[chunk],
+                                                 chunkFaces.begin() + chunkFaceOffsets[chunk + 1]);
+
+            // collect the distinct and the duplicate vertices in order of their first use
+            std::unordered_set<unsigned int> usedVertices;
+            std::vector<VertexHandle> builderDuplicates;
+            for (const FaceHandle& face : builderFaces)
+            {
+                for (VertexHandle vertex : halfEdgeMesh->getVerticesOfFace(face))
+                {
+                    if (usedVertices.insert(vertex.idx()).second && duplicateVertices[vertex.idx()])
+                    {
+                        builderDuplicates.push_back(vertex);
+                    }
                 }
             }
+
+            ChunkBuilder builder(halfEdgeMesh,
+                                 std::move(builderFaces),
+                                 std::move(builderDuplicates),
+                                 usedVertices.size());
+
+            // get mesh of chunk from chunk builder
+            chunkMeshes[r - roundStart] = builder.buildMesh(mesh, splitVertices, splitFaces);
+        }
+
+        // write chunks in hdf5
+        for (size_t r = roundStart; r < roundEnd; r++)
+        {
+            const BaseVector<int>& cell = chunkCells[selectedChunks[r]];
+            setChunk<MeshBufferPtr>(layer, cell.x, cell.y, cell.z, chunkMeshes[r - roundStart]);
         }
     }
 }
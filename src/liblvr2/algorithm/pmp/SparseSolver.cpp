@@ -0,0 +1,145 @@
+// Copyright 2011-2020 the Polygon Mesh Processing Library developers.
+// Distributed under a MIT-style license, see PMP_LICENSE.txt for details.
+
+#include "lvr2/algorithm/pmp/SparseSolver.h"
+
+#include <algorithm>
+
+namespace pmp {
+
+SparseSolver::SparseSolver(Method method)
+    : method_(method),
+      tolerance_(1e-10),
+      max_iterations_(-1),
+      analyzed_(false),
+      rows_(0),
+      cols_(0)
+{
+}
+
+void SparseSolver::set_method(Method method)
+{
+    if (method != method_)
+    {
+        method_ = method;
+        reset();
+    }
+}
+
+void SparseSolver::reset()
+{
+    analyzed_ = false;
+    rows_ = cols_ = 0;
+    outer_.clear();
+    inner_.clear();
+    x_prev_.resize(0, 0);
+}
+
+bool SparseSolver::same_pattern(const SparseMatrix& A) const
+{
+    if (!analyzed_ || A.rows() != rows_ || A.cols() != cols_ ||
+        (size_t)A.nonZeros() != inner_.size())
+        return false;
+
+    return std::equal(outer_.begin(), outer_.end(), A.outerIndexPtr()) &&
+           std::equal(inner_.begin(), inner_.end(), A.innerIndexPtr());
+}
+
+void SparseSolver::store_pattern(const SparseMatrix& A)
+{
+    rows_ = A.rows();
+    cols_ = A.cols();
+    outer_.assign(A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1);
+    inner_.assign(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros());
+    analyzed_ = true;
+}
+
+bool SparseSolver::solve(const SparseMatrix& A, const Eigen::MatrixXd& B,
+                         Eigen::MatrixXd& X)
+{
+    // the cached pattern is only valid for compressed storage
+    SparseMatrix compressed;
+    const SparseMatrix* M = &A;
+    if (!A.isCompressed())
+    {
+        compressed = A;
+        compressed.makeCompressed();
+        M = &compressed;
+    }
+
+    const bool reuse = same_pattern(*M);
+
+    bool ok = false;
+    switch (method_)
+    {
+        case Method::LDLT:
+            ok = solve_ldlt(*M, reuse, B, X);
+            break;
+        case Method::CG_Jacobi:
+            ok = solve_cg(cg_jacobi_, *M, reuse, B, X);
+            break;
+        case Method::CG_IncompleteCholesky:
+            ok = solve_cg(cg_ichol_, *M, reuse, B, X);
+            break;
+    }
+
+    if (!ok)
+    {
+        reset();
+        return false;
+    }
+
+    if (!reuse)
+        store_pattern(*M);
+
+    return true;
+}
+
+bool SparseSolver::solve_ldlt(const SparseMatrix& A, bool reuse,
+                              const Eigen::MatrixXd& B, Eigen::MatrixXd& X)
+{
+    // symbolic analysis only if the connectivity changed
+    if (!reuse)
+        ldlt_.analyzePattern(A);
+
+    ldlt_.factorize(A);
+    if (ldlt_.info() != Eigen::Success)
+        return false;
+
+    X = ldlt_.solve(B);
+    return ldlt_.info() == Eigen::Success;
+}
+
+template <typename CG>
+bool SparseSolver::solve_cg(CG& cg, const SparseMatrix& A, bool reuse,
+                            const Eigen::MatrixXd& B, Eigen::MatrixXd& X)
+{
+    // row-major storage lets Eigen parallelize the matrix-vector products
+    RowMajorMatrix R(A);
+
+    cg.setTolerance(tolerance_);
+    cg.setMaxIterations(max_iterations_ > 0 ? max_iterations_
+                                            : 2 * (int)A.rows());
+
+    if (reuse)
+        cg.factorize(R);
+    else
+        cg.compute(R);
+
+    if (cg.info() != Eigen::Success)
+        return false;
+
+    // start from the previous solution if the system did not change its size
+    if (reuse && x_prev_.rows() == B.rows() && x_prev_.cols() == B.cols())
+        X = cg.solveWithGuess(B, x_prev_);
+    else
+        X = cg.solve(B);
+
+    if (cg.info() != Eigen::Success)
+        return false;
+
+    x_prev_ = X;
+    return true;
+}
+
+} // namespace pmp
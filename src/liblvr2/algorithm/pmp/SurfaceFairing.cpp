@@ -129,6 +129,10 @@ void SurfaceFairing::fair(unsigned int k)
     std::map<Vertex, double> row;
     std::vector<Triplet> triplets;
 
+    // the k-harmonic operator is negative definite for odd k, flip its sign
+    // to get a positive definite system for the iterative solvers
+    const double sign = (k % 2) ? -1.0 : 1.0;
+
     for (unsigned int i = 0; i < n; ++i)
     {
         b.fill(0.0);
@@ -138,7 +142,7 @@ void SurfaceFairing::fair(unsigned int k)
         for (auto r : row)
         {
             auto v = r.first;
-            auto w = r.second;
+            auto w = sign * r.second;
 
             if (idx_[v] != -1)
             {
@@ -155,11 +159,9 @@ void SurfaceFairing::fair(unsigned int k)
 
     A.setFromTriplets(triplets.begin(), triplets.end());
 
-    // solve A*X = B
-    Eigen::SimplicialLDLT<SparseMatrix> solver(A);
-    Eigen::MatrixXd X = solver.solve(B);
-
-    if (solver.info() != Eigen::Success)
+    // solve A*X = B for x, y and z at once
+    Eigen::MatrixXd X;
+    if (!solver_.solve(A, B, X))
     {
         throw SolverException("SurfaceFairing: Failed to solve linear system.");
     }
@@ -159,10 +159,9 @@ void SurfaceParameterization::harmonic(bool use_uniform_weights)
     // build sparse matrix from triplets
     A.setFromTriplets(triplets.begin(), triplets.end());
 
-    // solve A*X = B
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(A);
-    Eigen::MatrixXd X = solver.solve(B);
-    if (solver.info() != Eigen::Success)
+    // solve A*X = B for u and v at once
+    Eigen::MatrixXd X;
+    if (!solver_.solve(A, B, X))
     {
         // clean-up
         mesh_.remove_vertex_property(idx);
@@ -386,10 +385,9 @@ void SurfaceParameterization::lscm()
     // build sparse matrix from triplets
     A.setFromTriplets(triplets.begin(), triplets.end());
 
-    // solve A*X = B
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(A);
-    Eigen::VectorXd x = solver.solve(b);
-    if (solver.info() != Eigen::Success)
+    // solve A*x = b
+    Eigen::MatrixXd x;
+    if (!solver_.solve(A, b, x))
     {
         // clean-up
         mesh_.remove_vertex_property(idx);
@@ -403,7 +401,7 @@ void SurfaceParameterization::lscm()
         // copy solution
         for (i = 0; i < n; ++i)
         {
-            tex[free_vertices[i]] = TexCoord(x[i], x[i + n]);
+            tex[free_vertices[i]] = TexCoord(x(i, 0), x(i + n, 0));
         }
     }
 
@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #include "lvr2/algorithm/pmp/TriangleKdTree.h"
 #include "lvr2/algorithm/pmp/SurfaceCurvature.h"
@@ -148,9 +149,10 @@ void SurfaceRemeshing::preprocessing()
     // compute sizing field
     if (uniform_)
     {
-        for (auto v : mesh_.vertices())
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < mesh_.vertices_size(); ++i)
         {
-            vsizing_[v] = target_edge_length_;
+            vsizing_[Vertex(i)] = target_edge_length_;
         }
     }
     else
@@ -205,8 +207,13 @@ void SurfaceRemeshing::preprocessing()
         }
 
         // now convert per-vertex curvature into target edge length
-        for (auto v : mesh_.vertices())
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < mesh_.vertices_size(); ++i)
         {
+            Vertex v(i);
+            if (mesh_.is_deleted(v))
+                continue;
+
             Scalar c = vsizing_[v];
 
             // get edge length from curvature
@@ -279,9 +286,22 @@ void SurfaceRemeshing::project_to_reference(Vertex v)
         return;
     }
 
+    Point p, n;
+    Scalar s;
+    project_point(points_[v], p, n, s);
+
+    // set result
+    points_[v] = p;
+    vnormal_[v] = n;
+    vsizing_[v] = s;
+}
+
+void SurfaceRemeshing::project_point(const Point& q, Point& p, Point& n,
+                                     Scalar& s) const
+{
     // find closest triangle of reference mesh
-    TriangleKdTree::NearestNeighbor nn = kd_tree_->nearest(points_[v]);
-    const Point p = nn.nearest;
+    TriangleKdTree::NearestNeighbor nn = kd_tree_->nearest(q);
+    p = nn.nearest;
     const Face f = nn.face;
 
     // get face data
@@ -302,7 +322,6 @@ void SurfaceRemeshing::project_to_reference(Vertex v)
     Point b = barycentric_coordinates(p, p0, p1, p2);
 
     // interpolate normal
-    Point n;
     n = (n0 * b[0]);
     n += (n1 * b[1]);
     n += (n2 * b[2]);
@@ -310,15 +329,9 @@ void SurfaceRemeshing::project_to_reference(Vertex v)
     assert(!std::isnan(n[0]));
 
     // interpolate sizing field
-    Scalar s;
     s = (s0 * b[0]);
     s += (s1 * b[1]);
     s += (s2 * b[2]);
-
-    // set result
-    points_[v] = p;
-    vnormal_[v] = n;
-    vsizing_[v] = s;
 }
 
 void SurfaceRemeshing::split_long_edges()
@@ -329,45 +342,94 @@ void SurfaceRemeshing::split_long_edges()
     bool ok, is_feature, is_boundary;
     int i;
 
+    std::vector<Edge> long_edges;
+    std::vector<Point> proj_points, proj_normals;
+    std::vector<Scalar> proj_sizing;
+
     for (ok = false, i = 0; !ok && i < 10; ++i)
     {
         ok = true;
 
-        for (auto e : mesh_.edges())
+        // Find the long edges in parallel. A split only changes the split
+        // edge itself and adds new edges, which are not visited in this
+        // pass. Thus the candidates are exactly the edges the serial loop
+        // would split.
+        const size_t n_edges = mesh_.edges_size();
+        std::vector<char> is_long(n_edges, 0);
+
+        #pragma omp parallel for schedule(static)
+        for (size_t j = 0; j < n_edges; ++j)
         {
-            v0 = mesh_.vertex(e, 0);
-            v1 = mesh_.vertex(e, 1);
+            Edge e(j);
+            if (!mesh_.is_deleted(e) && !elocked_[e] &&
+                is_too_long(mesh_.vertex(e, 0), mesh_.vertex(e, 1)))
+                is_long[j] = 1;
+        }
 
-            if (!elocked_[e] && is_too_long(v0, v1))
+        long_edges.clear();
+        for (size_t j = 0; j < n_edges; ++j)
+        {
+            if (is_long[j])
+                long_edges.push_back(Edge(j));
+        }
+
+        // The end points of the long edges are not moved by the splits, so
+        // the back-projections of the midpoints are computed up front in
+        // parallel. The serial loop below only applies them.
+        if (use_projection_)
+        {
+            proj_points.resize(long_edges.size());
+            proj_normals.resize(long_edges.size());
+            proj_sizing.resize(long_edges.size());
+
+            #pragma omp parallel for schedule(static)
+            for (size_t j = 0; j < long_edges.size(); ++j)
             {
-                const Point& p0 = points_[v0];
-                const Point& p1 = points_[v1];
+                Edge e = long_edges[j];
+                if (efeature_[e])
+                    continue;
+
+                const Point p = (points_[mesh_.vertex(e, 0)] +
+                                 points_[mesh_.vertex(e, 1)]) * 0.5f;
+                project_point(p, proj_points[j], proj_normals[j],
+                              proj_sizing[j]);
+            }
+        }
+
+        for (size_t j = 0; j < long_edges.size(); ++j)
+        {
+            Edge e = long_edges[j];
+            v0 = mesh_.vertex(e, 0);
+            v1 = mesh_.vertex(e, 1);
 
-                is_feature = efeature_[e];
-                is_boundary = mesh_.is_boundary(e);
+            const Point& p0 = points_[v0];
+            const Point& p1 = points_[v1];
 
-                vnew = mesh_.add_vertex((p0 + p1) * 0.5f);
-                mesh_.split(e, vnew);
+            is_feature = efeature_[e];
+            is_boundary = mesh_.is_boundary(e);
 
-                // need normal or sizing for adaptive refinement
-                vnormal_[vnew] =
-                    SurfaceNormals::compute_vertex_normal(mesh_, vnew);
-                vsizing_[vnew] = 0.5f * (vsizing_[v0] + vsizing_[v1]);
+            vnew = mesh_.add_vertex((p0 + p1) * 0.5f);
+            mesh_.split(e, vnew);
 
-                if (is_feature)
-                {
-                    enew = is_boundary ? Edge(mesh_.n_edges() - 2)
-                                       : Edge(mesh_.n_edges() - 3);
-                    efeature_[enew] = true;
-                    vfeature_[vnew] = true;
-                }
-                else
-                {
-                    project_to_reference(vnew);
-                }
+            // need normal or sizing for adaptive refinement
+            vnormal_[vnew] = SurfaceNormals::compute_vertex_normal(mesh_, vnew);
+            vsizing_[vnew] = 0.5f * (vsizing_[v0] + vsizing_[v1]);
 
-                ok = false;
+            if (is_feature)
+            {
+                enew = is_boundary ? Edge(mesh_.n_edges() - 2)
+                                   : Edge(mesh_.n_edges() - 3);
+                efeature_[enew] = true;
+                vfeature_[vnew] = true;
+            }
+            else if (use_projection_)
+            {
+                points_[vnew] = proj_points[j];
+                vnormal_[vnew] = proj_normals[j];
+                vsizing_[vnew] = proj_sizing[j];
             }
+
+            ok = false;
         }
     }
 }
@@ -380,12 +442,34 @@ void SurfaceRemeshing::collapse_short_edges()
     int i;
     bool hcol01, hcol10;
 
+    std::vector<char> is_short;
+    std::vector<char> moved;
+
     for (ok = false, i = 0; !ok && i < 10; ++i)
     {
         ok = true;
 
-        for (auto e : mesh_.edges())
+        // Find the short edges in parallel. Collapses do not move vertices,
+        // they only reconnect the edges of the removed vertex to the
+        // remaining one. Edges without such a vertex keep their length, so
+        // only the candidates and the edges at remaining vertices need to be
+        // tested again in the serial loop.
+        const size_t n_edges = mesh_.edges_size();
+        is_short.assign(n_edges, 0);
+        moved.assign(mesh_.vertices_size(), 0);
+
+        #pragma omp parallel for schedule(static)
+        for (size_t j = 0; j < n_edges; ++j)
         {
+            Edge e(j);
+            if (!mesh_.is_deleted(e) && !elocked_[e] &&
+                is_too_short(mesh_.vertex(e, 0), mesh_.vertex(e, 1)))
+                is_short[j] = 1;
+        }
+
+        for (size_t j = 0; j < n_edges; ++j)
+        {
+            Edge e(j);
             if (!mesh_.is_deleted(e) && !elocked_[e])
             {
                 h10 = mesh_.halfedge(e, 0);
@@ -393,6 +477,9 @@ void SurfaceRemeshing::collapse_short_edges()
                 v0 = mesh_.to_vertex(h10);
                 v1 = mesh_.to_vertex(h01);
 
+                if (!is_short[j] && !moved[v0.idx()] && !moved[v1.idx()])
+                    continue;
+
                 if (is_too_short(v0, v1))
                 {
                     // get status
@@ -481,6 +568,7 @@ void SurfaceRemeshing::collapse_short_edges()
                         if (hcol10)
                         {
                             mesh_.collapse(h10);
+                            moved[v0.idx()] = 1;
                             ok = false;
                         }
                     }
@@ -501,6 +589,7 @@ void SurfaceRemeshing::collapse_short_edges()
                         if (hcol01)
                         {
                             mesh_.collapse(h01);
+                            moved[v1.idx()] = 1;
                             ok = false;
                         }
                     }
@@ -515,10 +604,6 @@ void SurfaceRemeshing::collapse_short_edges()
 void SurfaceRemeshing::flip_edges()
 {
     Vertex v0, v1, v2, v3;
-    Halfedge h;
-    int val0, val1, val2, val3;
-    int val_opt0, val_opt1, val_opt2, val_opt3;
-    int ve0, ve1, ve2, ve3, ve_before, ve_after;
     bool ok;
     int i;
 
@@ -529,64 +614,102 @@ void SurfaceRemeshing::flip_edges()
         valence[v] = mesh_.valence(v);
     }
 
+    // check whether flipping an edge reduces the squared deviation of the
+    // valences of its four vertices from their optimal valences
+    auto improves_valence = [&](Vertex v0, Vertex v1, Vertex v2, Vertex v3) {
+        int val0 = valence[v0];
+        int val1 = valence[v1];
+        int val2 = valence[v2];
+        int val3 = valence[v3];
+
+        const int val_opt0 = (mesh_.is_boundary(v0) ? 4 : 6);
+        const int val_opt1 = (mesh_.is_boundary(v1) ? 4 : 6);
+        const int val_opt2 = (mesh_.is_boundary(v2) ? 4 : 6);
+        const int val_opt3 = (mesh_.is_boundary(v3) ? 4 : 6);
+
+        int ve0 = (val0 - val_opt0);
+        int ve1 = (val1 - val_opt1);
+        int ve2 = (val2 - val_opt2);
+        int ve3 = (val3 - val_opt3);
+
+        ve0 *= ve0;
+        ve1 *= ve1;
+        ve2 *= ve2;
+        ve3 *= ve3;
+
+        const int ve_before = ve0 + ve1 + ve2 + ve3;
+
+        --val0;
+        --val1;
+        ++val2;
+        ++val3;
+
+        ve0 = (val0 - val_opt0);
+        ve1 = (val1 - val_opt1);
+        ve2 = (val2 - val_opt2);
+        ve3 = (val3 - val_opt3);
+
+        ve0 *= ve0;
+        ve1 *= ve1;
+        ve2 *= ve2;
+        ve3 *= ve3;
+
+        const int ve_after = ve0 + ve1 + ve2 + ve3;
+
+        return ve_before > ve_after;
+    };
+
+    // get the vertices of an edge and the opposite vertices of its triangles
+    auto quad = [&](Edge e, Vertex& v0, Vertex& v1, Vertex& v2, Vertex& v3) {
+        Halfedge h = mesh_.halfedge(e, 0);
+        v0 = mesh_.to_vertex(h);
+        v2 = mesh_.to_vertex(mesh_.next_halfedge(h));
+        h = mesh_.halfedge(e, 1);
+        v1 = mesh_.to_vertex(h);
+        v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
+
+        return !vlocked_[v0] && !vlocked_[v1] && !vlocked_[v2] &&
+               !vlocked_[v3];
+    };
+
+    std::vector<char> is_candidate;
+    std::vector<char> changed;
+
     for (ok = false, i = 0; !ok && i < 10; ++i)
     {
         ok = true;
 
-        for (auto e : mesh_.edges())
+        // Find the edges whose flip improves the valences in parallel. A flip
+        // only changes the valences and neighborhoods of its four vertices.
+        // All edges of the triangles around them are marked as changed, so
+        // only the candidates and the changed edges are tested again in the
+        // serial loop.
+        const size_t n_edges = mesh_.edges_size();
+        is_candidate.assign(n_edges, 0);
+        changed.assign(n_edges, 0);
+
+        #pragma omp parallel for schedule(static)
+        for (size_t j = 0; j < n_edges; ++j)
         {
-            if (!elocked_[e] && !efeature_[e])
+            Edge e(j);
+            Vertex w0, w1, w2, w3;
+            if (!mesh_.is_deleted(e) && !elocked_[e] && !efeature_[e] &&
+                quad(e, w0, w1, w2, w3) && improves_valence(w0, w1, w2, w3))
+                is_candidate[j] = 1;
+        }
+
+        for (size_t j = 0; j < n_edges; ++j)
+        {
+            if (!is_candidate[j] && !changed[j])
+                continue;
+
+            Edge e(j);
+            if (!mesh_.is_deleted(e) && !elocked_[e] && !efeature_[e])
             {
-                h = mesh_.halfedge(e, 0);
-                v0 = mesh_.to_vertex(h);
-                v2 = mesh_.to_vertex(mesh_.next_halfedge(h));
-                h = mesh_.halfedge(e, 1);
-                v1 = mesh_.to_vertex(h);
-                v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
-
-                if (!vlocked_[v0] && !vlocked_[v1] && !vlocked_[v2] &&
-                    !vlocked_[v3])
+                if (quad(e, v0, v1, v2, v3))
                 {
-                    val0 = valence[v0];
-                    val1 = valence[v1];
-                    val2 = valence[v2];
-                    val3 = valence[v3];
-
-                    val_opt0 = (mesh_.is_boundary(v0) ? 4 : 6);
-                    val_opt1 = (mesh_.is_boundary(v1) ? 4 : 6);
-                    val_opt2 = (mesh_.is_boundary(v2) ? 4 : 6);
-                    val_opt3 = (mesh_.is_boundary(v3) ? 4 : 6);
-
-                    ve0 = (val0 - val_opt0);
-                    ve1 = (val1 - val_opt1);
-                    ve2 = (val2 - val_opt2);
-                    ve3 = (val3 - val_opt3);
-
-                    ve0 *= ve0;
-                    ve1 *= ve1;
-                    ve2 *= ve2;
-                    ve3 *= ve3;
-
-                    ve_before = ve0 + ve1 + ve2 + ve3;
-
-                    --val0;
-                    --val1;
-                    ++val2;
-                    ++val3;
-
-                    ve0 = (val0 - val_opt0);
-                    ve1 = (val1 - val_opt1);
-                    ve2 = (val2 - val_opt2);
-                    ve3 = (val3 - val_opt3);
-
-                    ve0 *= ve0;
-                    ve1 *= ve1;
-                    ve2 *= ve2;
-                    ve3 *= ve3;
-
-                    ve_after = ve0 + ve1 + ve2 + ve3;
-
-                    if (ve_before > ve_after && mesh_.is_flip_ok(e))
+                    if (improves_valence(v0, v1, v2, v3) &&
+                        mesh_.is_flip_ok(e))
                     {
                         mesh_.flip(e);
                         --valence[v0];
@@ -594,6 +717,16 @@ void SurfaceRemeshing::flip_edges()
                         ++valence[v2];
                         ++valence[v3];
                         ok = false;
+
+                        for (Vertex v : {v0, v1, v2, v3})
+                        {
+                            for (auto hv : mesh_.halfedges(v))
+                            {
+                                changed[mesh_.edge(hv).idx()] = 1;
+                                changed[mesh_.edge(mesh_.next_halfedge(hv))
+                                            .idx()] = 1;
+                            }
+                        }
                     }
                 }
             }
@@ -605,21 +738,25 @@ void SurfaceRemeshing::flip_edges()
 
 void SurfaceRemeshing::tangential_smoothing(unsigned int iterations)
 {
-    Vertex v1, v2, v3, vv;
-    Edge e;
-    Scalar w, ww;
-    Point u, n, t, b;
-
     // add property
     VertexProperty<Point> update = mesh_.add_vertex_property<Point>("v:update");
 
+    // all vertices are updated simultaneously from the positions of the
+    // previous iteration, so the vertex loops run in parallel
+    const size_t n_vertices = mesh_.vertices_size();
+    auto is_smoothed = [&](Vertex v) {
+        return !mesh_.is_deleted(v) && !mesh_.is_boundary(v) && !vlocked_[v];
+    };
+
     // project at the beginning to get valid sizing values and normal vectors
     // for vertices introduced by splitting
     if (use_projection_)
     {
-        for (auto v : mesh_.vertices())
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (size_t i = 0; i < n_vertices; ++i)
         {
-            if (!mesh_.is_boundary(v) && !vlocked_[v])
+            Vertex v(i);
+            if (is_smoothed(v))
             {
                 project_to_reference(v);
             }
@@ -628,9 +765,14 @@ void SurfaceRemeshing::tangential_smoothing(unsigned int iterations)
 
     for (unsigned int iters = 0; iters < iterations; ++iters)
     {
-        for (auto v : mesh_.vertices())
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (size_t i = 0; i < n_vertices; ++i)
         {
-            if (!mesh_.is_boundary(v) && !vlocked_[v])
+            Vertex v(i), vv;
+            Scalar w, ww;
+            Point u, n, t, b;
+
+            if (is_smoothed(v))
             {
                 if (vfeature_[v])
                 {
@@ -698,9 +840,11 @@ void SurfaceRemeshing::tangential_smoothing(unsigned int iterations)
         }
 
         // update vertex positions
-        for (auto v : mesh_.vertices())
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n_vertices; ++i)
         {
-            if (!mesh_.is_boundary(v) && !vlocked_[v])
+            Vertex v(i);
+            if (is_smoothed(v))
             {
                 points_[v] += update[v];
             }
@@ -713,9 +857,11 @@ void SurfaceRemeshing::tangential_smoothing(unsigned int iterations)
     // project at the end
     if (use_projection_)
     {
-        for (auto v : mesh_.vertices())
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (size_t i = 0; i < n_vertices; ++i)
         {
-            if (!mesh_.is_boundary(v) && !vlocked_[v])
+            Vertex v(i);
+            if (is_smoothed(v))
             {
                 project_to_reference(v);
             }
@@ -214,10 +214,9 @@ void SurfaceSmoothing::implicit_smoothing(Scalar timestep,
     // build sparse matrix from triplets
     A.setFromTriplets(triplets.begin(), triplets.end());
 
-    // solve A*X = B
-    Eigen::SimplicialLDLT<SparseMatrix> solver(A);
-    Eigen::MatrixXd X = solver.solve(B);
-    if (solver.info() != Eigen::Success)
+    // solve A*X = B for x, y and z at once
+    Eigen::MatrixXd X;
+    if (!solver_.solve(A, B, X))
     {
         // clean-up
         mesh_.remove_vertex_property(idx);
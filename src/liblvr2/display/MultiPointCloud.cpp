@@ -62,7 +62,7 @@ void MultiPointCloud::init(PointBufferPtr buffer)
         indexArray subClouds = buffer->getIndexArray("sub_clouds", numSubClouds, dummy);
 
         vector<indexPair> pairs;
-        pairs.reserve(numSubClouds);
+        pairs.resize(numSubClouds);
         for (size_t i = 0; i < numSubClouds; i++)
         {
             pairs[i].first  = subClouds[i*2 + 0];    
@@ -93,7 +93,7 @@ ModelPtr ModelFactory::readModel( std::string filename )
     {
         io = new ObjIO;
     }
-    else if (extension == ".las")
+    else if (extension == ".las" || extension == ".laz")
     {
         io = new LasIO;
     }
@@ -244,6 +244,10 @@ void ModelFactory::saveModel( ModelPtr m, std::string filename)
     {
         io = new STLIO;
     }
+    else if (extension == ".las" || extension == ".laz")
+    {
+        io = new LasIO;
+    }
     /**else if (extension == ".rdbx")
     {
         io = new RdbxIO;
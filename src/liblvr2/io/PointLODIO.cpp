@@ -0,0 +1,269 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * PointLODIO.cpp
+ *
+ * @date 18.10.2026
+ */
+
+#include "lvr2/io/PointLODIO.hpp"
+#include "lvr2/io/scanio/MetaFormatFactory.hpp"
+
+#include <boost/filesystem.hpp>
+#include <yaml-cpp/yaml.h>
+
+#include <stdexcept>
+
+namespace fs = boost::filesystem;
+
+namespace lvr2
+{
+
+namespace
+{
+
+const char* const MetadataFile = "metadata.yaml";
+const char* const HierarchyFile = "hierarchy.bin";
+const char* const DataFile = "octree.bin";
+
+/// Version of the file layout, stored in the metadata
+const int FormatVersion = 1;
+
+} // anonymous namespace
+
+PointLODIO::PointLODIO(const std::string& directory)
+    : m_directory(directory)
+{
+}
+
+void PointLODIO::beginWrite(const PointLODMetadata& metadata)
+{
+    fs::create_directories(m_directory);
+
+    m_metadata = metadata;
+    m_nodes.clear();
+    m_dataSize = 0;
+
+    m_dataOut.open((fs::path(m_directory) / DataFile).string(), std::ios::binary | std::ios::trunc);
+    if (!m_dataOut)
+    {
+        throw std::runtime_error("PointLODIO: Unable to open " + (fs::path(m_directory) / DataFile).string());
+    }
+}
+
+size_t PointLODIO::nodeDataSize(size_t numPoints) const
+{
+    size_t pointSize = 3 * sizeof(float);
+    if (m_metadata.hasNormals)
+    {
+        pointSize += 3 * sizeof(float);
+    }
+    if (m_metadata.hasColors)
+    {
+        pointSize += 3 * sizeof(unsigned char);
+    }
+    return numPoints * pointSize;
+}
+
+uint64_t PointLODIO::writeNodeData(const float* points, const float* normals, const unsigned char* colors, size_t numPoints)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint64_t offset = m_dataSize;
+
+    m_dataOut.write(reinterpret_cast<const char*>(points), 3 * numPoints * sizeof(float));
+    if (m_metadata.hasNormals)
+    {
+        m_dataOut.write(reinterpret_cast<const char*>(normals), 3 * numPoints * sizeof(float));
+    }
+    if (m_metadata.hasColors)
+    {
+        m_dataOut.write(reinterpret_cast<const char*>(colors), 3 * numPoints);
+    }
+    if (!m_dataOut)
+    {
+        throw std::runtime_error("PointLODIO: Writing node data failed");
+    }
+
+    m_dataSize += nodeDataSize(numPoints);
+    return offset;
+}
+
+void PointLODIO::finishWrite(const std::vector<PointLODNode>& nodes, const PointLODMetadata& metadata)
+{
+    m_dataOut.close();
+
+    m_metadata = metadata;
+    m_metadata.numNodes = nodes.size();
+    m_nodes = nodes;
+
+    std::ofstream hierarchy((fs::path(m_directory) / HierarchyFile).string(), std::ios::binary | std::ios::trunc);
+    hierarchy.write(reinterpret_cast<const char*>(m_nodes.data()), m_nodes.size() * sizeof(PointLODNode));
+    if (!hierarchy)
+    {
+        throw std::runtime_error("PointLODIO: Writing the hierarchy failed");
+    }
+
+    YAML::Node node;
+    node["version"] = FormatVersion;
+    node["num_points"] = m_metadata.numPoints;
+    node["num_stored_points"] = m_metadata.numStoredPoints;
+    node["num_nodes"] = m_metadata.numNodes;
+    node["max_depth"] = m_metadata.maxDepth;
+    node["sampling_resolution"] = m_metadata.samplingResolution;
+    node["refinement"] = "replace";
+    for (int i = 0; i < 3; i++)
+    {
+        node["bounding_box"]["min"].push_back(m_metadata.min[i]);
+        node["bounding_box"]["max"].push_back(m_metadata.max[i]);
+    }
+    node["attributes"].push_back("position");
+    if (m_metadata.hasNormals)
+    {
+        node["attributes"].push_back("normal");
+    }
+    if (m_metadata.hasColors)
+    {
+        node["attributes"].push_back("color");
+    }
+    saveMetaInformation((fs::path(m_directory) / MetadataFile).string(), node);
+}
+
+void PointLODIO::readIndex()
+{
+    fs::path metaPath = fs::path(m_directory) / MetadataFile;
+    if (!fs::exists(metaPath))
+    {
+        throw std::runtime_error("PointLODIO: " + metaPath.string() + " does not exist");
+    }
+
+    YAML::Node node = loadMetaInformation(metaPath.string());
+    if (node["version"].as<int>() != FormatVersion)
+    {
+        throw std::runtime_error("PointLODIO: Unsupported version in " + metaPath.string());
+    }
+
+    m_metadata = PointLODMetadata();
+    m_metadata.numPoints = node["num_points"].as<uint64_t>();
+    m_metadata.numStoredPoints = node["num_stored_points"].as<uint64_t>();
+    m_metadata.numNodes = node["num_nodes"].as<uint64_t>();
+    m_metadata.maxDepth = node["max_depth"].as<uint32_t>();
+    m_metadata.samplingResolution = node["sampling_resolution"].as<uint32_t>();
+    for (int i = 0; i < 3; i++)
+    {
+        m_metadata.min[i] = node["bounding_box"]["min"][i].as<float>();
+        m_metadata.max[i] = node["bounding_box"]["max"][i].as<float>();
+    }
+    for (const auto& attribute : node["attributes"])
+    {
+        std::string name = attribute.as<std::string>();
+        m_metadata.hasNormals |= name == "normal";
+        m_metadata.hasColors |= name == "color";
+    }
+
+    std::ifstream hierarchy((fs::path(m_directory) / HierarchyFile).string(), std::ios::binary);
+    m_nodes.resize(m_metadata.numNodes);
+    hierarchy.read(reinterpret_cast<char*>(m_nodes.data()), m_nodes.size() * sizeof(PointLODNode));
+    if (!hierarchy)
+    {
+        throw std::runtime_error("PointLODIO: Reading the hierarchy failed");
+    }
+}
+
+std::vector<size_t> PointLODIO::selectNodes(
+    const std::function<bool(const PointLODNode&)>& visible,
+    const std::function<bool(const PointLODNode&)>& refine) const
+{
+    std::vector<size_t> selected;
+    if (m_nodes.empty())
+    {
+        return selected;
+    }
+
+    std::vector<size_t> stack = { 0 };
+    while (!stack.empty())
+    {
+        size_t index = stack.back();
+        stack.pop_back();
+
+        const PointLODNode& node = m_nodes[index];
+        if (!visible(node))
+        {
+            continue;
+        }
+
+        if (node.numChildren > 0 && refine(node))
+        {
+            for (size_t i = 0; i < node.numChildren; i++)
+            {
+                stack.push_back(node.firstChild + i);
+            }
+        }
+        else
+        {
+            selected.push_back(index);
+        }
+    }
+
+    return selected;
+}
+
+PointBufferPtr PointLODIO::readNode(size_t index) const
+{
+    const PointLODNode& node = m_nodes.at(index);
+    const size_t n = node.numPoints;
+
+    std::ifstream in((fs::path(m_directory) / DataFile).string(), std::ios::binary);
+    in.seekg(node.byteOffset);
+
+    floatArr points(new float[3 * n]);
+    in.read(reinterpret_cast<char*>(points.get()), 3 * n * sizeof(float));
+    PointBufferPtr buffer(new PointBuffer(points, n));
+
+    if (m_metadata.hasNormals)
+    {
+        floatArr normals(new float[3 * n]);
+        in.read(reinterpret_cast<char*>(normals.get()), 3 * n * sizeof(float));
+        buffer->setNormalArray(normals, n);
+    }
+    if (m_metadata.hasColors)
+    {
+        ucharArr colors(new unsigned char[3 * n]);
+        in.read(reinterpret_cast<char*>(colors.get()), 3 * n);
+        buffer->setColorArray(colors, n);
+    }
+
+    if (!in)
+    {
+        throw std::runtime_error("PointLODIO: Reading node " + std::to_string(index) + " failed");
+    }
+
+    return buffer;
+}
+
+} // namespace lvr2
@@ -382,4 +382,10 @@ bool DirectoryKernel::isMeta(const std::string& path) const
     return isMetaFile(path);
 }
 
+bool DirectoryKernel::concurrentReads() const
+{
+    // Every read opens its own file
+    return true;
+}
+
 } // namespace lvr2
\ No newline at end of file
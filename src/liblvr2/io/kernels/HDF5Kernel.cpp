@@ -692,4 +692,12 @@ std::unordered_map<std::string, YAML::Node> HDF5Kernel::metas(
     return ret;
 }
 
+bool HDF5Kernel::concurrentReads() const
+{
+    // Only a thread-safe build of the HDF5 library serializes concurrent calls
+    hbool_t threadSafe = 0;
+    H5is_library_threadsafe(&threadSafe);
+    return threadSafe > 0;
+}
+
 } // namespace lvr2
@@ -4,6 +4,8 @@
 
 #include <iostream>
 
+#include <ogr_spatialref.h>
+
 #include "lvr2/io/modelio/GeoTIFFIO.hpp"
 #include "lvr2/util/Timestamp.hpp"
 
@@ -18,6 +20,33 @@ GeoTIFFIO::GeoTIFFIO(std::string filename, int cols, int rows, int bands) : m_co
     m_gtif_dataset = m_gtif_driver->Create(filename.c_str(), m_cols, m_rows, m_bands, GDT_UInt16, NULL);
 }
 
+GeoTIFFIO::GeoTIFFIO(std::string filename, int cols, int rows, int bands,
+                     GDALDataType type, int blockSize, std::string compression)
+    : m_cols(cols), m_rows(rows), m_bands(bands), m_compression(compression)
+{
+    GDALAllRegister();
+    m_gtif_driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+
+    std::string block = std::to_string(blockSize);
+    char **options = NULL;
+    options = CSLSetNameValue(options, "TILED", "YES");
+    options = CSLSetNameValue(options, "BLOCKXSIZE", block.c_str());
+    options = CSLSetNameValue(options, "BLOCKYSIZE", block.c_str());
+    options = CSLSetNameValue(options, "COMPRESS", compression.c_str());
+    if (compression != "NONE")
+    {
+        // Floating point predictor for height values, horizontal differencing otherwise
+        bool isFloat = type == GDT_Float32 || type == GDT_Float64;
+        options = CSLSetNameValue(options, "PREDICTOR", isFloat ? "3" : "2");
+        options = CSLSetNameValue(options, "NUM_THREADS", "ALL_CPUS");
+    }
+    options = CSLSetNameValue(options, "BIGTIFF", "IF_SAFER");
+    options = CSLSetNameValue(options, "SPARSE_OK", "TRUE");
+
+    m_gtif_dataset = m_gtif_driver->Create(filename.c_str(), m_cols, m_rows, m_bands, type, options);
+    CSLDestroy(options);
+}
+
 GeoTIFFIO::GeoTIFFIO(std::string filename)
 {
     GDALAllRegister();
@@ -56,6 +85,87 @@ int GeoTIFFIO::writeBand(cv::Mat *mat, int band)
     return 0;
 }
 
+int GeoTIFFIO::writeBlock(const float *data, int band, int xOff, int yOff, int width, int height)
+{
+    if (!m_gtif_dataset)
+    {
+        std::cout << timestamp << "GeoTIFF dataset not initialized!" << std::endl;
+        return -1;
+    }
+
+    // GDAL datasets must not be accessed concurrently
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_gtif_dataset->GetRasterBand(band)->RasterIO(
+            GF_Write, xOff, yOff, width, height, const_cast<float *>(data),
+            width, height, GDT_Float32, 0, 0) != CE_None)
+    {
+        std::cout << timestamp << "An error occurred in GDAL while writing band "
+            << band << " at (" << xOff << ", " << yOff << ")." << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+void GeoTIFFIO::setGeoTransform(double *geoTransform)
+{
+    if (m_gtif_dataset)
+    {
+        m_gtif_dataset->SetGeoTransform(geoTransform);
+    }
+}
+
+int GeoTIFFIO::setSpatialReference(const std::string& srs)
+{
+    if (!m_gtif_dataset)
+    {
+        return -1;
+    }
+
+    OGRSpatialReference reference;
+    if (reference.SetFromUserInput(srs.c_str()) != OGRERR_NONE)
+    {
+        std::cout << timestamp << "Unable to interpret coordinate system " << srs << std::endl;
+        return -1;
+    }
+
+    char *wkt = NULL;
+    reference.exportToWkt(&wkt);
+    CPLErr error = m_gtif_dataset->SetProjection(wkt);
+    CPLFree(wkt);
+    return error == CE_None ? 0 : -1;
+}
+
+void GeoTIFFIO::setNoDataValue(int band_index, double value)
+{
+    if (m_gtif_dataset)
+    {
+        m_gtif_dataset->GetRasterBand(band_index)->SetNoDataValue(value);
+    }
+}
+
+int GeoTIFFIO::buildOverviews(std::vector<int> factors, const std::string& resampling)
+{
+    if (!m_gtif_dataset || factors.empty())
+    {
+        return -1;
+    }
+
+    if (!m_compression.empty())
+    {
+        CPLSetThreadLocalConfigOption("COMPRESS_OVERVIEW", m_compression.c_str());
+    }
+    CPLErr error = m_gtif_dataset->BuildOverviews(
+        resampling.c_str(), factors.size(), factors.data(), 0, NULL, GDALTermProgress, NULL);
+    CPLSetThreadLocalConfigOption("COMPRESS_OVERVIEW", NULL);
+
+    if (error != CE_None)
+    {
+        std::cout << timestamp << "An error occurred in GDAL while building overviews." << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
 int GeoTIFFIO::getRasterWidth()
 {
     if(m_gtif_dataset)
@@ -32,82 +32,547 @@
  *  @author Thomas Wiemann
  */
 
-#include <iostream>
-using std::cout;
-using std::endl;
-
 #include "lvr2/io/modelio/LasIO.hpp"
-#include "lvr2/util/Timestamp.hpp"
+#include "lvr2/config/lvropenmp.hpp"
+#include "lvr2/util/Logging.hpp"
 
 #include <lasreader.hpp>
 #include <laswriter.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
 namespace lvr2
 {
 
+namespace
+{
+
+/// Minimal number of point records a reader thread decodes
+constexpr size_t LAS_MIN_RANGE_SIZE = 100000;
+
+/// Number of point records that are encoded in parallel before writing them
+constexpr size_t LAS_WRITE_BATCH_SIZE = 1 << 20;
+
+/// Destination of the decoded attributes, unused attributes are nullptr
+struct LasColumns
+{
+    float* points = nullptr;
+    float* intensities = nullptr;
+    uint16_t* rgb = nullptr;
+    unsigned char* classifications = nullptr;
+};
+
+/// Attributes that are read in addition to the coordinates
+struct LasAttributes
+{
+    bool intensities;
+    bool colors;
+    bool classifications;
+};
+
+/// Points and attributes of one range of point records inside a bounding box
+struct LasRangeBuffer
+{
+    std::vector<float> points;
+    std::vector<float> intensities;
+    std::vector<uint16_t> rgb;
+    std::vector<unsigned char> classifications;
+    size_t size = 0;
+};
+
+LASreader* openLasReader(const std::string& filename)
+{
+    LASreadOpener opener;
+    opener.set_file_name(filename.c_str());
+    return opener.active() ? opener.open() : nullptr;
+}
+
+/// Stores the attributes of p at index j of out. Files without colors
+/// get gray values from the intensities.
+inline void decodePoint(const LASpoint& p, const LasColumns& out, size_t j)
+{
+    out.points[3 * j]     = p.get_x();
+    out.points[3 * j + 1] = p.get_y();
+    out.points[3 * j + 2] = p.get_z();
+
+    if (out.intensities)
+    {
+        out.intensities[j] = p.intensity;
+    }
+    if (out.rgb)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            out.rgb[3 * j + c] = p.have_rgb ? p.rgb[c] : p.intensity;
+        }
+    }
+    if (out.classifications)
+    {
+        out.classifications[j] = p.classification;
+    }
+}
+
+/// Makes room for one more point in buffer and returns the columns to decode it into
+LasColumns appendPoint(LasRangeBuffer& buffer, const LasAttributes& attributes)
+{
+    const size_t n = ++buffer.size;
+    LasColumns out;
+    buffer.points.resize(3 * n);
+    out.points = buffer.points.data();
+    if (attributes.intensities)
+    {
+        buffer.intensities.resize(n);
+        out.intensities = buffer.intensities.data();
+    }
+    if (attributes.colors)
+    {
+        buffer.rgb.resize(3 * n);
+        out.rgb = buffer.rgb.data();
+    }
+    if (attributes.classifications)
+    {
+        buffer.classifications.resize(n);
+        out.classifications = buffer.classifications.data();
+    }
+    return out;
+}
+
+} // namespace
+
 ModelPtr LasIO::read(string filename )
 {
+    return readPoints(filename, nullptr, true, true, false);
+}
 
-    // Create Lasreader object
-    LASreadOpener lasreadopener;
-    lasreadopener.set_file_name(filename.c_str());
+ModelPtr LasIO::read(string filename, bool readColors, bool readIntensities, bool readClassifications)
+{
+    return readPoints(filename, nullptr, readColors, readIntensities, readClassifications);
+}
 
-    if(lasreadopener.active())
+ModelPtr LasIO::read(string filename, const BoundingBox<BaseVector<float>>& bb,
+                     bool readColors, bool readIntensities, bool readClassifications)
+{
+    return readPoints(filename, &bb, readColors, readIntensities, readClassifications);
+}
+
+bool LasIO::readHeader(string filename, BoundingBox<BaseVector<float>>& bb, size_t& numPoints)
+{
+    std::unique_ptr<LASreader> reader(openLasReader(filename));
+    if (!reader)
+    {
+        lvr2::logout::get() << lvr2::error << "[LasIO] Unable to open file " << filename << lvr2::endl;
+        return false;
+    }
+
+    bb = BoundingBox<BaseVector<float>>(
+        BaseVector<float>(reader->get_min_x(), reader->get_min_y(), reader->get_min_z()),
+        BaseVector<float>(reader->get_max_x(), reader->get_max_y(), reader->get_max_z()));
+    numPoints = reader->npoints;
+    return true;
+}
+
+bool LasIO::readChunks(string filename, size_t chunkSize, const std::function<void(PointBufferPtr)>& process)
+{
+    LASreader* first = openLasReader(filename);
+    if (!first)
     {
-        LASreader* lasreader = lasreadopener.open();
+        lvr2::logout::get() << lvr2::error << "[LasIO] Unable to open file " << filename << lvr2::endl;
+        return false;
+    }
 
-        // Get number of points in file
-        size_t num_points = lasreader->npoints;
+    const size_t numRecords = first->npoints;
+    chunkSize = std::max<size_t>(1, std::min(chunkSize, numRecords));
 
-        // Alloc coordinate array
-        floatArr points ( new float[3 * num_points]);
-        floatArr intensities ( new float[num_points]);
-        ucharArr colors (new unsigned char[3 * num_points]);
+    // Each reader decodes one range of every chunk
+    const size_t maxRanges = std::max<size_t>(1, chunkSize / LAS_MIN_RANGE_SIZE);
+    const size_t numRanges = std::min<size_t>(std::max(1, OpenMPConfig::getNumThreads()), maxRanges);
 
-        // Read point data
-        for(size_t i = 0; i < num_points; i++)
+    std::vector<std::unique_ptr<LASreader>> readers(numRanges);
+    readers[0].reset(first);
+    for (size_t r = 1; r < numRanges; r++)
+    {
+        readers[r].reset(openLasReader(filename));
+        if (!readers[r])
         {
-            size_t buf_pos = 3 * i;
-            lasreader->read_point();
-            points[buf_pos]     = lasreader->point.x;
-            points[buf_pos + 1] = lasreader->point.y;
-            points[buf_pos + 2] = lasreader->point.z;
+            lvr2::logout::get() << lvr2::error << "[LasIO] Unable to open file " << filename << lvr2::endl;
+            return false;
+        }
+    }
+
+    // Next record of each reader, a reader only seeks if its range does not follow
+    std::vector<size_t> positions(numRanges, 0);
 
-            // Create fake colors from intensities
-            /// TODO: Check for color attributes if possible...
-            colors[buf_pos] = lasreader->point.intensity;
-            colors[buf_pos + 1] = lasreader->point.intensity;
-            colors[buf_pos + 2] = lasreader->point.intensity;
+    for (size_t chunk = 0; chunk < numRecords; chunk += chunkSize)
+    {
+        const size_t n = std::min(chunkSize, numRecords - chunk);
+        const size_t rangeSize = (n + numRanges - 1) / numRanges;
+
+        floatArr points(new float[3 * n]);
+        LasColumns columns;
+        columns.points = points.get();
 
-            intensities[i] = lasreader->point.intensity;
+        bool ok = true;
+        #pragma omp parallel for schedule(static, 1) reduction(&&:ok)
+        for (size_t r = 0; r < numRanges; r++)
+        {
+            LASreader* reader = readers[r].get();
+            const size_t begin = chunk + r * rangeSize;
+            const size_t end = std::min(chunk + n, begin + rangeSize);
+            if (begin >= end)
+            {
+                continue;
+            }
+            if (positions[r] != begin && !reader->seek(begin))
+            {
+                ok = false;
+                continue;
+            }
 
+            for (size_t i = begin; i < end; i++)
+            {
+                if (!reader->read_point())
+                {
+                    ok = false;
+                    break;
+                }
+                decodePoint(reader->point, columns, i - chunk);
+            }
+            positions[r] = end;
         }
 
-        // Create point buffer and model
-        PointBufferPtr p_buffer( new PointBuffer);
-        p_buffer->setPointArray(points, num_points);
-        p_buffer->addFloatChannel(intensities, "intensities", num_points, 1);
-        p_buffer->setColorArray(colors, num_points);
+        if (!ok)
+        {
+            lvr2::logout::get() << lvr2::error << "[LasIO] Unexpected end of file " << filename << lvr2::endl;
+            return false;
+        }
+
+        process(PointBufferPtr(new PointBuffer(points, n)));
+    }
+    return true;
+}
+
+ModelPtr LasIO::readPoints(const string& filename, const BoundingBox<BaseVector<float>>* bb,
+                           bool readColors, bool readIntensities, bool readClassifications)
+{
+    LASreader* first = openLasReader(filename);
+    if (!first)
+    {
+        lvr2::logout::get() << lvr2::error << "[LasIO] Unable to open file " << filename << lvr2::endl;
+        return ModelPtr();
+    }
+
+    const size_t numRecords = first->npoints;
+
+    // Skip files that do not intersect the requested area
+    BoundingBox<BaseVector<float>> fileBB(
+        BaseVector<float>(first->get_min_x(), first->get_min_y(), first->get_min_z()),
+        BaseVector<float>(first->get_max_x(), first->get_max_y(), first->get_max_z()));
+    if (bb && !bb->overlap(fileBB))
+    {
+        delete first;
+        m_model = ModelPtr(new Model(PointBufferPtr(new PointBuffer)));
+        return m_model;
+    }
+
+    // Each range of point records is decoded by its own reader
+    const size_t maxRanges = std::max<size_t>(1, numRecords / LAS_MIN_RANGE_SIZE);
+    const size_t numRanges = std::min<size_t>(std::max(1, OpenMPConfig::getNumThreads()), maxRanges);
+    const size_t rangeSize = (numRecords + numRanges - 1) / numRanges;
+
+    std::vector<std::unique_ptr<LASreader>> readers(numRanges);
+    readers[0].reset(first);
+    for (size_t r = 1; r < numRanges; r++)
+    {
+        readers[r].reset(openLasReader(filename));
+        if (!readers[r])
+        {
+            lvr2::logout::get() << lvr2::error << "[LasIO] Unable to open file " << filename << lvr2::endl;
+            return ModelPtr();
+        }
+    }
+
+    // Columns of the result. With a bounding box the number of points is only
+    // known after decoding, so each range collects its points separately.
+    floatArr points;
+    floatArr intensities;
+    std::unique_ptr<uint16_t[]> rgb;
+    ucharArr classifications;
+    std::vector<LasRangeBuffer> rangeBuffers(bb ? numRanges : 0);
 
-        ModelPtr m_ptr( new Model(p_buffer));
-        m_model = m_ptr;
+    const LasAttributes attributes{readIntensities, readColors, readClassifications};
+    LasColumns columns;
+    if (!bb)
+    {
+        points = floatArr(new float[3 * numRecords]);
+        columns.points = points.get();
+        if (readIntensities)
+        {
+            intensities = floatArr(new float[numRecords]);
+            columns.intensities = intensities.get();
+        }
+        if (readColors)
+        {
+            rgb.reset(new uint16_t[3 * numRecords]);
+            columns.rgb = rgb.get();
+        }
+        if (readClassifications)
+        {
+            classifications = ucharArr(new unsigned char[numRecords]);
+            columns.classifications = classifications.get();
+        }
+    }
 
-        delete lasreader;
+    bool ok = true;
+    #pragma omp parallel for schedule(static, 1) reduction(&&:ok)
+    for (size_t r = 0; r < numRanges; r++)
+    {
+        LASreader* reader = readers[r].get();
+        const size_t begin = r * rangeSize;
+        const size_t end = std::min(numRecords, begin + rangeSize);
+        if (begin >= end || (begin > 0 && !reader->seek(begin)))
+        {
+            ok = begin >= end;
+            continue;
+        }
 
-        return m_ptr;
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!reader->read_point())
+            {
+                ok = false;
+                break;
+            }
+            if (!bb)
+            {
+                decodePoint(reader->point, columns, i);
+            }
+            else if (bb->contains(BaseVector<float>(reader->point.get_x(), reader->point.get_y(), reader->point.get_z())))
+            {
+                const LasColumns out = appendPoint(rangeBuffers[r], attributes);
+                decodePoint(reader->point, out, rangeBuffers[r].size - 1);
+            }
+        }
     }
-    else
+    readers.clear();
+
+    if (!ok)
     {
-        cout << timestamp << "LasIO::read(): Unable to open file " << filename << endl;
+        lvr2::logout::get() << lvr2::error << "[LasIO] Unexpected end of file " << filename << lvr2::endl;
         return ModelPtr();
     }
+
+    size_t numPoints = numRecords;
+    if (bb)
+    {
+        // Concatenate the points of all ranges
+        std::vector<size_t> offsets(numRanges + 1, 0);
+        for (size_t r = 0; r < numRanges; r++)
+        {
+            offsets[r + 1] = offsets[r] + rangeBuffers[r].size;
+        }
+        numPoints = offsets.back();
+
+        points = floatArr(new float[3 * numPoints]);
+        if (readIntensities)
+        {
+            intensities = floatArr(new float[numPoints]);
+        }
+        if (readColors)
+        {
+            rgb.reset(new uint16_t[3 * numPoints]);
+        }
+        if (readClassifications)
+        {
+            classifications = ucharArr(new unsigned char[numPoints]);
+        }
+
+        #pragma omp parallel for schedule(static, 1)
+        for (size_t r = 0; r < numRanges; r++)
+        {
+            const LasRangeBuffer& range = rangeBuffers[r];
+            const size_t o = offsets[r];
+            std::copy(range.points.begin(), range.points.end(), points.get() + 3 * o);
+            if (readIntensities)
+            {
+                std::copy(range.intensities.begin(), range.intensities.end(), intensities.get() + o);
+            }
+            if (readColors)
+            {
+                std::copy(range.rgb.begin(), range.rgb.end(), rgb.get() + 3 * o);
+            }
+            if (readClassifications)
+            {
+                std::copy(range.classifications.begin(), range.classifications.end(), classifications.get() + o);
+            }
+        }
+        rangeBuffers.clear();
+    }
+
+    PointBufferPtr p_buffer( new PointBuffer);
+    p_buffer->setPointArray(points, numPoints);
+
+    if (readIntensities)
+    {
+        p_buffer->addFloatChannel(intensities, "intensities", numPoints, 1);
+    }
+
+    if (readColors)
+    {
+        // The LAS specification demands 16 bit colors, but many files only
+        // use the lower 8 bits
+        uint16_t maxValue = 0;
+        #pragma omp parallel for schedule(static) reduction(max:maxValue)
+        for (size_t i = 0; i < 3 * numPoints; i++)
+        {
+            maxValue = std::max(maxValue, rgb[i]);
+        }
+        const int shift = maxValue > 255 ? 8 : 0;
+
+        ucharArr colors(new unsigned char[3 * numPoints]);
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < 3 * numPoints; i++)
+        {
+            colors[i] = static_cast<unsigned char>(rgb[i] >> shift);
+        }
+        p_buffer->setColorArray(colors, numPoints);
+    }
+
+    if (readClassifications)
+    {
+        p_buffer->addUCharChannel(classifications, "classifications", numPoints, 1);
+    }
+
+    ModelPtr m_ptr( new Model(p_buffer));
+    m_model = m_ptr;
+
+    return m_ptr;
 }
 
 
 void LasIO::save( string filename )
 {
-    /// TODO: Implement LAS output
-    std::cerr << "LASIO: Saving not yet implemented." << endl;
+    if (!m_model || !m_model->m_pointCloud)
+    {
+        lvr2::logout::get() << lvr2::error << "[LasIO] No point cloud to save" << lvr2::endl;
+        return;
+    }
+
+    PointBufferPtr buffer = m_model->m_pointCloud;
+    const size_t numPoints = buffer->numPoints();
+    if (numPoints > std::numeric_limits<U32>::max())
+    {
+        lvr2::logout::get() << lvr2::error << "[LasIO] Too many points for a LAS file: " << numPoints << lvr2::endl;
+        return;
+    }
+
+    floatArr points = buffer->getPointArray();
+
+    size_t n, w;
+    ucharArr colors = buffer->getColorArray(w);
+    if (colors && w < 3)
+    {
+        colors.reset();
+    }
+    const size_t colorWidth = colors ? w : 0;
+    floatArr intensities = buffer->getFloatArray("intensities", n, w);
+    if (intensities && w != 1)
+    {
+        intensities.reset();
+    }
+    ucharArr classifications = buffer->getUCharArray("classifications", n, w);
+    if (classifications && w != 1)
+    {
+        classifications.reset();
+    }
+
+    // Header with millimeter resolution relative to the minimum of the points
+    double minX = std::numeric_limits<double>::max();
+    double minY = minX, minZ = minX;
+    #pragma omp parallel for schedule(static) reduction(min:minX, minY, minZ)
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        minX = std::min<double>(minX, points[3 * i]);
+        minY = std::min<double>(minY, points[3 * i + 1]);
+        minZ = std::min<double>(minZ, points[3 * i + 2]);
+    }
+
+    LASheader header;
+    header.point_data_format = colors ? 2 : 0;
+    header.point_data_record_length = colors ? 26 : 20;
+    header.number_of_point_records = numPoints;
+    header.x_scale_factor = header.y_scale_factor = header.z_scale_factor = 0.001;
+    header.x_offset = numPoints ? std::floor(minX) : 0.0;
+    header.y_offset = numPoints ? std::floor(minY) : 0.0;
+    header.z_offset = numPoints ? std::floor(minZ) : 0.0;
+
+    LASwriteOpener opener;
+    opener.set_file_name(filename.c_str());
+    LASwriter* writer = opener.open(&header);
+    if (!writer)
+    {
+        lvr2::logout::get() << lvr2::error << "[LasIO] Unable to open file " << filename << lvr2::endl;
+        return;
+    }
+
+    // Encode batches of records in parallel, the writer itself is sequential
+    const U16 recordLength = header.point_data_record_length;
+    std::vector<U8> records(std::min(numPoints, LAS_WRITE_BATCH_SIZE) * recordLength);
+
+    LASpoint point;
+    point.init(&header, header.point_data_format, recordLength);
+
+    for (size_t begin = 0; begin < numPoints; begin += LAS_WRITE_BATCH_SIZE)
+    {
+        const size_t count = std::min(LAS_WRITE_BATCH_SIZE, numPoints - begin);
+
+        #pragma omp parallel
+        {
+            LASpoint local;
+            local.init(&header, header.point_data_format, recordLength);
+
+            #pragma omp for schedule(static)
+            for (size_t j = 0; j < count; j++)
+            {
+                const size_t i = begin + j;
+                local.set_x(points[3 * i]);
+                local.set_y(points[3 * i + 1]);
+                local.set_z(points[3 * i + 2]);
+                if (intensities)
+                {
+                    local.intensity = static_cast<U16>(std::clamp(std::lround(intensities[i]), 0L, 65535L));
+                }
+                if (colors)
+                {
+                    for (int c = 0; c < 3; c++)
+                    {
+                        // Scale to the full 16 bit range
+                        local.rgb[c] = colors[colorWidth * i + c] * 257;
+                    }
+                }
+                if (classifications)
+                {
+                    local.classification = classifications[i];
+                }
+                local.copy_to(&records[j * recordLength]);
+            }
+        }
+
+        for (size_t j = 0; j < count; j++)
+        {
+            point.copy_from(&records[j * recordLength]);
+            writer->write_point(&point);
+            writer->update_inventory(&point);
+        }
+    }
+
+    writer->update_header(&header, TRUE);
+    writer->close();
+    delete writer;
 }
 
 } /* namespace lvr2 */
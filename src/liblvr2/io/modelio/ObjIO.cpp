@@ -37,6 +37,7 @@
  */
 
 #include <climits>
+#include <initializer_list>
 #include <iostream>
 #include <fstream>
 #include <string.h>
@@ -44,9 +45,12 @@
 #include <sstream>
 
 #include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/tuple/tuple.hpp>
 
 #include "lvr2/io/modelio/ObjIO.hpp"
+#include "lvr2/config/lvropenmp.hpp"
+#include "lvr2/util/AsciiUtil.hpp"
 #include "lvr2/util/Util.hpp"
 #include "lvr2/util/Timestamp.hpp"
 #include "lvr2/texture/TextureFactory.hpp"
@@ -56,26 +60,186 @@
 namespace lvr2
 {
 
-void tokenize(const std::string& str,
-                      std::vector<std::string>& tokens,
-                      const std::string& delimiters = " ")
+namespace
 {
-    // Skip delimiters at beginning.
-    std::string::size_type lastPos = str.find_first_not_of(delimiters, 0);
-    // Find first "non-delimiter".
-    std::string::size_type pos     = str.find_first_of(delimiters, lastPos);
 
-    while (string::npos != pos || string::npos != lastPos)
+/// Lines are parsed in blocks of about this size
+const size_t OBJ_BLOCK_SIZE = 4 * 1024 * 1024;
+
+/// Number of faces or vertices formatted per block when saving
+const size_t OBJ_WRITE_BLOCK = 1 << 16;
+
+/// A usemtl or mtllib statement and the number of faces of its block before it
+struct ObjStatement
+{
+    bool        usemtl;
+    std::string name;
+    size_t      face;
+    int         material;
+};
+
+/// A line aligned part of an OBJ file
+struct ObjBlock
+{
+    const char* begin;
+    const char* end;
+
+    size_t numVertices  = 0;
+    size_t numColors    = 0;
+    size_t numTexCoords = 0;
+    size_t numNormals   = 0;
+    size_t numFaces     = 0;
+
+    // Positions of the first elements of this block in the channels
+    size_t vertexOffset   = 0;
+    size_t colorOffset    = 0;
+    size_t texCoordOffset = 0;
+    size_t normalOffset   = 0;
+    size_t faceOffset     = 0;
+
+    // Material of the faces before the first usemtl statement
+    int material = 0;
+
+    std::vector<ObjStatement> statements;
+};
+
+using asciiutil::skipBlanks;
+using asciiutil::tokenEnd;
+using asciiutil::parseFloat;
+
+/// Formats the keyword and the values like "%s %g %g ...\n" would in the C
+/// locale, regardless of the global locale. Returns the length of the line.
+inline int formatLine(char* line, const char* keyword, std::initializer_list<double> values,
+                      bool trailingBlank = false)
+{
+    char* p = line;
+    while(*keyword)
+    {
+        *p++ = *keyword++;
+    }
+    for(double value : values)
+    {
+        *p++ = ' ';
+        p = asciiutil::formatFloat(p, value);
+    }
+    if(trailingBlank)
+    {
+        *p++ = ' ';
+    }
+    *p++ = '\n';
+    return p - line;
+}
+
+/// Parses the vertex index of a face token like 1, 1/2 or 1/2/3
+inline long parseFaceIndex(const char* p, const char* end)
+{
+    while(p < end && *p == '/')
+    {
+        p++;
+    }
+    bool negative = p < end && *p == '-';
+    if(p < end && (*p == '-' || *p == '+'))
+    {
+        p++;
+    }
+    long value = 0;
+    while(p < end && *p >= '0' && *p <= '9')
+    {
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    return negative ? -value : value;
+}
+
+/// Returns the keyword of the line and moves p behind it
+inline std::string keyword(const char*& p, const char* end)
+{
+    p = skipBlanks(p, end);
+    const char* e = tokenEnd(p, end);
+    std::string k(p, e);
+    p = e;
+    return k;
+}
+
+/// Calls f(keyword, rest of line) for each line of the block
+template<typename F>
+void forEachLine(const ObjBlock& block, F f)
+{
+    const char* line = block.begin;
+    while(line < block.end)
+    {
+        const char* eol = (const char*)memchr(line, '\n', block.end - line);
+        if(!eol)
+        {
+            eol = block.end;
+        }
+
+        // Skip comments
+        if(*line != '#')
+        {
+            const char* p = line;
+            p = skipBlanks(p, eol);
+            const char* e = tokenEnd(p, eol);
+            f(p, e, e, eol);
+        }
+        line = eol + 1;
+    }
+}
+
+inline bool isKeyword(const char* k, const char* kEnd, const char* name)
+{
+    size_t len = strlen(name);
+    return (size_t)(kEnd - k) == len && memcmp(k, name, len) == 0;
+}
+
+/// Checks whether the vertex definition starting at p carries a color, i.e. has a
+/// fourth value that can be parsed
+inline bool hasVertexColor(const char* p, const char* end)
+{
+    for(int i = 0; i < 3; i++)
     {
-        // Found a token, add it to the vector.
-        tokens.push_back(str.substr(lastPos, pos - lastPos));
-        // Skip delimiters.  Note the "not_of"
-        lastPos = str.find_first_not_of(delimiters, pos);
-        // Find next "non-delimiter"
-        pos = str.find_first_of(delimiters, lastPos);
+        p = tokenEnd(skipBlanks(p, end), end);
+    }
+    float r;
+    return parseFloat(p, end, r);
+}
+
+/// Formats count elements in blocks and writes them to out in order. The
+/// blocks of each round are formatted in parallel.
+template<typename F>
+void writeBlocks(std::ofstream& out, size_t count, F format)
+{
+    size_t numBlocks = (count + OBJ_WRITE_BLOCK - 1) / OBJ_WRITE_BLOCK;
+    size_t blocksPerRound = 4 * OpenMPConfig::getNumThreads();
+    std::vector<std::string> buffers(blocksPerRound);
+
+    for(size_t first = 0; first < numBlocks; first += blocksPerRound)
+    {
+        size_t n = std::min(blocksPerRound, numBlocks - first);
+
+        #pragma omp parallel for schedule(dynamic)
+        for(size_t b = 0; b < n; b++)
+        {
+            std::string& buffer = buffers[b];
+            buffer.clear();
+            size_t begin = (first + b) * OBJ_WRITE_BLOCK;
+            size_t end = std::min(count, begin + OBJ_WRITE_BLOCK);
+            char line[256];
+            for(size_t i = begin; i < end; i++)
+            {
+                buffer.append(line, format(i, line));
+            }
+        }
+
+        for(size_t b = 0; b < n; b++)
+        {
+            out.write(buffers[b].data(), buffers[b].size());
+        }
     }
 }
 
+} // namespace
+
 void ObjIO::parseMtlFile(
         std::map<std::string, int>& matNames,
         std::vector<Material>& materials,
@@ -168,151 +332,291 @@ ModelPtr ObjIO::read(std::string filename)
     // Get path from filename
     boost::filesystem::path p(filename);
 
-    std::ifstream in(filename.c_str());
-
     MeshBufferPtr mesh = MeshBufferPtr(new MeshBuffer);
-
-    std::vector<float>         vertices;
-    std::vector<float>         normals;
-    std::vector<unsigned char> colors;
-    std::vector<float>         texcoords;
-    std::vector<uint>          faceMaterials;
-    std::vector<uint>          faces;
     std::vector<Material>&     materials = mesh->getMaterials();
     std::vector<Texture>&      textures = mesh->getTextures();
 
     std::map<std::string, int> matNames;
 
-    int currentMat = 0;
+    // Map the whole file, empty files can not be mapped
+    boost::iostreams::mapped_file_source file;
+    boost::system::error_code error;
+    uintmax_t fileSize = boost::filesystem::file_size(filename, error);
+    if(!error && fileSize > 0)
+    {
+        try
+        {
+            file.open(filename);
+        }
+        catch(const std::exception& e)
+        {
+            std::cout << timestamp << "ObjIO::read(): " << e.what() << std::endl;
+        }
+    }
 
-    if(in.good())
+    if(!file.is_open())
     {
-        char buffer[1024];
-        while(in.good())
+        if(error || fileSize > 0)
         {
-            in.getline(buffer, 1024);
+            std::cout << timestamp << "ObjIO::read(): Unable to open file'" << filename << "'." << std::endl;
+        }
+        ModelPtr m(new Model(mesh));
+        m_model = m;
+        return m;
+    }
 
-            // Skip comments
-            if(buffer[0] == '#') continue;
+    // =======================================================================
+    // Split the file into line aligned blocks
+    // =======================================================================
+    const char* data = file.data();
+    const char* dataEnd = data + file.size();
+    size_t numBlocks = std::max<size_t>(1, file.size() / OBJ_BLOCK_SIZE);
 
-            std::stringstream ss(buffer);
-            std::string keyword;
-            ss >> keyword;
-            float x, y, z;
-            float r, g, b;
-            if(keyword == "v")
+    std::vector<ObjBlock> blocks(numBlocks);
+    const char* begin = data;
+    for(size_t i = 0; i < numBlocks; i++)
+    {
+        const char* end = dataEnd;
+        if(i + 1 < numBlocks)
+        {
+            end = std::max(begin, data + (i + 1) * (file.size() / numBlocks));
+            const char* eol = (const char*)memchr(end, '\n', dataEnd - end);
+            end = eol ? eol + 1 : dataEnd;
+        }
+        blocks[i].begin = begin;
+        blocks[i].end = end;
+        begin = end;
+    }
+
+    // =======================================================================
+    // Count the elements of each block
+    // =======================================================================
+    #pragma omp parallel for schedule(dynamic)
+    for(size_t i = 0; i < numBlocks; i++)
+    {
+        ObjBlock& block = blocks[i];
+        forEachLine(block, [&](const char* k, const char* kEnd, const char* p, const char* eol)
+        {
+            if(isKeyword(k, kEnd, "v"))
             {
-                ss >> x >> y >> z;
-                vertices.push_back(x);
-                vertices.push_back(y);
-                vertices.push_back(z);
-                // TODO: check if r is end of line
-                std::string s;
-                bool colors_exist = static_cast<bool>(ss >> r);
-                // r = s[0];
-                ss >> g >> b;
-                if(colors_exist)
+                block.numVertices++;
+                if(hasVertexColor(p, eol))
                 {
-                    colors.push_back(static_cast<unsigned char>(r*255.0 + 0.5));
-                    colors.push_back(static_cast<unsigned char>(g*255.0 + 0.5));
-                    colors.push_back(static_cast<unsigned char>(b*255.0 + 0.5));
+                    block.numColors++;
                 }
             }
-            else if(keyword == "vt")
+            else if(isKeyword(k, kEnd, "vt"))
             {
-                ss >> x >> y >> z;
-                texcoords.push_back(x);
-                texcoords.push_back(1.0 - y);
-                // z is ignored because texcoords only have 2 coords...
-                //texcoords.push_back(z);
+                block.numTexCoords++;
             }
-            else if(keyword == "vn")
+            else if(isKeyword(k, kEnd, "vn"))
             {
-                ss >> x >> y >> z;
-                normals.push_back(x);
-                normals.push_back(y);
-                normals.push_back(z);
+                block.numNormals++;
             }
-            else if(keyword == "f")
+            else if(isKeyword(k, kEnd, "f"))
             {
-                std::vector<std::string> tokens;
-                tokenize(buffer, tokens);
-
-                if(tokens.size() < 4)
-                    continue;
-
-                std::vector<std::string> tokens2;
-                tokenize(tokens.at(1),tokens2,"/");
-                int a = atoi(tokens2.at(0).c_str());
-                tokens2.clear();
-
-                tokenize(tokens.at(2),tokens2,"/");
-                int b = atoi(tokens2.at(0).c_str());
-                tokens2.clear();
-
-                tokenize(tokens.at(3),tokens2,"/");
-                int c = atoi(tokens2.at(0).c_str());
-                tokens2.clear();
-
-                faces.push_back(a - 1);
-                faces.push_back(b - 1);
-                faces.push_back(c - 1);
-
-                // Use current material
-                faceMaterials.push_back(currentMat);
+                int n = 0;
+                for(p = skipBlanks(p, eol); p < eol && n < 3; p = skipBlanks(tokenEnd(p, eol), eol))
+                {
+                    n++;
+                }
+                if(n == 3)
+                {
+                    block.numFaces++;
+                }
             }
-            else if(keyword == "usemtl")
+            else if(isKeyword(k, kEnd, "usemtl") || isKeyword(k, kEnd, "mtllib"))
+            {
+                ObjStatement statement;
+                statement.usemtl = isKeyword(k, kEnd, "usemtl");
+                statement.name = keyword(p, eol);
+                statement.face = block.numFaces;
+                statement.material = 0;
+                block.statements.push_back(statement);
+            }
+        });
+    }
+
+    // =======================================================================
+    // Compute the offsets of the blocks and resolve the materials in order
+    // =======================================================================
+    size_t numVertices = 0, numColors = 0, numTexCoords = 0, numNormals = 0, numFaces = 0;
+    int currentMat = 0;
+    for(ObjBlock& block : blocks)
+    {
+        block.vertexOffset = numVertices;
+        block.colorOffset = numColors;
+        block.texCoordOffset = numTexCoords;
+        block.normalOffset = numNormals;
+        block.faceOffset = numFaces;
+        numVertices += block.numVertices;
+        numColors += block.numColors;
+        numTexCoords += block.numTexCoords;
+        numNormals += block.numNormals;
+        numFaces += block.numFaces;
+
+        block.material = currentMat;
+        for(ObjStatement& statement : block.statements)
+        {
+            if(statement.usemtl)
             {
-                std::string mtlname;
-                ss >> mtlname;
                 // Find name and set current material
-                std::map<std::string, int>::iterator it = matNames.find(mtlname);
+                std::map<std::string, int>::iterator it = matNames.find(statement.name);
                 if(it == matNames.end())
                 {
-                    std::cout << "ObjIO:read(): Warning material '" << mtlname << "' is undefined." << std::endl;
+                    std::cout << "ObjIO:read(): Warning material '" << statement.name << "' is undefined." << std::endl;
                 }
                 else
                 {
                     currentMat = it->second;
                 }
             }
-            else if(keyword == "mtllib")
+            else
             {
-                // Get current path
+                // Get current path and append .mtl file name
                 p = p.remove_filename();
-
-                // Append .mtl file name
-                std::string mtlfile;
-                ss >> mtlfile;
-                p = p / mtlfile;
+                p = p / statement.name;
 
                 // Get path as string and parse mtl
                 std::string mtl_path = p.string();
                 parseMtlFile(matNames, materials, textures, mtl_path);
             }
+            statement.material = currentMat;
         }
-
     }
-    else
+
+    // =======================================================================
+    // Parse the blocks directly into the channels
+    // =======================================================================
+    floatArr   vertices(new float[numVertices * 3]);
+    ucharArr   colors(new unsigned char[numColors * 3]);
+    floatArr   texcoords(new float[numTexCoords * 2]);
+    floatArr   normals(new float[numNormals * 3]);
+    indexArray faces(new unsigned int[numFaces * 3]);
+    indexArray faceMaterials(new unsigned int[numFaces]);
+
+    #pragma omp parallel for schedule(dynamic)
+    for(size_t i = 0; i < numBlocks; i++)
     {
-        std::cout << timestamp << "ObjIO::read(): Unable to open file'" << filename << "'." << std::endl;
+        const ObjBlock& block = blocks[i];
+        size_t v = block.vertexOffset, c = block.colorOffset, t = block.texCoordOffset, n = block.normalOffset, f = block.faceOffset;
+
+        forEachLine(block, [&](const char* k, const char* kEnd, const char* p, const char* eol)
+        {
+            float x = 0, y = 0, z = 0;
+            if(isKeyword(k, kEnd, "v"))
+            {
+                bool color = hasVertexColor(p, eol);
+                parseFloat(p, eol, x);
+                parseFloat(p, eol, y);
+                parseFloat(p, eol, z);
+                vertices[v * 3]     = x;
+                vertices[v * 3 + 1] = y;
+                vertices[v * 3 + 2] = z;
+                v++;
+                if(color)
+                {
+                    float r = 0, g = 0, b = 0;
+                    parseFloat(p, eol, r);
+                    parseFloat(p, eol, g);
+                    parseFloat(p, eol, b);
+                    colors[c * 3]     = static_cast<unsigned char>(r*255.0 + 0.5);
+                    colors[c * 3 + 1] = static_cast<unsigned char>(g*255.0 + 0.5);
+                    colors[c * 3 + 2] = static_cast<unsigned char>(b*255.0 + 0.5);
+                    c++;
+                }
+            }
+            else if(isKeyword(k, kEnd, "vt"))
+            {
+                // z is ignored because texcoords only have 2 coords...
+                parseFloat(p, eol, x);
+                parseFloat(p, eol, y);
+                texcoords[t * 2]     = x;
+                texcoords[t * 2 + 1] = 1.0 - y;
+                t++;
+            }
+            else if(isKeyword(k, kEnd, "vn"))
+            {
+                parseFloat(p, eol, x);
+                parseFloat(p, eol, y);
+                parseFloat(p, eol, z);
+                normals[n * 3]     = x;
+                normals[n * 3 + 1] = y;
+                normals[n * 3 + 2] = z;
+                n++;
+            }
+            else if(isKeyword(k, kEnd, "f"))
+            {
+                long indices[3];
+                int count = 0;
+                for(p = skipBlanks(p, eol); p < eol && count < 3; p = skipBlanks(p, eol))
+                {
+                    const char* e = tokenEnd(p, eol);
+                    indices[count++] = parseFaceIndex(p, e);
+                    p = e;
+                }
+                if(count == 3)
+                {
+                    for(int j = 0; j < 3; j++)
+                    {
+                        // Negative indices are relative to the vertices defined so far
+                        faces[f * 3 + j] = indices[j] < 0 ? v + indices[j] : indices[j] - 1;
+                    }
+                    f++;
+                }
+            }
+        });
+
+        // Use the material that was current when the faces were defined
+        size_t face = block.faceOffset;
+        int material = block.material;
+        for(const ObjStatement& statement : block.statements)
+        {
+            std::fill(faceMaterials.get() + face, faceMaterials.get() + block.faceOffset + statement.face, material);
+            face = block.faceOffset + statement.face;
+            material = statement.material;
+        }
+        std::fill(faceMaterials.get() + face, faceMaterials.get() + block.faceOffset + block.numFaces, material);
     }
 
-    mesh->setVertices(Util::convert_vector_to_shared_array(vertices), vertices.size() / 3);
-    mesh->setFaceIndices(Util::convert_vector_to_shared_array(faces), faces.size() / 3);
+    mesh->setVertices(vertices, numVertices);
+    mesh->setFaceIndices(faces, numFaces);
+    mesh->setFaceMaterialIndices(faceMaterials);
 
-    if(faceMaterials.size() == faces.size() / 3)
+    // Attributes are only added if they can be assigned to the vertices
+    if(numTexCoords)
     {
-        mesh->setFaceMaterialIndices(Util::convert_vector_to_shared_array(faceMaterials));
+        if(numTexCoords >= numVertices)
+        {
+            mesh->setTextureCoordinates(texcoords);
+        }
+        else
+        {
+            std::cout << "ObjIO::read(): Warning: Texture coordinate buffer does not match vertex number." << std::endl;
+        }
     }
-    else
+    if(numNormals)
     {
-        std::cout << "ObjIO::read(): Warning: Face material index buffer does not match face number." << std::endl;
+        if(numNormals >= numVertices)
+        {
+            mesh->setVertexNormals(normals);
+        }
+        else
+        {
+            std::cout << "ObjIO::read(): Warning: Normal buffer does not match vertex number." << std::endl;
+        }
+    }
+    if(numColors)
+    {
+        if(numColors >= numVertices)
+        {
+            mesh->setVertexColors(colors);
+        }
+        else
+        {
+            std::cout << "ObjIO::read(): Warning: Color buffer does not match vertex number." << std::endl;
+        }
     }
-
-    mesh->setTextureCoordinates(Util::convert_vector_to_shared_array(texcoords));
-    mesh->setVertexNormals(Util::convert_vector_to_shared_array(normals));
-    mesh->setVertexColors(Util::convert_vector_to_shared_array(colors));
 
     ModelPtr m(new Model(mesh));
     m_model = m;
@@ -392,168 +696,105 @@ void ObjIO::save( string filename )
         }
         out << std::endl << std::endl << "##  Beginning of vertex definitions.\n";
 
-        for( size_t i=0; i < lenVertices; ++i )
+        // The lines are formatted in parallel blocks, the output is the same
+        // as writing the values with the default stream formatting (%g)
+        writeBlocks(out, lenVertices, [&](size_t i, char* line)
         {
-            out << "v " << vertices[i*3 + 0] << " "
-                    << vertices[i*3 + 1] << " "
-                    << vertices[i*3 + 2] << " ";
-                    if(lenColors>0){
-                        unsigned char r = colors[i*w_color + 0],
-                                      g = colors[i*w_color + 1],
-                                      b = colors[i*w_color + 2];
-
-                        out << static_cast<float>(r)/255.0 << " "
-                        << static_cast<float>(g)/255.0 << " "
-                        << static_cast<float>(b)/255.0 ;
-                    }
-
-                    out << std::endl;
-        }
+            if(lenColors>0)
+            {
+                unsigned char r = colors[i*w_color + 0],
+                              g = colors[i*w_color + 1],
+                              b = colors[i*w_color + 2];
+                return formatLine(line, "v", {vertices[i*3 + 0], vertices[i*3 + 1], vertices[i*3 + 2],
+                    static_cast<float>(r)/255.0, static_cast<float>(g)/255.0, static_cast<float>(b)/255.0});
+            }
+            return formatLine(line, "v", {vertices[i*3 + 0], vertices[i*3 + 1], vertices[i*3 + 2]}, true);
+        });
 
         out<<std::endl;
 
         if (m_model->m_mesh->hasVertexNormals())
         {
             out << std::endl << std::endl << "##  Beginning of vertex normals.\n";
-            for( size_t i=0; i < lenNormals; ++i )
+            writeBlocks(out, lenNormals, [&](size_t i, char* line)
             {
-                out << "vn " << normals[i*3 + 0] << " "
-                        << normals[i*3 + 1] << " "
-                        << normals[i*3 + 2] << std::endl;
-            }
+                return formatLine(line, "vn", {normals[i*3 + 0], normals[i*3 + 1], normals[i*3 + 2]});
+            });
         }
 
         out << std::endl << std::endl << "##  Beginning of vertexTextureCoordinates.\n";
 
-        for( size_t i=0; i < lenTextureCoordinates; ++i )
+        if (textureCoordinates)
         {
-            out << "vt " << textureCoordinates[i*2 + 0] << " "
-                    << 1.0 - textureCoordinates[i*2 + 1] << " "
-                    << 0.0 << std::endl;
+            writeBlocks(out, lenTextureCoordinates, [&](size_t i, char* line)
+            {
+                return formatLine(line, "vt", {textureCoordinates[i*2 + 0], 1.0 - textureCoordinates[i*2 + 1], 0.0});
+            });
         }
 
 
         out << std::endl << std::endl << "##  Beginning of faces.\n";
-        // format of a face: f v/vt/vn
-        //for( size_t i = 0; i < lenFaces; ++i )
-        //{
-            //std::cout << faceMaterialIndices[i] << " " << lenFaceMaterials << std::endl;
-            //RGBMaterial* m = materials[faceMaterialIndices[i]];
-            //if(m->texture_index >= 0)
-            //{
-                //out << "usemtl texture_" << m->texture_index << std::endl;
-            //}
-            //else
-            //{
-                //out << "usemtl color_" << faceMaterialIndices[i] << std::endl;
-            //}
-
-            ////unsigned int* faceTextureIndices
-            ////float**       textureCoordinates
-            ////usemtl....
-            //// +1 after every index since in obj the 0-th vertex has index 1.
-            //out << "f "
-                    //<< faceIndices[i * 3 + 0] + 1 << "/"
-                    //<< faceIndices[i * 3 + 0] + 1 << "/"
-                    //<< faceIndices[i * 3 + 0] + 1 << " "
-                    //<< faceIndices[i * 3 + 1] + 1 << "/"
-                    //<< faceIndices[i * 3 + 1] + 1 << "/"
-                    //<< faceIndices[i * 3 + 1] + 1 << " "
-                    //<< faceIndices[i * 3 + 2] + 1 << "/"
-                    //<< faceIndices[i * 3 + 2] + 1 << "/"
-                    //<< faceIndices[i * 3 + 2] + 1 << std::endl;
-        //}
 
         // format of a face: f v/vt/vn
+        // +1 after every index since in obj the 0-th vertex has index 1.
+        auto formatFace = [&](size_t face_index, char* line)
+        {
+            unsigned int a = faceIndices[face_index * 3 + 0] + 1;
+            unsigned int b = faceIndices[face_index * 3 + 1] + 1;
+            unsigned int c = faceIndices[face_index * 3 + 2] + 1;
+            return sprintf(line, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c);
+        };
 
-        std::vector<int> color_indices, texture_indices;
-
-        //splitting materials in colors an textures
-        for(size_t i = 0; i< lenFaceMaterialIndices; ++i)
+        if (!faceMaterialIndices)
         {
-            Material &m = materials[faceMaterialIndices[i]];
-            if(m.m_texture)
-            {
-                texture_indices.push_back(i);
-            }else{
-                color_indices.push_back(i);
-            }
+            writeBlocks(out, lenFaces, formatFace);
+            out<<std::endl;
         }
-        //sort faceMaterialsIndices: colors, textur_indices
-        //sort new index lists instead of the faceMaterialIndices
-        std::sort(color_indices.begin(),color_indices.end(),sort_indices(faceMaterialIndices));
-        std::sort(texture_indices.begin(),texture_indices.end(),sort_indices(faceMaterialIndices));
-
-        //colors
-        for(size_t i = 0; i<color_indices.size() ; i++)
+        else
         {
-            unsigned int first = faceMaterialIndices[color_indices[i]];
-            unsigned int face_index=color_indices[i];
+            std::vector<int> color_indices, texture_indices;
 
-            if( i == 0 || first != faceMaterialIndices[color_indices[i-1]] )
-            {
-                out << "usemtl color_" << faceMaterialIndices[color_indices[i]] << std::endl;
-                out << "f "
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << " "
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << " "
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << std::endl;
-
-            }else if( first == faceMaterialIndices[color_indices[i-1]] )
+            //splitting materials in colors an textures
+            for(size_t i = 0; i< lenFaceMaterialIndices; ++i)
             {
-                out << "f "
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << " "
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << " "
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << std::endl;
+                Material &m = materials[faceMaterialIndices[i]];
+                if(m.m_texture)
+                {
+                    texture_indices.push_back(i);
+                }else{
+                    color_indices.push_back(i);
+                }
             }
-        }
+            //sort faceMaterialsIndices: colors, textur_indices
+            //sort new index lists instead of the faceMaterialIndices
+            std::sort(color_indices.begin(),color_indices.end(),sort_indices(faceMaterialIndices));
+            std::sort(texture_indices.begin(),texture_indices.end(),sort_indices(faceMaterialIndices));
 
-        out<<std::endl;
+            //colors
+            writeBlocks(out, color_indices.size(), [&](size_t i, char* line)
+            {
+                int len = 0;
+                unsigned int first = faceMaterialIndices[color_indices[i]];
+                if( i == 0 || first != faceMaterialIndices[color_indices[i-1]] )
+                {
+                    len = sprintf(line, "usemtl color_%u\n", first);
+                }
+                return len + formatFace(color_indices[i], line + len);
+            });
 
-        //textures
-        for(size_t i = 0; i<texture_indices.size() ; i++)
-        {
-            Material &first = materials[faceMaterialIndices[texture_indices[i]]];
-            size_t face_index=texture_indices[i];
+            out<<std::endl;
 
-            if(i==0 || first.m_texture != materials[faceMaterialIndices[texture_indices[i-1]]].m_texture )
-            {
-                out << "usemtl texture_" << first.m_texture->idx() << std::endl;
-                //std::cout << "usemtl texture_" << first->texture_index << std::endl;
-                out << "f "
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << " "
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << " "
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << std::endl;
-            }else if(first.m_texture == materials[faceMaterialIndices[texture_indices[i-1]]].m_texture )
+            //textures
+            writeBlocks(out, texture_indices.size(), [&](size_t i, char* line)
             {
-                out << "f "
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << "/"
-                    << faceIndices[face_index * 3 + 0] + 1 << " "
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << "/"
-                    << faceIndices[face_index * 3 + 1] + 1 << " "
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << "/"
-                    << faceIndices[face_index * 3 + 2] + 1 << std::endl;
-            }
+                int len = 0;
+                Material &first = materials[faceMaterialIndices[texture_indices[i]]];
+                if(i==0 || first.m_texture != materials[faceMaterialIndices[texture_indices[i-1]]].m_texture )
+                {
+                    len = sprintf(line, "usemtl texture_%lu\n", static_cast<unsigned long>(first.m_texture->idx()));
+                }
+                return len + formatFace(texture_indices[i], line + len);
+            });
         }
 
 
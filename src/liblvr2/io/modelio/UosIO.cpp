@@ -40,6 +40,8 @@
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <cstring>
 
 using std::list;
 using std::vector;
@@ -48,13 +50,131 @@ using std::stringstream;
 
 #include <boost/filesystem.hpp>
 
+#include <boost/iostreams/device/mapped_file.hpp>
+
 #include "lvr2/io/modelio/UosIO.hpp"
+#include "lvr2/config/lvropenmp.hpp"
+#include "lvr2/registration/OctreeReduction.hpp"
+#include "lvr2/util/AsciiUtil.hpp"
 #include "lvr2/util/Progress.hpp"
 #include "lvr2/util/Timestamp.hpp"
 
 namespace lvr2
 {
 
+namespace
+{
+
+/// A memory mapped scan, pose or frames file. Empty and missing files
+/// are not mapped.
+class MappedScan
+{
+public:
+    MappedScan(const string& filename)
+    {
+        boost::system::error_code error;
+        uintmax_t fileSize = boost::filesystem::file_size(filename, error);
+        if(!error && fileSize > 0)
+        {
+            try
+            {
+                m_file.open(filename);
+            }
+            catch(const std::exception& e)
+            {
+                cout << timestamp << "UOS Reader: " << e.what() << std::endl;
+            }
+        }
+    }
+
+    bool isOpen() const { return m_file.is_open(); }
+
+    const char* begin() const { return isOpen() ? m_file.data() : nullptr; }
+
+    const char* end() const { return isOpen() ? m_file.data() + m_file.size() : nullptr; }
+
+private:
+    boost::iostreams::mapped_file_source m_file;
+};
+
+using asciiutil::isBlank;
+using asciiutil::skipBlanks;
+using asciiutil::parseFloat;
+
+inline const char* lineEnd(const char* line, const char* end)
+{
+    const char* eol = (const char*)memchr(line, '\n', end - line);
+    return eol ? eol : end;
+}
+
+inline const char* nextLine(const char* line, const char* end)
+{
+    const char* eol = lineEnd(line, end);
+    return eol < end ? eol + 1 : end;
+}
+
+/// Appends the value like "%g " would in the C locale, regardless of the
+/// global locale
+inline void appendFloat(std::string& out, double value)
+{
+    char buffer[33];
+    char* e = asciiutil::formatFloat(buffer, value);
+    *e++ = ' ';
+    out.append(buffer, e - buffer);
+}
+
+/// Number of blank separated entries in the given line
+inline int entriesInLine(const char* line, const char* end)
+{
+    const char* eol = lineEnd(line, end);
+    int c = 0;
+    const char* p = skipBlanks(line, eol);
+    while(p < eol)
+    {
+        c++;
+        while(p < eol && !isBlank(*p))
+        {
+            p++;
+        }
+        p = skipBlanks(p, eol);
+    }
+    return c;
+}
+
+/// Returns the line of the first point. The first line is metadata unless
+/// it starts with three numbers and has as many entries as the next line.
+inline const char* firstDataLine(const char* begin, const char* end)
+{
+    if(begin == end)
+    {
+        return end;
+    }
+
+    const char* second = nextLine(begin, end);
+    const char* eol = lineEnd(begin, end);
+    const char* p = begin;
+    float v;
+    bool isPoint = parseFloat(p, eol, v) && parseFloat(p, eol, v) && parseFloat(p, eol, v);
+    if(isPoint && second < end)
+    {
+        isPoint = entriesInLine(begin, end) == entriesInLine(second, end);
+    }
+    return isPoint ? begin : second;
+}
+
+/// Number of lines behind the metadata line, if there is one
+inline size_t countDataLines(const char* begin, const char* end)
+{
+    size_t c = 0;
+    for(const char* line = firstDataLine(begin, end); line < end; line = nextLine(line, end))
+    {
+        c++;
+    }
+    return c;
+}
+
+} // namespace
+
 
 ModelPtr UosIO::read(string dir)
 {
@@ -113,7 +233,7 @@ ModelPtr UosIO::read(string dir)
             m_lastScan = lastScan;
 
             cout << timestamp << "Reading " << n3dFiles << " scans in UOS format "
-                << "(From " << firstScan << " to " << lastScan << ")." << endl;
+                << "(From " << firstScan << " to " << lastScan << ")." << std::endl;
             readNewFormat(model, dir, firstScan, lastScan, n);
         }
         else
@@ -157,7 +277,7 @@ ModelPtr UosIO::read(string dir)
                 m_lastScan = lastScan;
 
                 cout << timestamp << "Reading " << nDirs << " scans in old UOS format "
-                    << "(From " << firstScan << " to " << lastScan << ")." << endl;
+                    << "(From " << firstScan << " to " << lastScan << ")." << std::endl;
                 readOldFormat(model, dir, firstScan, lastScan, n);
             }
             else
@@ -169,7 +289,7 @@ ModelPtr UosIO::read(string dir)
     }
     else
     {
-        cout << timestamp << "UOSReader: " << dir << " is not a directory." << endl;
+        cout << timestamp << "UOSReader: " << dir << " is not a directory." << std::endl;
     }
 
     m_model = model;
@@ -183,7 +303,7 @@ void UosIO::reduce(string dir, string target, int reduction)
     m_outputFile.open(target.c_str());
     if(!m_outputFile.good())
     {
-        cout << timestamp << "UOSReader: " << dir << " unable to open " << target << " for writing." << endl;
+        cout << timestamp << "UOSReader: " << dir << " unable to open " << target << " for writing." << std::endl;
         return;
     }
 
@@ -200,318 +320,505 @@ void UosIO::reduce(string dir, string target, int reduction)
 
 void UosIO::readNewFormat(ModelPtr &model, string dir, int first, int last, size_t &n)
 {
-    list<Vec > allPoints;
-    list<BaseVector<int> > allColors;
-
-    size_t point_counter = 0;
-
-    vector<indexPair> sub_clouds;
+    m_scanInfos.clear();
 
-    // Count points in all given files
-    size_t numPointsTotal = 0;
+    // Collect existing scans and their pose information
+    vector<UosScanInfo> infos;
     for(int fileCounter = first; fileCounter <= last; fileCounter++)
     {
-        // Create scan file name
         boost::filesystem::path scan_path(
                 boost::filesystem::path(dir) /
                 boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".3d" ) );
-        string scanFileName = "/" + scan_path.relative_path().string();
 
-        // Count lines in scan
-        numPointsTotal += AsciiIO::countLines(scanFileName);
+        if(!boost::filesystem::exists(scan_path))
+        {
+            // Continue with next file if the expected file couldn't be read
+            cout << timestamp << "UOS Reader: Unable to read scan " << scan_path.string() << std::endl;
+            continue;
+        }
+
+        UosScanInfo info;
+        info.number = fileCounter;
+        info.filename = scan_path.string();
+        info.numPoints = 0;
+        info.hasColor = false;
+        info.hasIntensity = false;
+        infos.push_back(info);
+    }
+
+    // Poses and meta data are cheap, read them for all scans first
+    #pragma omp parallel for schedule(dynamic)
+    for(size_t i = 0; i < infos.size(); i++)
+    {
+        boost::filesystem::path base =
+            boost::filesystem::path(dir) / boost::filesystem::path("scan" + to_string(infos[i].number, 3));
+
+        infos[i].pose = readScanPose(base.string());
+        readScanAttributes(infos[i].filename, infos[i].hasColor, infos[i].hasIntensity);
+    }
+
+    for(const UosScanInfo& info : infos)
+    {
+        // Print pose information
+        float euler[6];
+        Matrix4<Vec> tf = info.pose;
+        tf.toPostionAngle(euler);
+
+        cout << timestamp << "Processing " << info.filename << " @ "
+            << euler[0] << " " << euler[1] << " " << euler[2] << " "
+            << euler[3] << " " << euler[4] << " " << euler[5] << std::endl;
+    }
+
+    if(m_posesOnly)
+    {
+        m_numScans += infos.size();
+        m_scanInfos = infos;
+        model = ModelPtr(new Model);
+        return;
     }
 
     // Calculate the number of points to skip when writing to disk
     size_t skipPoints = 1;
+    if(m_saveToDisk && m_reductionTarget > 1)
+    {
+        size_t numPointsTotal = 0;
+        #pragma omp parallel for schedule(dynamic) reduction(+:numPointsTotal)
+        for(size_t i = 0; i < infos.size(); i++)
+        {
+            MappedScan file(infos[i].filename);
+            numPointsTotal += countDataLines(file.begin(), file.end());
+        }
+        skipPoints = std::max<size_t>(1, numPointsTotal / m_reductionTarget);
+    }
 
-    if(m_reductionTarget > 1)
+    if(m_saveToDisk)
     {
-        skipPoints = (int)numPointsTotal / m_reductionTarget;
+        cout << timestamp << "Reduction mode. Writing every " << skipPoints << "th point." << std::endl;
     }
 
+    // In reduction mode, the scans are loaded in rounds that are written
+    // before the next round is read to keep the memory consumption low.
+    // Otherwise all scans are loaded at once.
+    size_t roundSize = infos.size();
     if(m_saveToDisk)
     {
-        cout << timestamp << "Reduction mode. Writing every " << skipPoints << "th point." << endl;
+        roundSize = 4 * OpenMPConfig::getNumThreads();
     }
 
-    for(int fileCounter = first; fileCounter <= last; fileCounter++)
+    vector<PointBufferPtr> scans(infos.size());
+    size_t point_counter = 0;
+
+    string comment = timestamp.getElapsedTime() + "Reading " + std::to_string(infos.size()) + " scans";
+    ProgressBar progress(infos.size(), comment);
+
+    for(size_t roundStart = 0; roundStart < infos.size(); roundStart += roundSize)
     {
-        // New (unit) transformation matrix
-        Matrix4<Vec> tf;
+        size_t roundEnd = std::min(infos.size(), roundStart + roundSize);
 
-        // Input file streams for scan data, poses and frames
-        std::ifstream scan_in, pose_in, frame_in;
+        // Read and transform the scans of this round concurrently
+        #pragma omp parallel for schedule(dynamic)
+        for(size_t i = roundStart; i < roundEnd; i++)
+        {
+            PointBufferPtr scan = readScan(infos[i].filename);
+            if(scan)
+            {
+                transformScan(scan, infos[i].pose);
+                infos[i].numPoints = scan->numPoints();
+            }
+            scans[i] = scan;
+            ++progress;
+        }
 
-        // Create scan file name
-        boost::filesystem::path scan_path(
-                boost::filesystem::path(dir) /
-                boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".3d" ) );
-        string scanFileName = scan_path.string();
+        if(!m_saveToDisk)
+        {
+            continue;
+        }
 
-        // Count lines in scan
-        size_t points_in_file = AsciiIO::countLines(scanFileName);
+        // Format the selected points of each scan concurrently and
+        // write them in scan order
+        vector<size_t> firstCounter(roundEnd - roundStart);
+        for(size_t i = roundStart; i < roundEnd; i++)
+        {
+            firstCounter[i - roundStart] = point_counter;
+            point_counter += scans[i] ? scans[i]->numPoints() : 0;
+        }
 
-        int num_attributes = AsciiIO::getEntriesInLine(scanFileName) - 3;
-        bool has_color = (num_attributes == 3) || (num_attributes == 4);
-        bool has_intensity = (num_attributes == 1) || (num_attributes == 4);
+        vector<string> lines(roundEnd - roundStart);
+        #pragma omp parallel for schedule(dynamic)
+        for(size_t i = roundStart; i < roundEnd; i++)
+        {
+            if(scans[i])
+            {
+                formatReducedPoints(scans[i], firstCounter[i - roundStart], skipPoints, lines[i - roundStart]);
+                scans[i].reset();
+            }
+        }
 
-        if(has_color)
+        for(const string& l : lines)
         {
-            cout << timestamp << "Reading color information." << endl;
+            if(m_outputFile.good())
+            {
+                m_outputFile.write(l.data(), l.size());
+            }
         }
+    }
+    cout << std::endl;
 
-        if(has_intensity)
+    // Remember the successfully loaded scans
+    vector<indexPair> sub_clouds;
+    vector<size_t> offsets;
+    size_t numPoints = 0;
+    bool hasColors = false;
+    bool hasIntensities = false;
+    for(size_t i = 0; i < infos.size(); i++)
+    {
+        if(m_saveToDisk || scans[i])
         {
-            cout << timestamp << "Reading intensity information." << endl;
+            m_numScans++;
+            m_scanInfos.push_back(infos[i]);
         }
 
-        // Read scan data
-        scan_in.open(scanFileName.c_str());
-        if(!scan_in.good())
+        if(!scans[i])
         {
-            // Continue with next file if the expected file couldn't be read
-            cout << timestamp << "UOS Reader: Unable to read scan " << scanFileName << endl;
-            scan_in.close();
-            scan_in.clear();
             continue;
         }
-        else
-        {
-            // Tmp list of read points
-            list<Vec > tmp_points;
 
+        // Save index pair for current scan
+        size_t n_scan = scans[i]->numPoints();
+        size_t firstIndex = numPoints;
+        size_t lastIndex = numPoints + n_scan > 0 ? numPoints + n_scan - 1 : 0;
+        sub_clouds.push_back(make_pair(firstIndex, lastIndex));
 
-            // Try to get fransformation from .frames file
-            boost::filesystem::path frame_path(
-                    boost::filesystem::path(dir) /
-                    boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".frames" ) );
-            string frameFileName = frame_path.string();
+        offsets.push_back(numPoints);
+        numPoints += n_scan;
+        hasColors |= scans[i]->hasColors();
+        hasIntensities |= bool(scans[i]->getChannel<float>("intensities"));
+    }
 
-            frame_in.open(frameFileName.c_str());
-            if(!frame_in.good())
-            {
-                // Try to parse .pose file
-                boost::filesystem::path pose_path(
-                        boost::filesystem::path(dir) /
-                        boost::filesystem::path( "scan" + to_string( fileCounter, 3 ) + ".pose" ) );
-                string poseFileName = pose_path.string();
-
-                pose_in.open(poseFileName.c_str());
-                if(pose_in.good())
-                {
-                    float euler[6];
-                    for(int i = 0; i < 6; i++) pose_in >> euler[i];
+    // Convert into array
+    if(numPoints)
+    {
+        cout << timestamp << "UOS Reader: Read " << numPoints << " points." << std::endl;
 
-                    euler[3] *= 0.017453293;
-                    euler[4] *= 0.017453293;
-                    euler[5] *= 0.017453293;
+        floatArr points(new float[3 * numPoints]);
+        ucharArr pointColors;
+        floatArr intensities;
 
-                    Vec position(euler[0], euler[1], euler[2]);
-                    Vec angle(euler[3], euler[4], euler[5]);
+        if(hasColors)
+        {
+            pointColors = ucharArr(new unsigned char[3 * numPoints]);
+            std::fill_n(pointColors.get(), 3 * numPoints, 0);
+        }
+        if(hasIntensities)
+        {
+            intensities = floatArr(new float[numPoints]);
+            std::fill_n(intensities.get(), numPoints, 0.0f);
+        }
 
-                    tf = Matrix4<Vec>(position, angle);
-                }
-                else
-                {
-                    cout << timestamp << "UOS Reader: Warning: No position information found." << endl;
-                    tf = Matrix4<Vec>();
-                }
+        // Copy the scans into the final arrays
+        vector<PointBufferPtr> loaded;
+        for(PointBufferPtr& scan : scans)
+        {
+            if(scan)
+            {
+                loaded.push_back(scan);
+            }
+        }
 
+        #pragma omp parallel for schedule(dynamic)
+        for(size_t i = 0; i < loaded.size(); i++)
+        {
+            const PointBufferPtr& scan = loaded[i];
+            size_t n_scan = scan->numPoints();
+            size_t offset = offsets[i];
+
+            floatArr scanPoints = scan->getPointArray();
+            std::copy_n(scanPoints.get(), 3 * n_scan, points.get() + 3 * offset);
+
+            if(hasColors && scan->hasColors())
+            {
+                size_t w;
+                ucharArr scanColors = scan->getColorArray(w);
+                std::copy_n(scanColors.get(), 3 * n_scan, pointColors.get() + 3 * offset);
             }
-            else
+
+            typename Channel<float>::Optional scanIntensities = scan->getChannel<float>("intensities");
+            if(hasIntensities && scanIntensities)
             {
-                // Use transformation from .frame files
-                tf = parseFrameFile(frame_in);
+                std::copy_n(scanIntensities->dataPtr().get(), n_scan, intensities.get() + offset);
+            }
+        }
 
+        // Create point cloud in model
+        model = ModelPtr( new Model );
+        model->m_pointCloud = PointBufferPtr( new PointBuffer );
+        model->m_pointCloud->setPointArray( points, numPoints );
+
+        if (hasColors)
+        {
+            model->m_pointCloud->setColorArray(pointColors, numPoints);
+        }
+
+        if (hasIntensities)
+        {
+            model->m_pointCloud->addFloatChannel(intensities, "intensities", numPoints, 1);
+        }
+
+        // Add sub cloud information
+        if (sub_clouds.size())
+        {
+            indexArray sub_clouds_array = indexArray( new unsigned int[sub_clouds.size() * 2] );
+            for(size_t i = 0; i < sub_clouds.size(); i++)
+            {
+                sub_clouds_array[i*2 + 0] = sub_clouds[i].first;
+                sub_clouds_array[i*2 + 1] = sub_clouds[i].second;
             }
 
-            // Print pose information
-            float euler[6];
-            tf.toPostionAngle(euler);
+            model->m_pointCloud->addIndexChannel(sub_clouds_array, "sub_clouds", sub_clouds.size(), 2);
+        }
+        n = numPoints;
+    }
+}
 
-            cout << timestamp << "Processing " << scanFileName << " @ "
-                << euler[0] << " " << euler[1] << " " << euler[2] << " "
-                << euler[3] << " " << euler[4] << " " << euler[5] << endl;
+PointBufferPtr UosIO::readScan(const string& filename)
+{
+    MappedScan file(filename);
+    if(!file.isOpen())
+    {
+        return PointBufferPtr();
+    }
 
-            // Skip first line in scan file (maybe metadata)
-            char dummy[1024];
-            scan_in.getline(dummy, 1024);
+    const char* begin = file.begin();
+    const char* end = file.end();
 
-            // Setup info output
-            string comment = timestamp.getElapsedTime() + "Reading file " + scanFileName;
-            ProgressBar progress(points_in_file, comment);
+    // Skip the first line in the scan file if it is metadata
+    const char* line = firstDataLine(begin, end);
 
-            // Read all points
-            while(scan_in.good())
-            {
-                float x, y, z, rem, dummy;
-                int r, g, b;
+    // Get number of entries in first data line and analyze
+    int num_attributes = entriesInLine(line, end) - 3;
+    bool has_color = (num_attributes == 3) || (num_attributes == 4);
+    bool has_intensity = (num_attributes == 1) || (num_attributes == 4);
 
-                point_counter ++;
+    // Upper bound for the number of kept points
+    size_t maxPoints = countDataLines(begin, end) / m_modulo + 1;
 
-                if(has_intensity && !has_color)
-                {
-                    scan_in >> x >> y >> z >> rem;
-                }
-                else if(has_intensity && has_color)
-                {
-                    scan_in >> x >> y >> z >> rem >> r >> g >> b;
-                    allColors.push_back(BaseVector<int> (r, g, b));
-                }
-                else if(has_color && !has_intensity)
-                {
-                    scan_in >> x >> y >> z >> r >> g >> b;
-                    allColors.push_back(BaseVector<int> (r, g, b));
-                }
-                else
-                {
-                    scan_in >> x >> y >> z;
-                    for(int n_dummys = 0; n_dummys < num_attributes; n_dummys++) scan_in >> dummy;
-                }
+    floatArr points(new float[3 * maxPoints]);
+    ucharArr colors;
+    floatArr intensities;
+    if(has_color)
+    {
+        colors = ucharArr(new unsigned char[3 * maxPoints]);
+    }
+    if(has_intensity)
+    {
+        intensities = floatArr(new float[maxPoints]);
+    }
 
-                BaseVector<float> point(x, y, z);
-                BaseVector<unsigned char> color;
+    size_t numPoints = 0;
+    size_t lineCounter = 0;
+    for(; line < end; line = nextLine(line, end))
+    {
+        const char* eol = lineEnd(line, end);
+        const char* p = line;
 
-                // Code branching for point converter!
-                if(!m_saveToDisk)
-                {
-                    tmp_points.push_back(point);
-                }
-                else
-                {
-                    if(m_outputFile.good())
-                    {
-                        if(point_counter % skipPoints == 0)
-                        {
-                            point = tf * point;
-                            m_outputFile << point[0] << " " << point[1] << " " << point[2] << " ";
-
-                            // Save remission values if present
-                            if(has_intensity && m_saveRemission)
-                            {
-                                m_outputFile << rem << " ";
-                            }
-
-                            // Save color values if present
-                            if(has_color)
-                            {
-                                m_outputFile << r << " " << g << " " << b;
-                            }
-                            else if(m_saveRemissionColor)
-                            {
-                                r = g = b = rem;
-                                m_outputFile << r << " " << g << " " << b;
-                            }
-                            m_outputFile << endl;
-                        }
-                    }
-                }
-                ++progress;
-            }
+        // Skip empty lines
+        p = skipBlanks(p, eol);
+        if(p == eol)
+        {
+            continue;
+        }
 
-            // Save index of first point of new scan
-            size_t firstIndex;
-            if(allPoints.size() > 0)
-            {
-                firstIndex = allPoints.size();
-            }
-            else
-            {
-                firstIndex = 0;
-            }
+        // Only every m_modulo-th point is parsed
+        if(lineCounter++ % m_modulo != 0 || numPoints == maxPoints)
+        {
+            continue;
+        }
+
+        float v[7];
+        if(!parseFloat(p, eol, v[0]) || !parseFloat(p, eol, v[1]) || !parseFloat(p, eol, v[2]))
+        {
+            continue;
+        }
 
-            // Transform scan point with current matrix
-            list<Vec >::iterator it, it1;
-            for(it = tmp_points.begin(); it != tmp_points.end(); it++)
+        int n_values = has_color ? (has_intensity ? 4 : 3) : (has_intensity ? 1 : 0);
+        for(int i = 0; i < n_values; i++)
+        {
+            if(!parseFloat(p, eol, v[3 + i]))
             {
-                Vec v = *it;
-                v = tf * v;
-                allPoints.push_back(v);
+                v[3 + i] = 0.0f;
             }
+        }
+
+        points[3 * numPoints    ] = v[0];
+        points[3 * numPoints + 1] = v[1];
+        points[3 * numPoints + 2] = v[2];
+
+        if(has_intensity)
+        {
+            intensities[numPoints] = v[3];
+        }
 
-            // Save last index
-            size_t lastIndex;
-            if(allPoints.size() > 0)
+        if(has_color)
+        {
+            int c = has_intensity ? 4 : 3;
+            colors[3 * numPoints    ] = (unsigned char)(int)v[c];
+            colors[3 * numPoints + 1] = (unsigned char)(int)v[c + 1];
+            colors[3 * numPoints + 2] = (unsigned char)(int)v[c + 2];
+        }
+        numPoints++;
+    }
+
+    PointBufferPtr buffer(new PointBuffer);
+    buffer->setPointArray(points, numPoints);
+    if(has_color)
+    {
+        buffer->setColorArray(colors, numPoints);
+    }
+    if(has_intensity)
+    {
+        buffer->addFloatChannel(intensities, "intensities", numPoints, 1);
+    }
+
+    // Octree reduction of the scan
+    if(m_voxelSize > 0 && numPoints > 0)
+    {
+        RandomSampleOctreeReduction oct(buffer, m_voxelSize, m_minPointsPerVoxel);
+        buffer = oct.getReducedPoints();
+    }
+
+    return buffer;
+}
+
+Matrix4<Vec> UosIO::readScanPose(const string& base)
+{
+    // Try to get transformation from .frames file
+    MappedScan frames(base + ".frames");
+    if(frames.isOpen())
+    {
+        // Use the last transformation in the file. Each line contains
+        // 16 matrix entries followed by a color value
+        float m[16];
+        float values[17];
+        bool found = false;
+        for(const char* line = frames.begin(); line < frames.end(); line = nextLine(line, frames.end()))
+        {
+            const char* eol = lineEnd(line, frames.end());
+            const char* p = line;
+            int i = 0;
+            while(i < 17 && parseFloat(p, eol, values[i]))
             {
-                lastIndex = allPoints.size() - 1;
+                i++;
             }
-            else
+
+            if(i >= 16)
             {
-                lastIndex = 0;
+                std::copy_n(values, 16, m);
+                found = true;
             }
+        }
 
-            // Save index pair for current scan
-            sub_clouds.push_back(make_pair(firstIndex, lastIndex));
-            m_numScans++;
+        if(found)
+        {
+            return Matrix4<Vec>(m);
         }
-        cout << endl;
     }
 
-    // Convert into array
-    if ( allPoints.size() )
+    // Try to parse .pose file
+    std::ifstream pose_in((base + ".pose").c_str());
+    if(pose_in.good())
     {
-        cout << timestamp << "UOS Reader: Read " << allPoints.size() << " points." << endl;
+        float euler[6];
+        for(int i = 0; i < 6; i++) pose_in >> euler[i];
 
-        // Save position information
+        euler[3] *= 0.017453293;
+        euler[4] *= 0.017453293;
+        euler[5] *= 0.017453293;
 
-        size_t numPoints(0);
-        floatArr points;
-        ucharArr pointColors;
+        Vec position(euler[0], euler[1], euler[2]);
+        Vec angle(euler[3], euler[4], euler[5]);
 
+        return Matrix4<Vec>(position, angle);
+    }
 
-        numPoints = allPoints.size();
-        points = floatArr( new float[3 * allPoints.size()] );
-        list<Vec >::iterator p_it;
-        size_t i(0);
-        for( p_it = allPoints.begin(); p_it != allPoints.end(); p_it++ )
-        {
-            Vec v = *p_it;
-            points[i    ] = v[0];
-            points[i + 1] = v[1];
-            points[i + 2] = v[2];
-            i += 3;
-        }
+    cout << timestamp << "UOS Reader: Warning: No position information found for " << base << "." << std::endl;
+    return Matrix4<Vec>();
+}
+
+void UosIO::readScanAttributes(const string& filename, bool& hasColor, bool& hasIntensity)
+{
+    std::ifstream in(filename.c_str());
 
-        // Save color information
-        if ( allColors.size() )
+    // Skip first line (possibly metadata) and analyze the second one
+    string line;
+    std::getline(in, line);
+    std::getline(in, line);
+
+    int num_attributes = entriesInLine(line.data(), line.data() + line.size()) - 3;
+    hasColor = (num_attributes == 3) || (num_attributes == 4);
+    hasIntensity = (num_attributes == 1) || (num_attributes == 4);
+}
+
+void UosIO::transformScan(PointBufferPtr scan, const Matrix4<Vec>& tf)
+{
+    size_t numPoints = scan->numPoints();
+    floatArr points = scan->getPointArray();
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        Vec v(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+        v = tf * v;
+        points[3 * i    ] = v[0];
+        points[3 * i + 1] = v[1];
+        points[3 * i + 2] = v[2];
+    }
+}
+
+void UosIO::formatReducedPoints(PointBufferPtr scan, size_t firstCounter, size_t skipPoints, string& out)
+{
+    size_t numPoints = scan->numPoints();
+    floatArr points = scan->getPointArray();
+
+    size_t w;
+    ucharArr colors = scan->getColorArray(w);
+    floatArr intensities;
+    typename Channel<float>::Optional intensityChannel = scan->getChannel<float>("intensities");
+    if(intensityChannel)
+    {
+        intensities = intensityChannel->dataPtr();
+    }
+
+    char buffer[256];
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        if((firstCounter + i + 1) % skipPoints != 0)
         {
-            pointColors = ucharArr( new unsigned char[ 3 * numPoints ] );
-            i = 0;
-            list<BaseVector<int>>::iterator c_it;
-            for(c_it = allColors.begin(); c_it != allColors.end(); c_it++)
-            {
-                BaseVector<int> v = *c_it;
-                pointColors[i    ] = (unsigned char) v[0];
-                pointColors[i + 1] = (unsigned char) v[1];
-                pointColors[i + 2] = (unsigned char) v[2];
-                i += 3;
-            }
+            continue;
         }
 
-        // Create point cloud in model
-        model = ModelPtr( new Model );
-        model->m_pointCloud = PointBufferPtr( new PointBuffer );
-        model->m_pointCloud->setPointArray( points, numPoints );
+        appendFloat(out, points[3 * i]);
+        appendFloat(out, points[3 * i + 1]);
+        appendFloat(out, points[3 * i + 2]);
 
-        if (allColors.size())
+        // Save remission values if present
+        if(intensities && m_saveRemission)
         {
-            model->m_pointCloud->setColorArray(pointColors, numPoints);
+            appendFloat(out, intensities[i]);
         }
 
-        // Add sub cloud information
-        if (sub_clouds.size())
+        // Save color values if present
+        if(colors)
         {
-            indexArray sub_clouds_array = indexArray( new unsigned int[sub_clouds.size() * 2] );
-            for(size_t i = 0; i < sub_clouds.size(); i++)
-            {
-                sub_clouds_array[i*2 + 0] = sub_clouds[i].first;
-                sub_clouds_array[i*2 + 1] = sub_clouds[i].second;
-            }
-
-            model->m_pointCloud->addIndexChannel(sub_clouds_array, "sub_clouds", numPoints, 2);
+            int len = snprintf(buffer, sizeof(buffer), "%d %d %d",
+                           colors[3 * i], colors[3 * i + 1], colors[3 * i + 2]);
+            out.append(buffer, len);
+        }
+        else if(intensities && m_saveRemissionColor)
+        {
+            int r = intensities[i];
+            int len = snprintf(buffer, sizeof(buffer), "%d %d %d", r, r, r);
+            out.append(buffer, len);
         }
+        out += '\n';
     }
-
 }
 
 void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size_t &n)
@@ -544,7 +851,7 @@ void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size
 
         // Abort if opening failed and try with next die
         if (!pose_in.good()) continue;
-        cout << timestamp << "Processing Scan " << dir << "/" << to_string(fileCounter, 3) << endl;
+        cout << timestamp << "Processing Scan " << dir << "/" << to_string(fileCounter, 3) << std::endl;
 
         // Extract pose information
         for (unsigned int i = 0; i < 6; pose_in >> euler[i++]);
@@ -605,7 +912,7 @@ void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size
                 cAngle[6] = firstLine[41];
                 cAngle[7] = 0;
                 current_angle = atof(cAngle);
-                cout << current_angle << endl;
+                cout << current_angle << std::endl;
             } else {
                 intensity_flag = 0;
                 char cAngle[8];
@@ -683,7 +990,7 @@ void UosIO::readOldFormat(ModelPtr &model, string dir, int first, int last, size
     // Convert into indexed array
     if(allPoints.size() > 0)
     {
-        cout << timestamp << "UOS Reader: Read " << allPoints.size() << " points." << endl;
+        cout << timestamp << "UOS Reader: Read " << allPoints.size() << " points." << std::endl;
         n = allPoints.size();
         floatArr points( new float[3 * allPoints.size()] );
         list<Vec >::iterator p_it;
@@ -0,0 +1,661 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * CpuSurface.cpp
+ *
+ * @date 18.10.2026
+ */
+
+#include "lvr2/reconstruction/CpuSurface.hpp"
+#include "lvr2/config/lvropenmp.hpp"
+#include "lvr2/util/Logging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace lvr2
+{
+
+namespace
+{
+
+/// Number of neighbors used by the distance kernels of CudaSurface and ClSurface
+constexpr size_t DistanceNeighbors = 5;
+
+/// Spreads the lower 21 bits of v so that there are two zero bits between each bit
+inline uint64_t expandBits(uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffff;
+    v = (v | v << 16) & 0x1f0000ff0000ff;
+    v = (v | v << 8)  & 0x100f00f00f00f00f;
+    v = (v | v << 4)  & 0x10c30c30c30c30c3;
+    v = (v | v << 2)  & 0x1249249249249249;
+    return v;
+}
+
+/// Sorts each thread's part of keys and merges the parts pairwise
+void parallelSort(std::vector<uint64_t>& keys, int numThreads)
+{
+    const size_t n = keys.size();
+    const size_t numParts = n < (1 << 16) ? 1 : numThreads;
+
+    std::vector<size_t> bounds(numParts + 1);
+    for (size_t i = 0; i <= numParts; i++)
+    {
+        bounds[i] = n * i / numParts;
+    }
+
+    #pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+    for (size_t i = 0; i < numParts; i++)
+    {
+        std::sort(keys.begin() + bounds[i], keys.begin() + bounds[i + 1]);
+    }
+
+    for (size_t width = 1; width < numParts; width *= 2)
+    {
+        #pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+        for (size_t i = 0; i < numParts; i += 2 * width)
+        {
+            if (i + width < numParts)
+            {
+                std::inplace_merge(keys.begin() + bounds[i],
+                                   keys.begin() + bounds[i + width],
+                                   keys.begin() + bounds[std::min(i + 2 * width, numParts)]);
+            }
+        }
+    }
+}
+
+/// Weight of a neighbor in the normal interpolation, same as in the GPU kernels
+inline float gaussianFactor(float offset, int ki)
+{
+    const float ki_2 = ki / 2.0f;
+    if (offset > ki_2)
+    {
+        return 0.0f;
+    }
+    const float border_val = 0.2f;
+    const float ratio = offset / ki_2;
+    return (1.0f - ratio * ratio * (1.0f - border_val)) * 5.0f;
+}
+
+} // anonymous namespace
+
+CpuSurface::CpuSurface(floatArr& points, size_t num_points, int numThreads)
+    : m_points(points),
+      m_numPoints(num_points),
+      m_numThreads(numThreads),
+      m_vx(1000000.0f), m_vy(1000000.0f), m_vz(1000000.0f),
+      m_k(10), m_ki(10), m_kd(5)
+{
+    if (m_numThreads <= 0)
+    {
+        m_numThreads = OpenMPConfig::getNumThreads();
+    }
+    if (m_numPoints >= std::numeric_limits<uint32_t>::max())
+    {
+        throw std::invalid_argument("CpuSurface: Too many points");
+    }
+    buildIndex();
+}
+
+void CpuSurface::buildIndex()
+{
+    const size_t n = m_numPoints;
+    const float* points = m_points.get();
+
+    float minX = std::numeric_limits<float>::max(), maxX = std::numeric_limits<float>::lowest();
+    float minY = minX, maxY = maxX;
+    float minZ = minX, maxZ = maxX;
+
+    #pragma omp parallel for num_threads(m_numThreads) reduction(min:minX,minY,minZ) reduction(max:maxX,maxY,maxZ)
+    for (size_t i = 0; i < n; i++)
+    {
+        minX = std::min(minX, points[3 * i]);
+        minY = std::min(minY, points[3 * i + 1]);
+        minZ = std::min(minZ, points[3 * i + 2]);
+        maxX = std::max(maxX, points[3 * i]);
+        maxY = std::max(maxY, points[3 * i + 1]);
+        maxZ = std::max(maxZ, points[3 * i + 2]);
+    }
+
+    // Sort keys: the upper 32 bits of a Morton code with 21 bits per axis,
+    // followed by the point index. Sorting them yields the Morton order and
+    // keeps equal codes in index order.
+    const float extent = std::max({ maxX - minX, maxY - minY, maxZ - minZ, 1e-6f });
+    const float scale = static_cast<float>((1 << 21) - 1) / extent;
+
+    std::vector<uint64_t> keys(n);
+
+    #pragma omp parallel for num_threads(m_numThreads)
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t x = static_cast<uint64_t>((points[3 * i] - minX) * scale);
+        uint64_t y = static_cast<uint64_t>((points[3 * i + 1] - minY) * scale);
+        uint64_t z = static_cast<uint64_t>((points[3 * i + 2] - minZ) * scale);
+        uint64_t code = (expandBits(x) << 2) | (expandBits(y) << 1) | expandBits(z);
+        keys[i] = ((code >> 31) << 32) | i;
+    }
+
+    parallelSort(keys, m_numThreads);
+
+    const float inf = std::numeric_limits<float>::infinity();
+    m_x.assign(n + LeafSize, inf);
+    m_y.assign(n + LeafSize, inf);
+    m_z.assign(n + LeafSize, inf);
+    m_order.resize(n);
+
+    #pragma omp parallel for num_threads(m_numThreads)
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t index = static_cast<uint32_t>(keys[i]);
+        m_order[i] = index;
+        m_x[i] = points[3 * index];
+        m_y[i] = points[3 * index + 1];
+        m_z[i] = points[3 * index + 2];
+    }
+
+    m_nodes.clear();
+    if (n == 0)
+    {
+        return;
+    }
+    m_nodes.reserve(4 * (n / LeafSize + 1));
+    buildNode(keys, 0, n);
+    std::vector<uint64_t>().swap(keys);
+
+    // Bounding boxes of the leaves in parallel, then of the inner nodes
+    // from the back, since children are stored after their parents
+    #pragma omp parallel for schedule(dynamic, 64) num_threads(m_numThreads)
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        Node& node = m_nodes[i];
+        if (node.count == 0)
+        {
+            continue;
+        }
+        std::fill(node.min, node.min + 3, inf);
+        std::fill(node.max, node.max + 3, -inf);
+        for (size_t j = node.first; j < node.first + node.count; j++)
+        {
+            node.min[0] = std::min(node.min[0], m_x[j]);
+            node.min[1] = std::min(node.min[1], m_y[j]);
+            node.min[2] = std::min(node.min[2], m_z[j]);
+            node.max[0] = std::max(node.max[0], m_x[j]);
+            node.max[1] = std::max(node.max[1], m_y[j]);
+            node.max[2] = std::max(node.max[2], m_z[j]);
+        }
+    }
+
+    for (size_t i = m_nodes.size(); i-- > 0; )
+    {
+        Node& node = m_nodes[i];
+        if (node.count > 0)
+        {
+            continue;
+        }
+        const Node& left = m_nodes[node.left];
+        const Node& right = m_nodes[node.right];
+        for (int d = 0; d < 3; d++)
+        {
+            node.min[d] = std::min(left.min[d], right.min[d]);
+            node.max[d] = std::max(left.max[d], right.max[d]);
+        }
+    }
+}
+
+uint32_t CpuSurface::buildNode(const std::vector<uint64_t>& keys, size_t begin, size_t end)
+{
+    const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+
+    if (end - begin <= LeafSize)
+    {
+        m_nodes[index].first = static_cast<uint32_t>(begin);
+        m_nodes[index].count = static_cast<uint32_t>(end - begin);
+        return index;
+    }
+
+    // Split where the highest bit in which the first and last code differ
+    // changes. Equal codes are split in the middle.
+    const uint64_t firstCode = keys[begin] >> 32;
+    const uint64_t lastCode = keys[end - 1] >> 32;
+
+    size_t split = begin + (end - begin) / 2;
+    if (firstCode != lastCode)
+    {
+        int bit = 63;
+        while (!(((firstCode ^ lastCode) >> bit) & 1))
+        {
+            bit--;
+        }
+        split = std::partition_point(keys.begin() + begin, keys.begin() + end,
+            [bit](uint64_t key) { return !(((key >> 32) >> bit) & 1); }) - keys.begin();
+    }
+
+    const uint32_t left = buildNode(keys, begin, split);
+    const uint32_t right = buildNode(keys, split, end);
+
+    m_nodes[index].count = 0;
+    m_nodes[index].left = left;
+    m_nodes[index].right = right;
+    return index;
+}
+
+float CpuSurface::boxDistance(const Node& node, float x, float y, float z) const
+{
+    float dx = std::max({ node.min[0] - x, 0.0f, x - node.max[0] });
+    float dy = std::max({ node.min[1] - y, 0.0f, y - node.max[1] });
+    float dz = std::max({ node.min[2] - z, 0.0f, z - node.max[2] });
+    return dx * dx + dy * dy + dz * dz;
+}
+
+size_t CpuSurface::kSearch(float x, float y, float z, size_t k, uint32_t* indices, float* distances) const
+{
+    if (k == 0 || m_numPoints == 0)
+    {
+        return 0;
+    }
+
+    struct QueueEntry
+    {
+        float distance;
+        uint32_t node;
+
+        bool operator>(const QueueEntry& o) const { return distance > o.distance; }
+    };
+
+    // Best first traversal: nodes are visited by increasing distance of
+    // their bounding boxes, so only leaves that can contain one of the
+    // neighbors are searched.
+    thread_local std::vector<QueueEntry> queue;
+    queue.clear();
+    queue.push_back({ boxDistance(m_nodes[0], x, y, z), 0 });
+
+    size_t found = 0;
+    float leafDistances[LeafSize];
+
+    while (!queue.empty())
+    {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+        const QueueEntry entry = queue.back();
+        queue.pop_back();
+
+        if (found == k && entry.distance >= distances[k - 1])
+        {
+            break;
+        }
+
+        const Node& node = m_nodes[entry.node];
+        if (node.count == 0)
+        {
+            for (uint32_t child : { node.left, node.right })
+            {
+                const float d = boxDistance(m_nodes[child], x, y, z);
+                if (found < k || d < distances[k - 1])
+                {
+                    queue.push_back({ d, child });
+                    std::push_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+                }
+            }
+            continue;
+        }
+
+        const size_t begin = node.first;
+        const float* bx = &m_x[begin];
+        const float* by = &m_y[begin];
+        const float* bz = &m_z[begin];
+
+        // Always compute a full leaf, the padding makes this safe for the last one
+        #pragma omp simd
+        for (size_t j = 0; j < LeafSize; j++)
+        {
+            const float dx = bx[j] - x;
+            const float dy = by[j] - y;
+            const float dz = bz[j] - z;
+            leafDistances[j] = dx * dx + dy * dy + dz * dz;
+        }
+
+        const size_t count = node.count;
+        for (size_t j = 0; j < count; j++)
+        {
+            const float d = leafDistances[j];
+            if (found == k && d >= distances[k - 1])
+            {
+                continue;
+            }
+
+            // Sorted insertion, dropping the farthest neighbor if full
+            size_t pos = found < k ? found++ : k - 1;
+            while (pos > 0 && distances[pos - 1] > d)
+            {
+                distances[pos] = distances[pos - 1];
+                indices[pos] = indices[pos - 1];
+                pos--;
+            }
+            distances[pos] = d;
+            indices[pos] = static_cast<uint32_t>(begin + j);
+        }
+    }
+
+    return found;
+}
+
+void CpuSurface::calculateNormals()
+{
+    const size_t n = m_numPoints;
+    m_normals.resize(3 * n);
+
+    lvr2::logout::get() << lvr2::info << "[CpuSurface] Estimating normals with kn = " << m_k << " and ki = " << m_ki << lvr2::endl;
+
+    // Plane fit through each point and its kn nearest neighbors, oriented
+    // towards the flip point
+    #pragma omp parallel num_threads(m_numThreads)
+    {
+        std::vector<uint32_t> nn(m_k + 1);
+        std::vector<float> dist(m_k + 1);
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (size_t i = 0; i < n; i++)
+        {
+            const float vertex_x = m_x[i];
+            const float vertex_y = m_y[i];
+            const float vertex_z = m_z[i];
+
+            size_t numNeighbors = kSearch(vertex_x, vertex_y, vertex_z, m_k + 1, nn.data(), dist.data());
+
+            // ilikebigbits.com/blog/2015/3/2/plane-from-points
+            float xx = 0.0f, xy = 0.0f, xz = 0.0f;
+            float yy = 0.0f, yz = 0.0f, zz = 0.0f;
+
+            int used = 0;
+            for (size_t j = 0; j < numNeighbors && used < m_k; j++)
+            {
+                if (nn[j] == i)
+                {
+                    continue;
+                }
+                const float rx = m_x[nn[j]] - vertex_x;
+                const float ry = m_y[nn[j]] - vertex_y;
+                const float rz = m_z[nn[j]] - vertex_z;
+
+                xx += rx * rx;
+                xy += rx * ry;
+                xz += rx * rz;
+                yy += ry * ry;
+                yz += ry * rz;
+                zz += rz * rz;
+                used++;
+            }
+
+            const float det_x = yy * zz - yz * yz;
+            const float det_y = xx * zz - xz * xz;
+            const float det_z = xx * yy - xy * xy;
+
+            float dir_x, dir_y, dir_z;
+            if (det_x <= 0.0f && det_y <= 0.0f && det_z <= 0.0f)
+            {
+                // Not a plane. The GPU kernels divide by zero here.
+                dir_x = 0.0f;
+                dir_y = 0.0f;
+                dir_z = 1.0f;
+            }
+            else if (det_x >= det_y && det_x >= det_z)
+            {
+                dir_x = 1.0f;
+                dir_y = (xz * yz - xy * zz) / det_x;
+                dir_z = (xy * yz - xz * yy) / det_x;
+            }
+            else if (det_y >= det_x && det_y >= det_z)
+            {
+                dir_x = (yz * xz - xy * zz) / det_y;
+                dir_y = 1.0f;
+                dir_z = (xy * xz - yz * xx) / det_y;
+            }
+            else
+            {
+                dir_x = (yz * xy - xz * yy) / det_z;
+                dir_y = (xz * xy - yz * xx) / det_z;
+                dir_z = 1.0f;
+            }
+
+            const float norm = std::sqrt(dir_x * dir_x + dir_y * dir_y + dir_z * dir_z);
+            const float invnorm = norm > 0.00001f ? 1.0f / norm : 1.0f;
+            dir_x *= invnorm;
+            dir_y *= invnorm;
+            dir_z *= invnorm;
+
+            const float scalar = (m_vx - vertex_x) * dir_x + (m_vy - vertex_y) * dir_y + (m_vz - vertex_z) * dir_z;
+            if (scalar < 0)
+            {
+                dir_x = -dir_x;
+                dir_y = -dir_y;
+                dir_z = -dir_z;
+            }
+
+            m_normals[3 * i]     = dir_x;
+            m_normals[3 * i + 1] = dir_y;
+            m_normals[3 * i + 2] = dir_z;
+        }
+    }
+
+    if (m_ki <= 0)
+    {
+        return;
+    }
+
+    // Interpolate over the ki nearest neighbors. The GPU kernels weight the
+    // neighbors by their distance in the kd-tree order, alternating left and
+    // right. The same weights are applied here to the neighbors sorted by
+    // their actual distance.
+    std::vector<float> interpolated(3 * n);
+
+    #pragma omp parallel num_threads(m_numThreads)
+    {
+        std::vector<uint32_t> nn(m_ki + 1);
+        std::vector<float> dist(m_ki + 1);
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t numNeighbors = kSearch(m_x[i], m_y[i], m_z[i], m_ki + 1, nn.data(), dist.data());
+
+            float n_x = m_normals[3 * i];
+            float n_y = m_normals[3 * i + 1];
+            float n_z = m_normals[3 * i + 2];
+
+            int rank = 0;
+            for (size_t j = 0; j < numNeighbors && rank < m_ki; j++)
+            {
+                if (nn[j] == i)
+                {
+                    continue;
+                }
+                rank++;
+                const float gaussian = gaussianFactor(static_cast<float>((rank + 1) / 2), m_ki);
+                n_x += gaussian * m_normals[3 * nn[j]];
+                n_y += gaussian * m_normals[3 * nn[j] + 1];
+                n_z += gaussian * m_normals[3 * nn[j] + 2];
+            }
+
+            const float norm = std::sqrt(n_x * n_x + n_y * n_y + n_z * n_z);
+            if (norm > 0.00001f)
+            {
+                n_x /= norm;
+                n_y /= norm;
+                n_z /= norm;
+            }
+
+            interpolated[3 * i]     = n_x;
+            interpolated[3 * i + 1] = n_y;
+            interpolated[3 * i + 2] = n_z;
+        }
+    }
+
+    m_normals.swap(interpolated);
+}
+
+void CpuSurface::getNormals(floatArr output_normals)
+{
+    if (m_normals.size() != 3 * m_numPoints)
+    {
+        throw std::runtime_error("CpuSurface: Normals have not been calculated");
+    }
+
+    #pragma omp parallel for num_threads(m_numThreads)
+    for (size_t i = 0; i < m_numPoints; i++)
+    {
+        const size_t index = m_order[i];
+        output_normals[3 * index]     = m_normals[3 * i];
+        output_normals[3 * index + 1] = m_normals[3 * i + 1];
+        output_normals[3 * index + 2] = m_normals[3 * i + 2];
+    }
+}
+
+void CpuSurface::setNormals(floatArr normals)
+{
+    m_normals.resize(3 * m_numPoints);
+
+    #pragma omp parallel for num_threads(m_numThreads)
+    for (size_t i = 0; i < m_numPoints; i++)
+    {
+        const size_t index = m_order[i];
+        m_normals[3 * i]     = normals[3 * index];
+        m_normals[3 * i + 1] = normals[3 * index + 1];
+        m_normals[3 * i + 2] = normals[3 * index + 2];
+    }
+}
+
+void CpuSurface::distances(std::vector<QueryPoint<Vec> >& query_points, float voxel_size)
+{
+    if (m_normals.size() != 3 * m_numPoints)
+    {
+        throw std::runtime_error("CpuSurface: Distances need normals. Call calculateNormals or setNormals first");
+    }
+
+    const size_t numQueries = query_points.size();
+
+    #pragma omp parallel num_threads(m_numThreads)
+    {
+        uint32_t nn[DistanceNeighbors];
+        float dist[DistanceNeighbors];
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (size_t q = 0; q < numQueries; q++)
+        {
+            QueryPoint<Vec>& qp = query_points[q];
+            const float qp_x = qp.m_position.x;
+            const float qp_y = qp.m_position.y;
+            const float qp_z = qp.m_position.z;
+
+            size_t numNeighbors = kSearch(qp_x, qp_y, qp_z, DistanceNeighbors, nn, dist);
+            if (numNeighbors == 0)
+            {
+                qp.m_invalid = true;
+                continue;
+            }
+
+            // Mean position and normal of the nearest points
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            float n_x = 0.0f, n_y = 0.0f, n_z = 0.0f;
+            for (size_t j = 0; j < numNeighbors; j++)
+            {
+                x += m_x[nn[j]];
+                y += m_y[nn[j]];
+                z += m_z[nn[j]];
+                n_x += m_normals[3 * nn[j]];
+                n_y += m_normals[3 * nn[j] + 1];
+                n_z += m_normals[3 * nn[j] + 2];
+            }
+            x /= numNeighbors;
+            y /= numNeighbors;
+            z /= numNeighbors;
+
+            const float n_norm = std::sqrt(n_x * n_x + n_y * n_y + n_z * n_z);
+            if (n_norm > 0.0f)
+            {
+                n_x /= n_norm;
+                n_y /= n_norm;
+                n_z /= n_norm;
+            }
+
+            qp.m_invalid = false;
+            qp.m_distance = (qp_x - x) * n_x + (qp_y - y) * n_y + (qp_z - z) * n_z;
+        }
+    }
+}
+
+void CpuSurface::setKn(int kn)
+{
+    m_k = kn;
+}
+
+void CpuSurface::setKi(int ki)
+{
+    m_ki = ki;
+}
+
+void CpuSurface::setKd(int kd)
+{
+    m_kd = kd;
+}
+
+void CpuSurface::setFlippoint(float v_x, float v_y, float v_z)
+{
+    m_vx = v_x;
+    m_vy = v_y;
+    m_vz = v_z;
+}
+
+void CpuSurface::setMethod(const std::string& method)
+{
+    if (method != "PCA")
+    {
+        lvr2::logout::get() << lvr2::warning << "[CpuSurface] Normal calculation method " << method << " is not implemented. Using PCA." << lvr2::endl;
+    }
+}
+
+void CpuSurface::setReconstructionMode(bool mode)
+{
+}
+
+void CpuSurface::freeGPU()
+{
+    std::vector<float>().swap(m_x);
+    std::vector<float>().swap(m_y);
+    std::vector<float>().swap(m_z);
+    std::vector<Node>().swap(m_nodes);
+    std::vector<float>().swap(m_normals);
+    std::vector<uint32_t>().swap(m_order);
+}
+
+} // namespace lvr2
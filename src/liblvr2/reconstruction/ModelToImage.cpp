@@ -34,6 +34,7 @@
 
 #include "lvr2/reconstruction/ModelToImage.hpp"
 #include "lvr2/reconstruction/Projection.hpp"
+#include "lvr2/config/lvropenmp.hpp"
 #include "lvr2/util/Progress.hpp"
 #include "lvr2/util/Timestamp.hpp"
 #include "lvr2/geometry/BaseVector.hpp"
@@ -78,6 +79,9 @@ ModelToImage::ModelToImage(
                 minVerticalAngle, maxVerticalAngle,
                 imageOptimization, system);
 
+    // The projection may have adapted the image size to the field of view
+    m_width = m_projection->w();
+    m_height = m_projection->h();
 }
 
 
@@ -87,104 +91,177 @@ ModelToImage::~ModelToImage()
     // TODO Auto-generated destructor stub
 }
 
-void ModelToImage::computeDepthListMatrix(DepthListMatrix& mat)
+void ModelToImage::projectPoints(vector<int>& pixels, vector<float>& ranges, float& minRange, float& maxRange)
 {
-    std::cout << timestamp << "Initializting DepthListMatrix with dimensions " << m_width << " x " << m_height << std::endl;
-    // Set correct image width and height
-    for(int i = 0; i < m_height; i++)
-    {
-        mat.pixels.emplace_back(vector<vector<PanoramaPoint> >());
-        for(int j = 0; j < m_width; j++)
-        {
-            mat.pixels[i].push_back(vector<PanoramaPoint>());
-        }
-    }
-
     // Get point array and size from buffer
     size_t n_points = m_points->numPoints();
     floatArr points = m_points->getPointArray();
 
-    // Create progress output
-    string comment = timestamp.getElapsedTime() + "Projecting points ";
-    ProgressBar progress(n_points, comment);
+    std::cout << timestamp << "Projecting " << n_points << " points" << std::endl;
 
-    float range;
-    int img_x, img_y;
-    for(int i = 0; i < n_points; i++)
-    {        
-        Vec ppt(points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+    vector<int> rows(n_points);
+    pixels.resize(n_points);
+    ranges.resize(n_points);
+    m_projection->projectPoints(points.get(), n_points, pixels.data(), rows.data(), ranges.data());
 
-        m_projection->project(
-                    img_x, img_y, range,
-                    ppt.x, ppt.y, ppt.z);
+    // Convert to row-major pixel indices and update min and max ranges
+    float min_r = minRange;
+    float max_r = maxRange;
+    #pragma omp parallel for schedule(static) reduction(min:min_r) reduction(max:max_r)
+    for(size_t k = 0; k < n_points; k++)
+    {
+        pixels[k] += rows[k] * m_width;
+        min_r = std::min(min_r, ranges[k]);
+        max_r = std::max(max_r, ranges[k]);
+    }
+    minRange = min_r;
+    maxRange = max_r;
+}
 
-        // Update min and max ranges
-        if(range > mat.maxRange)
+void ModelToImage::bucketPoints(const vector<int>& pixels, vector<size_t>& offsets, vector<PanoramaPoint>& points)
+{
+    size_t n_pixels = (size_t)m_width * m_height;
+    offsets.assign(n_pixels + 1, 0);
+
+    // The points are split into contiguous blocks, one per thread. Each block
+    // counts the points per pixel in its own histogram. The prefix sum over
+    // (pixel, block) gives every block its own range inside each bucket, so
+    // the blocks scatter in parallel and keep the order of the point buffer.
+    // The histograms need blocks * pixels entries, so the number of blocks is
+    // limited to keep the total work and memory linear in the number of points.
+    size_t n_points = pixels.size();
+    size_t n_blocks = std::max(1, OpenMPConfig::getNumThreads());
+    n_blocks = std::max<size_t>(1, std::min(n_blocks, n_points / std::max<size_t>(1, n_pixels)));
+
+    vector<size_t> counts(n_blocks * n_pixels, 0);
+
+    // Count the points of each pixel per block
+    #pragma omp parallel for schedule(static, 1)
+    for(size_t b = 0; b < n_blocks; b++)
+    {
+        size_t* blockCounts = counts.data() + b * n_pixels;
+        size_t end = n_points * (b + 1) / n_blocks;
+        for(size_t k = n_points * b / n_blocks; k < end; k++)
         {
-            mat.maxRange = range;
+            if(pixels[k] >= 0)
+            {
+                blockCounts[pixels[k]]++;
+            }
         }
+    }
 
-        if(range < mat.minRange)
+    // Turn the counts into the first index of each block inside each bucket
+    size_t sum = 0;
+    for(size_t p = 0; p < n_pixels; p++)
+    {
+        offsets[p] = sum;
+        for(size_t b = 0; b < n_blocks; b++)
         {
-            mat.minRange = range;
+            size_t count = counts[b * n_pixels + p];
+            counts[b * n_pixels + p] = sum;
+            sum += count;
         }
+    }
+    offsets[n_pixels] = sum;
 
-        if(range < m_maxZ)
+    // Scatter the point indices into their buckets
+    points.resize(sum);
+
+    #pragma omp parallel for schedule(static, 1)
+    for(size_t b = 0; b < n_blocks; b++)
+    {
+        size_t* fill = counts.data() + b * n_pixels;
+        size_t end = n_points * (b + 1) / n_blocks;
+        for(size_t k = n_points * b / n_blocks; k < end; k++)
         {
-            // Add point index to image pixel
-            mat.pixels[img_y][img_x].emplace_back(PanoramaPoint(i));
+            if(pixels[k] >= 0)
+            {
+                points[fill[pixels[k]]++] = PanoramaPoint(k);
+            }
         }
-        ++progress;
     }
-    std::cout << std::endl;
 }
 
-void ModelToImage::computeDepthImage(ModelToImage::DepthImage& img, ModelToImage::ProjectionPolicy policy)
+void ModelToImage::computeDepthListMatrix(DepthListMatrix& mat)
 {
-    std::cout << timestamp << "Computing depth image. Image dimensions: " << m_width << " x " << m_height << std::endl;
+    std::cout << timestamp << "Initializting DepthListMatrix with dimensions " << m_width << " x " << m_height << std::endl;
+    mat.width = m_width;
+    mat.height = m_height;
 
-    // Set correct image width and height
-    for(int i = 0; i < m_height; i++)
+    vector<int> pixels;
+    vector<float> ranges;
+    projectPoints(pixels, ranges, mat.minRange, mat.maxRange);
+
+    // Only points closer than maxZ are added to the matrix
+    #pragma omp parallel for schedule(static)
+    for(size_t k = 0; k < pixels.size(); k++)
     {
-        img.pixels.emplace_back(vector<float>());
-        for(int j = 0; j < m_width; j++)
+        if(ranges[k] >= m_maxZ)
         {
-            img.pixels[i].push_back(0.0f);
+            pixels[k] = -1;
         }
     }
 
+    bucketPoints(pixels, mat.offsets, mat.points);
+}
 
-    // Get point array and size from buffer
-    size_t n_points = m_points->numPoints();
-    floatArr points = m_points->getPointArray();
+void ModelToImage::computeDepthImage(ModelToImage::DepthImage& img, ModelToImage::ProjectionPolicy policy)
+{
+    std::cout << timestamp << "Computing depth image. Image dimensions: " << m_width << " x " << m_height << std::endl;
 
-    // Create progress output
-    string comment = timestamp.getElapsedTime() + "Projecting points ";
-    ProgressBar progress(n_points, comment);
+    // Set correct image width and height
+    img.width = m_width;
+    img.height = m_height;
+    img.pixels.assign((size_t)m_width * m_height, 0.0f);
 
-    float range;
-    int img_x, img_y;
-    for(int i = 0; i < n_points; i++)
-    {
-        m_projection->project(
-                    img_x, img_y, range,
-                    points[3 * i], points[3 * i + 1], points[3 * i + 2]);
+    vector<int> pixels;
+    vector<float> ranges;
+    projectPoints(pixels, ranges, img.minRange, img.maxRange);
+
+    vector<size_t> offsets;
+    vector<PanoramaPoint> buckets;
+    bucketPoints(pixels, offsets, buckets);
 
-        // Update min and max ranges
-        if(range > img.maxRange)
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(size_t p = 0; p < img.pixels.size(); p++)
+    {
+        size_t first = offsets[p];
+        size_t last = offsets[p + 1];
+        if(first == last)
         {
-            img.maxRange = range;
+            continue;
         }
 
-        if(range < img.minRange)
+        float depth = ranges[buckets[last - 1].index];
+        switch(policy)
         {
-            img.minRange = range;
+        case FIRST:
+            depth = ranges[buckets[first].index];
+            break;
+        case MINRANGE:
+        case MAXRANGE:
+        case AVERAGE:
+        {
+            float sum = 0.0f;
+            for(size_t k = first; k < last; k++)
+            {
+                float r = ranges[buckets[k].index];
+                depth = (policy == MINRANGE) ? std::min(depth, r) : std::max(depth, r);
+                sum += r;
+            }
+            if(policy == AVERAGE)
+            {
+                depth = sum / (last - first);
+            }
+            break;
         }
-
-        img.pixels[img_y][img_x] = range;
-        ++progress;
+        default:
+            // LAST and policies without depth semantics
+            break;
+        }
+        img.pixels[p] = depth;
     }
-    cout << endl;
+
     cout << timestamp << "Min / Max range: " << img.minRange << " / " << img.maxRange << endl;
 }
 
@@ -204,13 +281,13 @@ void ModelToImage::writePGM(string filename, float cutoff)
     // Open file, write header and pixel values
     std::ofstream out(filename);
     out << "P2" << endl;
-    out << img.pixels[0].size() << " " << img.pixels.size() << " 255" << endl;
+    out << img.width << " " << img.height << " 255" << endl;
 
-    for(int i = 0; i < img.pixels.size(); i++)
+    for(int i = 0; i < img.height; i++)
     {
-        for(int j = 0; j < img.pixels[i].size(); j++)
+        for(int j = 0; j < img.width; j++)
         {
-            int val = img.pixels[i][j];
+            int val = img.at(i, j);
 
             // Image was initialized with zeros. Fix that to
             // the measured min value
@@ -100,17 +100,17 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
     // Compute normals
     // Create progress output
     string comment = timestamp.getElapsedTime() + "Computing normals ";
-    ProgressBar progress(mat.pixels.size(), comment);
+    ProgressBar progress(mat.height, comment);
 
 
 
-    for(size_t i = 0; i < mat.pixels.size(); i++)
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < mat.height; i++)
     {
-        #pragma omp parallel for
-        for(size_t j = 0; j < mat.pixels[i].size(); j++)
+        for(int j = 0; j < mat.width; j++)
         {
             // Check if image entry is empty
-            if(mat.pixels[i][j].size() == 0)
+            if(mat.size(i, j) == 0)
             {
                 continue;
             }
@@ -119,7 +119,7 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
             vector<ModelToImage::PanoramaPoint> nb;
 
             // The points at the current position are part of the neighborhood
-            std::copy(mat.pixels[i][j].begin(), mat.pixels[i][j].end(), std::back_inserter(nb));
+            std::copy(mat.begin(i, j), mat.end(i, j), std::back_inserter(nb));
 
             for(int off_i = -di; off_i <= di; off_i++)
             {
@@ -129,16 +129,16 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
                     int p_j = j + off_j;
 
 
-                    if(p_i >= 0 && p_i < mat.pixels.size() &&
-                       p_j >= 0 && p_j < mat.pixels[i].size())
+                    if(p_i >= 0 && p_i < mat.height &&
+                       p_j >= 0 && p_j < mat.width)
                     {
                         // We only save the first point as representative
                         // because using all points from list will likely
                         // result in undesirable configurations for local
                         // normal estimation
-                        if(mat.pixels[p_i][p_j].size() > 0)
+                        if(mat.size(p_i, p_j) > 0)
                         {
-                            nb.push_back(mat.pixels[p_i][p_j][0]);
+                            nb.push_back(*mat.begin(p_i, p_j));
                         }
                     }
                 }
@@ -225,7 +225,7 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
                 Normal<float> nn(nx, ny, nz);
                 Vec center(0, 0, 0);
 
-                size_t index = mat.pixels[i][j][0].index * 3;
+                size_t index = mat.begin(i, j)->index * 3;
                 Vec p1 = center - Vec(in_points[index], in_points[index + 1], in_points[index + 2]);
 
                 if(Normal<float>(p1) * nn < 0)
@@ -235,13 +235,13 @@ PointBufferPtr PanoramaNormals::computeNormals(int width, int height, bool inter
                     nz *= -1;
                 }
 
-                for(size_t k = 0; k < mat.pixels[i][j].size(); k++)
+                for(const ModelToImage::PanoramaPoint* pp = mat.begin(i, j); pp != mat.end(i, j); pp++)
                 {
                     // Assign the same normal to all points
                     // behind this pixel to preserve the complete
                     // point cloud
-                    size_t index = mat.pixels[i][j][k].index * 3;
-                    size_t color_index = mat.pixels[i][j][k].index * w_color;
+                    size_t index = pp->index * 3;
+                    size_t color_index = pp->index * w_color;
 
                     // Copy point and normal to target buffer
                     p_arr[index    ] = in_points[index];
@@ -50,6 +50,16 @@ Projection::Projection(int width, int height, int minH, int maxH, int minV, int
 
 
 
+void Projection::projectPoints(const float* points, size_t n, int* i, int* j, float* r)
+{
+    #pragma omp parallel for schedule(static)
+    for(size_t k = 0; k < n; k++)
+    {
+        r[k] = 0.0f;
+        project(i[k], j[k], r[k], points[3 * k], points[3 * k + 1], points[3 * k + 2]);
+    }
+}
+
 void Projection::setImageRatio()
 {
     if(((double)m_xSize / m_ySize) != ((double)m_width / m_height))
@@ -120,6 +130,17 @@ EquirectangularProjection::EquirectangularProjection(int width, int height, int
 
 }
 
+void EquirectangularProjection::projectPoints(const float* points, size_t n, int* i, int* j, float* r)
+{
+    // Same as the base class, but without a virtual call per point
+    #pragma omp parallel for schedule(static)
+    for(size_t k = 0; k < n; k++)
+    {
+        r[k] = 0.0f;
+        EquirectangularProjection::project(i[k], j[k], r[k], points[3 * k], points[3 * k + 1], points[3 * k + 2]);
+    }
+}
+
 void EquirectangularProjection::project(int& i, int& j, float& range, float x, float y, float z)
 {
     float kart[3];
@@ -41,6 +41,8 @@
 
 #include <Eigen/SparseCholesky>
 
+#include <algorithm>
+
 #include <math.h>
 
 using namespace std;
@@ -63,6 +65,18 @@ bool findCloseScans(const vector<SLAMScanPtr>& scans, size_t scan, const SLAMOpt
         return false;
     }
 
+    // the local KDTrees and bounding boxes are cached in the Scans, so this is cheap after the first call
+    CloseScanIndex index(scans, scan, options);
+    return index.findCloseScans(scan, output);
+}
+
+bool findCloseScansExhaustive(const vector<SLAMScanPtr>& scans, size_t scan, const SLAMOptions& options, vector<size_t>& output)
+{
+    if (scan < options.loopSize)
+    {
+        return false;
+    }
+
     const SLAMScanPtr& cur = scans[scan];
 
     // closeLoopPairs not specified => use closeLoopDistance
@@ -103,6 +117,261 @@ bool findCloseScans(const vector<SLAMScanPtr>& scans, size_t scan, const SLAMOpt
     return !output.empty();
 }
 
+/// Minimum number of Points sampled from a Scan when estimating the number of pairs
+constexpr size_t MIN_OVERLAP_SAMPLES = 4096;
+
+/// Minimum number of sampled hits that stand for the required number of pairs
+constexpr size_t MIN_SAMPLED_HITS = 16;
+
+/// Number of bits per dimension in a CloseScanIndex::CellKey
+constexpr int CELL_KEY_BITS = 21;
+
+CloseScanIndex::CloseScanIndex(const vector<SLAMScanPtr>& scans, size_t last, const SLAMOptions& options)
+    : m_scans(scans),
+      m_options(options),
+      m_usePairs(options.closeLoopPairs >= 0),
+      m_cellSize(0.0),
+      m_maxRadius(0.0)
+{
+    update(last);
+}
+
+void CloseScanIndex::update(size_t last)
+{
+    // moved Scans change the grid in unknown ways, so they are all added again
+    bool rebuild = m_usePairs != (m_options.closeLoopPairs >= 0) || m_poses.size() > last + 1;
+    for (size_t i = 0; i < m_poses.size() && !rebuild; i++)
+    {
+        rebuild = m_poses[i] != m_scans[i]->pose();
+    }
+
+    size_t first = rebuild ? 0 : m_poses.size();
+    if (rebuild)
+    {
+        m_usePairs = m_options.closeLoopPairs >= 0;
+        m_maxRadius = 0.0;
+    }
+    m_centers.resize(last + 1);
+    m_radii.resize(last + 1);
+    m_poses.resize(last + 1);
+
+    double maxRadius = m_maxRadius;
+
+    #pragma omp parallel for schedule(dynamic) reduction(max:maxRadius)
+    for (size_t i = first; i <= last; i++)
+    {
+        const SLAMScanPtr& scan = m_scans[i];
+        m_poses[i] = scan->pose();
+        m_radii[i] = 0.0;
+        if (!m_usePairs)
+        {
+            m_centers[i] = scan->getPosition();
+            continue;
+        }
+        if (scan->numPoints() == 0)
+        {
+            // a Scan without Points can't have pairs
+            m_radii[i] = -1.0;
+            continue;
+        }
+        Vector3f min, max;
+        scan->localBoundingBox(min, max);
+        Vector4d center;
+        center << ((min + max) / 2.0f).cast<double>(), 1.0;
+        m_centers[i] = (scan->pose() * center).block<3, 1>(0, 0);
+        m_radii[i] = (max - min).cast<double>().norm() / 2.0;
+        maxRadius = std::max(maxRadius, m_radii[i]);
+    }
+    m_maxRadius = maxRadius;
+
+    // any two Scans that could have pairs are at most one cell apart
+    double cellSize = m_usePairs ? 2.0 * m_maxRadius + m_options.slamMaxDistance : m_options.closeLoopDistance;
+    if (rebuild || cellSize != m_cellSize)
+    {
+        // a larger Scan or changed options need a new grid
+        m_cellSize = cellSize;
+        m_grid.clear();
+        first = 0;
+    }
+
+    if (m_cellSize <= 0.0)
+    {
+        // nothing can be close, findCloseScans checks for an empty grid
+        return;
+    }
+
+    for (size_t i = first; i <= last; i++)
+    {
+        if (m_radii[i] >= 0.0)
+        {
+            m_grid[cellKey(m_centers[i])].push_back(i);
+        }
+    }
+}
+
+CloseScanIndex::CellKey CloseScanIndex::cellKey(const Vector3d& p) const
+{
+    // clamping keeps neighboring cells neighbors, so far away Scans only end up in the outer cells
+    const double offset = 1 << (CELL_KEY_BITS - 1);
+    const double limit = offset - 2;
+    CellKey key = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        double cell = std::floor(p[i] / m_cellSize);
+        cell = std::min(std::max(cell, -limit), limit) + offset;
+        key = (key << CELL_KEY_BITS) | static_cast<CellKey>(cell);
+    }
+    return key;
+}
+
+bool CloseScanIndex::findCloseScans(size_t scan, vector<size_t>& output) const
+{
+    size_t begin = output.size();
+    searchCloseScans(scan, output);
+
+    if (m_options.verifyCloseScans)
+    {
+        vector<size_t> expected;
+        findCloseScansExhaustive(m_scans, scan, m_options, expected);
+        if (!std::equal(output.begin() + begin, output.end(), expected.begin(), expected.end()))
+        {
+            #pragma omp critical
+            {
+                std::cout << "Close Scans of Scan " << scan << " differ from the exhaustive search: found "
+                          << output.size() - begin << ", expected " << expected.size() << std::endl;
+            }
+        }
+    }
+
+    return !output.empty();
+}
+
+void CloseScanIndex::searchCloseScans(size_t scan, vector<size_t>& output) const
+{
+    if (scan < m_options.loopSize)
+    {
+        return;
+    }
+    size_t end = scan - m_options.loopSize;
+
+    if (m_usePairs && m_options.closeLoopPairs == 0)
+    {
+        // every Scan has at least 0 pairs
+        for (size_t other = 0; other < end; other++)
+        {
+            output.push_back(other);
+        }
+        return;
+    }
+
+    if (m_grid.empty() || m_radii[scan] < 0.0)
+    {
+        return;
+    }
+
+    const Vector3d& center = m_centers[scan];
+    double maxDist = m_usePairs ? m_radii[scan] + m_options.slamMaxDistance : m_options.closeLoopDistance;
+
+    // collect the Scans in the 27 neighboring cells
+    vector<size_t> candidates;
+    for (int dx = -1; dx <= 1; dx++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dz = -1; dz <= 1; dz++)
+            {
+                Vector3d offset(dx * m_cellSize, dy * m_cellSize, dz * m_cellSize);
+                auto it = m_grid.find(cellKey(center + offset));
+                if (it == m_grid.end())
+                {
+                    continue;
+                }
+                for (size_t other : it->second)
+                {
+                    double dist = m_usePairs ? maxDist + m_radii[other] : maxDist;
+                    if (other < end && (m_centers[other] - center).squaredNorm() < dist * dist)
+                    {
+                        candidates.push_back(other);
+                    }
+                }
+            }
+        }
+    }
+
+    // clamped cells may be visited more than once
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    if (!m_usePairs || candidates.empty())
+    {
+        output.insert(output.end(), candidates.begin(), candidates.end());
+        return;
+    }
+
+    auto tree = m_scans[scan]->localKDTree(m_options.maxLeafSize);
+
+    vector<char> close(candidates.size(), 0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        close[i] = enoughPairs(scan, candidates[i], tree);
+    }
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        if (close[i])
+        {
+            output.push_back(candidates[i]);
+        }
+    }
+}
+
+bool CloseScanIndex::enoughPairs(size_t scan, size_t other, const KDTreePtr<Vector3f>& tree) const
+{
+    const SLAMScanPtr& otherScan = m_scans[other];
+    size_t n = otherScan->numPoints();
+    size_t needed = m_options.closeLoopPairs;
+    if (n < needed)
+    {
+        return false;
+    }
+
+    // every step-th Point stands for step Points. Small Scans are tested exactly.
+    // The step is bounded by the threshold, so a pair is only accepted after at
+    // least MIN_SAMPLED_HITS sampled hits and not because of a few lucky ones.
+    size_t samples = std::max(MIN_OVERLAP_SAMPLES, MIN_SAMPLED_HITS * needed);
+    size_t step = std::min(std::max<size_t>(1, n / samples),
+                           std::max<size_t>(1, needed / MIN_SAMPLED_HITS));
+    size_t remaining = (n + step - 1) / step;
+
+    // transform the other Scan into the local Coordinate System of the tree
+    Matrix4d transform = m_scans[scan]->pose().inverse() * otherScan->pose();
+    Matrix3f rotation = transform.block<3, 3>(0, 0).cast<float>();
+    Vector3f translation = transform.block<3, 1>(0, 3).cast<float>();
+
+    size_t hits = 0;
+    Vector3f* neighbor = nullptr;
+    float distance;
+    for (size_t i = 0; i < n; i += step)
+    {
+        remaining--;
+        Vector3f p = rotation * otherScan->rawPoint(i) + translation;
+        if (tree->nnSearch(p, neighbor, distance, m_options.slamMaxDistance))
+        {
+            hits++;
+            if (hits * step >= needed)
+            {
+                return true;
+            }
+        }
+        else if ((hits + remaining) * step < needed)
+        {
+            return false;
+        }
+    }
+    return false;
+}
 
 /**
  * Conversion from Pose to Matrix representation in GraphSLAMs internally consistent Coordinate System
@@ -260,17 +529,27 @@ void GraphSLAM::createGraph(const vector<SLAMScanPtr>& scans, size_t last, Graph
         graph.push_back(make_pair(i - 1, i));
     }
 
-    vector<size_t> others;
+    if (last < m_options->loopSize)
+    {
+        return;
+    }
+
+    CloseScanIndex index(scans, last, *m_options);
+
+    vector<vector<size_t>> others(last + 1);
+
+    #pragma omp parallel for schedule(dynamic)
     for (size_t i = m_options->loopSize; i <= last; i++)
     {
-        findCloseScans(scans, i, *m_options, others);
+        index.findCloseScans(i, others[i]);
+    }
 
-        for (size_t other : others)
+    for (size_t i = m_options->loopSize; i <= last; i++)
+    {
+        for (size_t other : others[i])
         {
             graph.push_back(make_pair(other, i));
         }
-
-        others.clear();
     }
 }
 
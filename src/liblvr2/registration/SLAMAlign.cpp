@@ -57,6 +57,27 @@ SLAMAlign::SLAMAlign(const SLAMOptions& options, std::vector<bool> new_scans)
 {
 }
 
+SLAMAlign::SLAMAlign(const SLAMAlign& other)
+    : m_options(other.m_options), m_scans(other.m_scans), m_metascan(other.m_metascan), m_graph(&m_options),
+      m_foundLoop(other.m_foundLoop), m_loopIndexCount(other.m_loopIndexCount), m_new_scans(other.m_new_scans),
+      m_icp_graph(other.m_icp_graph)
+{
+}
+
+SLAMAlign& SLAMAlign::operator=(const SLAMAlign& other)
+{
+    // m_graph keeps pointing to m_options, and the index refers to the Scans of other
+    m_options = other.m_options;
+    m_scans = other.m_scans;
+    m_metascan = other.m_metascan;
+    m_foundLoop = other.m_foundLoop;
+    m_loopIndexCount = other.m_loopIndexCount;
+    m_new_scans = other.m_new_scans;
+    m_icp_graph = other.m_icp_graph;
+    m_closeScans.reset();
+    return *this;
+}
+
 void SLAMAlign::setOptions(const SLAMOptions& options)
 {
     m_options = options;
@@ -273,8 +294,18 @@ void SLAMAlign::checkLoopClose(size_t last)
     bool hasLoop = false;
     size_t first = 0;
 
+    // the index only adds the new Scans, unless loopClose or graphSLAM moved the others
+    if (!m_closeScans)
+    {
+        m_closeScans.reset(new CloseScanIndex(m_scans, last, m_options));
+    }
+    else
+    {
+        m_closeScans->update(last);
+    }
+
     vector<size_t> others;
-    if (findCloseScans(m_scans, last, m_options, others))
+    if (m_closeScans->findCloseScans(last, others))
     {
         hasLoop = true;
         first = others[0];
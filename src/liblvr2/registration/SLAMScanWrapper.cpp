@@ -36,6 +36,7 @@
 #include "lvr2/registration/OctreeReduction.hpp"
 
 #include <fstream>
+#include <limits>
 
 namespace lvr2
 {
@@ -88,6 +89,7 @@ void SLAMScanWrapper::reduce(double voxelSize, int maxLeafSize)
 {
     RandomSampleOctreeReduction reduction(m_points.data(), m_numPoints, voxelSize, maxLeafSize);
     m_points.resize(m_numPoints);
+    invalidateLocalCache();
 }
 
 void SLAMScanWrapper::setMinDistance(double minDistance)
@@ -108,6 +110,7 @@ void SLAMScanWrapper::setMinDistance(double minDistance)
         }
     }
     m_points.resize(m_numPoints);
+    invalidateLocalCache();
 }
 
 void SLAMScanWrapper::setMaxDistance(double maxDistance)
@@ -128,6 +131,45 @@ void SLAMScanWrapper::setMaxDistance(double maxDistance)
         }
     }
     m_points.resize(m_numPoints);
+    invalidateLocalCache();
+}
+
+void SLAMScanWrapper::invalidateLocalCache()
+{
+    std::lock_guard<std::mutex> lock(m_localCacheMutex);
+    m_localTree.reset();
+    m_localBoxValid = false;
+}
+
+KDTreePtr<Vector3f> SLAMScanWrapper::localKDTree(size_t maxLeafSize) const
+{
+    // concurrent callers wait for the first one instead of building the tree twice
+    std::lock_guard<std::mutex> lock(m_localCacheMutex);
+    if (!m_localTree)
+    {
+        std::unique_ptr<Vector3f[]> points(new Vector3f[m_numPoints]);
+        std::copy(m_points.begin(), m_points.begin() + m_numPoints, points.get());
+        m_localTree = KDTree<Vector3f>::create(std::move(points), m_numPoints, maxLeafSize);
+    }
+    return m_localTree;
+}
+
+void SLAMScanWrapper::localBoundingBox(Vector3f& min, Vector3f& max) const
+{
+    std::lock_guard<std::mutex> lock(m_localCacheMutex);
+    if (!m_localBoxValid)
+    {
+        m_localMin.setConstant(std::numeric_limits<float>::max());
+        m_localMax.setConstant(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < m_numPoints; i++)
+        {
+            m_localMin = m_localMin.cwiseMin(m_points[i]);
+            m_localMax = m_localMax.cwiseMax(m_points[i]);
+        }
+        m_localBoxValid = true;
+    }
+    min = m_localMin;
+    max = m_localMax;
 }
 
 void SLAMScanWrapper::trim()
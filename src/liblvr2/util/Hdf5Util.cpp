@@ -1,5 +1,11 @@
 #include "lvr2/util/Hdf5Util.hpp"
 #include "lvr2/types/Channel.hpp"
+#include "lvr2/config/lvropenmp.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace lvr2
 {
@@ -305,6 +311,449 @@ boost::optional<std::string> highFiveTypeToLvr(std::string h5type)
     return ret;
 }
 
+std::vector<hsize_t> computeChunkSize(
+    const std::vector<size_t>& dims,
+    size_t elementSize,
+    size_t chunkBytes)
+{
+    std::vector<hsize_t> chunkSizes(dims.size(), 1);
+    if(dims.empty() || std::find(dims.begin(), dims.end(), 0) != dims.end())
+    {
+        return std::vector<hsize_t>();
+    }
+
+    const size_t elementsPerChunk = std::max<size_t>(1, chunkBytes / std::max<size_t>(1, elementSize));
+    size_t currentElements = 1;
+
+    // Take complete trailing dimensions as long as they fit
+    size_t d = dims.size();
+    while(d > 0 && dims[d - 1] * currentElements <= elementsPerChunk)
+    {
+        d--;
+        chunkSizes[d] = dims[d];
+        currentElements *= dims[d];
+    }
+
+    if(d > 0)
+    {
+        chunkSizes[d - 1] = std::max<size_t>(1, elementsPerChunk / currentElements);
+    }
+    return chunkSizes;
+}
+
+namespace
+{
+
+/// Layout and filters of a dataset that supports direct chunk IO
+struct ChunkLayout
+{
+    std::vector<hsize_t> dims;
+    std::vector<hsize_t> chunk;
+    std::vector<hsize_t> numChunks;
+    size_t totalChunks = 1;
+    size_t chunkElements = 1;
+    bool shuffle = false;
+    int deflateLevel = -1;
+};
+
+/// Reads the layout of dataset, returns false if direct chunk IO is not supported
+bool getChunkLayout(const HighFive::DataSet& dataset, size_t elementSize, ChunkLayout& layout)
+{
+    const hid_t id = dataset.getId();
+
+    // Raw chunk data is only valid for native types of the expected size
+    const hid_t fileType = H5Dget_type(id);
+    const H5T_class_t typeClass = H5Tget_class(fileType);
+    const hid_t nativeType = H5Tget_native_type(fileType, H5T_DIR_DEFAULT);
+    const bool typeOk = (typeClass == H5T_INTEGER || typeClass == H5T_FLOAT)
+        && H5Tget_size(fileType) == elementSize
+        && H5Tequal(fileType, nativeType) > 0;
+    H5Tclose(nativeType);
+    H5Tclose(fileType);
+    if(!typeOk)
+    {
+        return false;
+    }
+
+    const hid_t plist = H5Dget_create_plist(id);
+    bool ok = H5Pget_layout(plist) == H5D_CHUNKED;
+
+    const hid_t space = H5Dget_space(id);
+    const int rank = H5Sget_simple_extent_ndims(space);
+    ok = ok && rank > 0;
+    if(ok)
+    {
+        layout.dims.resize(rank);
+        layout.chunk.resize(rank);
+        H5Sget_simple_extent_dims(space, layout.dims.data(), nullptr);
+        ok = H5Pget_chunk(plist, rank, layout.chunk.data()) == rank;
+    }
+    H5Sclose(space);
+
+    // Supported pipelines: deflate or shuffle + deflate
+    const int numFilters = ok ? H5Pget_nfilters(plist) : 0;
+    for(int i = 0; ok && i < numFilters; i++)
+    {
+        unsigned int flags;
+        size_t numValues = 1;
+        unsigned int values[1] = {0};
+        unsigned int config;
+        const H5Z_filter_t filter = H5Pget_filter2(plist, i, &flags, &numValues, values, 0, nullptr, &config);
+        if(filter == H5Z_FILTER_SHUFFLE && i == 0 && numFilters == 2)
+        {
+            layout.shuffle = true;
+        }
+        else if(filter == H5Z_FILTER_DEFLATE && i == numFilters - 1)
+        {
+            layout.deflateLevel = numValues > 0 ? values[0] : Z_DEFAULT_COMPRESSION;
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+    H5Pclose(plist);
+
+    if(!ok || layout.deflateLevel < 0)
+    {
+        return false;
+    }
+
+    layout.numChunks.resize(rank);
+    for(int d = 0; d < rank; d++)
+    {
+        if(layout.dims[d] == 0)
+        {
+            return false;
+        }
+        layout.numChunks[d] = (layout.dims[d] + layout.chunk[d] - 1) / layout.chunk[d];
+        layout.totalChunks *= layout.numChunks[d];
+        layout.chunkElements *= layout.chunk[d];
+    }
+    return true;
+}
+
+/// Computes the element offset of the chunk with the given linear index
+std::vector<hsize_t> chunkOffset(const ChunkLayout& layout, size_t index)
+{
+    std::vector<hsize_t> offset(layout.dims.size());
+    for(size_t d = layout.dims.size(); d-- > 0;)
+    {
+        offset[d] = (index % layout.numChunks[d]) * layout.chunk[d];
+        index /= layout.numChunks[d];
+    }
+    return offset;
+}
+
+/**
+ * Copies the elements of a chunk between the row-major dataset and the
+ * row-major chunk buffer. Parts of edge chunks outside the dataset are
+ * zero in the chunk buffer.
+ */
+void copyChunk(const ChunkLayout& layout, const std::vector<hsize_t>& offset,
+               size_t elementSize, const char* src, char* dst, bool toChunk)
+{
+    const size_t rank = layout.dims.size();
+    const size_t last = rank - 1;
+    const size_t rowLength = std::min(layout.chunk[last], layout.dims[last] - offset[last]);
+
+    if(toChunk)
+    {
+        std::memset(dst, 0, layout.chunkElements * elementSize);
+    }
+
+    // Chunks that span all but the first dimension completely are contiguous
+    // in the dataset
+    bool contiguous = true;
+    size_t sliceElements = 1;
+    for(size_t d = 1; d < rank; d++)
+    {
+        contiguous = contiguous && layout.chunk[d] == layout.dims[d];
+        sliceElements *= layout.dims[d];
+    }
+    if(contiguous)
+    {
+        const size_t bytes = std::min(layout.chunk[0], layout.dims[0] - offset[0]) * sliceElements * elementSize;
+        const size_t datasetByte = offset[0] * sliceElements * elementSize;
+        if(toChunk)
+        {
+            std::memcpy(dst, src + datasetByte, bytes);
+        }
+        else
+        {
+            std::memcpy(dst + datasetByte, src, bytes);
+        }
+        return;
+    }
+
+    // Iterate over all rows of the chunk, i.e. all positions but the last dimension
+    std::vector<hsize_t> position(rank, 0);
+    while(true)
+    {
+        bool inside = true;
+        size_t datasetIndex = 0;
+        size_t chunkIndex = 0;
+        for(size_t d = 0; d < rank; d++)
+        {
+            inside = inside && offset[d] + position[d] < layout.dims[d];
+            datasetIndex = datasetIndex * layout.dims[d] + offset[d] + position[d];
+            chunkIndex = chunkIndex * layout.chunk[d] + position[d];
+        }
+
+        if(inside)
+        {
+            if(toChunk)
+            {
+                std::memcpy(dst + chunkIndex * elementSize, src + datasetIndex * elementSize, rowLength * elementSize);
+            }
+            else
+            {
+                std::memcpy(dst + datasetIndex * elementSize, src + chunkIndex * elementSize, rowLength * elementSize);
+            }
+        }
+
+        // Advance to the next row
+        size_t d = last;
+        while(d-- > 0)
+        {
+            if(++position[d] < layout.chunk[d])
+            {
+                break;
+            }
+            position[d] = 0;
+        }
+        if(d == static_cast<size_t>(-1))
+        {
+            return;
+        }
+    }
+}
+
+/// Same byte reordering as the HDF5 shuffle filter
+void shuffleBytes(const char* src, char* dst, size_t numElements, size_t elementSize, bool forward)
+{
+    for(size_t b = 0; b < elementSize; b++)
+    {
+        for(size_t i = 0; i < numElements; i++)
+        {
+            if(forward)
+            {
+                dst[b * numElements + i] = src[i * elementSize + b];
+            }
+            else
+            {
+                dst[i * elementSize + b] = src[b * numElements + i];
+            }
+        }
+    }
+}
+
+/// Number of chunks that are filtered in parallel before they are passed to HDF5
+size_t chunkBatchSize(int numThreads)
+{
+    return 4 * static_cast<size_t>(numThreads);
+}
+
+/// Chunks larger than this are passed to HDF5 as a whole. Legacy files store
+/// a channel in a single chunk, which would need several copies of the channel.
+constexpr size_t MAX_PARALLEL_CHUNK_BYTES = 16 * 1024 * 1024;
+
+int resolveNumThreads(int numThreads, const ChunkLayout& layout)
+{
+    numThreads = numThreads > 0 ? numThreads : std::max(1, OpenMPConfig::getNumThreads());
+    return static_cast<int>(std::min(static_cast<size_t>(numThreads), layout.totalChunks));
+}
+
+/// Parallel filtering only pays off for several chunks of moderate size
+bool useParallelChunks(const ChunkLayout& layout, size_t elementSize)
+{
+    return layout.totalChunks > 1
+        && layout.chunkElements * elementSize <= MAX_PARALLEL_CHUNK_BYTES;
+}
+
+} // namespace
+
+bool writeChunksParallel(
+    HighFive::DataSet& dataset,
+    const void* data,
+    size_t elementSize,
+    int numThreads)
+{
+    ChunkLayout layout;
+    if(!getChunkLayout(dataset, elementSize, layout) || !useParallelChunks(layout, elementSize))
+    {
+        return false;
+    }
+
+    numThreads = resolveNumThreads(numThreads, layout);
+    const size_t chunkBytes = layout.chunkElements * elementSize;
+    const bool shuffle = layout.shuffle && elementSize > 1;
+    const size_t batchSize = std::min(layout.totalChunks, chunkBatchSize(numThreads));
+
+    std::vector<std::vector<char>> compressed(batchSize);
+    std::vector<uLongf> compressedSize(batchSize);
+    bool ok = true;
+
+    for(size_t begin = 0; begin < layout.totalChunks && ok; begin += batchSize)
+    {
+        const size_t count = std::min(batchSize, layout.totalChunks - begin);
+
+        #pragma omp parallel num_threads(numThreads) reduction(&&:ok)
+        {
+            // Allocated on first use, threads without a chunk need no buffers
+            std::vector<char> chunk;
+            std::vector<char> shuffled;
+
+            #pragma omp for schedule(dynamic, 1)
+            for(size_t i = 0; i < count; i++)
+            {
+                chunk.resize(chunkBytes);
+                shuffled.resize(shuffle ? chunkBytes : 0);
+
+                copyChunk(layout, chunkOffset(layout, begin + i), elementSize,
+                          static_cast<const char*>(data), chunk.data(), true);
+
+                const char* input = chunk.data();
+                if(shuffle)
+                {
+                    shuffleBytes(chunk.data(), shuffled.data(), layout.chunkElements, elementSize, true);
+                    input = shuffled.data();
+                }
+
+                compressedSize[i] = compressBound(chunkBytes);
+                compressed[i].resize(compressedSize[i]);
+                const bool chunkOk = compress2(reinterpret_cast<Bytef*>(compressed[i].data()), &compressedSize[i],
+                                               reinterpret_cast<const Bytef*>(input), chunkBytes, layout.deflateLevel) == Z_OK;
+                // Accumulate, a later chunk of this thread must not hide a failed one
+                ok = ok && chunkOk;
+            }
+        }
+
+        // HDF5 itself is not thread-safe
+        for(size_t i = 0; i < count && ok; i++)
+        {
+            const std::vector<hsize_t> offset = chunkOffset(layout, begin + i);
+            ok = H5Dwrite_chunk(dataset.getId(), H5P_DEFAULT, 0, offset.data(),
+                                compressedSize[i], compressed[i].data()) >= 0;
+        }
+    }
+
+    if(!ok)
+    {
+        throw std::runtime_error("[Hdf5Util - writeChunksParallel]: Failed to write chunks.");
+    }
+    return true;
+}
+
+bool readChunksParallel(
+    const HighFive::DataSet& dataset,
+    void* data,
+    size_t elementSize,
+    int numThreads)
+{
+    ChunkLayout layout;
+    if(!getChunkLayout(dataset, elementSize, layout) || !useParallelChunks(layout, elementSize))
+    {
+        return false;
+    }
+
+    numThreads = resolveNumThreads(numThreads, layout);
+    const size_t chunkBytes = layout.chunkElements * elementSize;
+    const bool shuffle = layout.shuffle && elementSize > 1;
+    const size_t batchSize = std::min(layout.totalChunks, chunkBatchSize(numThreads));
+
+    std::vector<std::vector<char>> raw(batchSize);
+    std::vector<uint32_t> filterMask(batchSize);
+    std::vector<bool> allocated(batchSize);
+    bool ok = true;
+
+    for(size_t begin = 0; begin < layout.totalChunks && ok; begin += batchSize)
+    {
+        const size_t count = std::min(batchSize, layout.totalChunks - begin);
+
+        // HDF5 itself is not thread-safe
+        for(size_t i = 0; i < count && ok; i++)
+        {
+            const std::vector<hsize_t> offset = chunkOffset(layout, begin + i);
+            hsize_t storageSize = 0;
+            ok = H5Dget_chunk_storage_size(dataset.getId(), offset.data(), &storageSize) >= 0;
+            allocated[i] = storageSize > 0;
+            if(ok && allocated[i])
+            {
+                raw[i].resize(storageSize);
+                ok = H5Dread_chunk(dataset.getId(), H5P_DEFAULT, offset.data(), &filterMask[i], raw[i].data()) >= 0;
+            }
+        }
+
+        #pragma omp parallel num_threads(numThreads) reduction(&&:ok)
+        {
+            // Allocated on first use, threads without a chunk need no buffers
+            std::vector<char> chunk;
+            std::vector<char> inflated;
+
+            #pragma omp for schedule(dynamic, 1)
+            for(size_t i = 0; i < count; i++)
+            {
+                chunk.resize(chunkBytes);
+                inflated.resize(chunkBytes);
+
+                if(!allocated[i])
+                {
+                    // Unwritten chunks contain the default fill value zero
+                    std::memset(chunk.data(), 0, chunkBytes);
+                }
+                else
+                {
+                    // A set bit in the filter mask means the filter was skipped
+                    const bool deflated = !(filterMask[i] & (layout.shuffle ? 2u : 1u));
+                    const bool shuffled = shuffle && !(filterMask[i] & 1u);
+
+                    const char* input = raw[i].data();
+                    bool chunkOk;
+                    if(deflated)
+                    {
+                        uLongf size = chunkBytes;
+                        chunkOk = uncompress(reinterpret_cast<Bytef*>(inflated.data()), &size,
+                                         reinterpret_cast<const Bytef*>(raw[i].data()), raw[i].size()) == Z_OK
+                            && size == chunkBytes;
+                        input = inflated.data();
+                    }
+                    else
+                    {
+                        chunkOk = raw[i].size() == chunkBytes;
+                    }
+
+                    // The region of a broken chunk stays unwritten, which is only
+                    // acceptable because the whole call fails below
+                    if(!chunkOk)
+                    {
+                        ok = false;
+                        continue;
+                    }
+
+                    if(shuffled)
+                    {
+                        shuffleBytes(input, chunk.data(), layout.chunkElements, elementSize, false);
+                    }
+                    else
+                    {
+                        std::memcpy(chunk.data(), input, chunkBytes);
+                    }
+                }
+
+                copyChunk(layout, chunkOffset(layout, begin + i), elementSize,
+                          chunk.data(), static_cast<char*>(data), false);
+            }
+        }
+    }
+
+    if(!ok)
+    {
+        throw std::runtime_error("[Hdf5Util - readChunksParallel]: Failed to read chunks.");
+    }
+    return true;
+}
+
 } // namespace hdf5util
 
 } // namespace lvr2
@@ -28,7 +28,7 @@
 #include "lvr2/io/DataStruct.hpp"
 #include "lvr2/io/ModelFactory.hpp"
 #include "lvr2/types/WaveformBuffer.hpp"
-#include "lvr2/io/modelio/AsciiIO.hpp"
+#include "lvr2/io/modelio/UosIO.hpp"
 #include "lvr2/util/IOUtils.hpp"
 #include "lvr2/util/TransformUtils.hpp"
 
@@ -532,6 +532,14 @@ void parseSLAMDirectory(std::string dir, vector<ScanPtr>& scans)
 
         if(scan_files.size() > 0)
         {
+            // Load all scans concurrently, log afterwards in scan order
+            std::vector<ScanPtr> loaded(scan_files.size());
+            std::vector<char> hasFrames(scan_files.size(), 0);
+            std::vector<char> hasPose(scan_files.size(), 0);
+
+            lvr2::logout::get() << lvr2::info << "[ParseSLAMDirectory] Loading " << scan_files.size() << " scans." << lvr2::endl;
+
+            #pragma omp parallel for schedule(dynamic)
             for(size_t i = 0; i < scan_files.size(); i++)
             {
                 ScanPtr scan = ScanPtr(new Scan());
@@ -543,18 +551,20 @@ void parseSLAMDirectory(std::string dir, vector<ScanPtr>& scans)
                 boost::filesystem::path frame_path = directory/frame_file;
                 boost::filesystem::path pose_path = directory/pose_file;
 
-                lvr2::logout::get() << "Loading '" << filename << "'" << lvr2::endl;
-                AsciiIO io;
-                ModelPtr model = io.read(scan_files[i].string());
-                scan->points = model->m_pointCloud;
+                UosIO io;
+                scan->points = io.readScan(scan_files[i].string());
+                if(!scan->points)
+                {
+                    scan->points = PointBufferPtr(new PointBuffer);
+                }
 
                 size_t numPoints = scan->points->numPoints();
                 floatArr pts = scan->points->getPointArray();
 
                 scan->boundingBox = BoundingBox<BaseVector<float> >();
-                for (size_t i = 0; i < numPoints; i++)
+                for (size_t j = 0; j < numPoints; j++)
                 {
-                    BaseVector<float> pt(pts[i*3 + 0], pts[i*3 + 1], pts[i*3 + 2]);
+                    BaseVector<float> pt(pts[j*3 + 0], pts[j*3 + 1], pts[j*3 + 2]);
                     scan->boundingBox->expand(pt);
                 }
 
@@ -563,29 +573,39 @@ void parseSLAMDirectory(std::string dir, vector<ScanPtr>& scans)
 
                 if(boost::filesystem::exists(frame_path))
                 {
-                    lvr2::logout::get() << lvr2::info << "[ParseSLAMDirectory] Loading frame information from " << frame_path << lvr2::endl;
                     registration = getTransformationFromFrames<double>(frame_path);
-                }
-                else
-                {
-                    lvr2::logout::get() << lvr2::warning << "[ParseSLAMDirectory] Did not find a frame file for " << filename << lvr2::endl;
+                    hasFrames[i] = 1;
                 }
 
                 if(boost::filesystem::exists(pose_path))
                 {
-                    lvr2::logout::get() << lvr2::info << "[ParseSLAMDirectory] Loading pose estimation from " << pose_path << lvr2::endl;
                     pose_estimate = getTransformationFromPose<double>(pose_path);
-                }
-                else
-                {
-                    lvr2::logout::get() << lvr2::warning << "[ParseSLAMDirectory] Did not find a pose file for " << filename << lvr2::endl;
+                    hasPose[i] = 1;
                 }
 
                 // transform points?
                 scan->transformation = registration;
                 scan->poseEstimation = pose_estimate;
 
-                scans.push_back(scan);
+                loaded[i] = scan;
+            }
+
+            for(size_t i = 0; i < scan_files.size(); i++)
+            {
+                std::string filename = (scan_files[i]).stem().string();
+                lvr2::logout::get() << "Loaded '" << filename << "' with " << loaded[i]->points->numPoints() << " points" << lvr2::endl;
+
+                if(!hasFrames[i])
+                {
+                    lvr2::logout::get() << lvr2::warning << "[ParseSLAMDirectory] Did not find a frame file for " << filename << lvr2::endl;
+                }
+
+                if(!hasPose[i])
+                {
+                    lvr2::logout::get() << lvr2::warning << "[ParseSLAMDirectory] Did not find a pose file for " << filename << lvr2::endl;
+                }
+
+                scans.push_back(loaded[i]);
             }
         }
         else
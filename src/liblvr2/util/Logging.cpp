@@ -18,14 +18,25 @@ LVR2_API Logger::Logger()
 {
     m_logger = spdlog::stdout_color_mt("lvr2logger");
     m_logger->set_pattern("[%H:%M:%S:%e]%^[%-7l]%$ %v");
-    m_level = LogLevel::info;
+}
+
+LVR2_API std::stringstream& Logger::buffer()
+{
+    thread_local std::stringstream buffer;
+    return buffer;
+}
+
+LVR2_API LogLevel& Logger::currentLevel()
+{
+    thread_local LogLevel level = LogLevel::info;
+    return level;
 }
 
 LVR2_API void Logger::print()
 {
     spdlog::level::level_enum level;
     
-    switch(m_level)
+    switch(currentLevel())
     {
         case LogLevel::trace: level = spdlog::level::trace; break;
         case LogLevel::debug: level = spdlog::level::debug; break;
@@ -35,9 +46,10 @@ LVR2_API void Logger::print()
 
     }
 
-    m_logger->log(level, m_buffer.str());
-    m_buffer.str("");
-    m_buffer.clear();
+    std::stringstream& buf = buffer();
+    m_logger->log(level, buf.str());
+    buf.str("");
+    buf.clear();
 }
 
 LVR2_API void Logger::flush()
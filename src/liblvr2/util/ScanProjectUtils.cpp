@@ -4,6 +4,7 @@
 #include "lvr2/util/ScanSchemaUtils.hpp"
 #include "lvr2/util/TransformUtils.hpp"
 #include "lvr2/util/Logging.hpp"
+#include "lvr2/config/lvropenmp.hpp"
 #include "lvr2/io/ModelFactory.hpp"
 #include "lvr2/io/scanio/HDF5IO.hpp"
 #include "lvr2/io/scanio/DirectoryIO.hpp"
@@ -14,7 +15,15 @@
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/iostreams/stream.hpp>
 
+#include "ctpl_stl.h"
+
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
 
 namespace lvr2
 {
@@ -358,80 +367,261 @@ void printCameraImageStructure(const CameraImagePtr p)
     lvr2::logout::get() << lvr2::info << p;
 }
 
+namespace
+{
+
+/// A scan of a project together with its indices in the hierarchy
+struct ProjectScanRef
+{
+    ScanPtr scan;
+    size_t positionNr;
+    size_t lidarNr;
+    size_t scanNr;
+};
+
+/// A loaded scan waiting for normal computation
+struct LoadedScan
+{
+    ProjectScanRef ref;
+    size_t numPoints;
+    size_t bytes;
+};
+
+/// Rough memory footprint of a scan during normal estimation: 
+/// points, normals, interpolation buffer and search tree
+size_t normalEstimationBytes(size_t numPoints)
+{
+    return numPoints * (9 * sizeof(float) + 4 * sizeof(size_t));
+}
+
+} // namespace
+
 void estimateProjectNormals(ScanProjectPtr p, size_t kn, size_t ki)
 {
+    ProjectNormalOptions options;
+    options.kn = kn;
+    options.ki = ki;
+    estimateProjectNormals(p, options);
+}
+
+void estimateProjectNormals(ScanProjectPtr p, const ProjectNormalOptions& options)
+{
+    // Collect all scans of the project
+    std::vector<ProjectScanRef> scans;
     for(size_t positionNr = 0; positionNr < p->positions.size(); positionNr++)
     {
         ScanPositionPtr position = p->positions[positionNr];
-        if(position)
+        if(!position)
+        {
+            lvr2::logout::get() << lvr2::warning 
+                      << "[Project Normal Estimation]: Unable to load scan position " 
+                      << positionNr << lvr2::endl;
+            continue;
+        }
+
+        for(size_t lidarNr = 0; lidarNr < position->lidars.size(); lidarNr++)
+        {
+            LIDARPtr lidar = position->lidars[lidarNr];
+            if(!lidar)
+            {
+                lvr2::logout::get() << lvr2::warning << "[Project Normal Estimation]: Unable to load lidar " 
+                                       << lidarNr << " of scan position " 
+                                       << positionNr << lvr2::endl;
+                continue;
+            }
+
+            for(size_t scanNr = 0; scanNr < lidar->scans.size(); scanNr++)
+            {
+                ScanPtr scan = lidar->scans[scanNr];
+                if(!scan)
+                {
+                    lvr2::logout::get() << lvr2::warning << "[Project Normal Estimation]: "
+                              << "Unable to load scan " << scanNr << " of "
+                              << "lidar " << lidarNr << lvr2::endl; 
+                    continue;
+                }
+                scans.push_back({scan, positionNr, lidarNr, scanNr});
+            }
+        }
+    }
+
+    const size_t numThreads = options.numThreads ? 
+        options.numThreads : std::max(1u, std::thread::hardware_concurrency());
+    const size_t prefetch = std::max<size_t>(1, options.prefetch);
+    const int ompThreads = OpenMPConfig::getNumThreads();
+
+    // Kernels and schemas are not thread safe, so all loads 
+    // and saves are serialized through this mutex
+    std::mutex ioMutex;
+
+    // Shared pipeline state, guarded by stateMutex
+    std::mutex stateMutex;
+    std::condition_variable stateChanged;
+    std::deque<LoadedScan> ready;
+    bool loadingDone = false;
+    size_t bytesInFlight = 0;
+    size_t running = 0;
+    bool exclusive = false;
+    std::exception_ptr loaderError;
+
+    // Loader: reads scans ahead of the workers as long as the 
+    // prefetch queue and the memory budget allow
+    std::thread loader([&]()
+    {
+        try
         {
-            for(size_t lidarNr = 0; lidarNr < position->lidars.size(); lidarNr++)
+            for(const ProjectScanRef& ref : scans)
             {
-                LIDARPtr lidar = position->lidars[lidarNr];
-                if(lidar)
+                const size_t expected = normalEstimationBytes(ref.scan->numPoints);
                 {
-                    for(size_t scanNr = 0; scanNr < lidar->scans.size(); scanNr++)
+                    std::unique_lock<std::mutex> lock(stateMutex);
+                    stateChanged.wait(lock, [&]()
                     {
-                        ScanPtr scan = lidar->scans[scanNr];
-                        if(scan)
-                        {
-                            lvr2::logout::get() << lvr2::info << "[Project Normal Estimation]: Loading scan " << scanNr 
-                                      << " from lidar " << lidarNr << " of scan position " << positionNr << lvr2::endl;
-                        
-                            scan->load();
-                            PointBufferPtr ptBuffer = scan->points;
-                            if(ptBuffer)
-                            {
-                                size_t n = ptBuffer->numPoints();
-                                if(n)
-                                {
-                                    lvr2::logout::get() << lvr2::info << "[Project Normal Estimation]: Loaded " << n << " points" << lvr2::endl;
-                                    lvr2::logout::get() << lvr2::info << "[Project Normal Estimation]: Building search tree..." << lvr2::endl;
-
-                                    AdaptiveKSearchSurfacePtr<BaseVector<float>> surface(new AdaptiveKSearchSurface<BaseVector<float>>(ptBuffer, "flann", kn, ki));
-                                    surface->setFlipPoint(BaseVector<float>(0, 0, 0));
-                                    surface->calculateSurfaceNormals();
-                                    // surface->interpolateSurfaceNormals(); -> not required, already done in calculateSurfaceNormals
-
-                                    // Save data back to original project
-                                    scan->save();
-
-                                    // Free payload data
-                                    scan->release();
-                                }
-                                else
-                                {
-                                    lvr2::logout::get() << lvr2::warning << "[Project Normal Estimation]: No points in scan" << lvr2::endl;
-                                }
-       
-                            } 
-                            else
-                            {
-                                lvr2::logout::get() << lvr2::warning << "[Project Normal Estimation]:Unable to load point cloud data." << lvr2::endl;
-                            }
-                        }
-                        else
-                        {
-                            lvr2::logout::get() << lvr2::warning << "[Project Normal Estimation]: "
-                                      << "Unable to load scan " << scanNr << " of "
-                                      << "lidar " << lidarNr << lvr2::endl; 
-                        }
-                    }
+                        return ready.size() < prefetch && 
+                            (!options.memoryBudget || !bytesInFlight || 
+                              bytesInFlight + expected <= options.memoryBudget);
+                    });
                 }
-                else
+
+                lvr2::logout::get() << lvr2::info << "[Project Normal Estimation]: Loading scan " << ref.scanNr 
+                          << " from lidar " << ref.lidarNr << " of scan position " << ref.positionNr << lvr2::endl;
+
+                PointBufferPtr ptBuffer;
+                {
+                    std::lock_guard<std::mutex> lock(ioMutex);
+                    ref.scan->load();
+                    ptBuffer = ref.scan->points;
+                }
+
+                if(!ptBuffer)
                 {
-                    lvr2::logout::get() << lvr2::warning << "[Project Normal Estimation]: Unable to load lidar " 
-                                           << lidarNr << " of scan position " 
-                                           << positionNr << lvr2::endl;
+                    lvr2::logout::get() << lvr2::warning << "[Project Normal Estimation]: Unable to load point cloud data." << lvr2::endl;
+                    continue;
                 }
+
+                const size_t n = ptBuffer->numPoints();
+                if(!n)
+                {
+                    lvr2::logout::get() << lvr2::warning << "[Project Normal Estimation]: No points in scan" << lvr2::endl;
+                    ref.scan->release();
+                    continue;
+                }
+
+                lvr2::logout::get() << lvr2::info << "[Project Normal Estimation]: Loaded " << n << " points" << lvr2::endl;
+
+                std::lock_guard<std::mutex> lock(stateMutex);
+                bytesInFlight += normalEstimationBytes(n);
+                ready.push_back({ref, n, normalEstimationBytes(n)});
+                stateChanged.notify_all();
             }
         }
-        else
+        catch(...)
         {
-            lvr2::logout::get() << lvr2::warning 
-                      << "[Project Normal Estimation]: Unable to load scan position " 
-                      << positionNr << lvr2::endl;
+            loaderError = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        loadingDone = true;
+        stateChanged.notify_all();
+    });
+
+    // Computes the normals of a loaded scan, writes them back 
+    // and frees the payload data
+    auto process = [&](const LoadedScan& item, bool large)
+    {
+        // Returns the worker slot and the memory budget of the scan when
+        // the scan is done, also if estimating or saving throws. Otherwise
+        // the dispatcher and the loader would wait forever.
+        struct SlotGuard
+        {
+            std::function<void()> done;
+            ~SlotGuard() { done(); }
+        } guard{[&]()
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            bytesInFlight -= item.bytes;
+            running--;
+            exclusive = false;
+            stateChanged.notify_all();
+        }};
+
+        bool saved = false;
+        try
+        {
+            // Small scans run side by side with one thread each, 
+            // large scans alone with all threads
+            OpenMPConfig::setNumThreads(large ? ompThreads : 1);
+
+            {
+                AdaptiveKSearchSurfacePtr<BaseVector<float>> surface(
+                    new AdaptiveKSearchSurface<BaseVector<float>>(item.ref.scan->points, "flann", options.kn, options.ki));
+                surface->setFlipPoint(BaseVector<float>(0, 0, 0));
+                surface->calculateSurfaceNormals();
+                // surface->interpolateSurfaceNormals(); -> not required, already done in calculateSurfaceNormals
+            }
+
+            // Save data back to original project and free payload data
+            std::lock_guard<std::mutex> lock(ioMutex);
+            item.ref.scan->save();
+            saved = true;
+            item.ref.scan->release();
+        }
+        catch(...)
+        {
+            if(!saved)
+            {
+                std::lock_guard<std::mutex> lock(ioMutex);
+                item.ref.scan->release();
+            }
+            throw;
+        }
+
+        lvr2::logout::get() << lvr2::info << "[Project Normal Estimation]: Saved normals of scan " << item.ref.scanNr 
+                  << " from lidar " << item.ref.lidarNr << " of scan position " << item.ref.positionNr << lvr2::endl;
+    };
+
+    // Dispatch loaded scans to the worker threads
+    ctpl::thread_pool pool(numThreads);
+    std::vector<std::future<void>> results;
+    while(true)
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        stateChanged.wait(lock, [&]() { return !ready.empty() || loadingDone; });
+        if(ready.empty())
+        {
+            break;
         }
+
+        const bool large = ready.front().numPoints >= options.largeScanPoints;
+        stateChanged.wait(lock, [&]()
+        {
+            return large ? running == 0 : (!exclusive && running < numThreads);
+        });
+
+        LoadedScan item = ready.front();
+        ready.pop_front();
+        running++;
+        exclusive = large;
+        stateChanged.notify_all();
+        lock.unlock();
+
+        results.push_back(pool.push([&process, item, large](int)
+        {
+            process(item, large);
+        }));
+    }
+
+    pool.stop(true);
+    loader.join();
+    OpenMPConfig::setNumThreads(ompThreads);
+
+    if(loaderError)
+    {
+        std::rethrow_exception(loaderError);
+    }
+    for(auto& result : results)
+    {
+        result.get();
     }
 }
 
@@ -8,6 +8,9 @@
 #include "Main.hpp"
 #include "Options.hpp"
 
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
 using boost::optional;
 using std::unique_ptr;
 using std::make_unique;
@@ -257,26 +260,6 @@ int main(int argc, char* argv[])
     }
     std::cout << options << std::endl; 
 
-    // =======================================================================
-    // Load Pointcloud and create Model + Surface + SearchTree
-    // =======================================================================
-    lvr2::HalfEdgeMesh<VecD> mesh;
-    auto surface = loadPointCloud<Vec>(options.getInputFileName());   
-    if(surface == nullptr)
-    {
-        std::cout << timestamp.getElapsedTime() << "IO Error: Unable to interpret " << options.getInputFileName() << std::endl;
-        return 0;
-    } 
-    PointBufferPtr baseBuffer = surface->pointBuffer();
-    auto tree = SearchTreeFlann<VecD> (baseBuffer);
-
-    // Get the pointcloud coordinates from the FloatChannel
-    FloatChannel arr =  *(baseBuffer->getFloatChannel("points"));   
-    PointsetSurfacePtr<Vec> usedSurface = surface;
-    FloatChannel usedArr = arr;       
-    float resolution = options.getResolution();
-    float texelSize = resolution/2; 
-
     // Read what mode to use for DTM Creation
     int mode = -1;
     if(options.getExtractionMethod() == "NN")
@@ -398,6 +381,115 @@ int main(int argc, char* argv[])
         }        
     } 
 
+    // =======================================================================
+    // Rasterise the DTM into a tiled GeoTIFF
+    // =======================================================================
+    if(!options.getOutputGeoTIFF().empty())
+    {
+        if(mode == 2)
+        {
+            std::cout << timestamp.getElapsedTime() << "The Threshold Method cannot be used with --outputGeoTIFF" << std::endl;
+            return 0;
+        }
+        if(options.getTileSize() <= 0 || options.getTileSize() % 16 != 0)
+        {
+            std::cout << timestamp.getElapsedTime() << "The tile size has to be a positive multiple of 16" << std::endl;
+            return 0;
+        }
+
+        string inputFile = options.getInputFileName();
+        string extension = boost::algorithm::to_lower_copy(boost::filesystem::path(inputFile).extension().string());
+        BoundingBox<Vec> bb;
+        size_t numPoints = 0;
+        size_t bandPoints = options.getBandPoints();
+        PointStream streamPoints;
+        if(extension == ".las" || extension == ".laz")
+        {
+            // The file is read once in chunks of the band size
+            LasIO las;
+            if(!las.readHeader(inputFile, bb, numPoints))
+            {
+                std::cout << timestamp.getElapsedTime() << "IO Error: Unable to parse " << inputFile << std::endl;
+                return 0;
+            }
+            size_t chunkSize = bandPoints > 0 ? bandPoints : numPoints;
+            streamPoints = [inputFile, chunkSize](const std::function<void(PointBufferPtr)>& process)
+            {
+                LasIO io;
+                return io.readChunks(inputFile, chunkSize, process);
+            };
+        }
+        else
+        {
+            // Other formats can only be loaded as a whole, so the raster is processed in a single band
+            ModelPtr model = ModelFactory::readModel(inputFile);
+            if(!model || !model->m_pointCloud)
+            {
+                std::cout << timestamp.getElapsedTime() << "IO Error: Unable to parse " << inputFile << std::endl;
+                return 0;
+            }
+            PointBufferPtr cloud = model->m_pointCloud;
+            numPoints = cloud->numPoints();
+            if(numPoints > 0)
+            {
+                FloatChannel points = *(cloud->getFloatChannel("points"));
+                for (size_t i = 0; i < numPoints; i++)
+                {
+                    bb.expand(Vec(points[i][0], points[i][1], points[i][2]));
+                }
+            }
+            streamPoints = [cloud](const std::function<void(PointBufferPtr)>& process)
+            {
+                process(cloud);
+                return true;
+            };
+            bandPoints = 0;
+        }
+
+        string srs;
+        if(!options.getInputReferencePairs().empty())
+        {
+            srs = options.getTargetSystem().empty() ? currenSystem : options.getTargetSystem();
+        }
+
+        std::cout << timestamp.getElapsedTime() << "Start" << std::endl;
+        bool written = rasterizeDTM<VecD,double>(bb,numPoints,streamPoints,bandPoints,options.getOutputGeoTIFF(),mode,
+            options.getResolution(),options.getTileSize(),options.getCompression(),options.getNumberNeighbors(),options.getMinRadius(),options.getMaxRadius(),
+            options.getRadiusSteps(),fullAffineMatrix,srs);
+        std::cout << timestamp.getElapsedTime() << "End" << std::endl;
+
+        if(!written)
+        {
+            std::cout << timestamp.getElapsedTime() << "IO Error: Unable to write " << options.getOutputGeoTIFF() << std::endl;
+        }
+        if(!options.getInputReferencePairs().empty())
+        {
+            delete(srcPoints);
+            delete(dstPoints);
+        }
+        return 0;
+    }
+
+    // =======================================================================
+    // Load Pointcloud and create Model + Surface + SearchTree
+    // =======================================================================
+    lvr2::HalfEdgeMesh<VecD> mesh;
+    auto surface = loadPointCloud<Vec>(options.getInputFileName());   
+    if(surface == nullptr)
+    {
+        std::cout << timestamp.getElapsedTime() << "IO Error: Unable to interpret " << options.getInputFileName() << std::endl;
+        return 0;
+    } 
+    PointBufferPtr baseBuffer = surface->pointBuffer();
+    auto tree = SearchTreeFlann<VecD> (baseBuffer);
+
+    // Get the pointcloud coordinates from the FloatChannel
+    FloatChannel arr =  *(baseBuffer->getFloatChannel("points"));   
+    PointsetSurfacePtr<Vec> usedSurface = surface;
+    FloatChannel usedArr = arr;       
+    float resolution = options.getResolution();
+    float texelSize = resolution/2; 
+
     // =======================================================================
     // Extract ground from the point cloud
     // =======================================================================
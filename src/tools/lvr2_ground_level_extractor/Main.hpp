@@ -7,12 +7,15 @@
 
 #include <iostream>
 #include <memory>
+#include <functional>
 #include <tuple>
 #include <map>
 #include <chrono>
 #include <ctime>  
+#include <cstdio>
 
 #include <boost/optional.hpp>
+#include <boost/filesystem.hpp>
 
 #include <gdal.h>
 #include <gdalwarper.h>
@@ -32,6 +35,7 @@
 #include "lvr2/types/MeshBuffer.hpp"
 #include "lvr2/io/ModelFactory.hpp"
 #include "lvr2/io/modelio/GeoTIFFIO.hpp"
+#include "lvr2/io/modelio/LasIO.hpp"
 #include "lvr2/util/ColorGradient.hpp"
 
 
@@ -313,6 +317,142 @@ Data findLowestZ(Data x, Data y, Data lowestZ, Data highestZ, Data searchArea, S
     
 }
 
+/**
+ * @brief Calculates the height of a node as the arithmetic mean of its nearest neighbours. The search starts at the lowest point
+ * found near the node (see @findLowestZ).
+ * 
+ * @tparam BaseVecT Sets which BaseVector template is used.
+ * @tparam Data Sets which data type (float,double) is used.
+ * @param x x coordinate of the node.
+ * @param y y coordinate of the node.
+ * @param lowestZ Lowest recorded z coordinate value of the point clouds bounding box.
+ * @param highestZ Highest recorded z coordinate value of the point clouds bounding box.
+ * @param resolution Distance between the nodes. Neighbours further away than this exclude the node.
+ * @param numNeighbors Number of neighbours used for Nearest Neighbor Search.
+ * @param tree Search Tree that utilises the FLANN to enable Radius and Nearest Neighbor Search on the point clouds data.
+ * @param points Is used in conjunction with @tree to extract information about the points found.
+ * @param z Contains the height of the node if it is valid.
+ * @return bool Returns false, if the node has to be excluded from the model.
+ */
+template <typename BaseVecT, typename Data>
+bool nearestNeighborHeight(Data x, Data y, Data lowestZ, Data highestZ, Data resolution, int numNeighbors,
+SearchTreeFlann<BaseVecT>& tree, FloatChannel& points, Data& z)
+{
+    vector<size_t> indices;
+    vector<Data> distances;
+
+    // Check if there are ground points near the node
+    Data closeZ = findLowestZ<BaseVecT,Data>(x,y,lowestZ,highestZ,resolution/2,tree,points);
+    if(closeZ == std::numeric_limits<Data>::max())
+    {
+        return false;
+    }
+
+    // Use Nearest Neighbor Search to find the necessary amount of neighbors
+    if(tree.kSearch(BaseVecT(x,y,closeZ),numNeighbors,indices,distances) < numNeighbors)
+    {
+        return false;
+    }
+
+    // If there are not enough points surrounding our node, it is left blank
+    // Else, the nodes height value is set to its neighbors aithmetic mean
+    Data finalZ = 0;
+    for (int i = 0; i < numNeighbors; i++)
+    {
+        if(distances[i] > resolution)
+        {
+            return false;
+        }
+        auto nearest = points[indices[i]];
+        finalZ = finalZ + nearest[2];
+    }
+
+    z = finalZ/numNeighbors;
+    return true;
+}
+
+/**
+ * @brief Calculates the height of a node with the Improved Moving Average algorithm (see @improvedMovingAverage).
+ * 
+ * @tparam BaseVecT Sets which BaseVector template is used.
+ * @tparam Data Sets which data type (float,double) is used.
+ * @param x x coordinate of the node.
+ * @param y y coordinate of the node.
+ * @param lowestZ Lowest recorded z coordinate value of the point clouds bounding box.
+ * @param highestZ Highest recorded z coordinate value of the point clouds bounding box.
+ * @param resolution Distance between the nodes.
+ * @param minRadius Starting Radius.
+ * @param maxRadius Maximum Radius.
+ * @param minNeighbors The minimum amount of neighbours. If fewer neighbours are found, the node is excluded from the model.
+ * @param maxNeighbors The maximum amount of neighbours to look for.
+ * @param radiusSteps The number of steps necessary to extend from the @minRadius to the @maxRadius.
+ * @param tree Search Tree that utilises the FLANN to enable Radius and Nearest Neighbor Search on the point clouds data.
+ * @param points Is used in conjunction with @tree to extract information about the points found.
+ * @param z Contains the height of the node if it is valid.
+ * @return bool Returns false, if the node has to be excluded from the model.
+ */
+template <typename BaseVecT, typename Data>
+bool movingAverageHeight(Data x, Data y, Data lowestZ, Data highestZ, Data resolution, float minRadius, float maxRadius,
+int minNeighbors, int maxNeighbors, int radiusSteps, SearchTreeFlann<BaseVecT>& tree, FloatChannel& points, Data& z)
+{
+    vector<size_t> indices;
+    vector<Data> distances;
+    size_t numberNeighbors = 0;
+
+    // Calculate the radius step size
+    float radiusStepsize = (maxRadius - minRadius)/radiusSteps;
+    float radius = minRadius;
+
+    // Use lowestZ to find the start of the ground area --> if there is no ground area, the node is skipped
+    Data u_z = findLowestZ<BaseVecT,Data>(x,y,lowestZ,highestZ,resolution/2,tree,points);
+    if(u_z == std::numeric_limits<Data>::max())
+    {
+        return false;
+    }
+    BaseVecT point(x,y,u_z);
+
+    // If we don't find enough points in the current radius, we extend the radius
+    // If we hit the maximum extension and still find nothing, the node is left blank
+    while (true)
+    {
+        numberNeighbors = tree.radiusSearch(point,maxNeighbors,radius,indices,distances);
+        if(numberNeighbors >= minNeighbors)
+        {
+            break;
+        }
+        else if(radius <= maxRadius)
+        {
+            radius += radiusStepsize;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    // The nodes height value is calculated by weighting the surrounding points depending on their distance to the node
+    Data finalZ = 0;
+    Data addedDistance = 0;
+    for (int i = 0; i < numberNeighbors; i++)
+    {
+        size_t pointIdx = indices[i];
+        auto neighbor = points[pointIdx];
+        // When we are exactly on the point, distance is 0 and would divide by 0
+        Data distance = 1;
+        if(distances[i] != 0)
+        {
+            // Calculates inverted distance
+            distance = 1/distance;
+        }
+
+        finalZ += neighbor[2] * distance;
+        addedDistance += distance;
+    }
+
+    z = finalZ/addedDistance;
+    return true;
+}
+
 /**
  * @brief Builds a DTM utilising Nearest Neighbor Search and LowestZ on a point cloud. 
  * If points found by Nearest Neighbor Search lie outside a predefined area, the affected node is excluded from the model.
@@ -347,12 +487,6 @@ SearchTreeFlann<BaseVecT>& tree ,int numNeighbors, Data resolution, Eigen::Matri
     ssize_t xDim = abs(xMax) + abs(xMin);
     ssize_t yDim = abs(yMax) + abs(yMin);
 
-    vector<size_t> indices;
-    vector<Data> distances;
-    Data finalZ = 0;         
-    int trustedNeighbors = 0;
-    int numberNeighbors = numNeighbors;
-
     xMin = xMin * (1/resolution);
     xMax = xMax * (1/resolution);
     yMin = yMin * (1/resolution);
@@ -370,47 +504,12 @@ SearchTreeFlann<BaseVecT>& tree ,int numNeighbors, Data resolution, Eigen::Matri
         {               
             Data u_x = x * resolution;
             Data u_y = y * resolution;
-            indices.clear();
-            distances.clear();
-            finalZ = 0;  
-
-            // Check if there are ground points near the node
-            Data closeZ = findLowestZ<BaseVecT,Data>(u_x,u_y,zMin,zMax,resolution/2,tree,points);
-            if(closeZ == std::numeric_limits<Data>::max())
-            {
-                ++progressVert;
-                continue;
-            }         
-
-            // Use Nearest Neighbor Search to find the necessary amount of neighbors     
-            tree.kSearch(BaseVecT(u_x,u_y,closeZ),numberNeighbors,indices,distances);
-            
-            trustedNeighbors = numberNeighbors;
-            for (int i = 0; i < numberNeighbors; i++)
-            {
-                if(distances[i] > resolution)
-                {
-                    trustedNeighbors--;
-                    break;
-                }
-                else
-                {
-                    auto index = indices[i];
-                    auto nearest = points[index];
-                    finalZ = finalZ + nearest[2];
-                }
-            }
+            Data finalZ = 0;
 
-            // If there are not enough points surrounding our node, it is left blank
-            // Else, the nodes height value is set to its neighbors aithmetic mean
-            if(trustedNeighbors < numberNeighbors)
+            if(!nearestNeighborHeight<BaseVecT,Data>(u_x,u_y,zMin,zMax,resolution,numNeighbors,tree,points,finalZ))
             {
                 ++progressVert;
                 continue;
-            }  
-            else
-            {
-                finalZ = finalZ/trustedNeighbors;
             }
 
             //Valid Nodes are saved 
@@ -517,24 +616,11 @@ SearchTreeFlann<BaseVecT>& tree, float minRadius, float maxRadius, int minNeighb
     ssize_t xDim = abs(xMax) + abs(xMin);
     ssize_t yDim = abs(yMax) + abs(yMin);
 
-    size_t numberNeighbors = 0;
-
-    int found = 0;
-
     xMin = xMin * (1/resolution);
     xMax = xMax * (1/resolution);
     yMin = yMin * (1/resolution);
     yMax = yMax * (1/resolution);
 
-    Data finalZ = 0;  
-    Data addedDistance = 0;
-    vector<size_t> indices;  
-    vector<Data> distances;  
-
-    // Calculate the radius step size
-    float radiusStepsize = (maxRadius - minRadius)/radiusSteps;
-    float radius = 0;
-
     std::map<std::tuple<ssize_t, ssize_t>,VertexHandle> dict;
 
     ProgressBar progressVert((xDim/resolution)*(yDim/resolution), timestamp.getElapsedTime() + "Calculating height values"); 
@@ -548,67 +634,10 @@ SearchTreeFlann<BaseVecT>& tree, float minRadius, float maxRadius, int minNeighb
         {           
             Data u_x = x * resolution;
             Data u_y = y * resolution;
+            Data finalZ = 0;
 
-            BaseVecT point;
-            found = 0;
-            finalZ = 0;  
-            addedDistance = 0;
-            indices.clear();
-            distances.clear(); 
-
-            radius = minRadius;
-            // Use lowestZ to find the start of the ground area --> if there is no ground area, the node is skipped
-            Data u_z = findLowestZ<BaseVecT,Data>(u_x,u_y,zMin,zMax,resolution/2,tree,points);
-            if(u_z == std::numeric_limits<Data>::max())
-            {
-                ++progressVert; 
-                continue;
-            }
-            point = BaseVecT(u_x,u_y,u_z);
-            // If we don't find enough points in the current radius, we extend the radius
-            // If we hit the maximum extension and still find nothing, the node is left blank
-            while (found == 0)
-            {
-                numberNeighbors = tree.radiusSearch(point,maxNeighbors,radius,indices,distances);
-                if(numberNeighbors >= minNeighbors)
-                {
-                    found = 1;
-                    break;
-                }
-                else if(radius <= maxRadius)
-                {   
-                    radius += radiusStepsize;
-                    continue;
-                }
-                else
-                {
-                    found = -1;
-                    break;
-                }                 
-            }
-            // The nodes height value is calculated by weighting the surrounding points depending on their distance to the node
-            if(found == 1)
-            {
-                for (int i = 0; i < numberNeighbors; i++)
-                {
-                    size_t pointIdx = indices[i];
-                    auto neighbor = points[pointIdx];
-                    // When we are exactly on the point, distance is 0 and would divide by 0
-                    Data distance = 1;
-                    if(distances[i] != 0)
-                    {
-                        // Calculates inverted distance
-                        distance = 1/distance;; 
-                    }                        
-                    
-                    finalZ += neighbor[2] * distance;
-                    addedDistance += distance;                
-                }  
-                
-                finalZ = finalZ/addedDistance;                                 
-                
-            }
-            else
+            if(!movingAverageHeight<BaseVecT,Data>(u_x,u_y,zMin,zMax,resolution,minRadius,maxRadius,minNeighbors,maxNeighbors,
+                radiusSteps,tree,points,finalZ))
             {
                 ++progressVert; 
                 continue;
@@ -987,6 +1016,380 @@ void thresholdMethod(lvr2::HalfEdgeMesh<VecD>& mesh,FloatChannel& points, Points
     std::cout << std::endl;
 }
 
+/**
+ * @brief Passes all points of a point cloud to the given function, in one or several buffers in a single pass.
+ * Returns false if the points could not be read.
+ */
+using PointStream = std::function<bool(const std::function<void(PointBufferPtr)>&)>;
+
+/**
+ * @brief Rasterises a DTM from a point cloud tile by tile and streams it into a tiled, compressed GeoTIFF with overviews.
+ * The nodes are placed at multiples of @resolution and become the pixel centres of the raster. The raster is processed in
+ * bands of tile rows. The points are read once via @streamPoints. If there are several bands, the coordinates of each point
+ * are appended to a temporary file next to @filename for every band whose rows (including a margin that covers the search
+ * radius) contain it. Each band then loads its file and sorts the points into its tiles, and the tiles are processed in
+ * parallel, each with its own search tree.
+ * The number of rows of a band is chosen so that it holds about @bandPoints points, assuming they are evenly distributed.
+ * Memory used for points, interpolation and output is therefore bounded by the band size instead of the size of the
+ * whole point cloud and raster. Tiles without points are not written and read back as no data.
+ * The heights are calculated with Nearest Neighbor (@nearestNeighborHeight) or Improved Moving Average (@movingAverageHeight).
+ * 
+ * @tparam BaseVecT Sets which BaseVector template is used.
+ * @tparam Data Sets which data type (float,double) is used.
+ * @param bb Bounding box of the whole point cloud.
+ * @param numPoints Number of points of the whole point cloud.
+ * @param streamPoints Reads all points of the point cloud.
+ * @param bandPoints Approximate number of points per band. 0 processes the raster in a single band.
+ * @param filename Name of the created GeoTIFF.
+ * @param mode 0 for Improved Moving Average, 1 for Nearest Neighbor.
+ * @param resolution Parameter that sets the distance between the nodes and thus the pixel size.
+ * @param tileSize Width and height of a tile in pixels. Has to be a multiple of 16.
+ * @param compression GDAL compression method of the GeoTIFF.
+ * @param numNeighbors Number of neighbours used for NN. Minimum amount of neighbours for IMA.
+ * @param minRadius Starting Radius of IMA.
+ * @param maxRadius Maximum Radius of IMA.
+ * @param radiusSteps The number of steps necessary to extend from the @minRadius to the @maxRadius in IMA.
+ * @param affineMatrix If a matrix is provided, it is used to georeference the raster. The x and y coordinates are
+ *  transformed via the GeoTIFF's geo transform, the heights are transformed per pixel.
+ * @param srs Coordinate system of the georeferenced raster. May be empty.
+ * @return bool Returns true, if the GeoTIFF was written successfully.
+ */
+template <typename BaseVecT, typename Data>
+bool rasterizeDTM(const BoundingBox<Vec>& bb, size_t numPoints, PointStream streamPoints, size_t bandPoints, const std::string& filename,
+int mode, Data resolution, int tileSize, const std::string& compression, int numNeighbors, float minRadius, float maxRadius, 
+int radiusSteps, Eigen::MatrixXd& affineMatrix, const std::string& srs)
+{
+    // =======================================================================
+    // Generating Raster Dimensions from the Boundingbox
+    // =======================================================================
+    if(numPoints == 0 || !bb.isValid())
+    {
+        return false;
+    }
+
+    Data zMin = std::round(bb.getMin().z);
+    Data zMax = std::round(bb.getMax().z);
+
+    // Nodes are placed at multiples of the resolution, row 0 is the northernmost row
+    ssize_t xMin = (ssize_t)std::floor(bb.getMin().x / resolution);
+    ssize_t yMax = (ssize_t)std::ceil(bb.getMax().y / resolution);
+    ssize_t cols = (ssize_t)std::ceil(bb.getMax().x / resolution) - xMin + 1;
+    ssize_t rows = yMax - (ssize_t)std::floor(bb.getMin().y / resolution) + 1;
+    ssize_t tilesX = (cols + tileSize - 1) / tileSize;
+    ssize_t tilesY = (rows + tileSize - 1) / tileSize;
+    ssize_t numTiles = tilesX * tilesY;
+
+    // The search tree works on squared distances, so this is how far away the searches of a node reach
+    Data searchRadius = mode == 0 ? std::max<Data>(resolution, maxRadius + (maxRadius - minRadius)/radiusSteps) : resolution;
+    Data margin = std::max<Data>(resolution / 2, std::sqrt(searchRadius)) / resolution;
+
+    // Number of tile rows per band, assuming evenly distributed points
+    ssize_t bandTiles = tilesY;
+    if(bandPoints > 0)
+    {
+        Data pointsPerTileRow = (Data)numPoints / tilesY;
+        bandTiles = std::min<ssize_t>(tilesY, std::max<ssize_t>(1, bandPoints / std::max<Data>(1, pointsPerTileRow)));
+    }
+    ssize_t numBands = (tilesY + bandTiles - 1) / bandTiles;
+
+    std::cout << timestamp.getElapsedTime() << "Raster: " << cols << " x " << rows << " pixels in " 
+        << tilesX << " x " << tilesY << " tiles and " << numBands << " bands" << std::endl;
+
+    // =======================================================================
+    // Create the GeoTIFF
+    // =======================================================================
+    GeoTIFFIO io(filename, cols, rows, 1, GDT_Float32, tileSize, compression);
+    if(io.getRasterWidth() == 0)
+    {
+        std::cout << timestamp.getElapsedTime() << "IO Error: Unable to create " << filename << std::endl;
+        return false;
+    }
+
+    // Maps the pixel corners to model and then to georeferenced coordinates
+    Eigen::Matrix4d transform = Eigen::Matrix4d::Identity();
+    if(affineMatrix.size() != 0)
+    {
+        transform = affineMatrix;
+    }
+    double originX = (xMin - 0.5) * resolution;
+    double originY = (yMax + 0.5) * resolution;
+    double geoTransform[6] = {
+        transform(0,0) * originX + transform(0,1) * originY + transform(0,3), transform(0,0) * resolution, -transform(0,1) * resolution,
+        transform(1,0) * originX + transform(1,1) * originY + transform(1,3), transform(1,0) * resolution, -transform(1,1) * resolution
+    };
+    io.setGeoTransform(geoTransform);
+    if(!srs.empty())
+    {
+        io.setSpatialReference(srs);
+    }
+    const float noData = std::numeric_limits<float>::lowest();
+    io.setNoDataValue(1, noData);
+
+    // =======================================================================
+    // Distribute the Points to the Bands
+    // =======================================================================
+    // Rows whose nodes may search the points of a band. One pixel larger to be safe from rounding.
+    ssize_t rowsPerBand = bandTiles * tileSize;
+    auto bandRowMin = [&](ssize_t band) { return (Data)(band * rowsPerBand) - margin - 1; };
+    auto bandRowMax = [&](ssize_t band) { return (Data)(std::min<ssize_t>(rows, (band + 1) * rowsPerBand) - 1) + margin + 1; };
+
+    // A single band keeps the points in memory, several bands spill them to one file each
+    vector<PointBufferPtr> chunks;
+    vector<std::string> spillFiles;
+    for (ssize_t band = 0; numBands > 1 && band < numBands; band++)
+    {
+        spillFiles.push_back(filename + ".band" + std::to_string(band) + ".tmp");
+        std::remove(spillFiles.back().c_str());
+    }
+    auto removeSpillFiles = [&]()
+    {
+        for (const std::string& spillFile : spillFiles)
+        {
+            std::remove(spillFile.c_str());
+        }
+    };
+
+    std::cout << timestamp.getElapsedTime() << "Reading " << numPoints << " points" << std::endl;
+    bool spillFailed = false;
+    bool streamed = streamPoints([&](PointBufferPtr chunk)
+    {
+        if(numBands == 1)
+        {
+            chunks.push_back(chunk);
+            return;
+        }
+
+        size_t n = chunk->numPoints();
+        floatArr pts = chunk->getPointArray();
+        vector<vector<float>> staged(numBands);
+        for (size_t i = 0; i < n; i++)
+        {
+            Data row = yMax - pts[3 * i + 1] / resolution;
+            ssize_t first = std::max<ssize_t>(0, std::floor((row - margin - 1) / rowsPerBand) - 1);
+            ssize_t last = std::min<ssize_t>(numBands - 1, std::floor((row + margin + 1) / rowsPerBand) + 1);
+            for (ssize_t band = first; band <= last; band++)
+            {
+                if(row >= bandRowMin(band) && row <= bandRowMax(band))
+                {
+                    staged[band].insert(staged[band].end(), &pts[3 * i], &pts[3 * i + 3]);
+                }
+            }
+        }
+
+        // Append to the files of the bands that received points
+        for (ssize_t band = 0; band < numBands; band++)
+        {
+            if(staged[band].empty())
+            {
+                continue;
+            }
+            std::FILE* file = std::fopen(spillFiles[band].c_str(), "ab");
+            if(!file || std::fwrite(staged[band].data(), sizeof(float), staged[band].size(), file) != staged[band].size())
+            {
+                spillFailed = true;
+            }
+            if(file)
+            {
+                std::fclose(file);
+            }
+        }
+    });
+    if(!streamed || spillFailed)
+    {
+        std::cout << timestamp.getElapsedTime() << "IO Error: Unable to distribute the points to the bands" << std::endl;
+        removeSpillFiles();
+        return false;
+    }
+
+    // =======================================================================
+    // Calculate the Heights Band by Band and Tile by Tile
+    // =======================================================================
+    bool failed = false;
+    ProgressBar progressTiles(numTiles, timestamp.getElapsedTime() + "Rasterising tiles");
+    for (ssize_t band = 0; band < numBands && !failed; band++)
+    {
+        ssize_t tyBegin = band * bandTiles;
+        ssize_t tyEnd = std::min(tilesY, tyBegin + bandTiles);
+
+        // Load the points that the nodes of the band may search
+        PointBufferPtr buffer;
+        if(numBands == 1 && chunks.size() == 1)
+        {
+            buffer = chunks[0];
+        }
+        else if(numBands == 1)
+        {
+            size_t n = 0;
+            for (const PointBufferPtr& chunk : chunks)
+            {
+                n += chunk->numPoints();
+            }
+            floatArr coords(new float[3 * n]);
+            size_t offset = 0;
+            for (const PointBufferPtr& chunk : chunks)
+            {
+                floatArr pts = chunk->getPointArray();
+                std::copy(pts.get(), pts.get() + 3 * chunk->numPoints(), coords.get() + 3 * offset);
+                offset += chunk->numPoints();
+            }
+            vector<PointBufferPtr>().swap(chunks);
+            buffer = PointBufferPtr(new PointBuffer(coords, n));
+        }
+        else
+        {
+            boost::system::error_code error;
+            size_t n = boost::filesystem::exists(spillFiles[band]) ? boost::filesystem::file_size(spillFiles[band], error) / (3 * sizeof(float)) : 0;
+            floatArr coords(new float[3 * n]);
+            if(n > 0)
+            {
+                std::FILE* file = std::fopen(spillFiles[band].c_str(), "rb");
+                if(error || !file || std::fread(coords.get(), 3 * sizeof(float), n, file) != n)
+                {
+                    failed = true;
+                }
+                if(file)
+                {
+                    std::fclose(file);
+                }
+            }
+            std::remove(spillFiles[band].c_str());
+            if(failed)
+            {
+                break;
+            }
+            buffer = PointBufferPtr(new PointBuffer(coords, n));
+        }
+        size_t bandSize = buffer->numPoints();
+        if(bandSize == 0)
+        {
+            for (ssize_t t = 0; t < (tyEnd - tyBegin) * tilesX; t++)
+            {
+                ++progressTiles;
+            }
+            continue;
+        }
+        FloatChannel points = *(buffer->getFloatChannel("points"));
+
+        // Calls f(tile) for every tile of the band whose nodes may search point i
+        auto forEachTile = [&](size_t i, auto f)
+        {
+            auto p = points[i];
+            Data col = p[0] / resolution - xMin;
+            Data row = yMax - p[1] / resolution;
+            ssize_t txMin = std::max<ssize_t>(0, std::ceil((col - margin - tileSize + 1) / tileSize));
+            ssize_t txMax = std::min<ssize_t>(tilesX - 1, std::floor((col + margin) / tileSize));
+            ssize_t tyMin = std::max<ssize_t>(tyBegin, std::ceil((row - margin - tileSize + 1) / tileSize));
+            ssize_t tyMax = std::min<ssize_t>(tyEnd - 1, std::floor((row + margin) / tileSize));
+            for (ssize_t ty = tyMin; ty <= tyMax; ty++)
+            {
+                for (ssize_t tx = txMin; tx <= txMax; tx++)
+                {
+                    f((ty - tyBegin) * tilesX + tx);
+                }
+            }
+        };
+
+        // Sort the points of the band into its tiles, including their margins
+        ssize_t bandTileCount = (tyEnd - tyBegin) * tilesX;
+        vector<size_t> tileOffsets(bandTileCount + 1, 0);
+        for (size_t i = 0; i < bandSize; i++)
+        {
+            forEachTile(i, [&](ssize_t tile) { tileOffsets[tile + 1]++; });
+        }
+        for (ssize_t t = 0; t < bandTileCount; t++)
+        {
+            tileOffsets[t + 1] += tileOffsets[t];
+        }
+        vector<size_t> tilePoints(tileOffsets[bandTileCount]);
+        vector<size_t> tileFill(tileOffsets.begin(), tileOffsets.end() - 1);
+        for (size_t i = 0; i < bandSize; i++)
+        {
+            forEachTile(i, [&](ssize_t tile) { tilePoints[tileFill[tile]++] = i; });
+        }
+        vector<size_t>().swap(tileFill);
+
+        #pragma omp parallel for schedule(dynamic)
+        for (ssize_t tile = 0; tile < bandTileCount; tile++)
+        {
+            size_t begin = tileOffsets[tile];
+            size_t end = tileOffsets[tile + 1];
+            if(begin == end)
+            {
+                ++progressTiles;
+                continue;
+            }
+
+            // Search tree of the points near the tile
+            size_t n = end - begin;
+            floatArr localPoints(new float[3 * n]);
+            for (size_t i = 0; i < n; i++)
+            {
+                auto p = points[tilePoints[begin + i]];
+                localPoints[3 * i] = p[0];
+                localPoints[3 * i + 1] = p[1];
+                localPoints[3 * i + 2] = p[2];
+            }
+            PointBufferPtr localBuffer(new PointBuffer(localPoints, n));
+            SearchTreeFlann<BaseVecT> tree(localBuffer);
+            FloatChannel local = *(localBuffer->getFloatChannel("points"));
+
+            ssize_t col0 = (tile % tilesX) * tileSize;
+            ssize_t row0 = (tyBegin + tile / tilesX) * tileSize;
+            ssize_t width = std::min<ssize_t>(tileSize, cols - col0);
+            ssize_t height = std::min<ssize_t>(tileSize, rows - row0);
+            vector<float> heights(width * height, noData);
+            bool valid = false;
+
+            for (ssize_t r = 0; r < height; r++)
+            {
+                for (ssize_t c = 0; c < width; c++)
+                {
+                    Data u_x = (xMin + col0 + c) * resolution;
+                    Data u_y = (yMax - row0 - r) * resolution;
+                    Data z = 0;
+                    bool found = mode == 0 ?
+                        movingAverageHeight<BaseVecT,Data>(u_x,u_y,zMin,zMax,resolution,minRadius,maxRadius,numNeighbors,numNeighbors+1,radiusSteps,tree,local,z) :
+                        nearestNeighborHeight<BaseVecT,Data>(u_x,u_y,zMin,zMax,resolution,numNeighbors,tree,local,z);
+                    if(found)
+                    {
+                        heights[r * width + c] = transform(2,0) * u_x + transform(2,1) * u_y + transform(2,2) * z + transform(2,3);
+                        valid = true;
+                    }
+                }
+            }
+
+            if(valid && io.writeBlock(heights.data(), 1, col0, row0, width, height) != 0)
+            {
+                failed = true;
+            }
+            ++progressTiles;
+        }
+    }
+    std::cout << std::endl;
+    removeSpillFiles();
+
+    if(failed)
+    {
+        return false;
+    }
+
+    // =======================================================================
+    // Build Overviews until the coarsest Level fits into one Tile
+    // =======================================================================
+    std::vector<int> factors;
+    for (int f = 2; std::max(cols, rows) / (f / 2) > tileSize; f *= 2)
+    {
+        factors.push_back(f);
+    }
+    if(!factors.empty())
+    {
+        std::cout << timestamp.getElapsedTime() << "Building " << factors.size() << " overviews" << std::endl;
+        io.buildOverviews(factors);
+    }
+
+    return true;
+}
+
 /**
  * @brief Generates a Texture that shows the distance between a mesh and the point clouds it is based on. 
  * Each of the texture's texels represent the distance between the mesh to the highest point of the point cloud inside the texel's area.
@@ -51,7 +51,11 @@ Options::Options(int argc, char** argv)
         ("swThreshold", value<float>(&m_swThreshold)->default_value(1),"Threshold for the small window in THM.")
         ("lwSize", value<int>(&m_lwSize)->default_value(3), "Size of the large window (x*x) in THM.")
         ("lwThreshold", value<float>(&m_lwThreshold)->default_value(3),"Threshold for the large window in THM.")
-        ("slopeThreshold", value<float>(&m_slopeThreshold)->default_value(30),"Threshold for the slope's angle in THM.");
+        ("slopeThreshold", value<float>(&m_slopeThreshold)->default_value(30),"Threshold for the slope's angle in THM.")
+        ("outputGeoTIFF", value< string >()->default_value(""), "Rasterise the DTM tile by tile into a tiled and compressed GeoTIFF with overviews instead of creating a mesh. Works with NN and IMA.")
+        ("tileSize", value<int>(&m_tileSize)->default_value(512), "Width and height in pixels of the tiles used for --outputGeoTIFF. Has to be a multiple of 16.")
+        ("compression", value<string>(&m_compression)->default_value("DEFLATE"), "Compression of the GeoTIFF created with --outputGeoTIFF: DEFLATE, LZW, ZSTD or NONE.")
+        ("bandPoints", value<size_t>(&m_bandPoints)->default_value(50000000), "Approximate number of points of a LAS/LAZ file loaded at once by --outputGeoTIFF. The file is read once and its points are distributed to bands of tile rows via temporary files.");
 
     setup();
 }
@@ -151,6 +155,26 @@ float Options::getSlopeThreshold() const
     return m_variables["slopeThreshold"].as<float>();
 }
 
+string Options::getOutputGeoTIFF() const
+{
+    return m_variables["outputGeoTIFF"].as<string>();
+}
+
+int Options::getTileSize() const
+{
+    return m_variables["tileSize"].as<int>();
+}
+
+string Options::getCompression() const
+{
+    return m_variables["compression"].as<string>();
+}
+
+size_t Options::getBandPoints() const
+{
+    return m_variables["bandPoints"].as<size_t>();
+}
+
 bool Options::printUsage() const {
         if (m_variables.count("help"))
         {
@@ -129,6 +129,26 @@ public:
      */
     float getSlopeThreshold() const;
 
+    /**
+     * @brief   Returns the name of the rasterised GeoTIFF
+     */
+    string getOutputGeoTIFF() const;
+
+    /**
+     * @brief   Returns the tile size of the rasterised GeoTIFF
+     */
+    int getTileSize() const;
+
+    /**
+     * @brief   Returns the compression of the rasterised GeoTIFF
+     */
+    string getCompression() const;
+
+    /**
+     * @brief   Returns the approximate number of points loaded at once for the rasterised GeoTIFF
+     */
+    size_t getBandPoints() const;
+
     /*
      * prints information about needed command-line-inputs e.g: input-file (ply)
      */
@@ -181,6 +201,15 @@ private:
 
     ///Threshold of the Slope's Angle in THM
     float                           m_slopeThreshold;
+
+    ///Tile Size of the rasterised GeoTIFF
+    int                             m_tileSize;
+
+    ///Compression of the rasterised GeoTIFF
+    string                          m_compression;
+
+    ///Approximate Number of Points loaded at once for the rasterised GeoTIFF
+    size_t                          m_bandPoints;
     
 };
 
@@ -189,7 +218,17 @@ private:
 inline std::ostream& operator<<(std::ostream& os, const Options &o)
 {
     std::cout << "##### Input File Name: " << o.getInputFileName() << std::endl;
-    std::cout << "##### Output File Name: " << o.getOutputFileName() + ".ply/.obj" << std::endl;
+    if(!o.getOutputGeoTIFF().empty())
+    {
+        std::cout << "##### Output GeoTIFF: " << o.getOutputGeoTIFF() << std::endl;
+        std::cout << "##### Tile Size: " << o.getTileSize() << std::endl;
+        std::cout << "##### Compression: " << o.getCompression() << std::endl;
+        std::cout << "##### Band Points: " << o.getBandPoints() << std::endl;
+    }
+    else
+    {
+        std::cout << "##### Output File Name: " << o.getOutputFileName() + ".ply/.obj" << std::endl;
+    }
     std::cout << "##### Extraction Method: " << o.getExtractionMethod() << std::endl;
     std::cout << "##### Resolution: " << o.getResolution() << std::endl;
     if(!o.getInputGeoTIFF().empty())
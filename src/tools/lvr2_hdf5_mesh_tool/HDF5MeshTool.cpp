@@ -35,6 +35,7 @@
 #include "lvr2/util/Timestamp.hpp"
 #include "lvr2/algorithm/NormalAlgorithms.hpp"
 #include "lvr2/algorithm/GeometryAlgorithms.hpp"
+#include "lvr2/algorithm/LocalNeighborhoodEngine.hpp"
 #include "lvr2/geometry/HalfEdgeMesh.hpp"
 #include "lvr2/algorithm/ReductionAlgorithms.hpp"
 
@@ -344,23 +345,45 @@ int main( int argc, char ** argv )
       std::cout << timestamp << "Vertex average angles already included." << std::endl;
     }
 
-    // roughness
+    // roughness and height differences
     DenseVertexMap<float> roughness;
+    DenseVertexMap<float> heightDifferences;
     boost::optional<DenseVertexMap<float>> roughnessOpt;
+    boost::optional<DenseVertexMap<float>> heightDifferencesOpt;
     if (readFromHdf5)
     {
       roughnessOpt = hdf5In.getDenseAttributeMap<DenseVertexMap<float>>("roughness");
+      heightDifferencesOpt = hdf5In.getDenseAttributeMap<DenseVertexMap<float>>("height_diff");
     }
     if (roughnessOpt)
     {
       std::cout << timestamp << "Using existing roughness..." << std::endl;
       roughness = *roughnessOpt;
     }
-    else
+    if (heightDifferencesOpt)
+    {
+      std::cout << timestamp << "Using existing height differences..." << std::endl;
+      heightDifferences = *heightDifferencesOpt;
+    }
+    if (!roughnessOpt || !heightDifferencesOpt)
     {
-      std::cout << timestamp << "Computing roughness with a local radius of "
-                << options.getLocalRadius() << "m ..." << std::endl;
-      roughness = calcVertexRoughness(hem, options.getLocalRadius(), vertexNormals);
+      // Both use the same local neighborhoods, compute them in one traversal
+      LocalNeighborhoodFeatures features;
+      features.averageAngles = &averageAngles;
+      if (!roughnessOpt)
+      {
+        std::cout << timestamp << "Computing roughness with a local radius of "
+                  << options.getLocalRadius() << "m ..." << std::endl;
+        features.roughness = &roughness;
+      }
+      if (!heightDifferencesOpt)
+      {
+        std::cout << timestamp << "Computing height diff with a local radius of "
+                  << options.getLocalRadius() << "m ..." << std::endl;
+        features.heightDifferences = &heightDifferences;
+      }
+      LocalNeighborhoodEngine<BaseVector<float>> neighborhoods(hem, options.getLocalRadius());
+      neighborhoods.compute(features);
     }
     if (!roughnessOpt || !writeToHdf5Input)
     {
@@ -382,23 +405,6 @@ int main( int argc, char ** argv )
     }
 
     // height differences
-    DenseVertexMap<float> heightDifferences;
-    boost::optional<DenseVertexMap<float>> heightDifferencesOpt;
-    if (readFromHdf5)
-    {
-      heightDifferencesOpt = hdf5In.getDenseAttributeMap<DenseVertexMap<float>>("height_diff");
-    }
-    if (heightDifferencesOpt)
-    {
-      std::cout << timestamp << "Using existing height differences..." << std::endl;
-      heightDifferences = *heightDifferencesOpt;
-    }
-    else
-    {
-      std::cout << timestamp << "Computing height diff with a local radius of "
-                << options.getLocalRadius() << "m ..." << std::endl;
-      heightDifferences = calcVertexHeightDifferences(hem, options.getLocalRadius());
-    }
     if (!heightDifferencesOpt || !writeToHdf5Input)
     {
       std::cout << timestamp << "Adding roughness..." << std::endl;
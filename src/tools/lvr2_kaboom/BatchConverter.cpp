@@ -0,0 +1,493 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * BatchConverter.cpp
+ *
+ * @date 18.10.2026
+ */
+
+#include "BatchConverter.hpp"
+
+#include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/io/kernels/HDF5Kernel.hpp"
+#include "lvr2/registration/OctreeReduction.hpp"
+#include "lvr2/util/Hdf5Util.hpp"
+#include "lvr2/util/IOUtils.hpp"
+#include "lvr2/util/Timestamp.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+
+namespace fs = boost::filesystem;
+
+using namespace lvr2;
+
+namespace kaboom
+{
+
+namespace
+{
+
+/// The HDF5 library is not thread-safe, so all HDF5 file accesses are serialized
+std::mutex hdf5Mutex;
+
+/// Name of the journal with the files converted so far
+const std::string journalName = "kaboom_batch.journal";
+
+bool isPointCloudFile(const fs::path& p)
+{
+    static const std::unordered_set<std::string> extensions = {
+        ".ply", ".las", ".laz", ".pts", ".3d", ".xyz", ".txt", ".h5"
+    };
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return extensions.count(ext) > 0;
+}
+
+template<typename T>
+void loadHDF5Channel(const HighFive::DataSet& dataset, const std::string& name, PointBufferPtr buffer)
+{
+    std::vector<size_t> dims = dataset.getDimensions();
+    size_t n = dims.size() > 0 ? dims[0] : 0;
+    size_t width = dims.size() > 1 ? dims[1] : 1;
+
+    Channel<T> channel(n, width);
+    hdf5util::readParallel(dataset, channel.dataPtr().get());
+    (*buffer)[name] = channel;
+}
+
+} // namespace
+
+PointBufferPtr loadPointCloud(const std::string& filename)
+{
+    if(fs::path(filename).extension() != ".h5")
+    {
+        ModelPtr model = ModelFactory::readModel(filename);
+        return model ? model->m_pointCloud : PointBufferPtr();
+    }
+
+    std::lock_guard<std::mutex> lock(hdf5Mutex);
+
+    auto file = hdf5util::open(filename, HighFive::File::ReadOnly);
+    if(!file->exist("pointcloud"))
+    {
+        return PointBufferPtr();
+    }
+
+    PointBufferPtr buffer(new PointBuffer);
+    HighFive::Group group = file->getGroup("pointcloud");
+    for(const std::string& name : group.listObjectNames())
+    {
+        if(group.getObjectType(name) != HighFive::ObjectType::Dataset)
+        {
+            continue;
+        }
+
+        HighFive::DataSet dataset = group.getDataSet(name);
+        HighFive::DataType type = dataset.getDataType();
+        if(type == HighFive::AtomicType<float>())
+        {
+            loadHDF5Channel<float>(dataset, name, buffer);
+        }
+        else if(type == HighFive::AtomicType<unsigned char>())
+        {
+            loadHDF5Channel<unsigned char>(dataset, name, buffer);
+        }
+        else if(type == HighFive::AtomicType<unsigned int>())
+        {
+            loadHDF5Channel<unsigned int>(dataset, name, buffer);
+        }
+    }
+
+    if(!buffer->hasChannel<float>("points"))
+    {
+        return PointBufferPtr();
+    }
+    return buffer;
+}
+
+void savePointCloud(PointBufferPtr buffer, const std::string& filename)
+{
+    if(fs::path(filename).extension() != ".h5")
+    {
+        ModelFactory::saveModel(ModelPtr(new Model(buffer)), filename);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(hdf5Mutex);
+
+    HDF5Kernel kernel(filename);
+    kernel.savePointBuffer("pointcloud", "", buffer);
+}
+
+PointBufferPtr processPointCloud(PointBufferPtr buffer, const Options& options)
+{
+    PointBufferPtr result = buffer;
+
+    // Reduce if requested using the specified technique
+    if(options.getTargetSize())
+    {
+        result = subSamplePointBuffer(buffer, options.getTargetSize());
+    }
+    else if(options.getVoxelSize())
+    {
+        RandomSampleOctreeReduction oct(buffer, options.getVoxelSize(), 5);
+        result = oct.getReducedPoints();
+    }
+
+    // Convert coordinates of result buffer is nessessary
+    if(options.convertToLVR())
+    {
+        slamToLVRInPlace(result);
+    }
+
+    return result;
+}
+
+BatchConverter::BatchConverter(const Options& options)
+    : m_options(options),
+      m_inputDir(options.getInputDir()),
+      m_outputDir(options.getOutputDir()),
+      m_journal(fs::path(options.getOutputDir()) / journalName)
+{
+
+}
+
+std::string BatchConverter::targetExtension(const fs::path& input) const
+{
+    std::string format = m_options.getOutputFormat();
+    std::transform(format.begin(), format.end(), format.begin(), ::toupper);
+
+    if(format == "PLY")
+    {
+        return ".ply";
+    }
+    else if(format == "LAS")
+    {
+        return ".las";
+    }
+    else if(format == "LAZ")
+    {
+        return ".laz";
+    }
+    else if(format == "ASCII" || format == "XYZ")
+    {
+        return ".xyz";
+    }
+    else if(format == "HDF5" || format == "H5")
+    {
+        return ".h5";
+    }
+    return input.extension().string();
+}
+
+std::vector<std::string> BatchConverter::readJournal() const
+{
+    std::vector<std::string> converted;
+    std::ifstream in(m_journal.string());
+    std::string line;
+    while(std::getline(in, line))
+    {
+        if(!line.empty())
+        {
+            converted.push_back(line);
+        }
+    }
+    return converted;
+}
+
+std::vector<BatchConverter::Job> BatchConverter::collectJobs() const
+{
+    std::vector<Job> jobs;
+
+    // Never pick up our own results if the output is located inside the input
+    fs::path outputDir = fs::weakly_canonical(m_outputDir);
+
+    // Without a target format every file would be converted onto itself
+    if(outputDir == fs::weakly_canonical(m_inputDir) && m_options.getOutputFormat().empty())
+    {
+        throw std::runtime_error("The output directory equals the input directory. "
+                                 "Specify --outputFormat or a different --outputDir.");
+    }
+
+    for(fs::recursive_directory_iterator it(m_inputDir), end; it != end; ++it)
+    {
+        if(fs::is_directory(it->status()))
+        {
+            if(fs::weakly_canonical(it->path()) == outputDir)
+            {
+                it.no_push();
+            }
+            continue;
+        }
+
+        if(!fs::is_regular_file(it->status()) || !isPointCloudFile(it->path()))
+        {
+            continue;
+        }
+
+        Job job;
+        job.input = it->path();
+        job.relative = fs::relative(it->path(), m_inputDir);
+        job.output = m_outputDir / job.relative;
+        job.output.replace_extension(targetExtension(job.input));
+        job.bytes = fs::file_size(it->path());
+        jobs.push_back(job);
+    }
+
+    // Skip files that are already in the target format in place and make sure
+    // that no job overwrites an input file or the output of another job
+    std::map<fs::path, const Job*> inputs;
+    for(const Job& job : jobs)
+    {
+        inputs[fs::weakly_canonical(job.input)] = &job;
+    }
+
+    std::map<fs::path, const Job*> outputs;
+    std::vector<Job> unique;
+    for(const Job& job : jobs)
+    {
+        fs::path output = fs::weakly_canonical(job.output);
+        auto input = inputs.find(output);
+        if(input != inputs.end())
+        {
+            if(input->second != &job)
+            {
+                throw std::runtime_error("Converting '" + job.input.string() +
+                                         "' would overwrite the input file '" + input->second->input.string() + "'.");
+            }
+            std::cout << timestamp << "Skipping '" << job.input.string()
+                      << "', it is already in the target format." << std::endl;
+            continue;
+        }
+
+        auto other = outputs.emplace(output, &job);
+        if(!other.second)
+        {
+            throw std::runtime_error("'" + other.first->second->input.string() + "' and '" + job.input.string() +
+                                     "' would both be converted to '" + job.output.string() + "'.");
+        }
+        unique.push_back(job);
+    }
+    jobs.swap(unique);
+
+    // Start with the largest files so that the small ones fill the gaps at the end
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b)
+    {
+        return a.bytes != b.bytes ? a.bytes > b.bytes : a.relative < b.relative;
+    });
+
+    return jobs;
+}
+
+size_t BatchConverter::run()
+{
+    // create_directories() fails on paths like "./" that already exist
+    if(!fs::is_directory(m_outputDir))
+    {
+        fs::create_directories(m_outputDir);
+    }
+
+    std::vector<Job> jobs = collectJobs();
+
+    // Skip all files converted by previous runs
+    size_t numSkipped = 0;
+    if(m_options.resume())
+    {
+        std::vector<std::string> journal = readJournal();
+        std::unordered_set<std::string> converted(journal.begin(), journal.end());
+        auto done = std::remove_if(jobs.begin(), jobs.end(), [&](const Job& job)
+        {
+            return converted.count(job.relative.generic_string()) > 0;
+        });
+        numSkipped = jobs.end() - done;
+        jobs.erase(done, jobs.end());
+    }
+    else
+    {
+        fs::remove(m_journal);
+    }
+
+    size_t numThreads = m_options.getNumThreads() > 0 ?
+        m_options.getNumThreads() : std::max(1u, std::thread::hardware_concurrency());
+    numThreads = std::max<size_t>(1, std::min(numThreads, jobs.size()));
+
+    // Split the cores between the workers for the parallel parts of the IO and reduction
+    int threadsPerWorker = std::max<int>(1, omp_get_num_procs() / (int)numThreads);
+
+    size_t memoryBudget = m_options.getMaxMemory() * 1024 * 1024;
+
+    std::cout << timestamp << "Converting " << jobs.size() << " files with "
+              << numThreads << " workers";
+    if(numSkipped)
+    {
+        std::cout << " (" << numSkipped << " already converted)";
+    }
+    std::cout << "." << std::endl;
+
+    std::atomic<size_t> nextJob(0);
+    std::atomic<size_t> numFailed(0);
+    std::atomic<size_t> numPoints(0);
+    std::atomic<size_t> numBytes(0);
+    size_t numFinished = 0;
+
+    // Bytes of the input files currently in flight
+    size_t bytesInFlight = 0;
+    std::mutex memoryMutex;
+    std::condition_variable memoryFreed;
+
+    // Protects the console, the journal and numFinished
+    std::mutex outputMutex;
+    std::ofstream journal(m_journal.string(), std::ios::app);
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    auto worker = [&]()
+    {
+        omp_set_num_threads(threadsPerWorker);
+
+        for(size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+        {
+            const Job& job = jobs[i];
+
+            // Wait until the file fits into the memory budget. A file that exceeds
+            // the whole budget is converted as soon as nothing else is in flight.
+            if(memoryBudget)
+            {
+                std::unique_lock<std::mutex> lock(memoryMutex);
+                memoryFreed.wait(lock, [&]()
+                {
+                    return bytesInFlight == 0 || bytesInFlight + job.bytes <= memoryBudget;
+                });
+                bytesInFlight += job.bytes;
+            }
+
+            size_t points = 0;
+            std::string error;
+            try
+            {
+                PointBufferPtr buffer = loadPointCloud(job.input.string());
+                if(buffer)
+                {
+                    points = buffer->numPoints();
+                    PointBufferPtr result = processPointCloud(buffer, m_options);
+                    buffer.reset();
+
+                    // Write to a temporary file first, so that an interrupted run
+                    // never leaves a truncated file behind under the final name
+                    if(!fs::is_directory(job.output.parent_path()))
+                    {
+                        fs::create_directories(job.output.parent_path());
+                    }
+                    fs::path tmp = job.output.parent_path() /
+                        (job.output.stem().string() + ".tmp" + job.output.extension().string());
+                    fs::remove(tmp);
+                    savePointCloud(result, tmp.string());
+
+                    if(fs::exists(tmp))
+                    {
+                        fs::rename(tmp, job.output);
+                    }
+                    else
+                    {
+                        error = "No output written";
+                    }
+                }
+                else
+                {
+                    error = "Could not load point cloud";
+                }
+            }
+            catch(const std::exception& e)
+            {
+                error = e.what();
+            }
+
+            if(memoryBudget)
+            {
+                std::lock_guard<std::mutex> lock(memoryMutex);
+                bytesInFlight -= job.bytes;
+                memoryFreed.notify_all();
+            }
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            numFinished++;
+            if(error.empty())
+            {
+                numPoints += points;
+                numBytes += job.bytes;
+                journal << job.relative.generic_string() << std::endl;
+                std::cout << timestamp << "[" << numFinished << "/" << jobs.size() << "] "
+                          << job.relative.generic_string() << ": " << points << " points" << std::endl;
+            }
+            else
+            {
+                numFailed++;
+                std::cout << timestamp << "[" << numFinished << "/" << jobs.size() << "] "
+                          << "Error converting '" << job.input.string() << "': " << error << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < numThreads; i++)
+    {
+        workers.emplace_back(worker);
+    }
+    for(auto& t : workers)
+    {
+        t.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    double rate = seconds > 0 ? numPoints / seconds : 0.0;
+    double throughput = seconds > 0 ? numBytes / (1024.0 * 1024.0) / seconds : 0.0;
+
+    std::cout << timestamp << "Converted " << jobs.size() - numFailed << " of " << jobs.size()
+              << " files (" << numPoints << " points) in " << std::fixed << std::setprecision(2)
+              << seconds << " s: " << rate << " points/s, " << throughput << " MB/s." << std::endl;
+    if(numFailed)
+    {
+        std::cout << timestamp << numFailed << " files failed. Run again with --resume to retry them." << std::endl;
+    }
+
+    return numFailed;
+}
+
+} // namespace kaboom
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * BatchConverter.hpp
+ *
+ * @date 18.10.2026
+ */
+
+#ifndef KABOOM_BATCHCONVERTER_HPP_
+#define KABOOM_BATCHCONVERTER_HPP_
+
+#include "Options.hpp"
+
+#include "lvr2/types/PointBuffer.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+
+namespace kaboom
+{
+
+/**
+ * @brief Reads a point cloud from the given file. In addition to the formats
+ *        supported by lvr2::ModelFactory, HDF5 files (.h5) written by
+ *        savePointCloud() are supported.
+ */
+lvr2::PointBufferPtr loadPointCloud(const std::string& filename);
+
+/**
+ * @brief Saves a point cloud to the given file. The format is deduced from the
+ *        extension. HDF5 files (.h5) store all channels of the buffer in the
+ *        group "pointcloud".
+ */
+void savePointCloud(lvr2::PointBufferPtr buffer, const std::string& filename);
+
+/**
+ * @brief Applies the reduction and coordinate conversion requested in the
+ *        options to the given point cloud.
+ */
+lvr2::PointBufferPtr processPointCloud(lvr2::PointBufferPtr buffer, const Options& options);
+
+/**
+ * @brief Converts all point clouds in a directory tree concurrently.
+ *
+ * All files below the input directory with a supported point cloud extension
+ * are converted into the output directory, keeping their relative paths. The
+ * files are distributed over a pool of worker threads. At most one file per
+ * worker is held in memory, and a worker waits before loading a file as long
+ * as the input files in flight exceed the configured memory budget.
+ *
+ * Each converted file is written under a temporary name and renamed when it is
+ * complete. Its relative path is then appended to a journal in the output
+ * directory. When resuming, all files listed in the journal are skipped, so an
+ * interrupted run continues where it stopped.
+ */
+class BatchConverter
+{
+public:
+    BatchConverter(const Options& options);
+
+    /**
+     * @brief Converts all files and reports the aggregate throughput
+     *
+     * @return The number of files which could not be converted
+     * @throws std::runtime_error if the outputs of the jobs collide with
+     *         each other or with the input files
+     */
+    size_t run();
+
+private:
+
+    struct Job
+    {
+        boost::filesystem::path input;
+        boost::filesystem::path output;
+        boost::filesystem::path relative;
+        size_t bytes;
+    };
+
+    /**
+     * @brief Collects all files which have to be converted. Files whose output
+     *        would be the file itself are skipped.
+     *
+     * @throws std::runtime_error if a job would overwrite an input file or the
+     *         output of another job
+     */
+    std::vector<Job> collectJobs() const;
+
+    /// Reads the relative paths of all files converted by previous runs
+    std::vector<std::string> readJournal() const;
+
+    /// Returns the extension of the converted file for the given input
+    std::string targetExtension(const boost::filesystem::path& input) const;
+
+    const Options&          m_options;
+
+    boost::filesystem::path m_inputDir;
+    boost::filesystem::path m_outputDir;
+    boost::filesystem::path m_journal;
+};
+
+} // namespace kaboom
+
+#endif // KABOOM_BATCHCONVERTER_HPP_
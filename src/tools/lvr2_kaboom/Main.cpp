@@ -34,6 +34,7 @@
 
 
 #include "Options.hpp"
+#include "BatchConverter.hpp"
 
 #include "lvr2/io/ModelFactory.hpp"
 #include "lvr2/io/ScanDirectoryParser.hpp"
@@ -45,12 +46,8 @@ using namespace lvr2;
 const kaboom::Options* options;
 
 int main(int argc, char** argv) {
-    kaboom::Options options(argc, argv);
-    ModelPtr model = ModelFactory::readModel("/home/kyrill/rab/exchange/botanischer_garten_2018/2018-06-04_bot_garden.RiSCAN/SCANS/ScanPos001/POINTCLOUDS/180604_155149.rdbx");
-    //ModelPtr model = ModelFactory::readModel("/mnt/exchange/praktikum_sose_2022/tree.ply");
-    ModelFactory::saveModel(model, "/home/kyrill/Uni/Robotik_Prog_Praktikum/Test/Botanischer_Garten.ply");
-    return 0;
     // Parse command line arguments
+    kaboom::Options options(argc, argv);
 
     if (options.getTargetSize() && options.getVoxelSize())
     {
@@ -60,34 +57,39 @@ int main(int argc, char** argv) {
         return 0;
     }
 
+    if(options.batch())
+    {
+        try
+        {
+            kaboom::BatchConverter converter(options);
+            return converter.run() ? 1 : 0;
+        }
+        catch(const std::exception& e)
+        {
+            std::cout << timestamp << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     if(options.getInputFile() != "")
     {
         std::cout << timestamp << "Reading '" << options.getInputFile() << "." << std::endl;
-        ModelPtr model = ModelFactory::readModel(options.getInputFile());
-        if(model)
+        PointBufferPtr buffer = kaboom::loadPointCloud(options.getInputFile());
+        if(buffer)
         {
-            PointBufferPtr result = model->m_pointCloud;
-            PointBufferPtr buffer = model->m_pointCloud;
-            
-            // Reduce if requested using the specified technique
             if(options.getTargetSize())
             {
                 std::cout << timestamp << "Random sampling " << options.getTargetSize() << " points." << std::endl;
-                result = subSamplePointBuffer(buffer, options.getTargetSize());
             }
             else if(options.getVoxelSize())
             {
                 std::cout << timestamp << "Octree reduction with voxel size " << options.getVoxelSize() << std::endl;
-                RandomSampleOctreeReduction oct(buffer, options.getVoxelSize(), 5);
-                result = oct.getReducedPoints();
             }
-
-            // Convert coordinates of result buffer is nessessary
             if(options.convertToLVR())
             {
                 std::cout << timestamp << "Converting from SLAM6D to LVR coordinates" << std::endl;
-                slamToLVRInPlace(result);
             }
+            PointBufferPtr result = kaboom::processPointCloud(buffer, options);
 
             string targetFileName;
             if(options.getOutputFile() == "")
@@ -100,7 +102,7 @@ int main(int argc, char** argv) {
             }
 
             std::cout << timestamp << "Saving '" << targetFileName << "'" << std::endl;
-            ModelFactory::saveModel(ModelPtr(new Model(result)), targetFileName);
+            kaboom::savePointCloud(result, targetFileName);
         }
         else
         {
@@ -67,6 +67,10 @@ Options::Options(int argc, char** argv) : lvr2::BaseOption(argc, argv), m_descr(
 		("scanExtension", value<std::string>()->default_value(".3d"), "File extension for parsed files containing point cloud data")
 		("poseExtension", value<std::string>()->default_value(".dat"), "File extension for parsed files containing pose estimates")
 		("convertToLVR", value<bool>()->default_value(false), "Convert a file in SLAM coordinates to LVR coordinates")
+		("batch", "Convert all point clouds below --inputDir concurrently into --outputDir, keeping the directory structure.")
+		("threads", value<int>()->default_value(0), "Number of files converted concurrently in batch mode. (0) means one per core.")
+		("resume", "Skip all files that were converted by a previous (interrupted) batch run.")
+		("maxMemory", value<size_t>()->default_value(0), "Maximum size of the input files in flight during batch conversion in MB. (0) means no limit.")
 	;
 
 	m_pdescr.add("inputFile", -1);
@@ -156,6 +160,26 @@ size_t  Options::getMinPointsPerVoxel() const
 	return m_variables["minPointsPerVoxel"].as<size_t>();
 }
 
+bool    Options::batch() const
+{
+	return m_variables.count("batch");
+}
+
+bool    Options::resume() const
+{
+	return m_variables.count("resume");
+}
+
+int     Options::getNumThreads() const
+{
+	return m_variables["threads"].as<int>();
+}
+
+size_t  Options::getMaxMemory() const
+{
+	return m_variables["maxMemory"].as<size_t>();
+}
+
 
 Options::~Options() {
 	// TODO Auto-generated destructor stub
@@ -86,6 +86,11 @@ public:
 
 	bool    convertToLVR() const;
 
+	bool    batch() const;
+	bool    resume() const;
+	int     getNumThreads() const;
+	size_t  getMaxMemory() const;
+
 	/**
 	 * @brief   Returns the position of the x coordinate in the data.
 	 */
@@ -138,6 +138,9 @@ Options::Options(int argc, char** argv) : BaseOption(argc, argv)
     ("fillHoles,f", value<uint>(&m_options.fillHoles)->default_value(m_options.fillHoles),
      "Maximum size for hole filling.")
 
+    ("triangulateHoles", bool_switch(&m_options.triangulateHoles),
+     "Fill the holes selected by --fillHoles by a minimal weight triangulation instead of collapsing their edges.")
+
     ("optimizePlanes,o", bool_switch(&m_options.optimizePlanes),
      "Shift all triangle vertices of a cluster onto their shared plane.")
 
@@ -183,6 +186,9 @@ Options::Options(int argc, char** argv) : BaseOption(argc, argv)
     ("useGPUDistances", bool_switch(&m_options.useGPUDistances),
      "Use GPU for signed distance computation. Implies --useGPU.")
 
+    ("useCPUSurface", bool_switch(&m_options.useCPUSurface),
+     "Run the GPU computations selected by --useGPU and --useGPUDistances on the CPU. Default if no GPU support is available.")
+
     ("flipPoint", value<std::vector<float>>()->multitoken()->default_value(m_options.flipPoint),
      "Flippoint, used for GPU normal calculation, multitoken option: use it like this: --flipPoint x y z")
 
@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) 2018, University Osnabrück
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the University Osnabrück nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL University Osnabrück BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Main.cpp
+ *
+ * Exports a level of detail octree of a scan project for streaming viewers.
+ *
+ * @date 18.10.2026
+ */
+
+#include <iostream>
+#include <string>
+
+#include "lvr2/geometry/BaseVector.hpp"
+#include "lvr2/reconstruction/BigGridLOD.hpp"
+#include "lvr2/io/ModelFactory.hpp"
+#include "lvr2/io/kernels/HDF5Kernel.hpp"
+#include "lvr2/io/kernels/DirectoryKernel.hpp"
+#include "lvr2/io/scanio/DirectoryIO.hpp"
+#include "lvr2/io/scanio/HDF5IO.hpp"
+#include "lvr2/io/schema/ScanProjectSchemaHDF5.hpp"
+#include "lvr2/io/schema/ScanProjectSchemaRaw.hpp"
+#include "lvr2/util/Logging.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+using namespace lvr2;
+using namespace lvr2::scanio;
+namespace fs = boost::filesystem;
+
+using Vec = BaseVector<float>;
+
+/// Wraps a single point cloud into a scan project
+ScanPositionPtr scanPositionFromFile(const fs::path& file)
+{
+    ScanPtr scan(new Scan);
+    scan->points_loader = [file]() { return ModelFactory::readModel(file.string())->m_pointCloud; };
+
+    LIDARPtr lidar(new LIDAR);
+    lidar->scans.push_back(scan);
+
+    ScanPositionPtr position(new ScanPosition);
+    position->lidars.push_back(lidar);
+    return position;
+}
+
+ScanProjectEditMarkPtr loadProject(const fs::path& input)
+{
+    ScanProjectEditMarkPtr project(new ScanProjectEditMark);
+
+    if (input.extension() == ".h5")
+    {
+        lvr2::logout::get() << lvr2::info << "Reading project from HDF5 file " << input << lvr2::endl;
+        HDF5KernelPtr kernel(new HDF5Kernel(input.string()));
+        HDF5SchemaPtr schema(new ScanProjectSchemaHDF5());
+        HDF5IOPtr io(new HDF5IO(kernel, schema));
+        project->kernel = kernel;
+        project->schema = schema;
+        project->project = io->ScanProjectIO::load();
+    }
+    else if (fs::is_directory(input))
+    {
+        DirectoryKernelPtr kernel(new DirectoryKernel(input.string()));
+        DirectorySchemaPtr schema(new ScanProjectSchemaRaw(input.string()));
+        DirectoryIOPtr io(new DirectoryIO(kernel, schema));
+        project->kernel = kernel;
+        project->schema = schema;
+        project->project = io->ScanProjectIO::load();
+
+        // A directory of .ply files
+        if (!project->project)
+        {
+            project->project.reset(new ScanProject);
+            for (auto& entry : fs::directory_iterator(input))
+            {
+                if (entry.path().extension() == ".ply")
+                {
+                    lvr2::logout::get() << lvr2::info << "Using file " << entry.path() << lvr2::endl;
+                    project->project->positions.push_back(scanPositionFromFile(entry.path()));
+                }
+            }
+        }
+    }
+    else
+    {
+        lvr2::logout::get() << lvr2::info << "Reading single file " << input << lvr2::endl;
+        project->project.reset(new ScanProject);
+        project->project->positions.push_back(scanPositionFromFile(input));
+    }
+
+    if (project->project)
+    {
+        project->changed.resize(project->project->positions.size(), true);
+    }
+    return project;
+}
+
+int main(int argc, char** argv)
+{
+    fs::path inputFile;
+    fs::path outputDir = "pointcloud.lod";
+    fs::path tempDir = "./";
+    float voxelSize = 10.0f;
+    float scale = 1.0f;
+    BigGridLOD<Vec>::Options lodOptions;
+
+    try
+    {
+        using namespace boost::program_options;
+        namespace po = boost::program_options;
+
+        bool help = false;
+
+        options_description options("General Options");
+        options.add_options()
+        ("inputFile", value<fs::path>(&inputFile),
+         "The input: a scan project (HDF5 file or directory), a directory of .ply files or a single point cloud.")
+
+        ("outputDir,o", value<fs::path>(&outputDir)->default_value(outputDir),
+         "A Directory for the output.")
+
+        ("tempDir,t", value<fs::path>(&tempDir)->default_value(tempDir),
+         "A Directory for the memory mapped files of the grid.")
+
+        ("voxelSize,v", value<float>(&voxelSize)->default_value(voxelSize),
+         "Cell size of the grid. Cells are never split between octree nodes.")
+
+        ("scale,s", value<float>(&scale)->default_value(scale),
+         "Scale the points.")
+
+        ("maxPoints,m", value<size_t>(&lodOptions.maxPointsPerNode)->default_value(lodOptions.maxPointsPerNode),
+         "Nodes with more points are split.")
+
+        ("resolution,r", value<uint32_t>(&lodOptions.samplingResolution)->default_value(lodOptions.samplingResolution),
+         "Resolution of the sampling grid of inner nodes. Inner nodes keep at most one point per grid cell.")
+
+        ("help,h", bool_switch(&help),
+         "Print this message here.")
+        ;
+
+        positional_options_description pos;
+        pos.add("inputFile", 1);
+        pos.add("outputDir", 1);
+
+        variables_map variables;
+        store(command_line_parser(argc, argv).options(options).positional(pos).run(), variables);
+        notify(variables);
+
+        if (help)
+        {
+            std::stringstream options_ss;
+            options.print(options_ss);
+
+            lvr2::logout::get() << lvr2::info
+                << "Exports a level of detail octree of a point cloud" << lvr2::endl
+                << "Usage: " << lvr2::endl
+                << "    lvr2_pointcloud_lod [OPTIONS] <inputFile> [<outputDir>]" << lvr2::endl
+                << lvr2::endl
+                << options_ss.str() << lvr2::endl
+                << "See lvr2/io/PointLODIO.hpp for the output format." << lvr2::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if (variables.count("inputFile") == 0)
+        {
+            throw po::error("Missing <inputFile> Parameter");
+        }
+        if (!fs::exists(inputFile))
+        {
+            throw po::error("Input file does not exist");
+        }
+        if (voxelSize <= 0.0f || lodOptions.maxPointsPerNode == 0 || lodOptions.samplingResolution == 0)
+        {
+            throw po::error("voxelSize, maxPoints and resolution must be positive");
+        }
+    }
+    catch (const boost::program_options::error& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << std::endl;
+        std::cerr << "Use '--help' to see the list of possible options" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ScanProjectEditMarkPtr project = loadProject(inputFile);
+    if (!project->project || project->project->positions.empty())
+    {
+        lvr2::logout::get() << lvr2::error << "Unable to load any points from " << inputFile << lvr2::endl;
+        return EXIT_FAILURE;
+    }
+
+    fs::create_directories(tempDir);
+    BigGrid<Vec> grid(voxelSize, project, tempDir, scale);
+    project.reset();
+
+    BigGridLOD<Vec> lod(grid, lodOptions);
+    lod.write(outputDir.string());
+
+    return EXIT_SUCCESS;
+}
@@ -26,8 +26,11 @@
  */
 
 
+#include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <stdlib.h>
 
@@ -52,6 +55,7 @@
 #include "lvr2/algorithm/ClusterAlgorithms.hpp"
 #include "lvr2/algorithm/CleanupAlgorithms.hpp"
 #include "lvr2/algorithm/ReductionAlgorithms.hpp"
+#include "lvr2/algorithm/StatisticalOutlierFilter.hpp"
 #include "lvr2/algorithm/Materializer.hpp"
 #include "lvr2/algorithm/Texturizer.hpp"
 #include "lvr2/reconstruction/AdaptiveKSearchSurface.hpp" // Has to be included before anything includes opencv stuff, see https://github.com/flann-lib/flann/issues/214 
@@ -90,6 +94,8 @@
 
 #include "Options.hpp"
 
+#include "ctpl_stl.h"
+
 #if defined LVR2_USE_CUDA
     #define GPU_FOUND
 
@@ -113,121 +119,320 @@ using namespace lvr2;
 using Vec = BaseVector<float>;
 using PsSurface = lvr2::PointsetSurface<Vec>;
 
-auto buildCombinedPointCloud(lvr2::ScanProjectPtr& project, lvr2::ReductionAlgorithmPtr reduction_algorithm) -> lvr2::PointBufferPtr
+/// A scan of the project and its transformation into project coordinates
+struct CombinedScan
 {
-    // === Build the PointCloud ===
-    lvr2::Monitor mon(lvr2::LogLevel::info, "[LVR2 Reconstruct] Loading scan positions", project->positions.size());
+    ScanPtr     scan;
+    Transformf  transform;
+};
+
+/**
+ * @brief Copies the points of a scan into the given output arrays and 
+ *        transforms them into project coordinates on the fly, so that 
+ *        the source buffer is left untouched. Normals are rotated with 
+ *        the inverse transpose of the rotational part.
+ */
+void copyTransformed(
+    const PointBufferPtr& points, 
+    const Transformf& transform, 
+    size_t n, 
+    float* coords, 
+    float* normals)
+{
+    const Eigen::Matrix3f rotation = transform.block<3, 3>(0, 0);
+    const Eigen::Vector3f translation = transform.block<3, 1>(0, 3);
+
+    const float* src = points->getPointArray().get();
+    for (size_t i = 0; i < n; i++)
+    {
+        Eigen::Map<Eigen::Vector3f>(coords + 3 * i) = 
+            rotation * Eigen::Map<const Eigen::Vector3f>(src + 3 * i) + translation;
+    }
 
-    size_t npoints_total = 0;
-    // Count total number of points
-    for (auto pos: project->positions)
+    if (normals)
     {
-        for (auto lidar: pos->lidars)
+        const Eigen::Matrix3f normalRotation = rotation.inverse().transpose();
+        const float* srcNormals = points->getNormalArray().get();
+        for (size_t i = 0; i < n; i++)
         {
-            for (auto scan: lidar->scans)
+            Eigen::Map<Eigen::Vector3f>(normals + 3 * i) = 
+                normalRotation * Eigen::Map<const Eigen::Vector3f>(srcNormals + 3 * i);
+        }
+    }
+}
+
+/**
+ * @brief Merges all scans of the project into a single point buffer in
+ *        project coordinates.
+ * 
+ *        Scans are loaded and processed concurrently on a thread pool, at
+ *        most one scan per worker is held in memory. Loading is serialized 
+ *        since the IO kernels are not thread safe. Normals and colors are
+ *        only kept if every scan provides them, their arrays are allocated 
+ *        when the first scan that has them arrives.
+ * 
+ *        Without reduction, the output offsets are known from the scan meta 
+ *        data and every scan is written directly into its final place. With
+ *        reduction, or if the meta data lacks point counts, every worker 
+ *        reduces its scan with its own reduction instance and the scans are
+ *        merged once all are done.
+ * 
+ * @param project           The scan project
+ * @param makeReduction     Creates a reduction algorithm per scan. May be empty.
+ * @param numThreads        Number of scans processed concurrently
+ */
+auto buildCombinedPointCloud(
+    lvr2::ScanProjectPtr& project, 
+    std::function<lvr2::ReductionAlgorithmPtr()> makeReduction,
+    size_t numThreads) -> lvr2::PointBufferPtr
+{
+    // === Build the PointCloud ===
+    std::vector<CombinedScan> scans;
+    for (ScanPositionPtr pos: project->positions)
+    {
+        for (LIDARPtr lidar: pos->lidars)
+        {
+            for (ScanPtr scan: lidar->scans)
             {
-                npoints_total += scan->numPoints;
+                scans.push_back({scan, (pos->transformation * lidar->transformation * scan->transformation).cast<float>()});
             }
         }
     }
 
-    // Allocate buffers for coordinates, colors and normals
-    lvr2::floatArr coords(new float[npoints_total * 3]);
-    lvr2::floatArr normals(new float[npoints_total * 3]);
-    lvr2::ucharArr colors(new uchar[npoints_total * 3]);
-    auto coord_output = coords.get();
-    auto normal_output = normals.get();
-    auto color_output = colors.get();
+    // Count total number of points. Without reduction, the final position 
+    // of each scan in the output arrays is known from the meta data.
+    std::vector<size_t> offsets(scans.size() + 1, 0);
+    bool direct = !makeReduction;
+    for (size_t i = 0; i < scans.size(); i++)
+    {
+        offsets[i + 1] = offsets[i] + scans[i].scan->numPoints;
+        direct = direct && scans[i].scan->numPoints;
+    }
+    size_t npoints_total = offsets.back();
+
+    lvr2::logout::get() << "[LVR2 Reconstruct] Total number of points: " << npoints_total << lvr2::endl;
+
+    lvr2::Monitor mon(lvr2::LogLevel::info, "[LVR2 Reconstruct] Loading scans", scans.size());
 
+    // Kernels are not thread safe
+    std::mutex ioMutex;
+
+    // Output channels, only allocated when needed. Guarded by channelMutex.
+    std::mutex channelMutex;
+    lvr2::floatArr coords;
+    lvr2::floatArr normals;
+    lvr2::ucharArr colors;
     bool has_normals = true;
     bool has_colors = true;
-    int color_width = -1;
+    size_t color_width = 0;
 
-    lvr2::logout::get() << "[LVR2 Reconstruct] Total number of points: " << npoints_total << lvr2::endl;
+    // Number of points actually written per scan in direct mode
+    std::vector<size_t> written(scans.size(), 0);
 
-    for (ScanPositionPtr pos: project->positions)
+    // Reduced scans in reduction mode
+    std::vector<PointBufferPtr> reduced(scans.size());
+
+    if (direct)
     {
-        ++mon;
-        for (LIDARPtr lidar: pos->lidars)
+        coords = lvr2::floatArr(new float[npoints_total * 3]);
+    }
+
+    auto process = [&](size_t i)
+    {
+        // Workers run side by side, keep nested parallel regions serial
+        OpenMPConfig::setNumThreads(1);
+
+        const CombinedScan& s = scans[i];
+        PointBufferPtr points;
         {
-            for (ScanPtr scan: lidar->scans)
+            std::lock_guard<std::mutex> lock(ioMutex);
+            points = s.scan->loaded() ? s.scan->points : s.scan->points_loader();
+        }
+
+        if (!direct)
+        {
+            if (points && makeReduction)
             {
-                // Load scan
-                bool was_loaded = scan->loaded();
-                if (!scan->loaded())
-                {
-                    scan->load(reduction_algorithm);
-                }
+                ReductionAlgorithmPtr reduction = makeReduction();
+                reduction->setPointBuffer(points);
+                points = reduction->getReducedPoints();
+            }
+            reduced[i] = points;
+            ++mon;
+            return;
+        }
 
-                // Transform the new pointcloud
-                transformPointCloud<float>(
-                    std::make_shared<Model>(scan->points),
-                    (pos->transformation * lidar->transformation * scan->transformation).cast<float>());
-                
-                // Copy coordinates
-                coord_output = std::copy(
-                    scan->points->getPointArray().get(),
-                    scan->points->getPointArray().get() + (scan->points->numPoints() * 3),
-                    coord_output
-                );
+        size_t n = points ? points->numPoints() : 0;
+        if (n > s.scan->numPoints)
+        {
+            lvr2::logout::get() << lvr2::warning << "[LVR2 Reconstruct] Scan has " << n << " points, but meta data reports "
+                                << s.scan->numPoints << ". Ignoring additional points." << lvr2::endl;
+            n = s.scan->numPoints;
+        }
 
-                // Copy normals
-                if (scan->points->hasNormals() && has_normals)
+        // Decide which attribute channels survive. Local copies keep 
+        // the arrays alive even if another worker drops a channel.
+        lvr2::floatArr normalOut;
+        lvr2::ucharArr colorOut;
+        size_t width = 0;
+        {
+            std::lock_guard<std::mutex> lock(channelMutex);
+            if (has_normals && n)
+            {
+                if (!points->hasNormals())
                 {
-                    normal_output = std::copy(
-                        scan->points->getNormalArray().get(),
-                        scan->points->getNormalArray().get() + (scan->points->numPoints() * 3),
-                        normal_output
-                    );
+                    has_normals = false;
+                    normals.reset();
                 }
-                else
+                else if (!normals)
                 {
-                    has_normals = false;
+                    normals = lvr2::floatArr(new float[npoints_total * 3]);
                 }
+            }
 
-                // Copy colors
-                if (scan->points->hasColors() && has_colors)
+            if (has_colors && n)
+            {
+                if (!points->hasColors())
                 {
-                    size_t width;
-                    scan->points->getColorArray(width);
-                    if (width == color_width || color_width == -1)
+                    has_colors = false;
+                    colors.reset();
+                }
+                else
+                {
+                    points->getColorArray(width);
+                    if (!colors)
                     {
                         color_width = width;
-                        color_output = std::copy(
-                            scan->points->getColorArray(width).get(),
-                            scan->points->getColorArray(width).get() + (scan->points->numPoints() * width),
-                            color_output
-                        );
+                        colors = lvr2::ucharArr(new uchar[npoints_total * color_width]);
                     }
-                    else
+                    else if (width != color_width)
                     {
                         has_colors = false;
+                        colors.reset();
                     }
+                }
+            }
+
+            normalOut = normals;
+            colorOut = colors;
+        }
+
+        copyTransformed(points, s.transform, n, 
+            coords.get() + 3 * offsets[i], 
+            normalOut ? normalOut.get() + 3 * offsets[i] : nullptr);
+
+        if (colorOut)
+        {
+            const uchar* src = points->getColorArray(width).get();
+            std::copy(src, src + n * color_width, colorOut.get() + color_width * offsets[i]);
+        }
+
+        written[i] = n;
+        ++mon;
+    };
+
+    ctpl::thread_pool pool(std::max<size_t>(1, numThreads));
+    std::vector<std::future<void>> results;
+    for (size_t i = 0; i < scans.size(); i++)
+    {
+        results.push_back(pool.push([&process, i](int) { process(i); }));
+    }
+    for (auto& result : results)
+    {
+        result.get();
+    }
+    mon.terminate();
 
+    if (direct)
+    {
+        // Close gaps left by scans that contained fewer points than announced
+        size_t n = 0;
+        for (size_t i = 0; i < scans.size(); i++)
+        {
+            if (n != offsets[i])
+            {
+                std::copy(coords.get() + 3 * offsets[i], coords.get() + 3 * (offsets[i] + written[i]), coords.get() + 3 * n);
+                if (normals)
+                {
+                    std::copy(normals.get() + 3 * offsets[i], normals.get() + 3 * (offsets[i] + written[i]), normals.get() + 3 * n);
+                }
+                if (colors)
+                {
+                    std::copy(colors.get() + color_width * offsets[i], colors.get() + color_width * (offsets[i] + written[i]), colors.get() + color_width * n);
+                }
+            }
+            n += written[i];
+        }
+        npoints_total = n;
+    }
+    else
+    {
+        // Merge the reduced scans into their final places
+        for (size_t i = 0; i < scans.size(); i++)
+        {
+            const PointBufferPtr& points = reduced[i];
+            const size_t n = points ? points->numPoints() : 0;
+            offsets[i + 1] = offsets[i] + n;
+            if (n)
+            {
+                has_normals = has_normals && points->hasNormals();
+                if (has_colors && points->hasColors())
+                {
+                    size_t width;
+                    points->getColorArray(width);
+                    has_colors = !color_width || width == color_width;
+                    color_width = width;
                 }
                 else
                 {
                     has_colors = false;
                 }
-                
-                // If not previously loaded unload
-                if (!was_loaded)
+            }
+        }
+        npoints_total = offsets.back();
+
+        coords = lvr2::floatArr(new float[npoints_total * 3]);
+        if (has_normals)
+        {
+            normals = lvr2::floatArr(new float[npoints_total * 3]);
+        }
+        if (has_colors && color_width)
+        {
+            colors = lvr2::ucharArr(new uchar[npoints_total * color_width]);
+        }
+
+        #pragma omp parallel for schedule(dynamic)
+        for (size_t i = 0; i < scans.size(); i++)
+        {
+            const size_t n = offsets[i + 1] - offsets[i];
+            if (n)
+            {
+                copyTransformed(reduced[i], scans[i].transform, n, 
+                    coords.get() + 3 * offsets[i], 
+                    normals ? normals.get() + 3 * offsets[i] : nullptr);
+
+                if (colors)
                 {
-                    scan->release();
+                    size_t width;
+                    const uchar* src = reduced[i]->getColorArray(width).get();
+                    std::copy(src, src + n * color_width, colors.get() + color_width * offsets[i]);
                 }
             }
+            reduced[i].reset();
         }
     }
 
+    lvr2::logout::get() << "[LVR2 Reconstruct] Number of merged points: " << npoints_total << lvr2::endl;
+
     // Create new point buffer
     auto retval = std::make_shared<PointBuffer>(coords, npoints_total);
     // Add normals
-    if (has_normals)
+    if (normals)
     {
         retval->setNormalArray(normals, npoints_total);
     }
     // Add colors
-    if (has_colors)
+    if (colors)
     {
         retval->setColorArray(colors, npoints_total, color_width);
     }
@@ -245,15 +450,45 @@ PointsetSurfacePtr<BaseVecT> loadPointCloud(const reconstruct::Options& options)
     // Parse loaded data
     if (!model)
     {
-        ReductionAlgorithmPtr reduction_algorithm;
-        // If the user supplied valid octree reduction parameters use octree reduction otherwise use no reduction
-        if (options.getOctreeVoxelSize() > 0.0f)
-        {
-            reduction_algorithm = std::make_shared<OctreeReductionAlgorithm>(options.getOctreeVoxelSize(), options.getOctreeMinPoints());
-        }
-        else
+        // If the user supplied valid outlier removal or octree reduction parameters
+        // apply them, outlier removal first, otherwise use no reduction. Each scan gets
+        // its own reduction instance, since scans are reduced concurrently.
+        std::function<ReductionAlgorithmPtr()> make_reduction;
+        const bool removeOutliers = options.getOutlierK() > 0 || options.getOutlierRadius() > 0.0f;
+        const bool reduceOctree = options.getOctreeVoxelSize() > 0.0f;
+        if (removeOutliers || reduceOctree)
         {
-            reduction_algorithm = std::make_shared<NoReductionAlgorithm>();
+            OutlierReductionAlgorithm::Filter::Options outlierOptions;
+            if (options.getOutlierK() > 0)
+            {
+                outlierOptions.k = options.getOutlierK();
+                outlierOptions.stdDevMult = options.getOutlierStdDev();
+            }
+            else
+            {
+                outlierOptions.mode = OutlierReductionAlgorithm::Filter::Mode::Radius;
+                outlierOptions.radius = options.getOutlierRadius();
+                outlierOptions.minNeighbors = options.getOutlierMinNeighbors();
+            }
+            const float voxelSize = options.getOctreeVoxelSize();
+            const size_t minPoints = options.getOctreeMinPoints();
+            make_reduction = [=]()
+            {
+                std::vector<ReductionAlgorithmPtr> reductions;
+                if (removeOutliers)
+                {
+                    reductions.push_back(std::make_shared<OutlierReductionAlgorithm>(outlierOptions));
+                }
+                if (reduceOctree)
+                {
+                    reductions.push_back(std::make_shared<OctreeReductionAlgorithm>(voxelSize, minPoints));
+                }
+                if (reductions.size() == 1)
+                {
+                    return reductions.front();
+                }
+                return ReductionAlgorithmPtr(new SequentialReductionAlgorithm(reductions));
+            };
         }
         
         lvr2::ScanProjectPtr project;
@@ -271,7 +506,7 @@ PointsetSurfacePtr<BaseVecT> loadPointCloud(const reconstruct::Options& options)
             project = lvr2::loadScanProject(options.getInputSchema(), options.getInputFileName());
         }
         
-        buffer = buildCombinedPointCloud(project, reduction_algorithm);
+        buffer = buildCombinedPointCloud(project, make_reduction, options.getNumThreads());
     }
     else 
     {
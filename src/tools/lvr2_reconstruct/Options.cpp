@@ -127,6 +127,10 @@ Options::Options(int argc, char** argv)
         ("inputMeshFile", value<string>(&m_inputMeshFile), "The file to load the mesh from")
         ("reduceScan", value<float>(&m_octreeVoxelSize)->default_value(0.0f), "Use Octree reduction algorithm with the given gridsize when after loading the scans")
         ("reduceScanMinPoints", value<size_t>(&m_octreeMinPoints)->default_value(1), "The number of points an octree voxel has to contain to be considered occupied")
+        ("outlierK", value<int>(&m_outlierK)->default_value(0), "Remove statistical outliers from the scans after loading, using the mean distance to this many nearest neighbors. 0 disables the filter")
+        ("outlierStdDev", value<float>(&m_outlierStdDev)->default_value(1.0f), "Points whose mean neighbor distance exceeds the global mean by more than this many standard deviations are outliers")
+        ("outlierRadius", value<float>(&m_outlierRadius)->default_value(0.0f), "Remove points from the scans after loading that have less than outlierMinNeighbors neighbors within this radius. 0 disables the filter")
+        ("outlierMinNeighbors", value<int>(&m_outlierMinNeighbors)->default_value(2), "Number of neighbors a point needs within outlierRadius to be kept")
 #ifdef LVR2_USE_EMBREE
         ("useRaycastingTexturizer", "If this flag is set the RaycastingTexturizer is used. This uses raycasting for occlusion testing when generating the textures.")
 #endif
@@ -543,6 +547,26 @@ size_t Options::getOctreeMinPoints() const
     return m_octreeMinPoints;
 }
 
+int Options::getOutlierK() const
+{
+    return m_outlierK;
+}
+
+float Options::getOutlierStdDev() const
+{
+    return m_outlierStdDev;
+}
+
+float Options::getOutlierRadius() const
+{
+    return m_outlierRadius;
+}
+
+int Options::getOutlierMinNeighbors() const
+{
+    return m_outlierMinNeighbors;
+}
+
 bool Options::useRaycastingTexturizer() const
 {
     return m_variables.count("useRaycastingTexturizer");
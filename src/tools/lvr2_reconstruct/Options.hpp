@@ -379,6 +379,14 @@ public:
 
     size_t getOctreeMinPoints() const;
 
+    int getOutlierK() const;
+
+    float getOutlierStdDev() const;
+
+    float getOutlierRadius() const;
+
+    int getOutlierMinNeighbors() const;
+
     bool useRaycastingTexturizer() const;
 
     const std::string& getInputSchema() const;
@@ -529,6 +537,18 @@ private:
     /// Octree min points
     size_t m_octreeMinPoints;
 
+    /// Number of neighbors for statistical outlier removal
+    int m_outlierK;
+
+    /// Standard deviation multiplier for statistical outlier removal
+    float m_outlierStdDev;
+
+    /// Search radius for radius outlier removal
+    float m_outlierRadius;
+
+    /// Minimum number of neighbors for radius outlier removal
+    int m_outlierMinNeighbors;
+
     /// Input ScanProjectSchema
     std::string m_inputSchema;
 
@@ -177,6 +177,10 @@ int main(int argc, char** argv)
          "Also used in GraphSLAM when considering other Scans for Edges\n"
          "For Loopclosing, this value needs to be at least 6, for GraphSLAM at least 1.")
 
+        ("verifyCloseScans", bool_switch(&options.verifyCloseScans),
+         "Compare the close Scans found for Loopclosing and GraphSLAM to an exhaustive search and print any difference.\n"
+         "The exhaustive search is slow, so this is only meant for checking the results.")
+
         ("slamIterations,I", value<int>(&options.slamIterations)->default_value(options.slamIterations),
          "Number of iterations for SLAM.")
 
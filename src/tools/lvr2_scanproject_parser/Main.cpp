@@ -49,7 +49,13 @@ int main(int argc, char** argv)
 
     if(options.computeNormals())
     {
-        estimateProjectNormals(workProject, options.kn(), options.ki());
+        ProjectNormalOptions normalOptions;
+        normalOptions.kn = options.kn();
+        normalOptions.ki = options.ki();
+        normalOptions.numThreads = options.normalThreads();
+        normalOptions.prefetch = options.prefetch();
+        normalOptions.memoryBudget = options.memoryBudget() * 1024 * 1024;
+        estimateProjectNormals(workProject, normalOptions);
     }
 
     if(options.convert())
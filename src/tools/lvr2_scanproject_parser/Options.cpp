@@ -74,6 +74,9 @@ Options::Options(int argc, char** argv) : lvr2::BaseOption(argc, argv), m_descr(
         ("scanpositions",  value<std::vector<size_t>>()->multitoken(), "List of scan positions to load from a scan project")
         ("kn", value<size_t>()->default_value(100), "Number of nearest neighbors for normal estimation")
         ("ki", value<size_t>()->default_value(100), "Number of nearest neighbors for normal interpolation")
+        ("normalThreads", value<size_t>()->default_value(0), "Number of scans processed concurrently during normal estimation (0: all cores)")
+        ("prefetch", value<size_t>()->default_value(2), "Number of scans loaded ahead during normal estimation")
+        ("memoryBudget", value<size_t>()->default_value(0), "Memory budget for scans in flight during normal estimation in MB (0: unlimited)")
         ("printStructure,p", "Print structure of the loaded scan project")
         ("computeNormals,n", "Compute normals for each scan position in the project")
         ("convert,c", "Convert and save structure in a new schema defined by outputSchema and outputStructure")
@@ -86,6 +86,9 @@ class Options : public lvr2::BaseOption
 
     size_t kn() const {return m_variables["kn"].as<size_t>();}
     size_t ki() const {return m_variables["ki"].as<size_t>();}
+    size_t normalThreads() const {return m_variables["normalThreads"].as<size_t>();}
+    size_t prefetch() const {return m_variables["prefetch"].as<size_t>();}
+    size_t memoryBudget() const {return m_variables["memoryBudget"].as<size_t>();}
     size_t getMinPointsInVoxel() const {return m_variables["minPointsInVoxel"].as<size_t>();}
 
     std::vector<size_t> scanPositions()